@@ -0,0 +1,66 @@
+// bench_pdf_objects.cpp — wall time of the object-level PDF path (extract_pdf_objects),
+// load included, over the SAME in-memory bytes, best of N. Prints the bbox / font / style
+// counts beside the time so a faster build that extracts something different shows up.
+//
+//   bench_pdf_objects <file.pdf> [file2.pdf ...]       (BBOXES_PDFIUM_PATH as for the library)
+//
+// The 1,000-page input used for the numbers in the history was assembled with pypdfium2
+// by importing the pages of test_data/sample.pdf and the %PDF- files under
+// test_data/synthetic cyclically until the document held 1,000 pages:
+//
+//   dst = pdfium.PdfDocument.new()
+//   while len(dst) < 1000: dst.import_pages(pdfium.PdfDocument(next(srcs)))
+//   dst.save("p1000.pdf")
+#include "bboxes.h"
+#include "bboxes_types.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using clk = std::chrono::steady_clock;
+static double ms(clk::time_point a, clk::time_point b) {
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+static std::vector<uint8_t> read_file(const char* path) {
+    std::vector<uint8_t> buf;
+    FILE* f = std::fopen(path, "rb");
+    if (!f) return buf;
+    std::fseek(f, 0, SEEK_END);
+    long n = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    buf.resize(n > 0 ? n : 0);
+    if (n > 0 && std::fread(buf.data(), 1, n, f) != (size_t)n) buf.clear();
+    std::fclose(f);
+    return buf;
+}
+
+int main(int argc, char** argv) {
+    bboxes_pdf_init();
+    std::printf("%-26s %6s %9s %6s %7s %10s %8s\n",
+                "file", "pages", "bboxes", "fonts", "styles", "best ms", "ms/page");
+    for (int i = 1; i < argc; i++) {
+        auto bytes = read_file(argv[i]);
+        if (bytes.empty()) { std::printf("%-26s (unreadable)\n", argv[i]); continue; }
+        double best = 1e18;
+        BBoxResult r;
+        for (int rep = 0; rep < 5; rep++) {
+            auto t0 = clk::now();
+            r = extract_pdf_objects(bytes.data(), bytes.size(), nullptr, 0, 0, false);
+            auto t1 = clk::now();
+            best = std::min(best, ms(t0, t1));
+        }
+        size_t n = 0;
+        for (auto& p : r.pages) n += p.bboxes.size();
+        const char* base = std::strrchr(argv[i], '/');
+        std::printf("%-26s %6d %9zu %6zu %7zu %10.0f %8.2f\n",
+                    base ? base + 1 : argv[i], r.page_count, n, r.fonts.entries.size(),
+                    r.styles.entries.size(), best, r.page_count > 0 ? best / r.page_count : 0.0);
+    }
+    bboxes_pdf_destroy();
+    return 0;
+}
@@ -1,4 +1,4 @@
-//! blobboxes — bounding-box extraction from PDF/XLSX/DOCX/HTML/XLS/text,
+//! blobboxes — bounding-box extraction from PDF/XLSX/XLSB/ODS/DOCX/HTML/XLS/DOC/text,
 //! for DuckDB / SQLite / Python.
 //!
 //! The largest CMakeLists in the family (317 lines) and the most dependencies,
@@ -65,6 +65,8 @@ const core_sources: []const []const u8 = &.{
     "src/bboxes_pdf.cpp",
     "src/bboxes_meta.cpp",
     "src/bboxes_xfdf.cpp",
+    "src/bboxes_layout.cpp",
+    "src/bboxes_probe.cpp",
     // The PDFium dlopen loader. Always compiled: bboxes_pdf.cpp is always
     // compiled, and it now reaches PDFium only through these pointers.
     "src/pdfium_dyn.cpp",
@@ -104,10 +106,12 @@ const backends: []const Backend = &.{
     .{
         .name = "xls",
         .define = "BBOXES_HAS_XLS",
-        // Two lanes: libxls for cells/colours, and our own BIFF walker over the
-        // vendored compoundfilereader for formulas, defined names and VBA.
+        // Two lanes: our own BIFF walker over the CFB reader in
+        // include/bboxes_cfb.h (vendored compoundfilereader structs) for
+        // cells, formulas, defined names and VBA; libxls for document
+        // properties and the per-XF style decode.
         .sources = &.{ "src/bboxes_xls.cpp", "src/bboxes_xls_biff.cpp" },
-        .help = "Legacy .xls backend (libxls + our BIFF/OLE2 walker)",
+        .help = "Legacy .xls backend (our BIFF/OLE2 walker + libxls)",
     },
     .{
         .name = "docx",
@@ -115,6 +119,24 @@ const backends: []const Backend = &.{
         .sources = &.{"src/bboxes_docx.cpp"},
         .help = "DOCX backend (pugixml + miniz, both always linked)",
     },
+    .{
+        .name = "doc",
+        .define = "BBOXES_HAS_DOC",
+        .sources = &.{"src/bboxes_doc.cpp"},
+        .help = "Legacy .doc backend (Word 97 piece table over the CFB reader)",
+    },
+    .{
+        .name = "xlsb",
+        .define = "BBOXES_HAS_XLSB",
+        .sources = &.{"src/bboxes_xlsb.cpp"},
+        .help = "Binary workbook backend (BIFF12 records; miniz, always linked)",
+    },
+    .{
+        .name = "ods",
+        .define = "BBOXES_HAS_ODS",
+        .sources = &.{"src/bboxes_ods.cpp"},
+        .help = "OpenDocument spreadsheet backend (content.xml byte scan; miniz, always linked)",
+    },
 };
 
 /// xlnt's sources, for the high-fidelity XLSX reader.
@@ -334,6 +356,10 @@ fn addCore(b: *std.Build, mod: *std.Build.Module, d: Deps) void {
     mod.addIncludePath(b.path("include"));
     mod.addIncludePath(d.json.path("include"));
     mod.addIncludePath(d.pdfium.path("include"));
+    // The OLE2/CFB structs behind include/bboxes_cfb.h, header-only and
+    // vendored: the xls and doc backends read through it, and detection
+    // looks at an OLE2 directory to tell the two apart.
+    mod.addIncludePath(b.path("third_party/compoundfilereader"));
 
     for (core_sources) |src| {
         mod.addCSourceFile(.{ .file = b.path(src), .flags = cxx_flags });
@@ -407,8 +433,6 @@ fn addCore(b: *std.Build, mod: *std.Build.Module, d: Deps) void {
         mod.addIncludePath(libxls.path("include"));
         // Hand-authored stand-in for the autotools config.h. See the header.
         mod.addIncludePath(b.path("third_party/libxls"));
-        // The BIFF walker's OLE2/CFB reader, header-only and vendored.
-        mod.addIncludePath(b.path("third_party/compoundfilereader"));
         for (libxls_sources) |src| {
             mod.addCSourceFile(.{ .file = libxls.path(src), .flags = cFlags(t) });
         }
@@ -51,6 +51,8 @@ struct BindData {
     char*             file_path = nullptr;  // path variant (freed with duckdb_free)
     std::vector<char> blob;                 // blob variant (bytes already in hand)
     bool              is_blob = false;
+    int32_t           start_page = 0;       // 1-based inclusive; 0 = from the first
+    int32_t           end_page = 0;         //                   0 = to the last
 };
 
 struct InitData {
@@ -65,13 +67,32 @@ static void bind_data_dtor(void* p) {
     delete d;
 }
 
-static void shared_bind_path(duckdb_bind_info info, BindData** out) {
+/* False when the bind failed (the error is set; the caller returns). */
+static bool shared_bind_path(duckdb_bind_info info, BindData** out) {
     duckdb_value val = duckdb_bind_get_parameter(info, 0);
     auto* data = new BindData{};
     data->file_path = duckdb_get_varchar(val);
     duckdb_destroy_value(&val);
+    /* start_page / end_page named parameters (path variant only). PDF honours
+       them without reading the rest of the file; see bboxes_open_format_file. */
+    duckdb_value sp = duckdb_bind_get_named_parameter(info, "start_page");
+    if (sp) { data->start_page = duckdb_get_int32(sp); duckdb_destroy_value(&sp); }
+    duckdb_value ep = duckdb_bind_get_named_parameter(info, "end_page");
+    if (ep) { data->end_page = duckdb_get_int32(ep); duckdb_destroy_value(&ep); }
     duckdb_bind_set_bind_data(info, data, bind_data_dtor);
     *out = data;
+    /* The flow formats are one page with nothing to range over; refuse a range
+       rather than ignore it. AUTO resolves per file, in the library. */
+    auto* fmt_ptr = static_cast<Format*>(duckdb_bind_get_extra_info(info));
+    Format fmt = fmt_ptr ? *fmt_ptr : BBOXES_FORMAT_AUTO;
+    bool paged = fmt == BBOXES_FORMAT_AUTO || fmt == BBOXES_FORMAT_PDF
+              || fmt == BBOXES_FORMAT_PDF_OBJECTS || fmt == BBOXES_FORMAT_XLSX
+              || fmt == BBOXES_FORMAT_XLSX_FAST;
+    if (!paged && (data->start_page || data->end_page)) {
+        duckdb_bind_set_error(info, "start_page / end_page apply to PDF and spreadsheet formats only");
+        return false;
+    }
+    return true;
 }
 
 static void shared_bind_blob(duckdb_bind_info info, BindData** out) {
@@ -98,13 +119,20 @@ static void generic_init(duckdb_init_info info) {
     auto* data = new InitData{};
     data->fmt = fmt;
     data->cursor = nullptr;
-    data->buf = bind->is_blob ? bind->blob : read_file(bind->file_path);
     /* Reliability lives HERE so every consumer benefits (glob/batch scans, any
        driver): an unreadable or unparseable file yields ZERO rows, never a query
        abort — the scan skips it instead of failing. Matches the SQLite vtab, which
-       already sets eof on open failure. The cursor stays null; the func emits 0 rows. */
-    if (!data->buf.empty())
-        data->cursor = bboxes_open_format(fmt, data->buf.data(), data->buf.size());
+       already sets eof on open failure. The cursor stays null; the func emits 0 rows.
+       A path is handed to the library rather than read here, so a PDF page range
+       pulls only the byte ranges PDFium needs. */
+    if (bind->is_blob) {
+        data->buf = bind->blob;
+        if (!data->buf.empty())
+            data->cursor = bboxes_open_format(fmt, data->buf.data(), data->buf.size());
+    } else if (bind->file_path) {
+        data->cursor = bboxes_open_format_file(fmt, bind->file_path,
+                                               bind->start_page, bind->end_page);
+    }
     duckdb_init_set_max_threads(info, 1);
     duckdb_init_set_init_data(info, data, [](void* p) {
         auto* d = static_cast<InitData*>(p);
@@ -117,7 +145,7 @@ static void generic_init(duckdb_init_info info) {
 
 static void doc_bind(duckdb_bind_info info) {
     BindData* data;
-    shared_bind_path(info, &data);
+    if (!shared_bind_path(info, &data)) return;
 
     duckdb_logical_type t_int = duckdb_create_logical_type(DUCKDB_TYPE_INTEGER);
     duckdb_logical_type t_str = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
@@ -166,7 +194,7 @@ static void doc_func(duckdb_function_info info, duckdb_data_chunk output) {
 
 static void pages_bind(duckdb_bind_info info) {
     BindData* data;
-    shared_bind_path(info, &data);
+    if (!shared_bind_path(info, &data)) return;
 
     duckdb_logical_type t_int = duckdb_create_logical_type(DUCKDB_TYPE_INTEGER);
     duckdb_logical_type t_dbl = duckdb_create_logical_type(DUCKDB_TYPE_DOUBLE);
@@ -210,7 +238,7 @@ static void pages_func(duckdb_function_info info, duckdb_data_chunk output) {
 
 static void fonts_bind(duckdb_bind_info info) {
     BindData* data;
-    shared_bind_path(info, &data);
+    if (!shared_bind_path(info, &data)) return;
 
     duckdb_logical_type t_int = duckdb_create_logical_type(DUCKDB_TYPE_INTEGER);
     duckdb_logical_type t_str = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
@@ -245,7 +273,7 @@ static void fonts_func(duckdb_function_info info, duckdb_data_chunk output) {
 
 static void styles_bind(duckdb_bind_info info) {
     BindData* data;
-    shared_bind_path(info, &data);
+    if (!shared_bind_path(info, &data)) return;
 
     duckdb_logical_type t_int = duckdb_create_logical_type(DUCKDB_TYPE_INTEGER);
     duckdb_logical_type t_dbl = duckdb_create_logical_type(DUCKDB_TYPE_DOUBLE);
@@ -304,6 +332,7 @@ static void bboxes_declare_columns(duckdb_bind_info info) {
     duckdb_logical_type t_dbl = duckdb_create_logical_type(DUCKDB_TYPE_DOUBLE);
     duckdb_logical_type t_str = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
     duckdb_logical_type t_bool = duckdb_create_logical_type(DUCKDB_TYPE_BOOLEAN);
+    duckdb_logical_type t_ts = duckdb_create_logical_type(DUCKDB_TYPE_TIMESTAMP);
     /* xlsx/text/docx address an integer cell grid; pdf/AUTO keep float coords. */
     duckdb_logical_type t_coord = bboxes_format_int_coords(fmt) ? t_int : t_dbl;
 
@@ -317,6 +346,7 @@ static void bboxes_declare_columns(duckdb_bind_info info) {
     duckdb_bind_add_result_column(info, "cell_type", t_str);
     duckdb_bind_add_result_column(info, "vnum", t_dbl);
     duckdb_bind_add_result_column(info, "vbool", t_bool);
+    duckdb_bind_add_result_column(info, "vdate", t_ts);   /* date-formatted numbers */
     duckdb_bind_add_result_column(info, "text", t_str);
     duckdb_bind_add_result_column(info, "formula", t_str);
 
@@ -324,11 +354,12 @@ static void bboxes_declare_columns(duckdb_bind_info info) {
     duckdb_destroy_logical_type(&t_dbl);
     duckdb_destroy_logical_type(&t_str);
     duckdb_destroy_logical_type(&t_bool);
+    duckdb_destroy_logical_type(&t_ts);
 }
 
 static void bboxes_bind(duckdb_bind_info info) {
     BindData* data;
-    shared_bind_path(info, &data);
+    if (!shared_bind_path(info, &data)) return;
     bboxes_declare_columns(info);
 }
 
@@ -366,8 +397,10 @@ static void bboxes_func(duckdb_function_info info, duckdb_data_chunk output) {
     auto* vnum_data = static_cast<double*>(duckdb_vector_get_data(v_vnum));
     duckdb_vector v_vbool = duckdb_data_chunk_get_vector(output, 8);
     auto* vbool_data = static_cast<bool*>(duckdb_vector_get_data(v_vbool));
-    duckdb_vector v_text = duckdb_data_chunk_get_vector(output, 9);
-    duckdb_vector v_formula = duckdb_data_chunk_get_vector(output, 10);
+    duckdb_vector v_vdate = duckdb_data_chunk_get_vector(output, 9);
+    auto* vdate_data = static_cast<duckdb_timestamp*>(duckdb_vector_get_data(v_vdate));
+    duckdb_vector v_text = duckdb_data_chunk_get_vector(output, 10);
+    duckdb_vector v_formula = duckdb_data_chunk_get_vector(output, 11);
 
     const idx_t chunk_size = duckdb_vector_size();
     idx_t row = 0;
@@ -389,6 +422,9 @@ static void bboxes_func(duckdb_function_info info, duckdb_data_chunk output) {
         if (b->has_vbool) vbool_data[row] = (b->vbool != 0);
         else { duckdb_vector_ensure_validity_writable(v_vbool);
                duckdb_vector_get_validity(v_vbool)[row / 64] &= ~(uint64_t(1) << (row % 64)); }
+        if (b->has_vdate) vdate_data[row].micros = b->vdate;
+        else { duckdb_vector_ensure_validity_writable(v_vdate);
+               duckdb_vector_get_validity(v_vdate)[row / 64] &= ~(uint64_t(1) << (row % 64)); }
         duckdb_vector_assign_string_element(v_text, row, b->text);
         if (b->formula) {
             duckdb_vector_assign_string_element(v_formula, row, b->formula);
@@ -535,6 +571,10 @@ static void register_table_fn(duckdb_connection conn, const char* name,
     duckdb_logical_type t = duckdb_create_logical_type(DUCKDB_TYPE_VARCHAR);
     duckdb_table_function_add_parameter(func, t);
     duckdb_destroy_logical_type(&t);
+    duckdb_logical_type t_int = duckdb_create_logical_type(DUCKDB_TYPE_INTEGER);
+    duckdb_table_function_add_named_parameter(func, "start_page", t_int);
+    duckdb_table_function_add_named_parameter(func, "end_page", t_int);
+    duckdb_destroy_logical_type(&t_int);
     duckdb_table_function_set_bind(func, bind_fn);
     duckdb_table_function_set_init(func, generic_init);
     duckdb_table_function_set_function(func, func_fn);
@@ -812,6 +852,14 @@ DUCKDB_EXTENSION_ENTRYPOINT(duckdb_connection connection, duckdb_extension_info
                          reinterpret_cast<void*>(bboxes_pdf_header_json),
                          meta_blob_scalar);
 
+    /* bb_probe — pre-flight format/encryption/page count/cost, headers only */
+    register_meta_scalar(connection, "bb_probe", DUCKDB_TYPE_VARCHAR,
+                         reinterpret_cast<void*>(bboxes_probe_file),
+                         meta_path_scalar);
+    register_meta_scalar(connection, "bb_probe", DUCKDB_TYPE_BLOB,
+                         reinterpret_cast<void*>(bboxes_probe),
+                         meta_blob_scalar);
+
     /* container_walk — recursive tree of typed nodes (zip-in-zip, pdf, ...) */
     register_meta_scalar(connection, "container_walk", DUCKDB_TYPE_VARCHAR,
                          reinterpret_cast<void*>(bboxes_container_walk_json_file),
@@ -57,10 +57,55 @@ typedef struct {
     double      vnum;
     int         has_vbool;  /* 1 if vbool is set (cell_type=="bool")   */
     int         vbool;
+    int         has_vdate;  /* 1 if vdate is set (date-formatted number) */
+    int64_t     vdate;      /* microseconds since 1970-01-01, no tz    */
     const char* text;       /* value as a string (the vstr channel)    */
     const char* formula;    /* raw formula string, NULL if none        */
 } bboxes_bbox;
 
+/* Rich-text run of a cell (xlsx fast reader). Join to bboxes on (page_id, x, y);
+   start/length are code-point offsets into that bbox's text. run_style_id is an
+   interned id over the run properties, which are also given inline. */
+typedef struct {
+    uint32_t    page_id;
+    uint32_t    x, y;
+    uint32_t    start;
+    uint32_t    length;
+    uint32_t    run_style_id;
+    const char* font;
+    double      font_size;
+    const char* color;      /* "rgba(r,g,b,a)" */
+    const char* weight;     /* "normal" or "bold" */
+    int         italic;
+    int         underline;
+} bboxes_run;
+
+/* Ruling line or rectangle from a PDF path object (table borders, rules), in
+   the bbox coordinate space. kind is "hline" (h = 0), "vline" (w = 0) or
+   "rect"; line_width is the drawn thickness in points. */
+typedef struct {
+    uint32_t    page_id;
+    const char* kind;
+    double      x, y, w, h;
+    double      line_width;
+    const char* color;      /* "rgba(r,g,b,a)" */
+} bboxes_rule;
+
+/* Reading-order line from the layout pass: bboxes of one page grouped by
+   baseline band and split at column-sized gaps. line_id is the line's position
+   in reading order within its page; column_id numbers the page's columns in
+   the order they are read. bbox_indices index that page's bboxes (left to
+   right); text joins their texts with single spaces. */
+typedef struct {
+    uint32_t        page_id;
+    uint32_t        line_id;
+    uint32_t        column_id;
+    double          x, y, w, h;
+    const char*     text;
+    const uint32_t* bbox_indices;
+    uint32_t        bbox_count;
+} bboxes_line;
+
 /* ── cursor ──────────────────────────────────────────────────────── */
 /*
  * Single cursor opened once per document.
@@ -72,9 +117,31 @@ typedef struct {
 
 /* ── format detection ────────────────────────────────────────────── */
 
-/* Returns "pdf", "xlsx", "docx", or "text" based on magic bytes. */
+/* Returns "pdf", "xlsx", "xlsb", "ods", "docx", "xls", "doc", "html" or "text" based
+   on magic bytes; a zip is "ods" when its leading mimetype member says spreadsheet
+   and "xlsb" when its first 4 KiB name xl/workbook.bin, an OLE2 file is "doc" when
+   its directory holds a WordDocument stream, and "ooxml-encrypted" when it
+   holds an EncryptedPackage (password-protected OOXML: xlsx, xlsb or docx,
+   which only decryption tells). bboxes_open reads that kind through the fast
+   xlsx reader with the default password. */
 const char* bboxes_detect(const void* buf, size_t len);
 
+/* Pre-flight probe: format, encryption, page/sheet count and an extraction
+   cost estimate from headers, trailers and container directories only — no
+   content is extracted. Returns {format, encrypted, password_required, pages,
+   size_bytes, work_bytes, error} (null = unknown) in a thread-local buffer,
+   valid until the next call on the same thread. work_bytes is the decoded
+   volume extraction will walk. format extends bboxes_detect with "ole" for
+   other OLE2 payloads and "zip" for a zip that is none of the packages. For "ooxml-encrypted" only EncryptionInfo is read:
+   password_required is null, since whether the default password opens the
+   package is known only after the key derivation (100000 SHA-512 rounds as
+   Excel writes it), and error is set when the cipher is one the readers
+   refuse. The
+   *_file variant reads a zip's central directory, a PDF's xref and an OLE2
+   file's directory and globals from disk rather than the whole file. */
+const char* bboxes_probe(const void* buf, size_t len);
+const char* bboxes_probe_file(const char* path);
+
 /* ── document metadata (full-take JSON clob; not the bboxes stream) ──
  *
  * Dialect-specific structural / provenance metadata → one JSON string.
@@ -110,7 +177,7 @@ const char* bboxes_xls_style_decode_json(const void* buf, size_t len);
 const char* bboxes_xls_style_decode_json_file(const char* path);
 
 /* Legacy .xls WALKER lane (libxls-free; from [MS-XLS] via the OLE2/CFB container).
-   xls_names: defined-name inventory. (Cell formulas will populate the bbox `formula` field; VBA -> xls_vba.) */
+   xls_names: defined-name inventory. (Cell formulas populate the bbox `formula` field; VBA -> xls_vba.) */
 const char* bboxes_xls_names_json(const void* buf, size_t len);
 const char* bboxes_xls_names_json_file(const char* path);
 const char* bboxes_xls_formulas_json(const void* buf, size_t len);
@@ -162,6 +229,27 @@ const char* bboxes_xfdf_from_json(const char* annots_json);
 const char* bboxes_pdf_metadata_json(const void* buf, size_t len);
 const char* bboxes_pdf_metadata_json_file(const char* path);
 
+/* Page rasterization for overlay review. Renders 1-based `page_number` at
+   `dpi` as PNG or tight RGBA rows (BBOXES_RENDER_PNG / _RGBA); width and
+   height receive the pixel size, out_len the byte count. Each call returns
+   its own malloc'd buffer, which the caller releases with
+   bboxes_pdf_render_free; NULL on failure.
+
+   With a cache directory configured (bboxes_pdf_render_cache, or the
+   BBOXES_RENDER_CACHE environment variable) results are stored on disk under
+   the document's SHA-256 and evicted least-recently-used past `max_bytes`
+   (default 512 MiB). Pass the cursor's checksum to skip re-hashing `buf`;
+   NULL or "" hashes it. A NULL `dir` turns the cache off. */
+#define BBOXES_RENDER_PNG   0
+#define BBOXES_RENDER_RGBA  1
+
+const unsigned char* bboxes_pdf_render_page(const void* buf, size_t len,
+                                            const char* password, const char* checksum,
+                                            int page_number, double dpi, int format,
+                                            int* width, int* height, size_t* out_len);
+void bboxes_pdf_render_free(const unsigned char* pixels);
+void bboxes_pdf_render_cache(const char* dir, uint64_t max_bytes);
+
 /* ── cursor ──────────────────────────────────────────────────────── */
 
 typedef struct bboxes_cursor bboxes_cursor;
@@ -179,6 +267,34 @@ bboxes_cursor* bboxes_open_pdf_objects(const void* buf, size_t len,
                                         const char* password,
                                         int start_page, int end_page);
 
+/* Path variants of the two PDF opens: the file is read on demand through
+   FPDF_LoadCustomDocument, never loaded whole. The cursor's checksum is ""
+   — hashing would read every byte, which is exactly what these avoid. */
+bboxes_cursor* bboxes_open_pdf_file(const char* path, const char* password,
+                                     int start_page, int end_page);
+bboxes_cursor* bboxes_open_pdf_objects_file(const char* path, const char* password,
+                                             int start_page, int end_page);
+
+/* Open flags for the *_ex opens: side channels that cost extraction work of
+   their own, off unless asked for. The plain opens pass 0. */
+#define BBOXES_OPEN_RULES      0x1  /* PDF: ruling lines / rectangles (bboxes_next_rule) */
+#define BBOXES_OPEN_RICH_RUNS  0x2  /* fast xlsx: rich-text runs (bboxes_next_run) */
+
+bboxes_cursor* bboxes_open_pdf_ex(const void* buf, size_t len, const char* password,
+                                   int start_page, int end_page, int flags);
+bboxes_cursor* bboxes_open_pdf_objects_ex(const void* buf, size_t len, const char* password,
+                                           int start_page, int end_page, int flags);
+bboxes_cursor* bboxes_open_pdf_file_ex(const char* path, const char* password,
+                                        int start_page, int end_page, int flags);
+bboxes_cursor* bboxes_open_pdf_objects_file_ex(const char* path, const char* password,
+                                                int start_page, int end_page, int flags);
+
+/* Opt-in content address for a path-opened document: the SHA-256 hex the
+   buffer opens put in the doc checksum, streamed from the file. Reads every
+   byte. NULL if the file cannot be read; otherwise a thread-local buffer,
+   valid until the next call on the same thread. */
+const char* bboxes_file_checksum(const char* path);
+
 bboxes_cursor* bboxes_open_xlsx(const void* buf, size_t len,
                                  const char* password,
                                  int start_page, int end_page);
@@ -187,14 +303,39 @@ bboxes_cursor* bboxes_open_xlsx_fast(const void* buf, size_t len,
                                      const char* password,
                                      int start_page, int end_page);
 
+/* Single-pass xlsx artifact: ONE zip open feeds both the fast cell scan and the
+   artifact header (style decode + lean metadata), so workbook.xml, its rels,
+   styles.xml and sharedStrings.xml are each inflated once. Bboxes and sheet meta
+   come off the usual iterators; the header from bboxes_get_header_json. */
+bboxes_cursor* bboxes_open_xlsx_artifact(const void* buf, size_t len,
+                                         const char* password,
+                                         int start_page, int end_page);
+
+/* The two fast-reader opens with open flags (BBOXES_OPEN_RICH_RUNS). */
+bboxes_cursor* bboxes_open_xlsx_fast_ex(const void* buf, size_t len, const char* password,
+                                        int start_page, int end_page, int flags);
+bboxes_cursor* bboxes_open_xlsx_artifact_ex(const void* buf, size_t len, const char* password,
+                                            int start_page, int end_page, int flags);
+
 bboxes_cursor* bboxes_open_xls(const void* buf, size_t len,
                                 const char* password,
                                 int start_page, int end_page);
 
+bboxes_cursor* bboxes_open_xlsb(const void* buf, size_t len,
+                                 const char* password,
+                                 int start_page, int end_page);
+
+/* OpenDocument spreadsheet. No password: ODF package encryption is not read, and
+   an encrypted .ods gives NULL. */
+bboxes_cursor* bboxes_open_ods(const void* buf, size_t len,
+                                int start_page, int end_page);
+
 bboxes_cursor* bboxes_open_text(const void* buf, size_t len);
 
 bboxes_cursor* bboxes_open_docx(const void* buf, size_t len);
 
+bboxes_cursor* bboxes_open_doc(const void* buf, size_t len);
+
 bboxes_cursor* bboxes_open_html(const void* buf, size_t len);
 
 /* doc (single row, not an iterator) */
@@ -225,6 +366,61 @@ const char* bboxes_get_bboxes_json(bboxes_cursor* cursor);
 /* Per-sheet side-channel (merges + dimension) captured during the cell scan —
    pull from the SAME cursor as the bboxes for a single worksheet inflation. */
 const char* bboxes_get_sheet_meta_json(bboxes_cursor* cursor);
+/* Artifact header captured at open (same shape as bboxes_xlsx_header_json);
+   "null" for cursors not opened by bboxes_open_xlsx_artifact. */
+const char* bboxes_get_header_json(bboxes_cursor* cursor);
+
+/* rich-text run iterator (flat across pages; empty for formats without runs).
+   The fast xlsx reader records runs only for a cursor opened with
+   BBOXES_OPEN_RICH_RUNS — off by default, as every <rPr> is parsed and
+   interned. Run fonts are their own table: fonts_json stays empty on the fast
+   path. */
+const bboxes_run*   bboxes_next_run(bboxes_cursor* cursor);
+const char*         bboxes_get_runs_json(bboxes_cursor* cursor);
+
+/* ruling-line iterator (flat across pages; PDF only, produced in the same
+   page load as the text). Empty unless the cursor was opened with
+   BBOXES_OPEN_RULES: collecting them walks every path and form object. */
+const bboxes_rule*  bboxes_next_rule(bboxes_cursor* cursor);
+const char*         bboxes_get_rules_json(bboxes_cursor* cursor);
+
+/* reading-order line iterator (flat across pages). The layout pass runs once
+   per cursor on the first call; cursors that never ask for lines pay nothing.
+   Meaningful for float-geometry sources (pdf); grid sources group by row. */
+const bboxes_line*  bboxes_next_line(bboxes_cursor* cursor);
+const char*         bboxes_get_lines_json(bboxes_cursor* cursor);
+
+/* Spatial queries over one page's bboxes. A packed R-tree is built for the
+   page on its first query and kept for the cursor's lifetime. Results are
+   indices into that page's bboxes (the order bboxes_next_bbox yields them);
+   *out points at cursor-owned storage valid until the next query. The rect
+   query returns every bbox intersecting the rectangle, in index order;
+   nearest returns up to k bboxes by distance from (x, y) to the box, nearest
+   first. bboxes_get_bbox fetches one by (page_id, index) without disturbing
+   the bbox iterator. */
+size_t bboxes_query_rect(bboxes_cursor* cursor, uint32_t page_id,
+                         double x0, double y0, double x1, double y1,
+                         const uint32_t** out);
+size_t bboxes_query_nearest(bboxes_cursor* cursor, uint32_t page_id,
+                            double x, double y, size_t k, const uint32_t** out);
+const bboxes_bbox* bboxes_get_bbox(bboxes_cursor* cursor, uint32_t page_id, uint32_t index);
+
+/* Process-wide font/style dictionary. A cursor attached to it reports
+   font_id/style_id values that are stable across every attached cursor in the
+   process (one id per font name, one per distinct style), so a batch scan's
+   style dimension is one table rather than one per document. Attach before
+   iterating: ids already handed out by this cursor's iterators are not
+   revisited. Rich-text run_style_ids stay per-cursor. Returns 1 on success.
+   bboxes_global_dict_auto(1) attaches every cursor opened afterwards (for
+   callers, like the SQL extensions, that never see the cursor). The JSON
+   snapshots list every id issued so far, ordered by id, into a thread-local
+   buffer. reset forgets all ids; do not mix ids from before and after. All
+   of these are thread-safe. */
+int         bboxes_attach_global_dict(bboxes_cursor* cursor);
+void        bboxes_global_dict_auto(int enable);
+void        bboxes_global_dict_reset(void);
+const char* bboxes_global_fonts_json(void);
+const char* bboxes_global_styles_json(void);
 
 void bboxes_close(bboxes_cursor* cursor);
 
@@ -237,12 +433,25 @@ void bboxes_close(bboxes_cursor* cursor);
 #define BBOXES_FORMAT_PDF_OBJECTS  5  /* object-level PDF: one bbox per text object */
 #define BBOXES_FORMAT_XLSX_FAST    6  /* fast byte-scan xlsx reader (parallel to XLSX) */
 #define BBOXES_FORMAT_HTML         7  /* Lexbor DOM walk: tables → grid, flow → reading order */
-#define BBOXES_FORMAT_XLS          8  /* legacy .xls (BIFF/OLE2) via libxls */
+#define BBOXES_FORMAT_XLS          8  /* legacy .xls (BIFF/OLE2), native BIFF walker */
+#define BBOXES_FORMAT_DOC          9  /* legacy .doc (Word 97-2003, OLE2), piece-table walk */
+#define BBOXES_FORMAT_XLSB        10  /* binary workbook (BIFF12 records), fast-path grain */
+#define BBOXES_FORMAT_ODS         11  /* OpenDocument spreadsheet, content.xml streamed */
 
 bboxes_cursor* bboxes_open_format(int fmt, const void* buf, size_t len);
 
+/* Path-based bboxes_open_format for hosts. PDF formats (and AUTO on a %PDF
+   file) go through the file-backed opens with the given 1-based page range;
+   every other format reads the file and dispatches as bboxes_open_format, the
+   spreadsheet readers (and AUTO on a spreadsheet) with the range as a sheet
+   range. The flow formats (text, docx, doc, html) take no range: a non-zero
+   start_page / end_page on one returns NULL rather than being ignored. NULL
+   also when the file is unreadable or does not parse. */
+bboxes_cursor* bboxes_open_format_file(int fmt, const char* path,
+                                       int start_page, int end_page);
+
 /* Coordinate model (single source of truth — hosts must not re-encode this).
-   Returns 1 for cell-grid formats (xlsx/text/docx/html) whose bbox x/y/w/h are
+   Returns 1 for cell-grid formats (xlsx/xlsb/xls/ods/text/docx/doc/html) whose bbox x/y/w/h are
    integer row/col positions, 0 for rendered formats (pdf) with float coords. */
 int bboxes_format_int_coords(int fmt);
 
@@ -0,0 +1,73 @@
+#ifndef BBOXES_BYTES_H
+#define BBOXES_BYTES_H
+
+/* ── little-endian binary helpers ─────────────────────────────────────
+   The byte-level pieces the binary readers (.xls BIFF, .xlsb BIFF12, .doc)
+   all need: unaligned little-endian loads (le16, le32, le_f64), a code
+   point -> UTF-8 (put_utf8, which the ods reader's character references
+   use too), UTF-16 -> UTF-8 with surrogate pairing (put_utf16), UTF-8 ->
+   UTF-16LE for password keys (utf16le), a code-point count (utf8_len), the
+   RkNumber packed double (rk_number), and the A1 column / integer appenders
+   the formula renderers build addresses with (append_col, append_int). */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+inline uint16_t le16(const uint8_t* q) { return uint16_t(q[0] | (q[1] << 8)); }
+inline uint32_t le32(const uint8_t* q) { return uint32_t(q[0]) | (uint32_t(q[1]) << 8) | (uint32_t(q[2]) << 16) | (uint32_t(q[3]) << 24); }
+inline double le_f64(const uint8_t* q) { double d; std::memcpy(&d, q, 8); return d; }
+
+/* One code point -> UTF-8. */
+inline void put_utf8(std::string& s, uint32_t c) {
+    if (c < 0x80) s += char(c);
+    else if (c < 0x800) { s += char(0xC0 | (c >> 6)); s += char(0x80 | (c & 0x3F)); }
+    else if (c < 0x10000) { s += char(0xE0 | (c >> 12)); s += char(0x80 | ((c >> 6) & 0x3F)); s += char(0x80 | (c & 0x3F)); }
+    else { s += char(0xF0 | (c >> 18)); s += char(0x80 | ((c >> 12) & 0x3F)); s += char(0x80 | ((c >> 6) & 0x3F)); s += char(0x80 | (c & 0x3F)); }
+}
+
+/* UTF-16 code unit -> UTF-8, pairing surrogates across calls via `pend`. A lone low surrogate is dropped. */
+inline void put_utf16(std::string& s, uint32_t c, uint32_t& pend) {
+    if (c >= 0xD800 && c < 0xDC00) { pend = c; return; }
+    if (c >= 0xDC00 && c < 0xE000) { if (!pend) return; c = 0x10000 + ((pend - 0xD800) << 10) + (c - 0xDC00); }
+    pend = 0;
+    put_utf8(s, c);
+}
+
+/* UTF-8 -> UTF-16LE bytes, BMP only: the form the Office key derivations hash a password in. */
+inline std::vector<uint8_t> utf16le(const char* s) {
+    std::vector<uint8_t> u;
+    for (const unsigned char* q = reinterpret_cast<const unsigned char*>(s); *q; ) {
+        uint32_t c = *q++;
+        if (c >= 0xE0 && q[0] && q[1]) { c = ((c & 0x0F) << 12) | ((q[0] & 0x3F) << 6) | (q[1] & 0x3F); q += 2; }
+        else if (c >= 0xC0 && q[0]) { c = ((c & 0x1F) << 6) | (q[0] & 0x3F); q += 1; }
+        u.push_back(uint8_t(c)); u.push_back(uint8_t(c >> 8));
+    }
+    return u;
+}
+
+/* Code points in UTF-8 text: the bytes that do not continue a sequence. */
+inline size_t utf8_len(const std::string& s) {
+    size_t n = 0;
+    for (unsigned char c : s) n += (c & 0xC0) != 0x80;
+    return n;
+}
+
+/* RkNumber ([MS-XLS] 2.5.217, same in BIFF12): a 30-bit int or the top 30 bits of a double, optionally /100. */
+inline double rk_number(uint32_t v) {
+    double d;
+    if (v & 0x02) d = double(int32_t(v) >> 2);
+    else { uint64_t bits = uint64_t(v & 0xFFFFFFFCu) << 32; std::memcpy(&d, &bits, 8); }
+    return (v & 0x01) ? d / 100 : d;
+}
+
+inline void append_col(std::string& s, long col) {   /* 0-based col -> A, B, ... AA */
+    char b[8]; int k = 0; col += 1;
+    while (col > 0 && k < 8) { b[k++] = char('A' + (col - 1) % 26); col = (col - 1) / 26; }
+    while (k > 0) s += b[--k];
+}
+inline void append_int(std::string& s, long v) { char b[24]; int k = std::snprintf(b, sizeof b, "%ld", v); s.append(b, size_t(k)); }
+
+#endif /* BBOXES_BYTES_H */
@@ -0,0 +1,187 @@
+#ifndef BBOXES_CFB_H
+#define BBOXES_CFB_H
+
+/* ── opened OLE2 / CFB container ──────────────────────────────────────
+   One container parse shared by every xls entry point inside a single call:
+   the header, FAT (through the DIFAT), mini FAT and directory are read once,
+   then stream() maps a top-level stream to the byte spans it occupies in the
+   caller's buffer — sector chains with physically adjacent sectors merged. An
+   unfragmented stream is a single span and is read in place; flat() gathers
+   into a scratch buffer only when the chain really jumps around.
+
+   Everything is bounds-checked against the buffer and chain walks are capped
+   at the FAT size, so a malformed file fails the open or yields a short
+   stream rather than a crash. The on-disk structs come from the vendored
+   compoundfilereader.
+
+   CfbPackage: open() over a buffer, entry() / stream() by name, and the
+   static flat() / read() that turn a Stream's spans into bytes. */
+
+#include "compoundfilereader.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct CfbPackage {
+    struct Span { const uint8_t* p; size_t n; };
+    struct Stream { std::vector<Span> spans; size_t size = 0; };
+
+    bool open(const void* buf, size_t len) {
+        buf_ = static_cast<const uint8_t*>(buf);
+        len_ = buf_ ? len : 0;
+        if (len_ < 512 || std::memcmp(buf_, "\xD0\xCF\x11\xE0\xA1\xB1\x1A\xE1", 8) != 0) return fail("not an OLE2 file");
+        std::memcpy(&hdr_, buf_, sizeof hdr_);
+        ssz_ = hdr_.majorVersion == 4 ? 4096 : 512;
+        if (len_ < ssz_ * 2) return fail("truncated OLE2 container");
+
+        /* FAT: the first 109 sector ids sit in the header, the rest in the DIFAT chain */
+        std::vector<uint32_t> fat_secs;
+        for (uint32_t i = 0; i < 109 && fat_secs.size() < hdr_.numFATSector; i++) fat_secs.push_back(hdr_.headerDIFAT[i]);
+        uint32_t difat = hdr_.firstDIFATSectorLocation;
+        for (size_t hops = 0; fat_secs.size() < hdr_.numFATSector && difat < CFB::MAXREGSECT && hops < sectors(); hops++) {
+            const uint8_t* d = sector(difat, ssz_);
+            if (!d) break;
+            for (size_t k = 0; k + 1 < ssz_ / 4 && fat_secs.size() < hdr_.numFATSector; k++) fat_secs.push_back(u32(d + 4 * k));
+            difat = u32(d + ssz_ - 4);
+        }
+        for (uint32_t s : fat_secs) {
+            const uint8_t* f = sector(s, ssz_);
+            if (!f) break;
+            for (size_t k = 0; k < ssz_ / 4; k++) fat_.push_back(u32(f + 4 * k));
+        }
+        if (fat_.empty()) return fail("OLE2 FAT unreadable");
+
+        /* directory: 128-byte entries, referenced in place */
+        for (uint32_t s : chain(hdr_.firstDirectorySectorLocation)) {
+            const uint8_t* d = sector(s, ssz_);
+            if (!d) break;
+            for (size_t k = 0; k < ssz_ / sizeof(CFB::COMPOUND_FILE_ENTRY); k++)
+                dir_.push_back(reinterpret_cast<const CFB::COMPOUND_FILE_ENTRY*>(d + k * sizeof(CFB::COMPOUND_FILE_ENTRY)));
+        }
+        if (dir_.empty() || dir_[0]->type != 5) return fail("OLE2 root entry missing");
+
+        /* mini FAT + the root entry's chain, which carries the mini stream */
+        for (uint32_t s : chain(hdr_.firstMiniFATSectorLocation)) {
+            const uint8_t* f = sector(s, ssz_);
+            if (!f) break;
+            for (size_t k = 0; k < ssz_ / 4; k++) minifat_.push_back(u32(f + 4 * k));
+        }
+        ministream_ = chain(dir_[0]->startSectorLocation);
+        return true;
+    }
+
+    /* Top-level stream by name, ASCII only and control characters dropped, so
+       "SummaryInformation" finds \x05SummaryInformation. Storages are not
+       descended into: an embedded workbook never shadows the document's own. */
+    const CFB::COMPOUND_FILE_ENTRY* entry(const char* name) const {
+        const CFB::COMPOUND_FILE_ENTRY* found = nullptr;
+        std::vector<uint32_t> todo{dir_.empty() ? 0xFFFFFFFFu : dir_[0]->childID};
+        for (size_t visits = 0; !todo.empty() && !found && visits < dir_.size(); visits++) {
+            uint32_t id = todo.back(); todo.pop_back();
+            if (id >= dir_.size()) continue;
+            const CFB::COMPOUND_FILE_ENTRY* e = dir_[id];
+            if (e->type == 2 && entry_name(e) == name) found = e;
+            todo.push_back(e->leftSiblingID);
+            todo.push_back(e->rightSiblingID);
+        }
+        return found;
+    }
+
+    bool stream(const char* name, Stream& out) const {
+        const CFB::COMPOUND_FILE_ENTRY* e = entry(name);
+        return e && stream(e, out);
+    }
+    bool stream(const CFB::COMPOUND_FILE_ENTRY* e, Stream& out) const {
+        out.spans.clear();
+        out.size = 0;
+        size_t want = entry_size(e);
+        bool mini = want < hdr_.miniStreamCutoffSize;
+        size_t unit = mini ? 64 : ssz_;
+        uint32_t s = e->startSectorLocation;
+        const std::vector<uint32_t>& fat = mini ? minifat_ : fat_;
+        for (size_t hops = 0; out.size < want && s < CFB::MAXREGSECT && s < fat.size() && hops < fat.size(); hops++) {
+            size_t take = want - out.size < unit ? want - out.size : unit;
+            const uint8_t* q = mini ? mini_sector(s, take) : sector(s, take);
+            if (!q) break;
+            if (!out.spans.empty() && out.spans.back().p + out.spans.back().n == q) out.spans.back().n += take;
+            else out.spans.push_back({q, take});
+            out.size += take;
+            s = fat[s];
+        }
+        return out.size == want;
+    }
+
+    /* The stream as one contiguous run: in place for a single span, else
+       gathered into `scratch`. */
+    static const uint8_t* flat(const Stream& s, std::vector<uint8_t>& scratch) {
+        if (s.spans.size() == 1) return s.spans[0].p;
+        scratch.clear();
+        scratch.reserve(s.size);
+        for (const Span& sp : s.spans) scratch.insert(scratch.end(), sp.p, sp.p + sp.n);
+        return scratch.data();
+    }
+    /* n bytes at `off` into dst, across span seams; false when the stream is shorter. */
+    static bool read(const Stream& s, size_t off, void* dst, size_t n) {
+        uint8_t* d = static_cast<uint8_t*>(dst);
+        for (const Span& sp : s.spans) {
+            if (n == 0) break;
+            if (off >= sp.n) { off -= sp.n; continue; }
+            size_t k = sp.n - off < n ? sp.n - off : n;
+            std::memcpy(d, sp.p + off, k);
+            d += k; n -= k; off = 0;
+        }
+        return n == 0;
+    }
+
+    static std::string entry_name(const CFB::COMPOUND_FILE_ENTRY* e) {
+        std::string s;
+        int chars = e->nameLen >= 2 ? e->nameLen / 2 - 1 : 0;
+        for (int i = 0; i < chars && i < 31; i++) { uint16_t ch = e->name[i]; if (ch >= 32 && ch < 128) s += char(ch); }
+        return s;
+    }
+    /* v3 files leave the high dword of the size undefined. */
+    size_t entry_size(const CFB::COMPOUND_FILE_ENTRY* e) const {
+        return hdr_.majorVersion == 3 ? static_cast<size_t>(e->size & 0xFFFFFFFFu) : static_cast<size_t>(e->size);
+    }
+
+    const std::string& error() const { return err_; }
+
+private:
+    static uint32_t u32(const uint8_t* q) {
+        return uint32_t(q[0]) | (uint32_t(q[1]) << 8) | (uint32_t(q[2]) << 16) | (uint32_t(q[3]) << 24);
+    }
+    size_t sectors() const { return len_ / ssz_; }
+    /* `take` bytes at the start of regular sector s, or nullptr past the buffer. */
+    const uint8_t* sector(uint32_t s, size_t take) const {
+        if (s >= CFB::MAXREGSECT) return nullptr;
+        uint64_t at = (uint64_t(s) + 1) * ssz_;
+        return at + take <= len_ ? buf_ + at : nullptr;
+    }
+    const uint8_t* mini_sector(uint32_t m, size_t take) const {
+        uint64_t at = uint64_t(m) * 64;
+        size_t idx = static_cast<size_t>(at / ssz_), off = static_cast<size_t>(at % ssz_);
+        if (idx >= ministream_.size()) return nullptr;
+        const uint8_t* q = sector(ministream_[idx], off + take);
+        return q ? q + off : nullptr;
+    }
+    std::vector<uint32_t> chain(uint32_t s) const {
+        std::vector<uint32_t> out;
+        for (size_t hops = 0; s < CFB::MAXREGSECT && s < fat_.size() && hops < fat_.size(); hops++) {
+            out.push_back(s);
+            s = fat_[s];
+        }
+        return out;
+    }
+    bool fail(const char* why) { err_ = why; return false; }
+
+    const uint8_t* buf_ = nullptr;
+    size_t len_ = 0, ssz_ = 512;
+    CFB::COMPOUND_FILE_HDR hdr_{};
+    std::vector<uint32_t> fat_, minifat_, ministream_;
+    std::vector<const CFB::COMPOUND_FILE_ENTRY*> dir_;
+    std::string err_;
+};
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef BBOXES_COVERED_H
+#define BBOXES_COVERED_H
+
+/* ── cells hidden behind a merge or a shared/array formula range ───────
+   The spreadsheet readers (fast xlsx, xls, xlsb) drop every cell of a merge
+   or formula group except its origin. A range of up to kExpand cells is
+   expanded into a hash set. Larger ones (whole-row and whole-column refs) are
+   kept as spans and indexed by row band: the spans' row bounds cut the rows
+   into bands, and each band lists the spans crossing it sorted by first
+   column. has() is then a hash probe plus two binary searches rather than a
+   scan of every span for every cell. The band index is rebuilt on the first
+   query after a span is added, so a reader may interleave adds and queries. */
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+class CoveredCells {
+public:
+    static constexpr uint64_t kExpand = 4096;
+
+    /* Cover r1..r2 x c1..c2 (inclusive) except the origin (orow, ocol). */
+    void add(uint32_t r1, uint32_t c1, uint32_t r2, uint32_t c2, uint32_t orow, uint32_t ocol) {
+        if (r2 < r1 || c2 < c1) return;
+        if (uint64_t(r2 - r1 + 1) * (c2 - c1 + 1) > kExpand) {
+            spans_.push_back({r1, c1, r2, c2, orow, ocol});
+            dirty_ = true;
+            return;
+        }
+        for (uint32_t rr = r1; rr <= r2; rr++)
+            for (uint32_t cc = c1; cc <= c2; cc++)
+                if (!(rr == orow && cc == ocol)) cells_.insert(key(rr, cc));
+    }
+
+    /* One covered cell, e.g. a shared-formula child that names itself. */
+    void add(uint32_t row, uint32_t col) { cells_.insert(key(row, col)); }
+
+    bool has(uint32_t row, uint32_t col) const {
+        if (cells_.count(key(row, col))) return true;
+        if (spans_.empty()) return false;
+        if (dirty_) index();
+        auto b = std::upper_bound(bounds_.begin(), bounds_.end(), row);
+        if (b == bounds_.begin()) return false;
+        size_t band = static_cast<size_t>(b - bounds_.begin()) - 1;
+        const Entry* lo = entries_.data() + band_start_[band];
+        const Entry* e  = entries_.data() + band_start_[band + 1];
+        e = std::upper_bound(lo, e, col, [](uint32_t c, const Entry& x) { return c < x.c1; });
+        /* reach is the widest c2 from the band's first entry up to this one, so
+           the walk back stops as soon as nothing earlier can still reach col. */
+        while (e != lo && (--e)->reach >= col) {
+            const Span& s = spans_[e->span];
+            if (col <= s.c2 && (row != s.orow || col != s.ocol)) return true;
+        }
+        return false;
+    }
+
+    void clear() {
+        cells_.clear();
+        spans_.clear();
+        dirty_ = false;
+    }
+
+private:
+    struct Span  { uint32_t r1, c1, r2, c2, orow, ocol; };
+    struct Entry { uint32_t c1, reach, span; };
+
+    static uint64_t key(uint32_t row, uint32_t col) { return (uint64_t(row) << 32) | col; }
+
+    void index() const {
+        bounds_.clear();
+        for (const Span& s : spans_) {
+            bounds_.push_back(s.r1);
+            if (s.r2 != UINT32_MAX) bounds_.push_back(s.r2 + 1);
+        }
+        std::sort(bounds_.begin(), bounds_.end());
+        bounds_.erase(std::unique(bounds_.begin(), bounds_.end()), bounds_.end());
+
+        /* Band i is rows [bounds_[i], bounds_[i + 1]). */
+        std::vector<std::vector<Entry>> bands(bounds_.size());
+        for (uint32_t i = 0; i < spans_.size(); i++) {
+            const Span& s = spans_[i];
+            size_t first = std::lower_bound(bounds_.begin(), bounds_.end(), s.r1) - bounds_.begin();
+            size_t last  = s.r2 == UINT32_MAX ? bounds_.size()
+                         : std::lower_bound(bounds_.begin(), bounds_.end(), s.r2 + 1) - bounds_.begin();
+            for (size_t k = first; k < last; k++) bands[k].push_back({s.c1, s.c2, i});
+        }
+        entries_.clear();
+        band_start_.clear();
+        for (std::vector<Entry>& band : bands) {
+            band_start_.push_back(entries_.size());
+            std::sort(band.begin(), band.end(), [](const Entry& a, const Entry& b) { return a.c1 < b.c1; });
+            uint32_t reach = 0;
+            for (Entry& e : band) {
+                reach = std::max(reach, e.reach);
+                e.reach = reach;
+                entries_.push_back(e);
+            }
+        }
+        band_start_.push_back(entries_.size());
+        dirty_ = false;
+    }
+
+    std::unordered_set<uint64_t> cells_;
+    std::vector<Span> spans_;
+
+    /* Row-band index over spans_, rebuilt lazily from has(). */
+    mutable bool dirty_ = false;
+    mutable std::vector<uint32_t> bounds_;
+    mutable std::vector<size_t> band_start_;
+    mutable std::vector<Entry> entries_;
+};
+
+#endif /* BBOXES_COVERED_H */
@@ -0,0 +1,56 @@
+/*
+ * bboxes_crypto.h — the primitives behind encrypted-document reading.
+ *
+ * MD5, SHA-1, SHA-512 and AES come from std.crypto in src/bboxes_zig.zig,
+ * the same way SHA-256 does (see sha256.h): they are in the Zig standard
+ * library, so nothing is vendored for them. RC4 is not, and is a dozen
+ * lines, so it lives here.
+ *
+ * Only what the decrypters call is provided — one-shot digests over a
+ * buffer the caller has assembled, AES decryption of whole blocks in place,
+ * and an RC4 keystream that can be skipped forward. None of this is used to protect anything; it exists to read files
+ * that legacy Office locked with it.
+ */
+
+#ifndef BBOXES_CRYPTO_H
+#define BBOXES_CRYPTO_H
+
+#include <cstddef>
+#include <cstdint>
+
+/* Excel writes "VelvetSweatshop" as the password of a workbook that is only
+   write-protected; the .xls and OOXML decrypters try it when none is given. */
+constexpr const char* kDefaultXlsPassword = "VelvetSweatshop";
+
+extern "C" void bb_md5(const unsigned char *data, size_t len, unsigned char *out);   /* 16 bytes */
+extern "C" void bb_sha1(const unsigned char *data, size_t len, unsigned char *out);  /* 20 bytes */
+extern "C" void bb_sha512(const unsigned char *data, size_t len, unsigned char *out); /* 64 bytes */
+
+/* In place over whole 16-byte blocks: CBC from iv, ECB when iv is null. key_len 16 or 32, else false. */
+extern "C" bool bb_aes_decrypt(const unsigned char *key, size_t key_len, const unsigned char *iv,
+                               unsigned char *data, size_t len);
+
+struct Rc4 {
+    uint8_t s[256];
+    uint8_t i = 0, j = 0;
+
+    void init(const uint8_t *key, size_t n) {
+        for (int k = 0; k < 256; k++) s[k] = uint8_t(k);
+        uint8_t m = 0;
+        for (int k = 0; k < 256; k++) {
+            m = uint8_t(m + s[k] + key[k % n]);
+            uint8_t t = s[k]; s[k] = s[m]; s[m] = t;
+        }
+        i = j = 0;
+    }
+    uint8_t next() {
+        i = uint8_t(i + 1);
+        j = uint8_t(j + s[i]);
+        uint8_t t = s[i]; s[i] = s[j]; s[j] = t;
+        return s[uint8_t(s[i] + s[j])];
+    }
+    void apply(uint8_t *d, size_t n) { for (size_t k = 0; k < n; k++) d[k] ^= next(); }
+    void skip(size_t n) { while (n--) next(); }
+};
+
+#endif /* BBOXES_CRYPTO_H */
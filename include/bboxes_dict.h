@@ -0,0 +1,114 @@
+#ifndef BBOXES_DICT_H
+#define BBOXES_DICT_H
+
+/* ── process-wide font/style dictionary ───────────────────────────────
+   Optional interning shared by every cursor that attaches to it, so a batch
+   scan sees one font_id per font name and one style_id per (font, size,
+   colour, weight, italic, underline) across all documents instead of a fresh
+   0-based table per document. Ids are assigned in first-seen order and never
+   reused until reset().
+
+   Attaching costs one lookup per distinct local font/style (hundreds per
+   document, not one per bbox), so the tables are sharded by key hash with a
+   mutex each rather than anything cleverer: concurrent cursors only contend
+   when they intern into the same shard at the same moment.
+
+   GlobalDict::instance(): font() and style() intern and return the global
+   id, fonts() / styles() snapshot the tables in id order, reset() empties
+   both at once. */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bboxes_types.h"
+
+class GlobalDict {
+public:
+    static GlobalDict& instance() {
+        static GlobalDict d;
+        return d;
+    }
+
+    uint32_t font(const std::string& name) {
+        Shard<std::string, FontTable::Entry>& s = fonts_[std::hash<std::string>{}(name) % kShards];
+        std::lock_guard<std::mutex> lk(s.mu);
+        auto it = s.map.find(name);
+        if (it != s.map.end()) return it->second;
+        uint32_t id = next_font_.fetch_add(1, std::memory_order_relaxed);
+        s.map.emplace(name, id);
+        s.entries.push_back({id, name});
+        return id;
+    }
+
+    /* `key.font_id` must already be a global font id. */
+    uint32_t style(const StyleKey& key) {
+        Shard<StyleKey, StyleTable::Entry, StyleKeyHash>& s = styles_[StyleKeyHash{}(key) % kShards];
+        std::lock_guard<std::mutex> lk(s.mu);
+        auto it = s.map.find(key);
+        if (it != s.map.end()) return it->second;
+        uint32_t id = next_style_.fetch_add(1, std::memory_order_relaxed);
+        s.map.emplace(key, id);
+        s.entries.push_back({id, key.font_id, key.font_size, key.color, key.weight,
+                             key.italic, key.underline});
+        return id;
+    }
+
+    /* Snapshots ordered by id. */
+    std::vector<FontTable::Entry> fonts() const { return snapshot<FontTable::Entry>(fonts_); }
+    std::vector<StyleTable::Entry> styles() const { return snapshot<StyleTable::Entry>(styles_); }
+
+    /* Forget every id. Cursors already attached keep the ids they were given,
+       which will be handed out again for possibly different keys. Every shard
+       is locked for the whole reset, so an intern lands wholly before it (and
+       is forgotten) or wholly after it (and numbers from 0): no id is issued
+       twice and no snapshot sees half the tables cleared. */
+    void reset() {
+        auto fl = lock_all(fonts_);
+        auto sl = lock_all(styles_);
+        for (auto& s : fonts_)  { s.map.clear(); s.entries.clear(); }
+        for (auto& s : styles_) { s.map.clear(); s.entries.clear(); }
+        next_font_ = 0;
+        next_style_ = 0;
+    }
+
+private:
+    static constexpr size_t kShards = 16;
+
+    template <class K, class E, class H = std::hash<K>>
+    struct Shard {
+        mutable std::mutex mu;
+        std::unordered_map<K, uint32_t, H> map;
+        std::vector<E> entries;
+    };
+
+    /* Every shard's lock, in index order; reset() takes fonts before styles. */
+    template <class Sh, size_t N>
+    static std::vector<std::unique_lock<std::mutex>> lock_all(Sh (&shards)[N]) {
+        std::vector<std::unique_lock<std::mutex>> locks;
+        locks.reserve(N);
+        for (auto& s : shards) locks.emplace_back(s.mu);
+        return locks;
+    }
+
+    template <class E, class Sh, size_t N>
+    static std::vector<E> snapshot(const Sh (&shards)[N]) {
+        std::vector<E> out;
+        auto lk = lock_all(shards);
+        for (const auto& s : shards) out.insert(out.end(), s.entries.begin(), s.entries.end());
+        std::sort(out.begin(), out.end(), [](const E& a, const E& b) { return a.id < b.id; });
+        return out;
+    }
+
+    Shard<std::string, FontTable::Entry>             fonts_[kShards];
+    Shard<StyleKey, StyleTable::Entry, StyleKeyHash> styles_[kShards];
+    std::atomic<uint32_t> next_font_{0};
+    std::atomic<uint32_t> next_style_{0};
+};
+
+#endif
@@ -0,0 +1,243 @@
+#ifndef BBOXES_ENCRYPTED_PKG_H
+#define BBOXES_ENCRYPTED_PKG_H
+
+/* ── ECMA-376 encrypted OOXML package ─────────────────────────────────
+   A password-protected xlsx is not a zip at all but an OLE2 container with
+   two streams ([MS-OFFCRYPTO] 2.3.4): EncryptionInfo, which says how the
+   key is derived from the password and carries a verifier to check it, and
+   EncryptedPackage — the plaintext size (u64), then the zip, AES-encrypted.
+
+     Agile (4.4)      XML descriptor; SHA-1 or SHA-512 spun spinCount times,
+                      a random package key wrapped under the password key,
+                      AES-CBC in 4096-byte segments with a per-segment IV
+     Standard (x.2)   binary header; SHA-1 spun 50000 times, AES-ECB
+
+   read() decrypts on demand: the segments covering a request are decrypted
+   from the container's sector spans and the last one is kept, so the zip
+   reader pulling the central directory, then each member in turn, costs one
+   segment of memory rather than a plaintext copy of the package.
+
+   Extensible encryption, AES-192 and the SHA-256/384 Agile hashes are
+   refused rather than guessed at; open() fails with error() set. */
+
+#include "bboxes_bytes.h"
+#include "bboxes_cfb.h"
+#include "bboxes_crypto.h"
+
+#include <pugixml.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct EncryptedPackage {
+    static constexpr size_t kSegment = 4096;
+
+    /* Derive and verify the key for `password` (nullptr/empty: kDefaultXlsPassword).
+       The buffer must outlive the package: ciphertext is read from it in place. */
+    bool open(const void* buf, size_t len, const char* password) {
+        std::vector<uint8_t> pw = utf16le(password && *password ? password : kDefaultXlsPassword);
+        return parse(buf, len, &pw);
+    }
+
+    /* EncryptionInfo only: whether open() supports the cipher, without deriving
+       a key — that is spinCount hash rounds (100000 SHA-512 as Excel writes it),
+       too dear for a pre-flight probe. */
+    bool inspect(const void* buf, size_t len) { return parse(buf, len, nullptr); }
+
+    uint64_t size() const { return size_; }
+
+    /* n plaintext bytes at `off` into dst; returns how many were available. */
+    size_t read(uint64_t off, void* dst, size_t n) {
+        uint8_t* d = static_cast<uint8_t*>(dst);
+        size_t done = 0;
+        while (done < n && off < size_) {
+            uint64_t seg = off / kSegment;
+            if (seg != seg_ && !load(seg)) break;
+            size_t at = static_cast<size_t>(off % kSegment);
+            if (at >= plain_.size()) break;
+            size_t take = std::min<uint64_t>({n - done, plain_.size() - at, size_ - off});
+            std::memcpy(d + done, plain_.data() + at, take);
+            done += take; off += take;
+        }
+        return done;
+    }
+
+    const std::string& error() const { return err_; }
+
+private:
+    enum Hash { SHA1, SHA512 };
+
+    static void put32(uint8_t* p, uint32_t v) { for (int k = 0; k < 4; k++) p[k] = uint8_t(v >> (8 * k)); }
+
+    static std::vector<uint8_t> base64(const char* s) {
+        std::vector<uint8_t> out;
+        uint32_t acc = 0; int bits = 0;
+        for (; *s; s++) {
+            int v = *s >= 'A' && *s <= 'Z' ? *s - 'A' : *s >= 'a' && *s <= 'z' ? *s - 'a' + 26
+                  : *s >= '0' && *s <= '9' ? *s - '0' + 52 : *s == '+' ? 62 : *s == '/' ? 63 : -1;
+            if (v < 0) continue;                                     /* padding, whitespace */
+            acc = (acc << 6) | uint32_t(v); bits += 6;
+            if (bits >= 8) { bits -= 8; out.push_back(uint8_t(acc >> bits)); }
+        }
+        return out;
+    }
+
+    size_t hash_len() const { return hash_ == SHA1 ? 20 : 64; }
+    std::vector<uint8_t> hash(const std::vector<uint8_t>& a, const uint8_t* b = nullptr, size_t bn = 0) const {
+        std::vector<uint8_t> in(a);
+        in.insert(in.end(), b, b + bn);
+        std::vector<uint8_t> h(hash_len());
+        if (hash_ == SHA1) bb_sha1(in.data(), in.size(), h.data());
+        else bb_sha512(in.data(), in.size(), h.data());
+        return h;
+    }
+    /* H0 = H(salt || password), then H(i || H) spin times ([MS-OFFCRYPTO] 2.3.4.7, 2.3.4.11). */
+    std::vector<uint8_t> spin(const std::vector<uint8_t>& salt, const std::vector<uint8_t>& pw, uint32_t count) const {
+        std::vector<uint8_t> h = hash(salt, pw.data(), pw.size());
+        std::vector<uint8_t> buf(4 + h.size());
+        for (uint32_t i = 0; i < count; i++) {
+            put32(buf.data(), i);
+            std::memcpy(buf.data() + 4, h.data(), h.size());
+            if (hash_ == SHA1) bb_sha1(buf.data(), buf.size(), h.data());
+            else bb_sha512(buf.data(), buf.size(), h.data());
+        }
+        return h;
+    }
+    /* Truncate, or pad with 0x36, to n bytes. */
+    static std::vector<uint8_t> fit(std::vector<uint8_t> v, size_t n) { v.resize(n, 0x36); return v; }
+
+    /* The container, the package's declared size and EncryptionInfo's version;
+       then the key for `pw`, or with pw null only the cipher parameters. */
+    bool parse(const void* buf, size_t len, const std::vector<uint8_t>* pw) {
+        if (!cfb_.open(buf, len)) return fail(cfb_.error().c_str());
+        CfbPackage::Stream info;
+        std::vector<uint8_t> scratch;
+        if (!cfb_.stream("EncryptionInfo", info) || info.size < 8) return fail("EncryptionInfo missing");
+        if (!cfb_.stream("EncryptedPackage", pkg_) || pkg_.size < 8) return fail("EncryptedPackage missing");
+        const uint8_t* ei = CfbPackage::flat(info, scratch);
+        uint8_t sz[8];
+        CfbPackage::read(pkg_, 0, sz, 8);
+        size_ = 0;
+        for (int k = 7; k >= 0; k--) size_ = (size_ << 8) | sz[k];
+        if (size_ > pkg_.size - 8) return fail("EncryptedPackage shorter than its declared size");
+
+        uint16_t major = le16(ei), minor = le16(ei + 2);
+        if (major == 4 && minor == 4) return open_agile(ei + 8, info.size - 8, pw);
+        if ((major == 2 || major == 3 || major == 4) && minor == 2) return open_standard(ei, info.size, pw);
+        return fail("unsupported EncryptionInfo version");
+    }
+
+    bool set_hash(const char* name) {
+        if (std::strcmp(name, "SHA1") == 0) hash_ = SHA1;
+        else if (std::strcmp(name, "SHA512") == 0) hash_ = SHA512;
+        else return false;
+        return true;
+    }
+    static bool aes(const std::vector<uint8_t>& key, const uint8_t* iv, std::vector<uint8_t>& data) {
+        return !data.empty() && data.size() % 16 == 0 && bb_aes_decrypt(key.data(), key.size(), iv, data.data(), data.size());
+    }
+
+    bool open_agile(const uint8_t* xml, size_t n, const std::vector<uint8_t>* pw) {
+        pugi::xml_document doc;
+        if (!doc.load_buffer(xml, n)) return fail("EncryptionInfo XML unreadable");
+        pugi::xml_node enc = doc.first_child(), kd = enc.child("keyData"), pk;
+        for (pugi::xml_node ke : enc.child("keyEncryptors").children())
+            if (std::strcmp(ke.attribute("uri").value(), "http://schemas.microsoft.com/office/2006/keyEncryptor/password") == 0)
+                pk = ke.first_child();                               /* p:encryptedKey */
+        if (!kd || !pk) return fail("no password key encryptor");
+        for (pugi::xml_node x : {kd, pk}) {
+            if (std::strcmp(x.attribute("cipherAlgorithm").value(), "AES") != 0 ||
+                std::strcmp(x.attribute("cipherChaining").value(), "ChainingModeCBC") != 0)
+                return fail("unsupported cipher");
+        }
+        if (!set_hash(pk.attribute("hashAlgorithm").value())) return fail("unsupported hash algorithm");
+        if (pk.attribute("spinCount").as_uint() > 10000000) return fail("spinCount out of range");   /* 2.3.4.10 cap */
+        size_t key_n = pk.attribute("keyBits").as_uint() / 8, block_n = pk.attribute("blockSize").as_uint();
+        if (block_n != 16 || kd.attribute("blockSize").as_uint() != 16 || pk.attribute("keyBits").as_uint() != kd.attribute("keyBits").as_uint()) return fail("unsupported key size");
+        if (!pw) return true;
+
+        /* the password key, one per block key, unwraps the verifier pair and the package key */
+        std::vector<uint8_t> h = spin(base64(pk.attribute("saltValue").value()), *pw, pk.attribute("spinCount").as_uint());
+        std::vector<uint8_t> iv = fit(base64(pk.attribute("saltValue").value()), block_n);
+        auto unwrap = [&](uint64_t block, const char* attr, std::vector<uint8_t>& out) {
+            uint8_t bk[8];
+            for (int k = 0; k < 8; k++) bk[k] = uint8_t(block >> (56 - 8 * k));
+            out = base64(pk.attribute(attr).value());
+            return aes(fit(hash(h, bk, 8), key_n), iv.data(), out);
+        };
+        std::vector<uint8_t> vin, vhash;
+        if (!unwrap(0xfea7d2763b4b9e79ull, "encryptedVerifierHashInput", vin) ||
+            !unwrap(0xd7aa0f6d3061344eull, "encryptedVerifierHashValue", vhash) ||
+            !unwrap(0x146e0be7abacd0d6ull, "encryptedKeyValue", key_))
+            return fail("unsupported key size");
+        vin.resize(std::min<size_t>(vin.size(), pk.attribute("saltSize").as_uint()));
+        std::vector<uint8_t> want = hash(vin);
+        if (vhash.size() < want.size() || std::memcmp(vhash.data(), want.data(), want.size()) != 0) return fail("wrong password");
+        if (key_.size() < key_n) return fail("package key truncated");
+        key_.resize(key_n);
+
+        if (!set_hash(kd.attribute("hashAlgorithm").value())) return fail("unsupported hash algorithm");
+        salt_ = base64(kd.attribute("saltValue").value());
+        agile_ = true;
+        return true;
+    }
+
+    /* [MS-OFFCRYPTO] 2.3.4.5-2.3.4.9: EncryptionHeader after the flags and its size, EncryptionVerifier after it. */
+    bool open_standard(const uint8_t* ei, size_t n, const std::vector<uint8_t>* pw) {
+        if (n < 12) return fail("EncryptionInfo truncated");
+        size_t hsize = le32(ei + 8), v = 12 + hsize;
+        if (hsize < 32 || v + 4 + 16 + 16 + 4 + 32 > n || le32(ei + v) != 16) return fail("EncryptionInfo truncated");
+        uint32_t alg = le32(ei + 12 + 8), bits = le32(ei + 12 + 16);
+        if ((alg != 0x660E && alg != 0x6610) || bits != (alg == 0x660E ? 128u : 256u)) return fail("unsupported cipher");
+        if (!pw) return true;
+        hash_ = SHA1;
+        std::vector<uint8_t> h = spin(std::vector<uint8_t>(ei + v + 4, ei + v + 20), *pw, 50000);
+        uint8_t zero[4] = {};
+        h = hash(h, zero, 4);
+        std::vector<uint8_t> x1(64, 0x36), x2(64, 0x5C);             /* CryptDeriveKey */
+        for (size_t k = 0; k < h.size(); k++) { x1[k] ^= h[k]; x2[k] ^= h[k]; }
+        key_ = hash(x1);
+        std::vector<uint8_t> x2h = hash(x2);
+        key_.insert(key_.end(), x2h.begin(), x2h.end());
+        key_.resize(bits / 8);
+
+        std::vector<uint8_t> ver(ei + v + 20, ei + v + 36), vhash(ei + v + 40, ei + v + 72);
+        if (!aes(key_, nullptr, ver) || !aes(key_, nullptr, vhash)) return fail("unsupported key size");
+        std::vector<uint8_t> want = hash(ver);
+        if (std::memcmp(vhash.data(), want.data(), want.size()) != 0) return fail("wrong password");
+        agile_ = false;
+        return true;
+    }
+
+    /* Segment `seg` decrypted into plain_. The last one runs to the end of the
+       stream's whole blocks, which cover the declared size. */
+    bool load(uint64_t seg) {
+        uint64_t at = 8 + seg * kSegment;
+        size_t n = static_cast<size_t>(std::min<uint64_t>(kSegment, pkg_.size - at)) & ~size_t(15);
+        plain_.resize(n);
+        if (!n || !CfbPackage::read(pkg_, static_cast<size_t>(at), plain_.data(), n)) return false;
+        std::vector<uint8_t> iv;
+        if (agile_) {
+            uint8_t idx[4]; put32(idx, uint32_t(seg));
+            iv = fit(hash(salt_, idx, 4), 16);
+        }
+        if (!aes(key_, agile_ ? iv.data() : nullptr, plain_)) return false;
+        seg_ = seg;
+        return true;
+    }
+
+    bool fail(const char* why) { err_ = why; return false; }
+
+    CfbPackage cfb_;
+    CfbPackage::Stream pkg_;
+    uint64_t size_ = 0, seg_ = ~uint64_t(0);
+    Hash hash_ = SHA1;
+    bool agile_ = false;
+    std::vector<uint8_t> key_, salt_, plain_;
+    std::string err_;
+};
+
+#endif
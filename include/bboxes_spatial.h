@@ -0,0 +1,165 @@
+#ifndef BBOXES_SPATIAL_H
+#define BBOXES_SPATIAL_H
+
+/* ── per-page spatial index ───────────────────────────────────────────
+   A static packed R-tree over one page's bboxes, built on first query and
+   never mutated (a cursor's result is immutable once extracted). Items are
+   sorted along a Hilbert curve by centre and packed kNode to a node, level by
+   level, so siblings are spatially tight and the whole tree is three flat
+   arrays — no per-node allocation, cache-friendly traversal.
+
+   Rect queries and k-nearest answer in O(log n + hits) instead of a scan of
+   the page.
+
+   SpatialIndex: built from a page's bboxes; query() collects the items
+   overlapping a rectangle and nearest() the k closest to a point, both as
+   indices into Page::bboxes. */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <queue>
+#include <vector>
+
+#include "bboxes_types.h"
+
+class SpatialIndex {
+public:
+    static constexpr size_t kNode = 16;
+
+    explicit SpatialIndex(const std::vector<BBox>& items) {
+        const size_t n = items.size();
+        if (n == 0) return;
+
+        /* Level sizes, leaves first. */
+        level_end_.push_back(n);
+        for (size_t m = n; m > 1; ) {
+            m = (m + kNode - 1) / kNode;
+            level_end_.push_back(level_end_.back() + m);
+        }
+        boxes_.resize(level_end_.back());
+        ids_.resize(level_end_.back());
+
+        /* Hilbert order of the item centres over the page extent. */
+        Box ext{INFINITY, INFINITY, -INFINITY, -INFINITY};
+        for (const BBox& b : items) ext.grow(box_of(b));
+        double sx = ext.x1 > ext.x0 ? 65535.0 / (ext.x1 - ext.x0) : 0;
+        double sy = ext.y1 > ext.y0 ? 65535.0 / (ext.y1 - ext.y0) : 0;
+        std::vector<std::pair<uint32_t, uint32_t>> order(n);
+        for (size_t i = 0; i < n; ++i) {
+            Box b = box_of(items[i]);
+            auto hx = static_cast<uint32_t>(((b.x0 + b.x1) / 2 - ext.x0) * sx);
+            auto hy = static_cast<uint32_t>(((b.y0 + b.y1) / 2 - ext.y0) * sy);
+            order[i] = {hilbert(hx, hy), static_cast<uint32_t>(i)};
+        }
+        std::sort(order.begin(), order.end());
+        for (size_t i = 0; i < n; ++i) {
+            ids_[i]   = order[i].second;
+            boxes_[i] = box_of(items[order[i].second]);
+        }
+
+        /* Parents: node j of a level covers children [j*kNode, (j+1)*kNode)
+           of the level below; ids_ of a parent holds its first child slot. */
+        size_t lo = 0;
+        for (size_t lv = 1; lv < level_end_.size(); ++lv) {
+            size_t hi = level_end_[lv - 1];
+            size_t out = hi;
+            for (size_t c = lo; c < hi; c += kNode) {
+                Box nb = boxes_[c];
+                for (size_t k = c + 1; k < std::min(c + kNode, hi); ++k) nb.grow(boxes_[k]);
+                boxes_[out] = nb;
+                ids_[out]   = static_cast<uint32_t>(c);
+                ++out;
+            }
+            lo = hi;
+        }
+    }
+
+    /* Items whose box intersects [x0,x1]×[y0,y1] (edges inclusive). */
+    void query(double x0, double y0, double x1, double y1, std::vector<uint32_t>& out) const {
+        out.clear();
+        if (boxes_.empty()) return;
+        Box q{std::min(x0, x1), std::min(y0, y1), std::max(x0, x1), std::max(y0, y1)};
+        std::vector<std::pair<size_t, size_t>> stack;   /* (node slot, level) */
+        stack.push_back({boxes_.size() - 1, level_end_.size() - 1});
+        while (!stack.empty()) {
+            auto [node, lv] = stack.back();
+            stack.pop_back();
+            if (!boxes_[node].hits(q)) continue;
+            if (lv == 0) { out.push_back(ids_[node]); continue; }
+            size_t first = ids_[node];
+            size_t end = std::min(first + kNode, level_end_[lv - 1]);
+            for (size_t c = first; c < end; ++c) stack.push_back({c, lv - 1});
+        }
+        std::sort(out.begin(), out.end());
+    }
+
+    /* Up to k items nearest to (x, y) by point-to-box distance, nearest
+       first (ties by index). Best-first search over the node boxes. */
+    void nearest(double x, double y, size_t k, std::vector<uint32_t>& out) const {
+        out.clear();
+        if (boxes_.empty() || k == 0) return;
+        struct Entry { double d; size_t node, lv; };
+        auto worse = [&](const Entry& a, const Entry& b) {
+            if (a.d != b.d) return a.d > b.d;
+            /* nodes before items at equal distance, so every item at that
+               distance is queued before any is emitted; then lower index */
+            if ((a.lv == 0) != (b.lv == 0)) return a.lv == 0;
+            return a.lv == 0 ? ids_[a.node] > ids_[b.node] : a.node > b.node;
+        };
+        std::priority_queue<Entry, std::vector<Entry>, decltype(worse)> pq(worse);
+        size_t root = boxes_.size() - 1;
+        pq.push({boxes_[root].dist2(x, y), root, level_end_.size() - 1});
+        while (!pq.empty() && out.size() < k) {
+            Entry e = pq.top();
+            pq.pop();
+            if (e.lv == 0) { out.push_back(ids_[e.node]); continue; }
+            size_t first = ids_[e.node];
+            size_t end = std::min(first + kNode, level_end_[e.lv - 1]);
+            for (size_t c = first; c < end; ++c) pq.push({boxes_[c].dist2(x, y), c, e.lv - 1});
+        }
+    }
+
+private:
+    struct Box {
+        double x0, y0, x1, y1;
+        void grow(const Box& o) {
+            x0 = std::min(x0, o.x0); y0 = std::min(y0, o.y0);
+            x1 = std::max(x1, o.x1); y1 = std::max(y1, o.y1);
+        }
+        bool hits(const Box& q) const {
+            return x0 <= q.x1 && q.x0 <= x1 && y0 <= q.y1 && q.y0 <= y1;
+        }
+        double dist2(double x, double y) const {
+            double dx = x < x0 ? x0 - x : (x > x1 ? x - x1 : 0);
+            double dy = y < y0 ? y0 - y : (y > y1 ? y - y1 : 0);
+            return dx * dx + dy * dy;
+        }
+    };
+
+    static Box box_of(const BBox& b) {
+        return {std::min(b.x, b.x + b.w), std::min(b.y, b.y + b.h),
+                std::max(b.x, b.x + b.w), std::max(b.y, b.y + b.h)};
+    }
+
+    /* 16-bit Hilbert curve index (x, y in [0, 65535]). */
+    static uint32_t hilbert(uint32_t x, uint32_t y) {
+        const uint32_t n = 1u << 16;
+        uint32_t d = 0;
+        for (uint32_t s = n >> 1; s > 0; s >>= 1) {
+            uint32_t rx = (x & s) ? 1 : 0, ry = (y & s) ? 1 : 0;
+            d += s * s * ((3 * rx) ^ ry);
+            if (ry == 0) {
+                if (rx == 1) { x = n - 1 - x; y = n - 1 - y; }
+                std::swap(x, y);
+            }
+        }
+        return d;
+    }
+
+    std::vector<Box>      boxes_;      /* leaves, then each parent level */
+    std::vector<uint32_t> ids_;        /* leaf: item index; node: first child slot */
+    std::vector<size_t>   level_end_;  /* exclusive end slot of each level */
+};
+
+#endif
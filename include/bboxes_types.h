@@ -1,6 +1,7 @@
 #ifndef BBOXES_TYPES_H
 #define BBOXES_TYPES_H
 
+#include <cmath>
 #include <cstdint>
 #include <cstdio>
 #include <string>
@@ -82,7 +83,12 @@ inline FontNameTraits font_name_traits(const char* name) {
 
 struct FontTable {
     std::unordered_map<std::string, uint32_t> map;
-    struct Entry { uint32_t id; std::string name; };
+    struct Entry {
+        uint32_t       id;
+        std::string    name;
+        bool           traits_known = false;   /* `traits` computed yet? */
+        FontNameTraits traits = {false, false, 0, false};
+    };
     std::vector<Entry> entries;
 
     uint32_t intern(const char* name) {
@@ -94,6 +100,17 @@ struct FontTable {
         entries.push_back({id, key});
         return id;
     }
+
+    /* font_name_traits of entry `id`'s name, computed on first use: the name
+       scan is a lowercase copy and a dozen finds, too much per character. */
+    const FontNameTraits& name_traits(uint32_t id) {
+        Entry& e = entries[id];
+        if (!e.traits_known) {
+            e.traits = font_name_traits(e.name.c_str());
+            e.traits_known = true;
+        }
+        return e.traits;
+    }
 };
 
 /* ── Style table (intern by font_id + visual properties) ───────── */
@@ -159,7 +176,8 @@ struct StyleTable {
    as a string (the vstr channel / raw <v>). Non-xlsx readers leave STRING. */
 enum BBoxCellType : uint8_t {
     BBOX_STRING = 0,   /* text / shared string / inlineStr — value in `text`        */
-    BBOX_NUMBER = 1,   /* numeric (incl. date serials)     — `vnum`, raw in `text`  */
+    BBOX_NUMBER = 1,   /* numeric (incl. date serials)     — `vnum`, raw in `text`;
+                          date-formatted serials also set `vdate`                   */
     BBOX_BOOL   = 2,   /* boolean                          — `vbool`                */
     BBOX_ERROR  = 3,   /* error (#REF! …)                  — `text`                 */
 };
@@ -175,12 +193,62 @@ struct BBox {
     uint8_t     cell_type = BBOX_STRING;   /* the value's type (discriminant)   */
     double      vnum = 0.0;                /* set iff cell_type == BBOX_NUMBER   */
     bool        vbool = false;             /* set iff cell_type == BBOX_BOOL     */
+    bool        has_vdate = false;         /* NUMBER whose numFmt is a date/time */
+    int64_t     vdate = 0;                 /* µs since 1970-01-01 (naive, no tz) */
     std::string text;                      /* value as string (always) / vstr    */
     std::string formula;
 };
 
+/* Spreadsheet date serial -> µs since the Unix epoch. 1900 system: serial 1 is
+   1900-01-01 and Lotus' phantom 1900-02-29 (serial 60) sits in the count, so
+   serials below 61 are one day further from the epoch; 1904 system: serial 0 is
+   1904-01-01. Rounded to the millisecond — finer digits are float noise. */
+inline int64_t bboxes_serial_to_unix_us(double serial, bool date1904) {
+    double days = date1904 ? serial - 24107.0 : serial - (serial < 61.0 ? 25568.0 : 25569.0);
+    return static_cast<int64_t>(std::llround(days * 86400000.0)) * 1000;
+}
+
+/* µs since the epoch -> "YYYY-MM-DDTHH:MM:SS[.mmm]" (civil-from-days, proleptic
+   Gregorian). Same shape as the pdf metadata dates, minus the offset. */
+inline std::string bboxes_unix_us_iso(int64_t us) {
+    int64_t ms = us >= 0 ? us / 1000 : -((-us + 999) / 1000);
+    int64_t days = ms >= 0 ? ms / 86400000 : -((-ms + 86399999) / 86400000);
+    int64_t tod = ms - days * 86400000;
+    int64_t z = days + 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    int64_t doe = z - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    int d = int(doy - (153 * mp + 2) / 5 + 1);
+    int m = int(mp < 10 ? mp + 3 : mp - 9);
+    int64_t y = yoe + era * 400 + (m <= 2);
+    char buf[40];
+    int n = snprintf(buf, sizeof(buf), "%04lld-%02d-%02dT%02d:%02d:%02d", (long long)y, m, d,
+                     int(tod / 3600000), int(tod / 60000 % 60), int(tod / 1000 % 60));
+    if (tod % 1000) snprintf(buf + n, sizeof(buf) - n, ".%03d", int(tod % 1000));
+    return buf;
+}
+
 struct Merge { int r1, c1, r2, c2; };   /* 1-based, inclusive */
 
+/* One rich-text run of a cell's text (fast xlsx reader: <r> runs of a shared or
+   inline string). (x, y) is the owning cell; start/length count code points of
+   the cell's `text`; style_id indexes BBoxResult::run_styles, NOT `styles`. */
+struct TextRun { uint32_t x, y, start, length, style_id; };
+
+/* One ruling line or rectangle from a PDF path object, reduced to axis-aligned
+   geometry in the bbox coordinate space (points, top-left origin). A line has
+   zero extent across its axis (h = 0 for 'h', w = 0 for 'v'); line_width is
+   its drawn thickness. rgba packs the stroke colour (fill for filled shapes). */
+enum PageRuleKind : uint8_t { RULE_HLINE = 0, RULE_VLINE = 1, RULE_RECT = 2 };
+struct PageRule {
+    uint8_t  kind;
+    double   x, y, w, h;
+    double   line_width;
+    uint32_t rgba;
+};
+
 struct Page {
     uint32_t    page_id;
     uint32_t    document_id;
@@ -188,6 +256,8 @@ struct Page {
     double      width, height;
     std::vector<BBox> bboxes;
     std::vector<Merge> merges;  /* side-channel: captured during the cell scan */
+    std::vector<TextRun> runs;  /* side-channel: rich-text runs, only for cells that have them */
+    std::vector<PageRule> rules; /* side-channel: PDF ruling lines / rectangles */
 };
 
 struct BBoxResult {
@@ -196,49 +266,123 @@ struct BBoxResult {
     int         page_count;
     FontTable   fonts;
     StyleTable  styles;
+    StyleTable  run_styles;    /* interned <rPr> of TextRun; font_id indexes run_fonts */
+    FontTable   run_fonts;     /* kept apart so a reader without a font table reports none */
     std::vector<Page> pages;
 };
 
 /* ── Backend interface ─────────────────────────────────────────── */
 
+/* `rules` collects ruling lines and rectangles (Page::rules), a walk over
+   every path and form object on the page; off, Page::rules stays empty. */
 BBoxResult extract_pdf(const void* buf, size_t len, const char* password,
-                        int start_page, int end_page);
+                        int start_page, int end_page, bool rules);
 
 /* Object-level PDF extraction: one bbox per PDF text object (word/phrase).
    Slower than char-by-char but produces clean text without downstream merging.
    Useful for interactive exploration. */
 BBoxResult extract_pdf_objects(const void* buf, size_t len, const char* password,
-                                int start_page, int end_page);
+                                int start_page, int end_page, bool rules);
+
+/* File-backed PDF extraction (either grain): PDFium pulls byte ranges through a
+   block cache instead of the caller reading the file, so a page range costs the
+   pages it touches rather than the file size. */
+BBoxResult extract_pdf_file(const char* path, const char* password,
+                            int start_page, int end_page, bool objects, bool rules);
 
 BBoxResult extract_xlsx(const void* buf, size_t len, const char* password,
                          int start_page, int end_page);
 
 /* fast byte-scan xlsx reader — same BBox grain, ~7-9x faster; style_id = cellXfs `s`,
-   text = raw value (shared-strings resolved). Parallel to extract_xlsx (unchanged). */
+   text = raw value (shared-strings resolved). Parallel to extract_xlsx (unchanged).
+   Also reads a password-protected (ECMA-376 encrypted) workbook, decrypting as it goes;
+   `password` nullptr tries Excel's default. `runs` records rich-text runs
+   (Page::runs), parsing and interning every <rPr>; off, run properties are
+   skipped. */
 BBoxResult extract_xlsx_fast(const void* buf, size_t len, const char* password,
-                             int start_page, int end_page);
+                             int start_page, int end_page, bool runs);
+
+/* .xlsb (BIFF12 binary workbook) backend — the extract_xlsx_fast grain read from cell records
+   instead of XML: style_id = raw iStyleRef, shared strings resolved, merges side-channel, formulas
+   rendered to A1 (bboxes_xlsb.cpp). Encrypted packages decrypt as for extract_xlsx_fast. */
+BBoxResult extract_xlsb(const void* buf, size_t len, const char* password,
+                        int start_page, int end_page);
+
+/* .ods (OpenDocument spreadsheet) backend — the extract_xlsx_fast grain from content.xml, scanned
+   row by row as it inflates; empty repeated rows/cells advance the grid without being expanded,
+   formulas are turned from OpenFormula into A1 text (bboxes_ods.cpp). page_count is every sheet of
+   the document whatever the page range, as for extract_xlsx_fast and extract_xlsb; an encrypted
+   package gives -1. */
+BBoxResult extract_ods(const void* buf, size_t len, int start_page, int end_page);
+
+/* numFmt classification (bboxes_meta.cpp). bboxes_builtin_numfmt returns the
+   US-English code for a builtin id (NULL if unknown); bboxes_numfmt_is_date says
+   whether a numFmt renders its number as a date/time — by id for the builtin
+   date ids, else by scanning `code` for date/time tokens outside literals. */
+const char* bboxes_builtin_numfmt(int id);
+bool bboxes_numfmt_is_date(int id, const char* code);
+
 
 BBoxResult extract_text(const void* buf, size_t len);
 
 BBoxResult extract_docx(const void* buf, size_t len);
 
+/* Legacy .doc (Word 97-2003, OLE2) backend — the piece table streamed in CP order onto the same
+   line/grid model as extract_docx (bboxes_doc.cpp). */
+BBoxResult extract_doc(const void* buf, size_t len);
+
 /* HTML backend (Lexbor): imputed INTEGER geometry — <table> cells map to an
    (x=col, y=row) grid (colspan/rowspan → w/h), flow content (p/li/hN/…) maps to
    reading-order lines (y=line, x=nesting depth, w=len(text)). Family with
    xlsx/text/docx — cell-grid, not float. */
 BBoxResult extract_html(const void* buf, size_t len);
 
-/* Legacy .xls (BIFF/OLE2) backend via libxls — cells/values/merges to the SAME grid as xlsx
-   (x=col, y=row, 1-based). No shared/array-formula regions (BIFF exposes evaluated results only). */
+/* Legacy .xls (BIFF5/BIFF8, OLE2) backend — cells/values/merges to the SAME grid as xlsx (x=col,
+   y=row, 1-based), formula A1 text in `formula`. A single libxls-free pass over the Workbook stream
+   (bboxes_xls_biff.cpp). A FILEPASS-encrypted stream is decrypted with `password` (nullptr: Excel's
+   default "VelvetSweatshop"); a password that does not verify gives page_count = -1. */
 BBoxResult extract_xls(const void* buf, size_t len, const char* password,
                        int start_page, int end_page);
 
-/* Cell-formula map from the libxls-free BIFF walker (bboxes_xls_biff.cpp): key encodes the
-   (sheet-index, 0-based row, 0-based col) via bboxes_xls_cellkey; value is the A1 formula string.
-   extract_xls uses this to populate the bbox `formula` field (libxls exposes only evaluated values). */
-inline uint64_t bboxes_xls_cellkey(int sheet, int row, int col) {
-    return (uint64_t(uint32_t(sheet)) << 40) | (uint64_t(row & 0xFFFF) << 16) | (uint32_t(col) & 0xFFFF);
-}
-std::unordered_map<uint64_t, std::string> bboxes_xls_formula_map(const void* buf, size_t len);
+/* BIFF colour index (icv) -> "rgba(r,g,b,255)" over the default 56-colour palette. */
+std::string bboxes_xls_color(uint16_t icv);
+
+/* ── Pre-flight probe (bboxes_probe.cpp) ───────────────────────── */
+
+/* What a document will cost before extraction commits to it, read from
+   headers, trailers and container directories only. -1 means unknown. */
+struct DocProbe {
+    std::string format;                 /* bboxes_detect name, or "ole" */
+    int         encrypted = -1;
+    int         password_required = -1; /* encrypted AND no empty/default password opens it;
+                                           unknown for OOXML, where telling costs the KDF */
+    int         pages = -1;             /* pages, or sheets for spreadsheets */
+    uint64_t    size_bytes = 0;         /* container size */
+    uint64_t    work_bytes = 0;         /* bytes the extractor will decode */
+    std::string error;
+};
+
+/* PDF: trailer + xref + page-tree root through PDFium (no page content is
+   parsed). `path` non-null reads through the block cache instead of `buf`. */
+void probe_pdf(const void* buf, size_t len, const char* path, DocProbe& out);
+
+/* OLE2/CFB: directory + the workbook-globals substream only (bboxes_xls_biff.cpp;
+   needs the xls backend's CFB reader). */
+void probe_ole(const void* buf, size_t len, DocProbe& out);
+
+/* ── Layout pass (bboxes_layout.cpp) ───────────────────────────── */
+
+/* One reading-order line: bboxes of a page that share a baseline band and are
+   not separated by a column-sized gap. Lines come back in reading order (the
+   vector index is the line_id); column_id counts XY-cut columns in the order
+   they are first read. members are indices into Page::bboxes, left to right;
+   text joins their texts with single spaces. */
+struct TextLine {
+    uint32_t column_id = 0;
+    double   x = 0, y = 0, w = 0, h = 0;
+    std::vector<uint32_t> members;
+    std::string text;
+};
+std::vector<TextLine> bboxes_group_lines(const Page& page);
 
 #endif
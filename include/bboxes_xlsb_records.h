@@ -0,0 +1,43 @@
+#ifndef BBOXES_XLSB_RECORDS_H
+#define BBOXES_XLSB_RECORDS_H
+
+/* ── BIFF12 record walk ───────────────────────────────────────────────
+   Every binary part of an .xlsb ([MS-XLSB] 2.1.4) is a flat run of records:
+   a 7-bit-varint id (1-2 bytes) and size (1-4 bytes), high bit = more, then
+   the body. Records::next() steps over one part in place; a header or body
+   running past the end ends the walk. The xlsb reader walks every part with
+   it, and the probe counts the sheets of workbook.bin. */
+
+#include <cstddef>
+#include <cstdint>
+
+struct Rec { uint32_t id; const uint8_t* p; uint32_t n; };
+
+class Records {
+public:
+    Records(const void* p, size_t n) : p_(static_cast<const uint8_t*>(p)), n_(n) {}
+    bool next(Rec& r) {
+        uint32_t id = 0, sz = 0;
+        for (int k = 0;; k++) {
+            if (pos_ >= n_ || k == 2) return false;
+            uint8_t b = p_[pos_++];
+            id |= uint32_t(b & 0x7F) << (7 * k);
+            if (!(b & 0x80)) break;
+        }
+        for (int k = 0;; k++) {
+            if (pos_ >= n_ || k == 4) return false;
+            uint8_t b = p_[pos_++];
+            sz |= uint32_t(b & 0x7F) << (7 * k);
+            if (!(b & 0x80)) break;
+        }
+        if (sz > n_ - pos_) return false;
+        r = {id, p_ + pos_, sz};
+        pos_ += sz;
+        return true;
+    }
+
+private:
+    const uint8_t* p_; size_t n_; size_t pos_ = 0;
+};
+
+#endif /* BBOXES_XLSB_RECORDS_H */
@@ -0,0 +1,93 @@
+#ifndef BBOXES_XLSX_PKG_H
+#define BBOXES_XLSX_PKG_H
+
+/* ── opened xlsx package ──────────────────────────────────────────────
+   One zip open shared by every xlsx entry point inside a single call: the header
+   (style decode + lean metadata) and the fast cell scan both pull their small
+   parts — workbook.xml, its rels, styles.xml, theme1.xml, sharedStrings.xml,
+   docProps — through part(), which locates the member via the central directory
+   and inflates it at most once. Worksheets are deliberately NOT memoized: the
+   cell scan reads each exactly once, and holding them would double peak memory.
+   A password-protected package (an OLE2 container, see bboxes_encrypted_pkg.h)
+   opens the same way: miniz reads through a callback that decrypts on demand.
+
+   XlsxPackage: open_mem() / open_file() (open_mem with a password for the
+   encrypted form), part() for a memoized member, and the raw mz_zip_archive
+   for the worksheet streams; below it, the readers that take an opened
+   package (fast xlsx cells, xlsb cells, the artifact header). */
+
+#include <miniz.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "bboxes_encrypted_pkg.h"
+#include "bboxes_types.h"
+
+struct XlsxPackage {
+    mz_zip_archive z;
+
+    XlsxPackage() { std::memset(&z, 0, sizeof(z)); }
+    ~XlsxPackage() { if (open_) mz_zip_reader_end(&z); }
+    XlsxPackage(const XlsxPackage&) = delete;
+    XlsxPackage& operator=(const XlsxPackage&) = delete;
+
+    bool open_mem(const void* buf, size_t len) {
+        return open_ = mz_zip_reader_init_mem(&z, buf, len, 0);
+    }
+    bool open_file(const char* path) {
+        return open_ = mz_zip_reader_init_file(&z, path, 0);
+    }
+    /* A zip as is; an OLE2 container as an encrypted package, opened with
+       `password` (nullptr: the default). error() says why an open failed. */
+    bool open_mem(const void* buf, size_t len, const char* password) {
+        if (len < 8 || std::memcmp(buf, "\xD0\xCF\x11\xE0\xA1\xB1\x1A\xE1", 8) != 0) return open_mem(buf, len);
+        enc_.reset(new EncryptedPackage);
+        if (!enc_->open(buf, len, password)) { err_ = enc_->error(); return false; }
+        z.m_pRead = [](void* o, mz_uint64 ofs, void* dst, size_t n) -> size_t {
+            return static_cast<EncryptedPackage*>(o)->read(ofs, dst, n);
+        };
+        z.m_pIO_opaque = enc_.get();
+        if (!(open_ = mz_zip_reader_init(&z, enc_->size(), 0))) err_ = "decrypted package is not a zip";
+        return open_;
+    }
+    const std::string& error() const { return err_; }
+
+    /* Inflated bytes of `name`, or nullptr when the member is absent/unreadable.
+       The pointer stays valid for the package's lifetime. */
+    const std::string* part(const char* name) {
+        auto it = parts_.find(name);
+        if (it == parts_.end()) {
+            Part p;
+            int idx = mz_zip_reader_locate_file(&z, name, nullptr, 0);
+            size_t sz = 0;
+            void* raw = idx < 0 ? nullptr : mz_zip_reader_extract_to_heap(&z, idx, &sz, 0);
+            if (raw) { p.present = true; p.bytes.assign(static_cast<const char*>(raw), sz); mz_free(raw); }
+            it = parts_.emplace(name, std::move(p)).first;
+        }
+        return it->second.present ? &it->second.bytes : nullptr;
+    }
+
+private:
+    struct Part { bool present = false; std::string bytes; };
+    std::unordered_map<std::string, Part> parts_;
+    std::unique_ptr<EncryptedPackage> enc_;
+    std::string err_;
+    bool open_ = false;
+};
+
+/* Fast cell scan over an already-opened package (bboxes_xlsx.cpp); the buffer
+   overload in bboxes_types.h opens one and forwards here. */
+BBoxResult extract_xlsx_fast(XlsxPackage& pkg, int start_page, int end_page, bool runs);
+
+/* The same over a package holding xl/workbook.bin (bboxes_xlsb.cpp): what a
+   decrypted package turns out to be is known only once it is open. */
+BBoxResult extract_xlsb(XlsxPackage& pkg, int start_page, int end_page);
+
+/* Artifact header over an already-opened package (bboxes_meta.cpp). `sha256` is
+   the caller's hash of the source bytes — the cursor has already computed it. */
+std::string bboxes_xlsx_header_from_pkg(XlsxPackage& pkg, const std::string& sha256);
+
+#endif
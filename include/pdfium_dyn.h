@@ -12,8 +12,9 @@
  * the PDF backend reports a clear error when libpdfium is absent while every
  * other format keeps working.
  *
- * How: PDFium's public headers are pure C, so the whole surface we use is 35
- * ordinary functions. The X-macro below names them once; from it we declare a
+ * How: PDFium's public headers are pure C, so the whole surface we use is 53
+ * ordinary functions, counting the file-backed open, the page render and the
+ * ruling-line walk. The X-macro below names them once; from it we declare a
  * function pointer per entry and then `#define` each PDFium name onto its
  * pointer, so **no call site changes**. bboxes_pdf.cpp still reads as if it
  * were linking normally.
@@ -59,6 +60,13 @@ extern "C" {
     X(FPDF_GetFileVersion)                                                     \
     X(FPDF_GetDocPermissions)                                                  \
     X(FPDF_GetSecurityHandlerRevision)                                         \
+    /* fpdfview.h — rasterization */                                           \
+    X(FPDFBitmap_Create)                                                       \
+    X(FPDFBitmap_FillRect)                                                     \
+    X(FPDFBitmap_GetBuffer)                                                    \
+    X(FPDFBitmap_GetStride)                                                    \
+    X(FPDFBitmap_Destroy)                                                      \
+    X(FPDF_RenderPageBitmap)                                                   \
     /* fpdf_doc.h — metadata */                                                \
     X(FPDF_GetMetaText)                                                        \
     /* fpdf_catalog.h */                                                       \
@@ -72,18 +80,31 @@ extern "C" {
     X(FPDFText_GetFontSize)                                                    \
     X(FPDFText_GetFontInfo)                                                    \
     X(FPDFText_GetFillColor)                                                   \
+    X(FPDFText_GetTextObject)                                                  \
     /* fpdf_edit.h — object-level extraction */                                \
     X(FPDFPage_CountObjects)                                                   \
     X(FPDFPage_GetObject)                                                      \
     X(FPDFPageObj_GetType)                                                     \
     X(FPDFPageObj_GetBounds)                                                   \
     X(FPDFPageObj_GetFillColor)                                                \
+    X(FPDFPageObj_GetStrokeColor)                                              \
+    X(FPDFPageObj_GetStrokeWidth)                                              \
+    X(FPDFPageObj_GetMatrix)                                                   \
     X(FPDFTextObj_GetText)                                                     \
     X(FPDFTextObj_GetFont)                                                     \
     X(FPDFTextObj_GetFontSize)                                                 \
     X(FPDFFont_GetFamilyName)                                                  \
     X(FPDFFont_GetFlags)                                                       \
-    X(FPDFFont_GetWeight)
+    X(FPDFFont_GetWeight)                                                      \
+    /* fpdf_edit.h — path objects (ruling lines) and form XObjects */          \
+    X(FPDFPath_CountSegments)                                                  \
+    X(FPDFPath_GetPathSegment)                                                 \
+    X(FPDFPath_GetDrawMode)                                                    \
+    X(FPDFPathSegment_GetPoint)                                                \
+    X(FPDFPathSegment_GetType)                                                 \
+    X(FPDFPathSegment_GetClose)                                                \
+    X(FPDFFormObj_CountObjects)                                                \
+    X(FPDFFormObj_GetObject)
 
 /* One pointer per function, holding the real prototype's type. */
 #define BBOXES_PDFIUM_DECL(name) extern decltype(&::name) bb_dyn_##name;
@@ -137,6 +158,12 @@ const char *bb_pdfium_error(void);
 #define FPDF_GetFileVersion           bb_dyn_FPDF_GetFileVersion
 #define FPDF_GetDocPermissions        bb_dyn_FPDF_GetDocPermissions
 #define FPDF_GetSecurityHandlerRevision bb_dyn_FPDF_GetSecurityHandlerRevision
+#define FPDFBitmap_Create             bb_dyn_FPDFBitmap_Create
+#define FPDFBitmap_FillRect           bb_dyn_FPDFBitmap_FillRect
+#define FPDFBitmap_GetBuffer          bb_dyn_FPDFBitmap_GetBuffer
+#define FPDFBitmap_GetStride          bb_dyn_FPDFBitmap_GetStride
+#define FPDFBitmap_Destroy            bb_dyn_FPDFBitmap_Destroy
+#define FPDF_RenderPageBitmap         bb_dyn_FPDF_RenderPageBitmap
 #define FPDF_GetMetaText              bb_dyn_FPDF_GetMetaText
 #define FPDFCatalog_IsTagged          bb_dyn_FPDFCatalog_IsTagged
 #define FPDFText_LoadPage             bb_dyn_FPDFText_LoadPage
@@ -147,17 +174,29 @@ const char *bb_pdfium_error(void);
 #define FPDFText_GetFontSize          bb_dyn_FPDFText_GetFontSize
 #define FPDFText_GetFontInfo          bb_dyn_FPDFText_GetFontInfo
 #define FPDFText_GetFillColor         bb_dyn_FPDFText_GetFillColor
+#define FPDFText_GetTextObject        bb_dyn_FPDFText_GetTextObject
 #define FPDFPage_CountObjects         bb_dyn_FPDFPage_CountObjects
 #define FPDFPage_GetObject            bb_dyn_FPDFPage_GetObject
 #define FPDFPageObj_GetType           bb_dyn_FPDFPageObj_GetType
 #define FPDFPageObj_GetBounds         bb_dyn_FPDFPageObj_GetBounds
 #define FPDFPageObj_GetFillColor      bb_dyn_FPDFPageObj_GetFillColor
+#define FPDFPageObj_GetStrokeColor    bb_dyn_FPDFPageObj_GetStrokeColor
+#define FPDFPageObj_GetStrokeWidth    bb_dyn_FPDFPageObj_GetStrokeWidth
+#define FPDFPageObj_GetMatrix         bb_dyn_FPDFPageObj_GetMatrix
 #define FPDFTextObj_GetText           bb_dyn_FPDFTextObj_GetText
 #define FPDFTextObj_GetFont           bb_dyn_FPDFTextObj_GetFont
 #define FPDFTextObj_GetFontSize       bb_dyn_FPDFTextObj_GetFontSize
 #define FPDFFont_GetFamilyName        bb_dyn_FPDFFont_GetFamilyName
 #define FPDFFont_GetFlags             bb_dyn_FPDFFont_GetFlags
 #define FPDFFont_GetWeight            bb_dyn_FPDFFont_GetWeight
+#define FPDFPath_CountSegments        bb_dyn_FPDFPath_CountSegments
+#define FPDFPath_GetPathSegment       bb_dyn_FPDFPath_GetPathSegment
+#define FPDFPath_GetDrawMode          bb_dyn_FPDFPath_GetDrawMode
+#define FPDFPathSegment_GetPoint      bb_dyn_FPDFPathSegment_GetPoint
+#define FPDFPathSegment_GetType       bb_dyn_FPDFPathSegment_GetType
+#define FPDFPathSegment_GetClose      bb_dyn_FPDFPathSegment_GetClose
+#define FPDFFormObj_CountObjects      bb_dyn_FPDFFormObj_CountObjects
+#define FPDFFormObj_GetObject         bb_dyn_FPDFFormObj_GetObject
 
 #endif /* BBOXES_PDFIUM_NO_REDIRECT */
 
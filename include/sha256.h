@@ -8,16 +8,17 @@
  * src/bboxes_zig.zig and this header is the shim that keeps the call sites
  * unchanged.
  *
- * Only the calling convention actually used is provided:
+ * Only the calling conventions actually used are provided:
  *
  *     SHA256 sha;
  *     std::string hex = sha(buffer, length);
  *
- * hash-library also offered incremental add()/getHash() and an std::string
- * overload. Those are deliberately absent rather than stubbed: nothing here
- * calls them, and an unused reimplementation is a thing to get subtly wrong.
- * Add them here, backed by a streaming variant of bb_sha256_hex, if a caller
- * ever needs them.
+ *     SHA256 sha;                 // incremental, for a file hashed in chunks
+ *     sha.add(chunk, n); ...
+ *     std::string hex = sha.getHash();
+ *
+ * hash-library's std::string overload is deliberately absent rather than
+ * stubbed: nothing here calls it.
  */
 
 #ifndef BBOXES_SHA256_H
@@ -27,9 +28,14 @@
 #include <string>
 
 extern "C" void bb_sha256_hex(const unsigned char *data, size_t len, char *out);
+extern "C" void bb_sha256_init(void *state);
+extern "C" void bb_sha256_update(void *state, const unsigned char *data, size_t len);
+extern "C" void bb_sha256_final_hex(void *state, char *out);
 
 class SHA256 {
 public:
+    SHA256() { bb_sha256_init(state_); }
+
     /* Lowercase hex, as hash-library produced. These digests are content
      * addresses that appear in extracted metadata (workbook_id, the document
      * checksum), so changing the case would silently invalidate every
@@ -39,6 +45,20 @@ public:
         bb_sha256_hex(static_cast<const unsigned char *>(data), len, buf);
         return std::string(buf, 64);
     }
+
+    /* Incremental form; operator() neither reads nor disturbs it. getHash()
+     * spends the state, so one SHA256 hashes one stream. */
+    void add(const void *data, size_t len) {
+        bb_sha256_update(state_, static_cast<const unsigned char *>(data), len);
+    }
+    std::string getHash() {
+        char buf[65];
+        bb_sha256_final_hex(state_, buf);
+        return std::string(buf, 64);
+    }
+
+private:
+    alignas(16) unsigned char state_[128];   /* std.crypto Sha256, see bb_sha256_init */
 };
 
 #endif /* BBOXES_SHA256_H */
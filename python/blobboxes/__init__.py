@@ -2,16 +2,24 @@
 
 from __future__ import annotations
 
+import ctypes
+import json as _json
+import os
+
 __version__ = "0.4.5"
 
 from ._cursors import (
     BBoxesAutoCursor,
+    BBoxesDocCursor,
     BBoxesDocxCursor,
     BBoxesHtmlCursor,
+    BBoxesOdsCursor,
     BBoxesPdfCursor,
     BBoxesPdfObjCursor,
     BBoxesTextCursor,
     BBoxesXlsCursor,
+    BBoxesXlsbCursor,
+    BBoxesXlsxArtifactCursor,
     BBoxesXlsxCursor,
     BBoxesXlsxSlowCursor,
 )
@@ -22,17 +30,21 @@ from ._native import (
     library_path,
     sqlite_extension_path,
 )
+from . import _native as _n
 from ._native import _str as _decode
 
 __all__ = [
-    "open", "open_pdf", "open_pdf_objects", "open_xlsx", "open_xlsx_slow",
-    "open_xls", "open_text", "open_docx", "open_html",
-    "detect", "info",
+    "open", "open_pdf", "open_pdf_objects", "open_xlsx", "open_xlsx_artifact", "open_xlsx_slow",
+    "open_xls", "open_xlsb", "open_ods", "open_text", "open_docx", "open_doc", "open_html",
+    "detect", "info", "probe", "probe_file", "file_checksum",
     "doc_json", "pages_json", "fonts_json", "styles_json", "bboxes_json", "xfdf",
+    "render_page", "render_cache",
+    "global_dict_auto", "global_dict_reset", "global_fonts", "global_styles",
     "Error", "library_path", "duckdb_extension_path", "sqlite_extension_path",
     "BBoxesAutoCursor", "BBoxesPdfCursor", "BBoxesPdfObjCursor",
-    "BBoxesXlsxCursor", "BBoxesXlsxSlowCursor", "BBoxesXlsCursor",
-    "BBoxesTextCursor", "BBoxesDocxCursor", "BBoxesHtmlCursor",
+    "BBoxesXlsxCursor", "BBoxesXlsxArtifactCursor", "BBoxesXlsxSlowCursor", "BBoxesXlsCursor", "BBoxesXlsbCursor",
+    "BBoxesOdsCursor",
+    "BBoxesTextCursor", "BBoxesDocxCursor", "BBoxesDocCursor", "BBoxesHtmlCursor",
 ]
 
 
@@ -57,16 +69,25 @@ _init()
 open_pdf = BBoxesPdfCursor
 open_pdf_objects = BBoxesPdfObjCursor  # object-level PDF (one bbox per text object)
 open_xlsx = BBoxesXlsxCursor           # DEFAULT: fast byte-scan reader
+open_xlsx_artifact = BBoxesXlsxArtifactCursor  # fast reader + header, one zip open
 open_xlsx_slow = BBoxesXlsxSlowCursor  # legacy xlnt path (kept for A/B)
 open_xls = BBoxesXlsCursor
+open_xlsb = BBoxesXlsbCursor
+open_ods = BBoxesOdsCursor
 open_text = BBoxesTextCursor
 open_docx = BBoxesDocxCursor
+open_doc = BBoxesDocCursor
 open_html = BBoxesHtmlCursor
 open = BBoxesAutoCursor  # noqa: A001 — shadows the builtin deliberately, as before
 
 
 def detect(data: bytes) -> str | None:
-    """Identify the format from magic bytes: 'pdf', 'xlsx', 'docx', 'text', ..."""
+    """Identify the format from magic bytes: 'pdf', 'xlsx', 'xlsb', 'ods', 'docx', 'xls', 'doc', 'text', ...
+
+    A password-protected OOXML file is 'ooxml-encrypted': what is inside is
+    known only after decryption, which the xlsx reader does (and which hands
+    an xlsb on to the xlsb reader).
+    """
     buf = bytes(data)
     return _decode(lib.bboxes_detect(buf, len(buf)))
 
@@ -77,6 +98,28 @@ def info(data: bytes) -> dict:
         return cur.doc()
 
 
+def probe(data: bytes) -> dict:
+    """Pre-flight: format, encryption, page/sheet count and cost estimate,
+    read from headers and container directories without extracting."""
+    buf = bytes(data)
+    return _json.loads(_decode(lib.bboxes_probe(buf, len(buf))))
+
+
+def probe_file(path) -> dict:
+    """probe() over a path; reads a zip's directory, a PDF's xref or an OLE2
+    file's directory and globals only."""
+    return _json.loads(_decode(lib.bboxes_probe_file(os.fsencode(path))))
+
+
+def file_checksum(path) -> str:
+    """SHA-256 hex of a file, streamed: the checksum a buffer open reports and
+    a from_path() cursor leaves empty. Reads the whole file."""
+    out = _decode(lib.bboxes_file_checksum(os.fsencode(path)))
+    if out is None:
+        raise Error(f"cannot read {path}")
+    return out
+
+
 def _cursor_for(data, password, start_page, end_page):
     """Pick the reader a JSON accessor should run against.
 
@@ -89,10 +132,14 @@ def _cursor_for(data, password, start_page, end_page):
     fmt = detect(data)
     if fmt == "pdf":
         return BBoxesPdfCursor(data, password, start_page, end_page)
-    if fmt == "xlsx":
+    if fmt in ("xlsx", "ooxml-encrypted"):
         return BBoxesXlsxCursor(data, password, start_page, end_page)
     if fmt == "xls":
         return BBoxesXlsCursor(data, password, start_page, end_page)
+    if fmt == "xlsb":
+        return BBoxesXlsbCursor(data, password, start_page, end_page)
+    if fmt == "ods":
+        return BBoxesOdsCursor(data, start_page, end_page)
     return BBoxesAutoCursor(data)
 
 
@@ -132,3 +179,50 @@ def bboxes_json(data, password=None, start_page=0, end_page=0) -> str:
 def xfdf(annots_json: str) -> str:
     """Render an annotation list as XFDF."""
     return _decode(lib.bboxes_xfdf_from_json(annots_json.encode())) or ""
+
+
+def render_page(data: bytes, page: int, dpi: float = 144.0, *, rgba: bool = False,
+                password=None, checksum: str | None = None) -> tuple[int, int, bytes]:
+    """Rasterize one 1-based PDF page → (width, height, PNG bytes or RGBA rows).
+
+    Served from the on-disk cache when one is configured (see render_cache);
+    pass the cursor's `doc()["checksum"]` to skip re-hashing `data`.
+    """
+    w, h, n = ctypes.c_int(), ctypes.c_int(), ctypes.c_size_t()
+    pw = password.encode() if isinstance(password, str) else password
+    p = lib.bboxes_pdf_render_page(
+        data, len(data), pw, checksum.encode() if checksum else None, page, dpi,
+        _n.RENDER_RGBA if rgba else _n.RENDER_PNG,
+        ctypes.byref(w), ctypes.byref(h), ctypes.byref(n))
+    if not p:
+        raise Error(f"could not render page {page}")
+    try:
+        return w.value, h.value, ctypes.string_at(p, n.value)
+    finally:
+        lib.bboxes_pdf_render_free(p)
+
+
+def render_cache(directory: str | None, max_bytes: int = 0) -> None:
+    """Cache rendered pages under `directory` (None turns the cache off)."""
+    lib.bboxes_pdf_render_cache(directory.encode() if directory else None, max_bytes)
+
+
+def global_dict_auto(enable: bool = True) -> None:
+    """Attach every cursor opened from now on to the process-wide font/style
+    dictionary, so font_id/style_id are stable across documents."""
+    lib.bboxes_global_dict_auto(1 if enable else 0)
+
+
+def global_dict_reset() -> None:
+    """Forget every global font/style id issued so far."""
+    lib.bboxes_global_dict_reset()
+
+
+def global_fonts() -> list:
+    """Every font in the global dictionary, ordered by font_id."""
+    return _json.loads(_decode(lib.bboxes_global_fonts_json()) or "[]")
+
+
+def global_styles() -> list:
+    """Every style in the global dictionary, ordered by style_id."""
+    return _json.loads(_decode(lib.bboxes_global_styles_json()) or "[]")
@@ -14,14 +14,17 @@ attribute would leave the cursor reading freed memory.
 
 from __future__ import annotations
 
+import ctypes
+import datetime as _dt
 import json as _json
+import os
 
 from . import _native as _n
 from ._native import Error, lib
 
 __all__ = [
     "BBoxesPdfCursor", "BBoxesPdfObjCursor", "BBoxesXlsxCursor",
-    "BBoxesXlsxSlowCursor", "BBoxesXlsCursor", "BBoxesTextCursor",
+    "BBoxesXlsxArtifactCursor", "BBoxesXlsxSlowCursor", "BBoxesXlsCursor", "BBoxesXlsbCursor", "BBoxesOdsCursor", "BBoxesTextCursor",
     "BBoxesDocxCursor", "BBoxesHtmlCursor", "BBoxesAutoCursor",
 ]
 
@@ -36,6 +39,9 @@ def _require(name: str):
     return fn
 
 
+_EPOCH = _dt.datetime(1970, 1, 1)
+
+
 def _rows(step, build):
     """Drain a `bboxes_next_*` iterator, copying each row out as it is read."""
     out = []
@@ -103,7 +109,7 @@ class _CursorBase:
         want_formula = self._include_formula
 
         def build(b):
-            # Cell-grid formats (xlsx/xls/text/docx/html) carry integer
+            # Cell-grid formats (xlsx/xls/xlsb/ods/text/docx/html) carry integer
             # coordinates; bboxes_format_int_coords is the single source of
             # truth for which, and hosts must not re-decide it.
             if int_coords:
@@ -114,6 +120,8 @@ class _CursorBase:
             row["cell_type"] = _n._str(b.cell_type)
             row["vnum"] = b.vnum if b.has_vnum else None
             row["vbool"] = bool(b.vbool) if b.has_vbool else None
+            # vdate is µs since the epoch with no zone, like DuckDB's TIMESTAMP
+            row["vdate"] = _EPOCH + _dt.timedelta(microseconds=b.vdate) if b.has_vdate else None
             row["text"] = _n._str(b.text)
             if want_formula:
                 row["formula"] = _n._str(b.formula)
@@ -121,6 +129,84 @@ class _CursorBase:
 
         return _rows(lambda: lib.bboxes_next_bbox(self._cur), build)
 
+    def runs(self) -> list:
+        """Rich-text runs of cells that have them (xlsx fast reader, recorded
+        only for a cursor opened with rich_runs=True; empty otherwise).
+
+        Join to bboxes() on (page_id, x, y); start/length are character offsets
+        into that bbox's text.
+        """
+        fn = getattr(lib, "bboxes_next_run", None)
+        if fn is None:
+            return []
+        return _rows(lambda: fn(self._cur), lambda r: {
+            "page_id": r.page_id,
+            "x": r.x,
+            "y": r.y,
+            "start": r.start,
+            "length": r.length,
+            "run_style_id": r.run_style_id,
+            "font": _n._str(r.font),
+            "font_size": r.font_size,
+            "color": _n._str(r.color),
+            "weight": _n._str(r.weight),
+            "italic": r.italic,
+            "underline": r.underline,
+        })
+
+    def attach_global(self) -> None:
+        """Rewrite this cursor's font/style ids to the process-wide dictionary
+        (see blobboxes.global_styles). Call before reading fonts/styles/bboxes."""
+        _require("bboxes_attach_global_dict")(self._cur)
+
+    def query_rect(self, page_id: int, x0: float, y0: float, x1: float, y1: float) -> list:
+        """Indices (within the page) of bboxes intersecting the rectangle."""
+        out = ctypes.POINTER(ctypes.c_uint32)()
+        n = _require("bboxes_query_rect")(self._cur, page_id, x0, y0, x1, y1, ctypes.byref(out))
+        return out[:n] if n else []
+
+    def nearest(self, page_id: int, x: float, y: float, k: int = 1) -> list:
+        """Indices (within the page) of the k bboxes nearest (x, y), nearest first."""
+        out = ctypes.POINTER(ctypes.c_uint32)()
+        n = _require("bboxes_query_nearest")(self._cur, page_id, x, y, k, ctypes.byref(out))
+        return out[:n] if n else []
+
+    def rules(self) -> list:
+        """Ruling lines and rectangles from PDF path objects (table borders),
+        in the same coordinate space as bboxes(). Empty unless the PDF cursor
+        was opened with rules=True, and for other formats."""
+        fn = getattr(lib, "bboxes_next_rule", None)
+        if fn is None:
+            return []
+        return _rows(lambda: fn(self._cur), lambda r: {
+            "page_id": r.page_id,
+            "kind": _n._str(r.kind),
+            "x": r.x,
+            "y": r.y,
+            "w": r.w,
+            "h": r.h,
+            "line_width": r.line_width,
+            "color": _n._str(r.color),
+        })
+
+    def lines(self) -> list:
+        """Reading-order lines: bboxes grouped by baseline band and split at
+        column gaps. bbox_indices index the page's bboxes()."""
+        fn = getattr(lib, "bboxes_next_line", None)
+        if fn is None:
+            return []
+        return _rows(lambda: fn(self._cur), lambda r: {
+            "page_id": r.page_id,
+            "line_id": r.line_id,
+            "column_id": r.column_id,
+            "x": r.x,
+            "y": r.y,
+            "w": r.w,
+            "h": r.h,
+            "text": _n._str(r.text),
+            "bbox_indices": r.bbox_indices[:r.bbox_count],
+        })
+
     # ── xlsx extras, off the same parse as bboxes() ──────────────────
 
     def sheet_meta(self):
@@ -162,20 +248,56 @@ def _open(self, data: bytes, opener: str, *args, what: str):
         raise Error(f"bad {what}")
 
 
+def _open_file(cls, path, opener: str, password, *args):
+    self = cls.__new__(cls)
+    _CursorBase.__init__(self)  # no _buf: the library reads the file itself
+    pw = password.encode() if isinstance(password, str) else password
+    self._cur = _require(opener)(os.fsencode(path), pw, *args)
+    if not self._cur:
+        raise Error(f"bad PDF: {path}")
+    return self
+
+
+def _pdf_flags(rules: bool) -> int:
+    return _n.OPEN_RULES if rules else 0
+
+
 class BBoxesPdfCursor(_CursorBase):
-    def __init__(self, data: bytes, password=None, start_page: int = 0, end_page: int = 0):
+    """Character-level PDF reader. `rules=True` also collects ruling lines and
+    rectangles for rules(), a walk over every path object on each page."""
+
+    def __init__(self, data: bytes, password=None, start_page: int = 0, end_page: int = 0,
+                 rules: bool = False):
         super().__init__()
         pw = password.encode() if isinstance(password, str) else password
-        _open(self, data, "bboxes_open_pdf", pw, start_page, end_page, what="PDF")
+        _open(self, data, "bboxes_open_pdf_ex", pw, start_page, end_page, _pdf_flags(rules), what="PDF")
+
+    @classmethod
+    def from_path(cls, path, password=None, start_page: int = 0, end_page: int = 0,
+                  rules: bool = False):
+        """Open a PDF on disk without reading it whole (PDFium pulls the byte
+        ranges it needs). `doc()["checksum"]` is "" on such a cursor; see
+        blobboxes.file_checksum()."""
+        return _open_file(cls, path, "bboxes_open_pdf_file_ex", password, start_page, end_page,
+                          _pdf_flags(rules))
 
 
 class BBoxesPdfObjCursor(_CursorBase):
-    """Object-level PDF reader: one bbox per text object."""
+    """Object-level PDF reader: one bbox per text object. `rules` as for
+    BBoxesPdfCursor."""
 
-    def __init__(self, data: bytes, password=None, start_page: int = 0, end_page: int = 0):
+    def __init__(self, data: bytes, password=None, start_page: int = 0, end_page: int = 0,
+                 rules: bool = False):
         super().__init__()
         pw = password.encode() if isinstance(password, str) else password
-        _open(self, data, "bboxes_open_pdf_objects", pw, start_page, end_page, what="PDF")
+        _open(self, data, "bboxes_open_pdf_objects_ex", pw, start_page, end_page, _pdf_flags(rules),
+              what="PDF")
+
+    @classmethod
+    def from_path(cls, path, password=None, start_page: int = 0, end_page: int = 0,
+                  rules: bool = False):
+        return _open_file(cls, path, "bboxes_open_pdf_objects_file_ex", password, start_page, end_page,
+                          _pdf_flags(rules))
 
 
 class _SpreadsheetCursor(_CursorBase):
@@ -191,10 +313,36 @@ class _SpreadsheetCursor(_CursorBase):
         _open(self, data, self._opener, pw, start_page, end_page, what=self._what)
 
 
-class BBoxesXlsxCursor(_SpreadsheetCursor):
-    """DEFAULT xlsx reader: the fast byte-scan path."""
+class _FastXlsxCursor(_SpreadsheetCursor):
+    def __init__(self, data: bytes, password=None, start_page: int = 0, end_page: int = 0,
+                 rich_runs: bool = False):
+        _CursorBase.__init__(self)
+        self._int_coords = bool(lib.bboxes_format_int_coords(self._format))
+        pw = password.encode() if isinstance(password, str) else password
+        _open(self, data, self._opener, pw, start_page, end_page,
+              _n.OPEN_RICH_RUNS if rich_runs else 0, what=self._what)
+
+
+class BBoxesXlsxCursor(_FastXlsxCursor):
+    """DEFAULT xlsx reader: the fast byte-scan path. `rich_runs` records
+    rich-text runs (runs()); off, the reader skips run properties entirely."""
+
+    _opener, _format, _what = "bboxes_open_xlsx_fast_ex", _n.FORMAT_XLSX_FAST, "XLSX"
+
 
-    _opener, _format, _what = "bboxes_open_xlsx_fast", _n.FORMAT_XLSX_FAST, "XLSX"
+class BBoxesXlsxArtifactCursor(_FastXlsxCursor):
+    """Fast reader plus the artifact header, off ONE zip open.
+
+    The small parts (workbook.xml, rels, styles.xml, sharedStrings.xml) are
+    inflated once and shared by the cell scan and the header build, so
+    `header()`, `bboxes()` and `sheet_meta()` together cost a single pass.
+    """
+
+    _opener, _format, _what = "bboxes_open_xlsx_artifact_ex", _n.FORMAT_XLSX_FAST, "XLSX"
+
+    def header(self):
+        """Same shape as xlsx_header(): sha256 + style decode + lean metadata."""
+        return _json.loads(_n._str(lib.bboxes_get_header_json(self._cur)) or "null")
 
 
 class BBoxesXlsxSlowCursor(_SpreadsheetCursor):
@@ -209,6 +357,24 @@ class BBoxesXlsCursor(_SpreadsheetCursor):
     _opener, _format, _what = "bboxes_open_xls", _n.FORMAT_XLS, "XLS"
 
 
+class BBoxesXlsbCursor(_SpreadsheetCursor):
+    """Binary workbook (.xlsb, BIFF12 records)."""
+
+    _opener, _format, _what = "bboxes_open_xlsb", _n.FORMAT_XLSB, "XLSB"
+
+
+class BBoxesOdsCursor(_SpreadsheetCursor):
+    """OpenDocument spreadsheet (.ods). There is no password: an encrypted
+    package is refused rather than read."""
+
+    _opener, _format, _what = "bboxes_open_ods", _n.FORMAT_ODS, "ODS"
+
+    def __init__(self, data: bytes, start_page: int = 0, end_page: int = 0):
+        _CursorBase.__init__(self)
+        self._int_coords = bool(lib.bboxes_format_int_coords(self._format))
+        _open(self, data, self._opener, start_page, end_page, what=self._what)
+
+
 class _FlowCursor(_CursorBase):
     _opener = ""
     _format = 0
@@ -228,6 +394,12 @@ class BBoxesDocxCursor(_FlowCursor):
     _opener, _format, _what = "bboxes_open_docx", _n.FORMAT_DOCX, "DOCX"
 
 
+class BBoxesDocCursor(_FlowCursor):
+    """Legacy .doc (Word 97-2003, OLE2)."""
+
+    _opener, _format, _what = "bboxes_open_doc", _n.FORMAT_DOC, "DOC"
+
+
 class BBoxesHtmlCursor(_FlowCursor):
     _opener, _format, _what = "bboxes_open_html", _n.FORMAT_HTML, "HTML"
 
@@ -241,12 +413,14 @@ class BBoxesAutoCursor(_CursorBase):
         fmt = _n._str(lib.bboxes_detect(self._buf, len(self._buf)))
         # Formulas exist only for the spreadsheet formats; asking for them
         # elsewhere would add a permanently-None column.
-        self._include_formula = fmt in ("xlsx", "xls")
+        self._include_formula = fmt in ("xlsx", "xls", "xlsb", "ods", "ooxml-encrypted")
         self._cur = lib.bboxes_open(self._buf, len(self._buf))
         if not self._cur:
             raise Error("failed to parse document")
         code = {
             "pdf": _n.FORMAT_PDF, "xlsx": _n.FORMAT_XLSX, "xls": _n.FORMAT_XLS,
-            "text": _n.FORMAT_TEXT, "docx": _n.FORMAT_DOCX, "html": _n.FORMAT_HTML,
+            "xlsb": _n.FORMAT_XLSB, "ods": _n.FORMAT_ODS, "ooxml-encrypted": _n.FORMAT_XLSX_FAST,
+            "text": _n.FORMAT_TEXT, "docx": _n.FORMAT_DOCX, "doc": _n.FORMAT_DOC,
+            "html": _n.FORMAT_HTML,
         }.get(fmt or "", _n.FORMAT_AUTO)
         self._int_coords = bool(lib.bboxes_format_int_coords(code))
@@ -21,15 +21,17 @@ from __future__ import annotations
 
 import ctypes
 import pathlib
-from ctypes import POINTER, c_char_p, c_double, c_int, c_size_t, c_uint32, c_void_p
+from ctypes import (POINTER, c_char_p, c_double, c_int, c_int64, c_size_t, c_ubyte, c_uint32,
+                    c_uint64, c_void_p)
 
 import blobzig
 
 __all__ = [
     "lib", "Error", "library_path", "duckdb_extension_path",
-    "sqlite_extension_path", "Doc", "Page", "Font", "Style", "BBox",
+    "sqlite_extension_path", "Doc", "Page", "Font", "Style", "BBox", "Run",
     "FORMAT_AUTO", "FORMAT_PDF", "FORMAT_XLSX", "FORMAT_TEXT", "FORMAT_DOCX",
     "FORMAT_PDF_OBJECTS", "FORMAT_XLSX_FAST", "FORMAT_HTML", "FORMAT_XLS",
+    "FORMAT_DOC", "FORMAT_XLSB", "FORMAT_ODS", "OPEN_RULES", "OPEN_RICH_RUNS",
 ]
 
 _PKG = pathlib.Path(__file__).resolve().parent
@@ -65,6 +67,13 @@ FORMAT_PDF_OBJECTS = 5
 FORMAT_XLSX_FAST = 6
 FORMAT_HTML = 7
 FORMAT_XLS = 8
+FORMAT_DOC = 9
+FORMAT_XLSB = 10
+FORMAT_ODS = 11
+
+# Open flags for the *_ex openers (BBOXES_OPEN_*).
+OPEN_RULES = 0x1
+OPEN_RICH_RUNS = 0x2
 
 
 # ── struct layouts, mirroring include/bboxes.h ───────────────────────
@@ -123,11 +132,58 @@ class BBox(ctypes.Structure):
         ("vnum", c_double),
         ("has_vbool", c_int),
         ("vbool", c_int),
+        ("has_vdate", c_int),
+        ("vdate", c_int64),
         ("text", c_char_p),
         ("formula", c_char_p),
     ]
 
 
+class Run(ctypes.Structure):
+    _fields_ = [
+        ("page_id", c_uint32),
+        ("x", c_uint32),
+        ("y", c_uint32),
+        ("start", c_uint32),
+        ("length", c_uint32),
+        ("run_style_id", c_uint32),
+        ("font", c_char_p),
+        ("font_size", c_double),
+        ("color", c_char_p),
+        ("weight", c_char_p),
+        ("italic", c_int),
+        ("underline", c_int),
+    ]
+
+
+class Rule(ctypes.Structure):
+    _fields_ = [
+        ("page_id", c_uint32),
+        ("kind", c_char_p),
+        ("x", c_double),
+        ("y", c_double),
+        ("w", c_double),
+        ("h", c_double),
+        ("line_width", c_double),
+        ("color", c_char_p),
+    ]
+
+
+class Line(ctypes.Structure):
+    _fields_ = [
+        ("page_id", c_uint32),
+        ("line_id", c_uint32),
+        ("column_id", c_uint32),
+        ("x", c_double),
+        ("y", c_double),
+        ("w", c_double),
+        ("h", c_double),
+        ("text", c_char_p),
+        ("bbox_indices", POINTER(c_uint32)),
+        ("bbox_count", c_uint32),
+    ]
+
+
 # ── prototypes ───────────────────────────────────────────────────────
 
 _P = c_void_p   # bboxes_cursor*
@@ -156,17 +212,31 @@ for _n in ("bboxes_pdf_init", "bboxes_pdf_destroy",
     _proto(_n, [], None)
 
 # Openers. PDF and the spreadsheet readers take a password and a 1-based
-# inclusive page range; the flow formats take neither.
+# inclusive page range (ods the range only); the flow formats take neither.
 for _n in ("bboxes_open_pdf", "bboxes_open_pdf_objects",
-           "bboxes_open_xlsx", "bboxes_open_xlsx_fast", "bboxes_open_xls"):
+           "bboxes_open_xlsx", "bboxes_open_xlsx_fast", "bboxes_open_xlsx_artifact",
+           "bboxes_open_xls", "bboxes_open_xlsb"):
     _proto(_n, [_B, c_size_t, _S, c_int, c_int], _P)
+_proto("bboxes_open_ods", [_B, c_size_t, c_int, c_int], _P)
 
-for _n in ("bboxes_open", "bboxes_open_text", "bboxes_open_docx", "bboxes_open_html"):
+for _n in ("bboxes_open", "bboxes_open_text", "bboxes_open_docx", "bboxes_open_doc",
+           "bboxes_open_html"):
     _proto(_n, [_B, c_size_t], _P)
 
 _proto("bboxes_open_format", [c_int, _B, c_size_t], _P)
+_proto("bboxes_open_format_file", [c_int, _S, c_int, c_int], _P)
+for _n in ("bboxes_open_pdf_file", "bboxes_open_pdf_objects_file"):
+    _proto(_n, [_S, _S, c_int, c_int], _P)
+for _n in ("bboxes_open_pdf_ex", "bboxes_open_pdf_objects_ex",
+           "bboxes_open_xlsx_fast_ex", "bboxes_open_xlsx_artifact_ex"):
+    _proto(_n, [_B, c_size_t, _S, c_int, c_int, c_int], _P)
+for _n in ("bboxes_open_pdf_file_ex", "bboxes_open_pdf_objects_file_ex"):
+    _proto(_n, [_S, _S, c_int, c_int, c_int], _P)
 _proto("bboxes_close", [_P], None)
 _proto("bboxes_detect", [_B, c_size_t], _S)          # borrowed static string
+_proto("bboxes_probe", [_B, c_size_t], _S)           # thread-local, copy at once
+_proto("bboxes_probe_file", [_S], _S)
+_proto("bboxes_file_checksum", [_S], _S)             # thread-local; NULL if unreadable
 _proto("bboxes_errmsg", [_P], _S)                    # borrowed
 _proto("bboxes_format_int_coords", [c_int], c_int)
 
@@ -176,16 +246,43 @@ _proto("bboxes_next_page", [_P], POINTER(Page))
 _proto("bboxes_next_font", [_P], POINTER(Font))
 _proto("bboxes_next_style", [_P], POINTER(Style))
 _proto("bboxes_next_bbox", [_P], POINTER(BBox))
+_proto("bboxes_next_run", [_P], POINTER(Run))
+_proto("bboxes_next_rule", [_P], POINTER(Rule))
+_proto("bboxes_next_line", [_P], POINTER(Line))
+
+# Spatial queries write a cursor-owned index array through the out-pointer.
+_proto("bboxes_query_rect", [_P, c_uint32, c_double, c_double, c_double, c_double,
+                             POINTER(POINTER(c_uint32))], c_size_t)
+_proto("bboxes_query_nearest", [_P, c_uint32, c_double, c_double, c_size_t,
+                                POINTER(POINTER(c_uint32))], c_size_t)
+_proto("bboxes_get_bbox", [_P, c_uint32, c_uint32], POINTER(BBox))
 
 # JSON accessors returning into a thread-local buffer, valid only until the next
 # call on the same thread (see the header). Copied immediately by _str.
 for _n in ("bboxes_get_doc_json", "bboxes_get_pages_json", "bboxes_get_fonts_json",
            "bboxes_get_styles_json", "bboxes_get_bboxes_json",
-           "bboxes_get_sheet_meta_json"):
+           "bboxes_get_sheet_meta_json", "bboxes_get_header_json",
+           "bboxes_get_runs_json", "bboxes_get_rules_json", "bboxes_get_lines_json"):
     _proto(_n, [_P], _S)
 
 _proto("bboxes_xfdf_from_json", [_S], _S)
 
+# Process-wide font/style dictionary (snapshots are thread-local buffers too).
+_proto("bboxes_attach_global_dict", [_P], c_int)
+_proto("bboxes_global_dict_auto", [c_int], None)
+_proto("bboxes_global_dict_reset", [], None)
+for _n in ("bboxes_global_fonts_json", "bboxes_global_styles_json"):
+    _proto(_n, [], _S)
+
+# Page raster: a buffer per call, copied out and handed back to render_free.
+_proto("bboxes_pdf_render_page",
+       [_B, c_size_t, _S, _S, c_int, c_double, c_int,
+        POINTER(c_int), POINTER(c_int), POINTER(c_size_t)], POINTER(c_ubyte))
+_proto("bboxes_pdf_render_free", [POINTER(c_ubyte)], None)
+_proto("bboxes_pdf_render_cache", [_S, c_uint64], None)
+RENDER_PNG = 0
+RENDER_RGBA = 1
+
 # Buffer-and-path metadata pairs. Each JSON extractor has a _file twin.
 for _base in ("bboxes_pdf_metadata_json", "bboxes_pdf_header_json",
               "bboxes_xlsx_metadata_json", "bboxes_xlsx_header_json",
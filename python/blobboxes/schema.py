@@ -15,7 +15,7 @@ class Doc(BaseModel):
     document_id: int
     source_type: str
     filename: Optional[str]
-    checksum: str              # MD5 hex of source bytes
+    checksum: str              # SHA-256 hex of source bytes
     page_count: int
 
 
@@ -2,6 +2,7 @@
 SQLITE_EXTENSION_INIT1
 
 #include "bboxes.h"
+#include "bboxes_types.h"   /* bboxes_unix_us_iso, the vdate text the JSON accessors emit */
 #include <cstdio>
 #include <cstring>
 #include <string>
@@ -116,19 +117,21 @@ static int Name##Filter(sqlite3_vtab_cursor* pCursor, int, const char*,
     if (c->cur) { bboxes_close(c->cur); c->cur = nullptr; }                             \
     if (argc < 1) { c->eof = true; return SQLITE_OK; }                                  \
     /* accept a path (TEXT) OR the bytes in hand (BLOB) — dynamic typing lets one       \
-       function serve both; the readers are byte-based either way. */                   \
+       function serve both. A path goes to the library unread, so a PDF is pulled      \
+       through PDFium's block reader instead of being buffered here. */                \
+    c->buf.clear();                                                                     \
     if (sqlite3_value_type(argv[0]) == SQLITE_BLOB) {                                    \
         const void* blob = sqlite3_value_blob(argv[0]);                                  \
         int n = sqlite3_value_bytes(argv[0]);                                            \
         if (blob && n > 0)                                                               \
             c->buf.assign(static_cast<const char*>(blob),                               \
                           static_cast<const char*>(blob) + n);                          \
+        if (c->buf.empty()) { c->eof = true; return SQLITE_OK; }                        \
+        c->cur = bboxes_open_format(fmt, c->buf.data(), c->buf.size());                 \
     } else {                                                                            \
         const char* path = reinterpret_cast<const char*>(sqlite3_value_text(argv[0]));   \
-        if (path) c->buf = read_file(path);                                             \
+        if (path) c->cur = bboxes_open_format_file(fmt, path, 0, 0);                    \
     }                                                                                   \
-    if (c->buf.empty()) { c->eof = true; return SQLITE_OK; }                            \
-    c->cur = bboxes_open_format(fmt, c->buf.data(), c->buf.size());                         \
     if (!c->cur) { c->eof = true; return SQLITE_OK; }                                   \
     c->current = next_fn(c->cur);                                                       \
     c->eof = (c->current == nullptr);                                                   \
@@ -277,8 +280,9 @@ static int StylesColumn(sqlite3_vtab_cursor* pCursor, sqlite3_context* ctx, int
    affinity here would coerce the integer results back to float. */
 DEFINE_VTAB(Bboxes,
     "CREATE TABLE x(page_id INTEGER, style_id INTEGER, "
-    "x, y, w, h, cell_type TEXT, vnum, vbool, text TEXT, formula TEXT, file_path TEXT HIDDEN)",
-    BboxesCursor, bboxes_bbox, bboxes_next_bbox, 11, 1000.0)
+    "x, y, w, h, cell_type TEXT, vnum, vbool, vdate TEXT, text TEXT, formula TEXT, "
+    "file_path TEXT HIDDEN)",
+    BboxesCursor, bboxes_bbox, bboxes_next_bbox, 12, 1000.0)
 
 static int BboxesColumn(sqlite3_vtab_cursor* pCursor, sqlite3_context* ctx, int col) {
     auto* b = static_cast<BboxesCursor*>(pCursor)->current;
@@ -296,8 +300,11 @@ static int BboxesColumn(sqlite3_vtab_cursor* pCursor, sqlite3_context* ctx, int
         case 6: sqlite3_result_text(ctx, b->cell_type, -1, SQLITE_TRANSIENT); break;
         case 7: if (b->has_vnum)  sqlite3_result_double(ctx, b->vnum); else sqlite3_result_null(ctx); break;
         case 8: if (b->has_vbool) sqlite3_result_int(ctx, b->vbool);    else sqlite3_result_null(ctx); break;
-        case 9: sqlite3_result_text(ctx, b->text, -1, SQLITE_TRANSIENT); break;
-        case 10: if (b->formula) sqlite3_result_text(ctx, b->formula, -1, SQLITE_TRANSIENT);
+        /* ISO-8601, which SQLite's date functions read natively */
+        case 9: if (b->has_vdate) sqlite3_result_text(ctx, bboxes_unix_us_iso(b->vdate).c_str(), -1, SQLITE_TRANSIENT);
+                else sqlite3_result_null(ctx); break;
+        case 10: sqlite3_result_text(ctx, b->text, -1, SQLITE_TRANSIENT); break;
+        case 11: if (b->formula) sqlite3_result_text(ctx, b->formula, -1, SQLITE_TRANSIENT);
                  else sqlite3_result_null(ctx); break;
         default: sqlite3_result_null(ctx); break;
     }
@@ -390,6 +397,7 @@ static MetaDesc s_xlsx_sheet_desc    = { bboxes_xlsx_sheet_meta_json_file,    bb
 static MetaDesc s_xlsx_header_desc   = { bboxes_xlsx_header_json_file,        bboxes_xlsx_header_json };
 static MetaDesc s_pdf_header_desc    = { bboxes_pdf_header_json_file,         bboxes_pdf_header_json };
 static MetaDesc s_container_desc     = { bboxes_container_walk_json_file, bboxes_container_walk_json };
+static MetaDesc s_probe_desc         = { bboxes_probe_file,               bboxes_probe };
 static MetaDesc s_vba_b64_desc       = { bboxes_xlsx_vba_base64_file,     bboxes_xlsx_vba_base64 };
 static MetaDesc s_xfdf_desc          = { bboxes_xfdf_from_json,           nullptr };  /* text in */
 
@@ -494,6 +502,7 @@ int sqlite3_bboxes_init(sqlite3* db, char** pzErrMsg,
         { "xlsx_sheet_meta",   &s_xlsx_sheet_desc },
         { "xlsx_header",       &s_xlsx_header_desc },
         { "pdf_header",        &s_pdf_header_desc },
+        { "bb_probe",        &s_probe_desc },      /* pre-flight: headers only */
         { "container_walk",  &s_container_desc },
         { "xlsx_vba_base64", &s_vba_b64_desc },
         { "xfdf",            &s_xfdf_desc },      /* JSON annots -> XFDF (text only) */
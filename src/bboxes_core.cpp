@@ -1,11 +1,20 @@
 #include "bboxes.h"
 #include "bboxes_types.h"
+#include "bboxes_dict.h"
+#include "bboxes_spatial.h"
+#include "bboxes_xlsx_pkg.h"
+#include "bboxes_cfb.h"
 
 #include <nlohmann/json.hpp>
 #include "sha256.h"
 
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <memory>
 #include <string>
 #include <string_view>
+#include <vector>
 
 static thread_local std::string g_errmsg;
 
@@ -15,6 +24,7 @@ using json = nlohmann::json;
 
 struct bboxes_cursor {
     BBoxResult result;
+    bool       global_ids = false;   /* font/style ids rewritten to GlobalDict */
 
     /* doc (single row) */
     bboxes_doc  doc_view;
@@ -42,12 +52,39 @@ struct bboxes_cursor {
     bboxes_bbox bbox_view;
     std::string bbox_json;
 
+    /* rich-text run iterator (flat across all pages) */
+    size_t      run_page;
+    size_t      run_within;
+    bboxes_run  run_view;
+
+    /* ruling-line iterator (flat across all pages) */
+    size_t      rule_page;
+    size_t      rule_within;
+    bboxes_rule rule_view;
+    std::string rule_color;
+
+    /* spatial queries: one index per page, built on first query */
+    std::vector<std::unique_ptr<SpatialIndex>> spatial;
+    std::vector<uint32_t> query_hits;
+    bboxes_bbox           query_view;
+
+    /* reading-order lines: layout pass run once, on the first line call */
+    bool        lines_built = false;
+    std::vector<std::vector<TextLine>> lines;   /* per result.pages slot */
+    size_t      line_page;
+    size_t      line_within;
+    bboxes_line line_view;
+
     /* array-level JSON (lazy-cached, built once on first call) */
     std::string pages_array_json;
     std::string fonts_array_json;
     std::string styles_array_json;
     std::string bboxes_array_json;
     std::string sheet_meta_json;
+    std::string runs_array_json;
+    std::string rules_array_json;
+    std::string lines_array_json;
+    std::string header_json;      /* set at open by bboxes_open_xlsx_artifact */
 };
 
 /* ── per-type JSON helpers ──────────────────────────────────────────── */
@@ -86,7 +123,9 @@ static json style_to_json(const StyleTable::Entry& e) {
 extern "C" int bboxes_format_int_coords(int fmt) {
     return fmt == BBOXES_FORMAT_XLSX || fmt == BBOXES_FORMAT_XLSX_FAST
         || fmt == BBOXES_FORMAT_TEXT || fmt == BBOXES_FORMAT_DOCX
-        || fmt == BBOXES_FORMAT_HTML || fmt == BBOXES_FORMAT_XLS;
+        || fmt == BBOXES_FORMAT_HTML || fmt == BBOXES_FORMAT_XLS
+        || fmt == BBOXES_FORMAT_DOC || fmt == BBOXES_FORMAT_XLSB
+        || fmt == BBOXES_FORMAT_ODS;
 }
 
 /* The JSON builder only carries the source_type string; route it through the
@@ -97,6 +136,9 @@ static bool source_int_coords(const std::string& source_type) {
     if (source_type == "docx") return bboxes_format_int_coords(BBOXES_FORMAT_DOCX);
     if (source_type == "html") return bboxes_format_int_coords(BBOXES_FORMAT_HTML);
     if (source_type == "xls")  return bboxes_format_int_coords(BBOXES_FORMAT_XLS);
+    if (source_type == "doc")  return bboxes_format_int_coords(BBOXES_FORMAT_DOC);
+    if (source_type == "xlsb") return bboxes_format_int_coords(BBOXES_FORMAT_XLSB);
+    if (source_type == "ods")  return bboxes_format_int_coords(BBOXES_FORMAT_ODS);
     return bboxes_format_int_coords(BBOXES_FORMAT_PDF);
 }
 
@@ -119,20 +161,49 @@ static json bbox_to_json(const BBox& b, const std::string& source_type) {
     obj["cell_type"] = bbox_cell_type_name(b.cell_type);
     obj["vnum"]  = (b.cell_type == BBOX_NUMBER) ? json(b.vnum)  : json(nullptr);
     obj["vbool"] = (b.cell_type == BBOX_BOOL)   ? json(b.vbool) : json(nullptr);
+    obj["vdate"] = b.has_vdate ? json(bboxes_unix_us_iso(b.vdate)) : json(nullptr);
     obj["text"] = b.text;
-    if (source_type == "xlsx")
+    if (source_type == "xlsx" || source_type == "xlsb" || source_type == "ods")
         obj["formula"] = b.formula.empty() ? json(nullptr) : json(b.formula);
     return obj;
 }
 
+/* ── global font/style dictionary ──────────────────────────────────── */
+
+static std::atomic<bool> g_dict_auto{false};
+
+/* Rewrite a result's font/style ids to the process-wide dictionary: each
+   distinct local entry is interned once, then bbox style_ids are remapped
+   through the small local→global table. Table entries keep their positions;
+   only their ids (and a style's font_id) change. Rich-text run styles stay
+   cursor-local — runs resolve their font through run_fonts. Sources
+   whose style_id is not a StyleTable index (xlsx_fast: the cellXfs `s`) have
+   an empty table and are left alone. */
+static void attach_global(BBoxResult& r) {
+    GlobalDict& d = GlobalDict::instance();
+    std::vector<uint32_t> font_map(r.fonts.entries.size());
+    for (size_t i = 0; i < font_map.size(); ++i) {
+        font_map[i] = d.font(r.fonts.entries[i].name);
+        r.fonts.entries[i].id = font_map[i];
+    }
+    std::vector<uint32_t> style_map(r.styles.entries.size());
+    for (size_t i = 0; i < style_map.size(); ++i) {
+        auto& e = r.styles.entries[i];
+        uint32_t font_id = e.font_id < font_map.size() ? font_map[e.font_id] : e.font_id;
+        style_map[i] = d.style({font_id, e.font_size, e.color, e.weight, e.italic, e.underline});
+        e.id = style_map[i];
+        e.font_id = font_id;
+    }
+    if (style_map.empty()) return;
+    for (auto& page : r.pages)
+        for (auto& b : page.bboxes)
+            if (b.style_id < style_map.size()) b.style_id = style_map[b.style_id];
+}
+
 /* ── helper: wrap a BBoxResult into a cursor ───────────────────────── */
 
-static bboxes_cursor* wrap_result(BBoxResult r, const void* buf, size_t len) {
+static bboxes_cursor* wrap_result(BBoxResult r) {
     if (r.page_count < 0) return nullptr;
-    {
-        SHA256 sha256;
-        r.checksum = sha256(buf, len);
-    }
     auto* c = new bboxes_cursor{};
     c->result       = std::move(r);
     c->doc_returned = false;
@@ -141,9 +212,28 @@ static bboxes_cursor* wrap_result(BBoxResult r, const void* buf, size_t len) {
     c->style_index  = 0;
     c->bbox_page    = 0;
     c->bbox_within  = 0;
+    c->run_page     = 0;
+    c->run_within   = 0;
+    c->rule_page    = 0;
+    c->rule_within  = 0;
+    c->line_page    = 0;
+    c->line_within  = 0;
+    if (g_dict_auto.load(std::memory_order_relaxed)) {
+        attach_global(c->result);
+        c->global_ids = true;
+    }
     return c;
 }
 
+static bboxes_cursor* wrap_result(BBoxResult r, const void* buf, size_t len) {
+    if (r.page_count < 0) return nullptr;
+    {
+        SHA256 sha256;
+        r.checksum = sha256(buf, len);
+    }
+    return wrap_result(std::move(r));
+}
+
 /* ── format detection ──────────────────────────────────────────────── */
 
 namespace {
@@ -198,8 +288,14 @@ const char* bboxes_detect(const void* buf, size_t len) {
     if (len >= 4 && p[0] == '%' && p[1] == 'P' && p[2] == 'D' && p[3] == 'F')
         return "pdf";
     if (len >= 4 && p[0] == 'P' && p[1] == 'K' && p[2] == 3 && p[3] == 4) {
-        /* ZIP archive — scan first 4KB for xl/ or word/ to distinguish */
+        /* ZIP archive — scan first 4KB for xl/ or word/ to distinguish. An
+           xlsb has xl/ parts too, so its workbook part is looked for first:
+           Excel writes it near the front, behind the content types. */
         size_t scan = len < 4096 ? len : 4096;
+        /* ODF stores its mimetype member first and uncompressed, so the media
+           type sits in the clear right behind the first local header. */
+        if (memmem(p, scan < 256 ? scan : 256, "application/vnd.oasis.opendocument.spreadsheet", 46)) return "ods";
+        if (memmem(p, scan, "xl/workbook.bin", 15)) return "xlsb";
         for (size_t i = 0; i + 3 < scan; i++) {
             if (p[i] == 'x' && p[i+1] == 'l' && p[i+2] == '/') return "xlsx";
             if (i + 4 < scan && p[i] == 'w' && p[i+1] == 'o' &&
@@ -208,8 +304,17 @@ const char* bboxes_detect(const void* buf, size_t len) {
         return "xlsx"; /* default ZIP → xlsx */
     }
     if (len >= 8 && p[0]==0xD0 && p[1]==0xCF && p[2]==0x11 && p[3]==0xE0 &&
-        p[4]==0xA1 && p[5]==0xB1 && p[6]==0x1A && p[7]==0xE1)
-        return "xls";   /* OLE2/CFB compound file — legacy .xls */
+        p[4]==0xA1 && p[5]==0xB1 && p[6]==0x1A && p[7]==0xE1) {
+        /* OLE2/CFB compound file: the directory says which payload. A buffer
+           too short to reach it (a sniffed head) stays "xls", as before. An
+           EncryptedPackage is password-protected OOXML: whether xlsx, xlsb or
+           docx is inside cannot be told without the key, so it is a kind of
+           its own, and the fast xlsx reader re-detects after decrypting. */
+        CfbPackage cfb;
+        if (cfb.open(buf, len) && cfb.entry("WordDocument")) return "doc";
+        if (cfb.entry("EncryptedPackage")) return "ooxml-encrypted";
+        return "xls";
+    }
 
     /* HTML has no magic number, so this is a sniff rather than a signature and
        is deliberately conservative: only a document that *opens* with an HTML
@@ -240,8 +345,14 @@ bboxes_cursor* bboxes_open(const void* buf, size_t len) {
         if (bboxes_cursor* c = bboxes_open_xlsx(buf, len, nullptr, 0, 0)) return c;
         return bboxes_open_xlsx_fast(buf, len, nullptr, 0, 0);
     }
+    if (fmt == "xlsb") return bboxes_open_xlsb(buf, len, nullptr, 0, 0);
+    /* xlnt cannot decrypt; the fast reader tries the default password and
+       hands a decrypted xlsb to the xlsb reader. */
+    if (fmt == "ooxml-encrypted") return bboxes_open_xlsx_fast(buf, len, nullptr, 0, 0);
+    if (fmt == "ods")  return bboxes_open_ods(buf, len, 0, 0);
     if (fmt == "docx") return bboxes_open_docx(buf, len);
     if (fmt == "xls")  return bboxes_open_xls(buf, len, nullptr, 0, 0);
+    if (fmt == "doc")  return bboxes_open_doc(buf, len);
     if (fmt == "html") {
         /* Fall back to the text reader if the DOM walk yields nothing, on the
            same reasoning as xlsx above: auto-detect should degrade to the
@@ -265,22 +376,131 @@ bboxes_cursor* bboxes_open_format(int fmt, const void* buf, size_t len) {
         case BBOXES_FORMAT_DOCX:        return bboxes_open_docx(buf, len);
         case BBOXES_FORMAT_HTML:        return bboxes_open_html(buf, len);
         case BBOXES_FORMAT_XLS:         return bboxes_open_xls(buf, len, nullptr, 0, 0);
+        case BBOXES_FORMAT_DOC:         return bboxes_open_doc(buf, len);
+        case BBOXES_FORMAT_XLSB:        return bboxes_open_xlsb(buf, len, nullptr, 0, 0);
+        case BBOXES_FORMAT_ODS:         return bboxes_open_ods(buf, len, 0, 0);
         default:                        return bboxes_open(buf, len);
     }
 }
 
+bboxes_cursor* bboxes_open_format_file(int fmt, const char* path,
+                                       int start_page, int end_page) {
+    if (!path) return nullptr;
+    FILE* f = std::fopen(path, "rb");
+    if (!f) return nullptr;
+    if (fmt == BBOXES_FORMAT_AUTO) {
+        char magic[4] = {};
+        size_t got = std::fread(magic, 1, sizeof(magic), f);
+        if (got == 4 && std::memcmp(magic, "%PDF", 4) == 0) fmt = BBOXES_FORMAT_PDF;
+    }
+    if (fmt == BBOXES_FORMAT_PDF || fmt == BBOXES_FORMAT_PDF_OBJECTS) {
+        std::fclose(f);
+        return fmt == BBOXES_FORMAT_PDF
+            ? bboxes_open_pdf_file(path, nullptr, start_page, end_page)
+            : bboxes_open_pdf_objects_file(path, nullptr, start_page, end_page);
+    }
+
+    /* The other readers are byte-based: read the file whole. */
+    std::fseek(f, 0, SEEK_END); long sz = std::ftell(f); std::fseek(f, 0, SEEK_SET);
+    std::string buf(sz > 0 ? static_cast<size_t>(sz) : 0, '\0');
+    bool ok = sz > 0 && std::fread(&buf[0], 1, buf.size(), f) == buf.size();
+    std::fclose(f);
+    if (!ok) return nullptr;
+    if (fmt == BBOXES_FORMAT_AUTO && (start_page || end_page)) {
+        /* Resolve to the reader bboxes_open would pick, so the range reaches it. */
+        std::string_view d = bboxes_detect(buf.data(), buf.size());
+        if (d == "pdf") return bboxes_open_pdf(buf.data(), buf.size(), nullptr, start_page, end_page);
+        if (d == "xlsx") {
+            if (bboxes_cursor* c = bboxes_open_xlsx(buf.data(), buf.size(), nullptr, start_page, end_page))
+                return c;
+            fmt = BBOXES_FORMAT_XLSX_FAST;
+        }
+        else if (d == "ooxml-encrypted") fmt = BBOXES_FORMAT_XLSX_FAST;
+        else if (d == "xlsb") fmt = BBOXES_FORMAT_XLSB;
+        else if (d == "xls")  fmt = BBOXES_FORMAT_XLS;
+        else if (d == "ods")  fmt = BBOXES_FORMAT_ODS;
+    }
+    switch (fmt) {
+        case BBOXES_FORMAT_XLSX:      return bboxes_open_xlsx(buf.data(), buf.size(), nullptr, start_page, end_page);
+        case BBOXES_FORMAT_XLSX_FAST: return bboxes_open_xlsx_fast(buf.data(), buf.size(), nullptr, start_page, end_page);
+        case BBOXES_FORMAT_XLS:       return bboxes_open_xls(buf.data(), buf.size(), nullptr, start_page, end_page);
+        case BBOXES_FORMAT_XLSB:      return bboxes_open_xlsb(buf.data(), buf.size(), nullptr, start_page, end_page);
+        case BBOXES_FORMAT_ODS:       return bboxes_open_ods(buf.data(), buf.size(), start_page, end_page);
+        default:
+            /* The flow formats have no pages to range over: refuse a range
+               rather than silently return the whole document. */
+            if (start_page || end_page) return nullptr;
+            return bboxes_open_format(fmt, buf.data(), buf.size());
+    }
+}
+
 /* ── open (PDF backend) ─────────────────────────────────────────────── */
 
 bboxes_cursor* bboxes_open_pdf(const void* buf, size_t len,
                                 const char* password,
                                 int start_page, int end_page) {
-    return wrap_result(extract_pdf(buf, len, password, start_page, end_page), buf, len);
+    return bboxes_open_pdf_ex(buf, len, password, start_page, end_page, 0);
 }
 
 bboxes_cursor* bboxes_open_pdf_objects(const void* buf, size_t len,
                                         const char* password,
                                         int start_page, int end_page) {
-    return wrap_result(extract_pdf_objects(buf, len, password, start_page, end_page), buf, len);
+    return bboxes_open_pdf_objects_ex(buf, len, password, start_page, end_page, 0);
+}
+
+bboxes_cursor* bboxes_open_pdf_ex(const void* buf, size_t len, const char* password,
+                                   int start_page, int end_page, int flags) {
+    return wrap_result(extract_pdf(buf, len, password, start_page, end_page,
+                                   flags & BBOXES_OPEN_RULES), buf, len);
+}
+
+bboxes_cursor* bboxes_open_pdf_objects_ex(const void* buf, size_t len, const char* password,
+                                           int start_page, int end_page, int flags) {
+    return wrap_result(extract_pdf_objects(buf, len, password, start_page, end_page,
+                                           flags & BBOXES_OPEN_RULES), buf, len);
+}
+
+/* File-backed: no checksum, since hashing would read the whole file (see
+   bboxes.h; bboxes_file_checksum is the explicit way to pay for it). */
+bboxes_cursor* bboxes_open_pdf_file(const char* path, const char* password,
+                                     int start_page, int end_page) {
+    return bboxes_open_pdf_file_ex(path, password, start_page, end_page, 0);
+}
+
+bboxes_cursor* bboxes_open_pdf_objects_file(const char* path, const char* password,
+                                             int start_page, int end_page) {
+    return bboxes_open_pdf_objects_file_ex(path, password, start_page, end_page, 0);
+}
+
+bboxes_cursor* bboxes_open_pdf_file_ex(const char* path, const char* password,
+                                        int start_page, int end_page, int flags) {
+    if (!path) return nullptr;
+    return wrap_result(extract_pdf_file(path, password, start_page, end_page, false,
+                                        flags & BBOXES_OPEN_RULES));
+}
+
+bboxes_cursor* bboxes_open_pdf_objects_file_ex(const char* path, const char* password,
+                                                int start_page, int end_page, int flags) {
+    if (!path) return nullptr;
+    return wrap_result(extract_pdf_file(path, password, start_page, end_page, true,
+                                        flags & BBOXES_OPEN_RULES));
+}
+
+/* Streamed in 1 MiB chunks through the incremental SHA256, so the file is never
+   held whole. */
+const char* bboxes_file_checksum(const char* path) {
+    static thread_local std::string out;
+    FILE* f = path ? std::fopen(path, "rb") : nullptr;
+    if (!f) return nullptr;
+    SHA256 sha256;
+    std::vector<char> chunk(1 << 20);
+    size_t n;
+    while ((n = std::fread(chunk.data(), 1, chunk.size(), f)) > 0) sha256.add(chunk.data(), n);
+    bool ok = !std::ferror(f);
+    std::fclose(f);
+    if (!ok) return nullptr;
+    out = sha256.getHash();
+    return out.c_str();
 }
 
 /* ── open (XLSX backend) ────────────────────────────────────────────── */
@@ -294,7 +514,26 @@ bboxes_cursor* bboxes_open_xlsx(const void* buf, size_t len,
 bboxes_cursor* bboxes_open_xlsx_fast(const void* buf, size_t len,
                                      const char* password,
                                      int start_page, int end_page) {
-    return wrap_result(extract_xlsx_fast(buf, len, password, start_page, end_page), buf, len);
+    return bboxes_open_xlsx_fast_ex(buf, len, password, start_page, end_page, 0);
+}
+bboxes_cursor* bboxes_open_xlsx_artifact(const void* buf, size_t len,
+                                         const char* password,
+                                         int start_page, int end_page) {
+    return bboxes_open_xlsx_artifact_ex(buf, len, password, start_page, end_page, 0);
+}
+bboxes_cursor* bboxes_open_xlsx_fast_ex(const void* buf, size_t len, const char* password,
+                                        int start_page, int end_page, int flags) {
+    return wrap_result(extract_xlsx_fast(buf, len, password, start_page, end_page,
+                                         flags & BBOXES_OPEN_RICH_RUNS), buf, len);
+}
+bboxes_cursor* bboxes_open_xlsx_artifact_ex(const void* buf, size_t len, const char* password,
+                                            int start_page, int end_page, int flags) {
+    XlsxPackage pkg;
+    if (!pkg.open_mem(buf, len, password)) return nullptr;
+    bboxes_cursor* c = wrap_result(extract_xlsx_fast(pkg, start_page, end_page,
+                                                     flags & BBOXES_OPEN_RICH_RUNS), buf, len);
+    if (c) c->header_json = bboxes_xlsx_header_from_pkg(pkg, c->result.checksum);  /* reuses sha */
+    return c;
 }
 #else
 void bboxes_xlsx_init(void) {}
@@ -305,6 +544,15 @@ bboxes_cursor* bboxes_open_xlsx(const void*, size_t, const char*, int, int) {
 bboxes_cursor* bboxes_open_xlsx_fast(const void*, size_t, const char*, int, int) {
     return nullptr;
 }
+bboxes_cursor* bboxes_open_xlsx_artifact(const void*, size_t, const char*, int, int) {
+    return nullptr;
+}
+bboxes_cursor* bboxes_open_xlsx_fast_ex(const void*, size_t, const char*, int, int, int) {
+    return nullptr;
+}
+bboxes_cursor* bboxes_open_xlsx_artifact_ex(const void*, size_t, const char*, int, int, int) {
+    return nullptr;
+}
 #endif
 
 /* ── open (XLS backend) ─────────────────────────────────────────────── */
@@ -318,6 +566,27 @@ bboxes_cursor* bboxes_open_xls(const void* buf, size_t len, const char* password
 bboxes_cursor* bboxes_open_xls(const void*, size_t, const char*, int, int) { return nullptr; }
 #endif
 
+/* ── open (XLSB backend) ────────────────────────────────────────────── */
+
+#ifdef BBOXES_HAS_XLSB
+bboxes_cursor* bboxes_open_xlsb(const void* buf, size_t len, const char* password,
+                                int start_page, int end_page) {
+    return wrap_result(extract_xlsb(buf, len, password, start_page, end_page), buf, len);
+}
+#else
+bboxes_cursor* bboxes_open_xlsb(const void*, size_t, const char*, int, int) { return nullptr; }
+#endif
+
+/* ── open (ODS backend) ─────────────────────────────────────────────── */
+
+#ifdef BBOXES_HAS_ODS
+bboxes_cursor* bboxes_open_ods(const void* buf, size_t len, int start_page, int end_page) {
+    return wrap_result(extract_ods(buf, len, start_page, end_page), buf, len);
+}
+#else
+bboxes_cursor* bboxes_open_ods(const void*, size_t, int, int) { return nullptr; }
+#endif
+
 /* ── open (text backend) ────────────────────────────────────────────── */
 
 #ifdef BBOXES_HAS_TEXT
@@ -338,6 +607,16 @@ bboxes_cursor* bboxes_open_docx(const void* buf, size_t len) {
 bboxes_cursor* bboxes_open_docx(const void*, size_t) { return nullptr; }
 #endif
 
+/* ── open (DOC backend) ─────────────────────────────────────────────── */
+
+#ifdef BBOXES_HAS_DOC
+bboxes_cursor* bboxes_open_doc(const void* buf, size_t len) {
+    return wrap_result(extract_doc(buf, len), buf, len);
+}
+#else
+bboxes_cursor* bboxes_open_doc(const void*, size_t) { return nullptr; }
+#endif
+
 /* ── open (HTML backend) ────────────────────────────────────────────── */
 
 #ifdef BBOXES_HAS_HTML
@@ -433,27 +712,32 @@ const char* bboxes_next_style_json(bboxes_cursor* c) {
 
 /* ── bbox iterator (flat across all pages) ──────────────────────────── */
 
+static void fill_bbox_view(bboxes_bbox& v, const BBox& b, const std::string& source_type) {
+    v.page_id  = b.page_id;
+    v.style_id = b.style_id;
+    v.x = b.x;
+    v.y = b.y;
+    v.w = b.w;
+    v.h = b.h;
+    v.cell_type = bbox_cell_type_name(b.cell_type);
+    v.has_vnum  = (b.cell_type == BBOX_NUMBER);
+    v.vnum      = b.vnum;
+    v.has_vbool = (b.cell_type == BBOX_BOOL);
+    v.vbool     = b.vbool ? 1 : 0;
+    v.has_vdate = b.has_vdate ? 1 : 0;
+    v.vdate     = b.vdate;
+    v.text = b.text.c_str();
+    v.formula = ((source_type == "xlsx" || source_type == "xlsb" || source_type == "xls" || source_type == "ods")
+                 && !b.formula.empty())
+                ? b.formula.c_str() : nullptr;
+}
+
 const bboxes_bbox* bboxes_next_bbox(bboxes_cursor* c) {
     if (!c) return nullptr;
     while (c->bbox_page < c->result.pages.size()) {
         const auto& page = c->result.pages[c->bbox_page];
         if (c->bbox_within < page.bboxes.size()) {
-            const BBox& b = page.bboxes[c->bbox_within++];
-            c->bbox_view.page_id  = b.page_id;
-            c->bbox_view.style_id = b.style_id;
-            c->bbox_view.x = b.x;
-            c->bbox_view.y = b.y;
-            c->bbox_view.w = b.w;
-            c->bbox_view.h = b.h;
-            c->bbox_view.cell_type = bbox_cell_type_name(b.cell_type);
-            c->bbox_view.has_vnum  = (b.cell_type == BBOX_NUMBER);
-            c->bbox_view.vnum      = b.vnum;
-            c->bbox_view.has_vbool = (b.cell_type == BBOX_BOOL);
-            c->bbox_view.vbool     = b.vbool ? 1 : 0;
-            c->bbox_view.text = b.text.c_str();
-            c->bbox_view.formula = ((c->result.source_type == "xlsx" || c->result.source_type == "xls")
-                                    && !b.formula.empty())
-                                   ? b.formula.c_str() : nullptr;
+            fill_bbox_view(c->bbox_view, page.bboxes[c->bbox_within++], c->result.source_type);
             return &c->bbox_view;
         }
         c->bbox_page++;
@@ -547,6 +831,286 @@ const char* bboxes_get_sheet_meta_json(bboxes_cursor* c) {
     return c->sheet_meta_json.c_str();
 }
 
+/* ── rich-text run side-channel ────────────────────────────────────── */
+
+static json run_to_json(const Page& p, const TextRun& r, const BBoxResult& res) {
+    const auto& s = res.run_styles.entries[r.style_id];
+    json obj;
+    obj["page_id"]      = p.page_id;
+    obj["x"]            = r.x;
+    obj["y"]            = r.y;
+    obj["start"]        = r.start;
+    obj["length"]       = r.length;
+    obj["run_style_id"] = r.style_id;
+    obj["font"]         = res.run_fonts.entries[s.font_id].name;
+    obj["font_size"]    = s.font_size;
+    obj["color"]        = s.color;
+    obj["weight"]       = s.weight;
+    obj["italic"]       = s.italic;
+    obj["underline"]    = s.underline;
+    return obj;
+}
+
+const bboxes_run* bboxes_next_run(bboxes_cursor* c) {
+    if (!c) return nullptr;
+    while (c->run_page < c->result.pages.size()) {
+        const auto& page = c->result.pages[c->run_page];
+        if (c->run_within < page.runs.size()) {
+            const TextRun& r = page.runs[c->run_within++];
+            const auto& s = c->result.run_styles.entries[r.style_id];
+            c->run_view.page_id      = page.page_id;
+            c->run_view.x            = r.x;
+            c->run_view.y            = r.y;
+            c->run_view.start        = r.start;
+            c->run_view.length       = r.length;
+            c->run_view.run_style_id = r.style_id;
+            c->run_view.font         = c->result.run_fonts.entries[s.font_id].name.c_str();
+            c->run_view.font_size    = s.font_size;
+            c->run_view.color        = s.color.c_str();
+            c->run_view.weight       = s.weight.c_str();
+            c->run_view.italic       = s.italic ? 1 : 0;
+            c->run_view.underline    = s.underline ? 1 : 0;
+            return &c->run_view;
+        }
+        c->run_page++;
+        c->run_within = 0;
+    }
+    return nullptr;
+}
+
+const char* bboxes_get_runs_json(bboxes_cursor* c) {
+    if (!c) return nullptr;
+    if (c->runs_array_json.empty()) {
+        json arr = json::array();
+        for (const auto& page : c->result.pages)
+            for (const auto& r : page.runs)
+                arr.push_back(run_to_json(page, r, c->result));
+        c->runs_array_json = arr.dump(-1, ' ', false, json::error_handler_t::replace);
+    }
+    return c->runs_array_json.c_str();
+}
+
+/* ── ruling-line side-channel ──────────────────────────────────────── */
+
+static const char* rule_kind_name(uint8_t k) {
+    switch (k) { case RULE_HLINE: return "hline"; case RULE_VLINE: return "vline";
+                 default: return "rect"; }
+}
+
+static std::string rule_color(uint32_t rgba) {
+    return color_string(rgba >> 24, (rgba >> 16) & 0xFF, (rgba >> 8) & 0xFF, rgba & 0xFF);
+}
+
+static json rule_to_json(const Page& p, const PageRule& r) {
+    json obj;
+    obj["page_id"]    = p.page_id;
+    obj["kind"]       = rule_kind_name(r.kind);
+    obj["x"]          = r.x;
+    obj["y"]          = r.y;
+    obj["w"]          = r.w;
+    obj["h"]          = r.h;
+    obj["line_width"] = r.line_width;
+    obj["color"]      = rule_color(r.rgba);
+    return obj;
+}
+
+const bboxes_rule* bboxes_next_rule(bboxes_cursor* c) {
+    if (!c) return nullptr;
+    while (c->rule_page < c->result.pages.size()) {
+        const auto& page = c->result.pages[c->rule_page];
+        if (c->rule_within < page.rules.size()) {
+            const PageRule& r = page.rules[c->rule_within++];
+            c->rule_color            = rule_color(r.rgba);
+            c->rule_view.page_id     = page.page_id;
+            c->rule_view.kind        = rule_kind_name(r.kind);
+            c->rule_view.x           = r.x;
+            c->rule_view.y           = r.y;
+            c->rule_view.w           = r.w;
+            c->rule_view.h           = r.h;
+            c->rule_view.line_width  = r.line_width;
+            c->rule_view.color       = c->rule_color.c_str();
+            return &c->rule_view;
+        }
+        c->rule_page++;
+        c->rule_within = 0;
+    }
+    return nullptr;
+}
+
+const char* bboxes_get_rules_json(bboxes_cursor* c) {
+    if (!c) return nullptr;
+    if (c->rules_array_json.empty()) {
+        json arr = json::array();
+        for (const auto& page : c->result.pages)
+            for (const auto& r : page.rules)
+                arr.push_back(rule_to_json(page, r));
+        c->rules_array_json = arr.dump(-1, ' ', false, json::error_handler_t::replace);
+    }
+    return c->rules_array_json.c_str();
+}
+
+/* ── spatial queries ───────────────────────────────────────────────── */
+
+/* page_id is the position in result.pages for every backend; fall back to a
+   scan if that ever stops holding. */
+static const Page* find_page(const bboxes_cursor* c, uint32_t page_id, size_t* slot) {
+    const auto& pages = c->result.pages;
+    if (page_id < pages.size() && pages[page_id].page_id == page_id) {
+        *slot = page_id;
+        return &pages[page_id];
+    }
+    for (size_t i = 0; i < pages.size(); ++i)
+        if (pages[i].page_id == page_id) { *slot = i; return &pages[i]; }
+    return nullptr;
+}
+
+static const SpatialIndex* page_index(bboxes_cursor* c, uint32_t page_id) {
+    size_t slot = 0;
+    const Page* p = find_page(c, page_id, &slot);
+    if (!p) return nullptr;
+    if (c->spatial.size() < c->result.pages.size()) c->spatial.resize(c->result.pages.size());
+    if (!c->spatial[slot]) c->spatial[slot] = std::make_unique<SpatialIndex>(p->bboxes);
+    return c->spatial[slot].get();
+}
+
+size_t bboxes_query_rect(bboxes_cursor* c, uint32_t page_id,
+                         double x0, double y0, double x1, double y1,
+                         const uint32_t** out) {
+    if (out) *out = nullptr;
+    if (!c || !out) return 0;
+    const SpatialIndex* ix = page_index(c, page_id);
+    if (!ix) return 0;
+    ix->query(x0, y0, x1, y1, c->query_hits);
+    *out = c->query_hits.data();
+    return c->query_hits.size();
+}
+
+size_t bboxes_query_nearest(bboxes_cursor* c, uint32_t page_id,
+                            double x, double y, size_t k, const uint32_t** out) {
+    if (out) *out = nullptr;
+    if (!c || !out) return 0;
+    const SpatialIndex* ix = page_index(c, page_id);
+    if (!ix) return 0;
+    ix->nearest(x, y, k, c->query_hits);
+    *out = c->query_hits.data();
+    return c->query_hits.size();
+}
+
+const bboxes_bbox* bboxes_get_bbox(bboxes_cursor* c, uint32_t page_id, uint32_t index) {
+    if (!c) return nullptr;
+    size_t slot = 0;
+    const Page* p = find_page(c, page_id, &slot);
+    if (!p || index >= p->bboxes.size()) return nullptr;
+    fill_bbox_view(c->query_view, p->bboxes[index], c->result.source_type);
+    return &c->query_view;
+}
+
+/* ── global dictionary API ─────────────────────────────────────────── */
+
+int bboxes_attach_global_dict(bboxes_cursor* c) {
+    if (!c) return 0;
+    if (!c->global_ids) {
+        attach_global(c->result);
+        c->global_ids = true;
+        /* ids baked into already-built JSON are now stale */
+        c->fonts_array_json.clear();
+        c->styles_array_json.clear();
+        c->bboxes_array_json.clear();
+    }
+    return 1;
+}
+
+void bboxes_global_dict_auto(int enable) {
+    g_dict_auto.store(enable != 0, std::memory_order_relaxed);
+}
+
+void bboxes_global_dict_reset(void) {
+    GlobalDict::instance().reset();
+}
+
+const char* bboxes_global_fonts_json(void) {
+    static thread_local std::string out;
+    json arr = json::array();
+    for (const auto& e : GlobalDict::instance().fonts()) arr.push_back(font_to_json(e));
+    out = arr.dump(-1, ' ', false, json::error_handler_t::replace);
+    return out.c_str();
+}
+
+const char* bboxes_global_styles_json(void) {
+    static thread_local std::string out;
+    json arr = json::array();
+    for (const auto& e : GlobalDict::instance().styles()) arr.push_back(style_to_json(e));
+    out = arr.dump(-1, ' ', false, json::error_handler_t::replace);
+    return out.c_str();
+}
+
+/* ── reading-order lines ───────────────────────────────────────────── */
+
+static void build_lines(bboxes_cursor* c) {
+    if (c->lines_built) return;
+    c->lines.reserve(c->result.pages.size());
+    for (const auto& page : c->result.pages) c->lines.push_back(bboxes_group_lines(page));
+    c->lines_built = true;
+}
+
+static json line_to_json(const Page& p, uint32_t line_id, const TextLine& l) {
+    json obj;
+    obj["page_id"]      = p.page_id;
+    obj["line_id"]      = line_id;
+    obj["column_id"]    = l.column_id;
+    obj["x"]            = l.x;
+    obj["y"]            = l.y;
+    obj["w"]            = l.w;
+    obj["h"]            = l.h;
+    obj["text"]         = l.text;
+    obj["bbox_indices"] = l.members;
+    return obj;
+}
+
+const bboxes_line* bboxes_next_line(bboxes_cursor* c) {
+    if (!c) return nullptr;
+    build_lines(c);
+    while (c->line_page < c->lines.size()) {
+        const auto& lines = c->lines[c->line_page];
+        if (c->line_within < lines.size()) {
+            uint32_t id = static_cast<uint32_t>(c->line_within);
+            const TextLine& l = lines[c->line_within++];
+            c->line_view.page_id      = c->result.pages[c->line_page].page_id;
+            c->line_view.line_id      = id;
+            c->line_view.column_id    = l.column_id;
+            c->line_view.x            = l.x;
+            c->line_view.y            = l.y;
+            c->line_view.w            = l.w;
+            c->line_view.h            = l.h;
+            c->line_view.text         = l.text.c_str();
+            c->line_view.bbox_indices = l.members.data();
+            c->line_view.bbox_count   = static_cast<uint32_t>(l.members.size());
+            return &c->line_view;
+        }
+        c->line_page++;
+        c->line_within = 0;
+    }
+    return nullptr;
+}
+
+const char* bboxes_get_lines_json(bboxes_cursor* c) {
+    if (!c) return nullptr;
+    if (c->lines_array_json.empty()) {
+        build_lines(c);
+        json arr = json::array();
+        for (size_t i = 0; i < c->lines.size(); ++i)
+            for (size_t k = 0; k < c->lines[i].size(); ++k)
+                arr.push_back(line_to_json(c->result.pages[i], static_cast<uint32_t>(k), c->lines[i][k]));
+        c->lines_array_json = arr.dump(-1, ' ', false, json::error_handler_t::replace);
+    }
+    return c->lines_array_json.c_str();
+}
+
+const char* bboxes_get_header_json(bboxes_cursor* c) {
+    if (!c) return nullptr;
+    return c->header_json.empty() ? "null" : c->header_json.c_str();
+}
+
 /* Path/blob convenience wrappers for SQL: open a fast-reader cursor, pull the
    sheet-meta, close. (The single-pass writer uses the cursor accessor above
    instead, sharing the parse with the cell read.) */
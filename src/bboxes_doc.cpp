@@ -0,0 +1,265 @@
+/* Legacy .doc (Word 97-2003) backend — the piece table of the WordDocument stream.
+ *
+ * [MS-DOC] 2.4.1: the FIB names the table stream (0Table / 1Table) and the Clx inside it, whose PlcPcd
+ * maps character positions to byte runs of the WordDocument stream (8-bit cp1252 or UTF-16LE). Both
+ * streams come from the shared CfbPackage the .xls backend uses, read in place, and the main-document
+ * text is streamed piece by piece in CP order: only the paragraph or table row being built is held, never
+ * the document's text or a tree of it.
+ *
+ * Boxes use the same line/grid model as extract_docx: a paragraph is a flow span (x=1, w=len(text),
+ * h=1) and a table row one line of cells (x=col, w=1). Cell and row ends are both 0x07 marks; the
+ * paragraph properties (PAPX FKPs, looked up per paragraph mark) say which are in a table and which
+ * close a row (sprmPFTtp); with no PAPX table, an empty mark right after a cell end is the row end.
+ * Fields show their result, not their code. Nested tables fold into the text of the outer cell, and
+ * merged cells are not decoded — doc keeps them in the row's TDefTable.
+ */
+#include "bboxes_types.h"
+#include "bboxes_bytes.h"
+#include "bboxes_cfb.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+/* cp1252 0x80..0x9F: the compressed-piece bytes that are not Latin-1. */
+const uint16_t kCp1252[32] = {
+    0x20AC,0x0081,0x201A,0x0192,0x201E,0x2026,0x2020,0x2021,0x02C6,0x2030,0x0160,0x2039,0x0152,0x008D,0x017D,0x008F,
+    0x0090,0x2018,0x2019,0x201C,0x201D,0x2022,0x2013,0x2014,0x02DC,0x2122,0x0161,0x203A,0x0153,0x009D,0x017E,0x0178 };
+
+/* One Pcd: CPs [cp0, cp1) live at byte fc of WordDocument, 1 byte per char when compressed, else 2. */
+struct Piece { uint32_t cp0, cp1, fc; bool compressed; };
+
+/* Table membership of a paragraph, from the sprms of its PAPX. */
+struct ParaProps { bool in_table = false, ttp = false; };
+
+/* PlcBtePapx -> PapxFkp -> PapxInFkp, keyed by the byte offset of a paragraph's mark. */
+class PapxIndex {
+public:
+    PapxIndex(const uint8_t* wd, size_t wn, const uint8_t* plc, size_t lcb) : wd_(wd), wn_(wn) {
+        size_t n = lcb >= 4 ? (lcb - 4) / 8 : 0;
+        for (size_t i = 0; i <= n && n; i++) fcs_.push_back(le32(plc + 4 * i));
+        for (size_t i = 0; i < n; i++) pns_.push_back(le32(plc + 4 * (n + 1) + 4 * i) & 0x003FFFFF);
+    }
+    bool empty() const { return pns_.empty(); }
+
+    ParaProps props(uint32_t fc) const {
+        ParaProps pp;
+        auto it = std::upper_bound(fcs_.begin(), fcs_.end(), fc);
+        if (it == fcs_.begin() || it == fcs_.end()) return pp;
+        size_t page = size_t(it - fcs_.begin()) - 1;
+        uint64_t at = uint64_t(pns_[page]) * 512;
+        if (at + 512 > wn_) return pp;
+        const uint8_t* fkp = wd_ + at;
+        uint8_t crun = fkp[511];
+        if (crun == 0 || 4u * (crun + 1) + 13u * crun > 511) return pp;
+        size_t j = 0;
+        while (j < crun && !(le32(fkp + 4 * j) <= fc && fc < le32(fkp + 4 * (j + 1)))) j++;
+        if (j == crun) return pp;
+        size_t bx = size_t(fkp[4 * (crun + 1) + 13 * j]) * 2;
+        if (bx == 0 || bx >= 511) return pp;
+        size_t start = bx + 1, len = size_t(fkp[bx]) * 2;
+        if (len == 0) { start = bx + 2; len = size_t(fkp[bx + 1]) * 2; }
+        else len -= 1;
+        if (start + len > 511) len = start < 511 ? 511 - start : 0;
+        scan_sprms(fkp + start, len, pp);
+        return pp;
+    }
+
+private:
+    /* GrpPrlAndIstd: istd, then Prls. The operand size follows spra except for the two
+       variable-length sprms whose size is not a plain count byte ([MS-DOC] 2.6.2). */
+    static void scan_sprms(const uint8_t* g, size_t len, ParaProps& pp) {
+        size_t k = 2;
+        while (k + 2 <= len) {
+            uint16_t sprm = le16(g + k); k += 2;
+            size_t op;
+            switch (sprm >> 13) {
+                case 0: case 1: op = 1; break;
+                case 2: case 4: case 5: op = 2; break;
+                case 3: op = 4; break;
+                case 7: op = 3; break;
+                default:
+                    if (k >= len) return;
+                    if (sprm == 0xD608 && k + 2 <= len) op = size_t(le16(g + k)) + 1;   /* sprmTDefTable */
+                    else if (sprm == 0xC615 && g[k] == 255) {                           /* sprmPChgTabs, cb 255: */
+                        size_t del = k + 1 < len ? g[k + 1] : 0, add = k + 2 + 4 * del;   /* size from the counts */
+                        if (add >= len) return;
+                        op = 3 + 4 * del + 3 * size_t(g[add]);   /* cb, cTabs + 4 per deletion, cTabs + 3 per addition */
+                    } else op = size_t(g[k]) + 1;
+                    break;
+            }
+            if (k + op > len) return;
+            if (sprm == 0x2416) pp.in_table = g[k] != 0;                  /* sprmPFInTable */
+            else if (sprm == 0x2417) pp.ttp = g[k] != 0;                  /* sprmPFTtp */
+            else if (sprm == 0x6649) pp.in_table |= le32(g + k) > 0;      /* sprmPItap */
+            k += op;
+        }
+    }
+
+    const uint8_t* wd_; size_t wn_;
+    std::vector<uint32_t> fcs_, pns_;
+};
+
+}  // namespace
+
+BBoxResult extract_doc(const void* buf, size_t len) {
+    BBoxResult result;
+    result.source_type = "doc";
+    result.page_count = -1;
+
+    CfbPackage cfb;
+    CfbPackage::Stream wst, tst;
+    if (!cfb.open(buf, len) || !cfb.stream("WordDocument", wst)) return result;
+    std::vector<uint8_t> wscratch, tscratch;
+    const uint8_t* wd = CfbPackage::flat(wst, wscratch);
+    const size_t wn = wst.size;
+
+    /* FibBase, then the variable-length FibRgW / FibRgLw / FibRgFcLcb blocks */
+    if (wn < 34 || le16(wd) != 0xA5EC || le16(wd + 2) < 0x00C0) return result;   /* Word 97 and later */
+    uint16_t flags = le16(wd + 0x0A);
+    if (flags & 0x0100) return result;                                          /* fEncrypted */
+    size_t pos = 32;
+    pos += 2 + size_t(le16(wd + pos)) * 2;                                      /* csw + FibRgW97 */
+    if (pos + 2 > wn) return result;
+    size_t rglw = pos + 2, cslw = le16(wd + pos);
+    pos = rglw + cslw * 4;                                                      /* FibRgLw97 */
+    if (cslw < 4 || pos + 2 > wn) return result;
+    uint32_t ccp_text = le32(wd + rglw + 12);
+    size_t rgfc = pos + 2, cb_rgfc = le16(wd + pos);
+    if (cb_rgfc < 34 || rgfc + cb_rgfc * 8 > wn) return result;
+    auto fclcb = [&](size_t i, uint32_t& fc, uint32_t& lcb) { fc = le32(wd + rgfc + 8 * i); lcb = le32(wd + rgfc + 8 * i + 4); };
+
+    if (!cfb.stream((flags & 0x0200) ? "1Table" : "0Table", tst)) return result;
+    const uint8_t* tb = CfbPackage::flat(tst, tscratch);
+    const size_t tn = tst.size;
+
+    /* Clx: Prc* then the Pcdt holding PlcPcd */
+    uint32_t fc_clx, lcb_clx;
+    fclcb(33, fc_clx, lcb_clx);
+    if (lcb_clx == 0 || uint64_t(fc_clx) + lcb_clx > tn) return result;
+    const uint8_t* clx = tb + fc_clx;
+    size_t c = 0;
+    while (c + 3 <= lcb_clx && clx[c] == 0x01) c += 3 + le16(clx + c + 1);
+    if (c + 5 > lcb_clx || clx[c] != 0x02) return result;
+    size_t lcb_plc = le32(clx + c + 1);
+    const uint8_t* plc = clx + c + 5;
+    if (lcb_plc < 16 || c + 5 + lcb_plc > lcb_clx) return result;
+    size_t npcd = (lcb_plc - 4) / 12;
+    std::vector<Piece> pieces;
+    pieces.reserve(npcd);
+    for (size_t i = 0; i < npcd; i++) {
+        uint32_t raw = le32(plc + 4 * (npcd + 1) + 8 * i + 2);
+        bool comp = (raw & 0x40000000) != 0;
+        raw &= 0x3FFFFFFF;
+        pieces.push_back({ le32(plc + 4 * i), le32(plc + 4 * (i + 1)), comp ? raw / 2 : raw, comp });
+    }
+
+    uint32_t fc_bte, lcb_bte;
+    fclcb(13, fc_bte, lcb_bte);
+    PapxIndex papx(wd, wn, tb + (uint64_t(fc_bte) + lcb_bte <= tn ? fc_bte : 0),
+                   uint64_t(fc_bte) + lcb_bte <= tn ? lcb_bte : 0);
+
+    /* default font + style, as docx */
+    uint32_t font_id = result.fonts.intern("default");
+    uint32_t style_id = result.styles.intern(
+        font_id, BBOXES_DEFAULT_FONT_SIZE, BBOXES_DEFAULT_COLOR,
+        BBOXES_DEFAULT_WEIGHT, false, false);
+
+    Page page;
+    page.page_id     = 0;
+    page.document_id = 0;
+    page.page_number = 1;
+    uint32_t line = 0;
+    double max_x = 0.0;
+
+    std::string para, cell;                  /* the paragraph being read; earlier paragraphs of its cell */
+    std::vector<std::string> row;            /* finished cells of the open table row */
+    bool in_cell = false;                    /* `cell` holds paragraphs of an unfinished cell */
+    bool prev_cell_end = false;              /* last mark was a cell end (no-PAPX fallback) */
+    uint32_t pend = 0;
+    std::vector<bool> fields;                /* open fields, true while still in their code */
+    size_t in_code = 0;
+
+    auto emit = [&](double x, double w, std::string text) {
+        BBox bb;
+        bb.page_id  = 0;
+        bb.style_id = style_id;
+        bb.x = x;
+        bb.y = static_cast<double>(line);
+        bb.w = w;
+        bb.h = 1.0;
+        bb.text = std::move(text);
+        if (bb.x + bb.w - 1 > max_x) max_x = bb.x + bb.w - 1;
+        page.bboxes.push_back(std::move(bb));
+    };
+    auto close_row = [&]() {
+        if (in_cell) { row.push_back(std::move(cell)); cell.clear(); in_cell = false; }
+        if (row.empty()) return;
+        line++;
+        for (size_t i = 0; i < row.size(); i++) emit(double(i + 1), 1.0, std::move(row[i]));
+        row.clear();
+    };
+    auto flow = [&]() {
+        close_row();
+        if (para.empty()) return;            /* no text to box */
+        line++;
+        double w = static_cast<double>(utf8_len(para));   /* characters, not UTF-8 bytes */
+        emit(1.0, w, std::move(para));
+    };
+    auto mark = [&](uint16_t ch, uint32_t fc) {
+        pend = 0;
+        ParaProps pp = ch == 0x0C ? ParaProps{} : papx.props(fc);
+        if (papx.empty() && ch != 0x0C) {    /* no PAPX: a mark right after a cell end closes the row, */
+            pp.in_table = ch == 0x07 || in_cell || !row.empty();   /* and an open row keeps paragraphs */
+            pp.ttp = ch == 0x07 && prev_cell_end && para.empty();
+        }
+        if (ch == 0x07 && pp.ttp) {
+            close_row();
+        } else if (ch == 0x07 || pp.in_table) {
+            if (in_cell) cell += '\n';
+            cell += para;
+            in_cell = true;
+            if (ch == 0x07) { row.push_back(std::move(cell)); cell.clear(); in_cell = false; }
+        } else {
+            flow();
+        }
+        prev_cell_end = ch == 0x07 && !pp.ttp;
+        para.clear();
+    };
+
+    for (const Piece& pc : pieces) {
+        if (pc.cp0 >= ccp_text) break;
+        uint32_t cp1 = std::min(pc.cp1, ccp_text);
+        if (cp1 <= pc.cp0) continue;
+        size_t width = pc.compressed ? 1 : 2;
+        uint64_t end = uint64_t(pc.fc) + uint64_t(cp1 - pc.cp0) * width;
+        if (end > wn) end = wn;                                         /* piece runs off the stream */
+        for (uint64_t at = pc.fc; at + width <= end; at += width) {
+            uint32_t ch = pc.compressed ? wd[at] : le16(wd + at);
+            if (pc.compressed && ch >= 0x80 && ch < 0xA0) ch = kCp1252[ch - 0x80];
+            switch (ch) {
+                case 0x13: fields.push_back(true); in_code++; continue;                 /* field begin */
+                case 0x14: if (!fields.empty() && fields.back()) { fields.back() = false; in_code--; } continue;
+                case 0x15: if (!fields.empty()) { if (fields.back()) in_code--; fields.pop_back(); } continue;
+                default: break;
+            }
+            if (ch == 0x0D || ch == 0x07 || ch == 0x0C) { mark(uint16_t(ch), uint32_t(at)); continue; }
+            if (in_code) continue;
+            if (ch == 0x09)                      para += '\t';
+            else if (ch == 0x0B || ch == 0x0E)   para += '\n';          /* line / column break */
+            else if (ch == 0x1E)                 para += '-';           /* non-breaking hyphen */
+            else if (ch >= 0x20)                 put_utf16(para, ch, pend);
+            /* else: 0x1F optional hyphen, object anchors (0x01 picture, 0x02 footnote ref, 0x08 drawing...) */
+        }
+    }
+    flow();                                  /* text after the last mark, and any unterminated row */
+
+    page.width  = max_x;
+    page.height = static_cast<double>(line);
+    result.page_count = 1;
+    result.pages.push_back(std::move(page));
+    return result;
+}
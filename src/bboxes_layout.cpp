@@ -0,0 +1,210 @@
+/* ── reading-order layout pass ────────────────────────────────────────
+   Groups one page's word-level bboxes into lines and columns, the merge that
+   the character-gap test in bboxes_pdf.cpp (break_mask) deliberately leaves
+   to a later stage. Runs on the finished Page, so it is backend-neutral and
+   only paid for when asked.
+
+   1. Bands: bboxes sorted by vertical centre are swept top to bottom; a box
+      joins the current band when it overlaps the band vertically by at least
+      half its own height (so a superscript stays on its line, the next line
+      does not).
+   2. Lines: each band is sorted by x and split where the horizontal gap
+      exceeds kLineGap line heights — a column gutter or table cell gap,
+      never a word space.
+   3. Columns and order: a recursive XY-cut over the lines. At each node a
+      vertical whitespace gap of kLineGap median heights splits it into
+      columns (left to right); failing that, a horizontal gap of kBlockGap
+      splits it into blocks (top to bottom). Trying the vertical cut first
+      keeps a two-column body in column order, and a full-width heading
+      blocks the gutter so it is cut off horizontally above it. The
+      depth-first order of the leaves is the reading order; every child of
+      a vertical cut opens a new column_id. The cut runs off an explicit
+      stack over index ranges of two orders sorted once up front, and stops
+      cutting kMaxDepth levels down, so a degenerate page costs neither
+      stack depth nor a re-sort per node. */
+
+#include "bboxes_types.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+
+constexpr double kLineGap  = 1.0;   /* × line height: x gap that ends a line */
+constexpr double kBlockGap = 0.8;   /* × median height: y gap that ends a block */
+constexpr uint32_t kMaxDepth = 256; /* cuts below this are not tried: the rest is one block */
+
+/* The XY-cut works on index ranges: by[0] holds the lines sorted by left edge,
+   by[1] by top edge, each sorted once. A node is the same range [b, e) of both,
+   holding the same lines, so its projections are read off in order; a cut
+   splits the range of its own axis at a partition point and stable-partitions
+   the other, which keeps that one sorted too. */
+struct Cut {
+    const std::vector<TextLine>& lines;
+    std::vector<uint32_t> by[2];
+    std::vector<double> h;           /* median scratch */
+
+    double lo(uint32_t i, int axis) const { return axis ? lines[i].y : lines[i].x; }
+    double hi(uint32_t i, int axis) const { return axis ? lines[i].y + lines[i].h : lines[i].x + lines[i].w; }
+
+    explicit Cut(const std::vector<TextLine>& l) : lines(l) {
+        for (int axis = 0; axis < 2; ++axis) {
+            by[axis].resize(lines.size());
+            std::iota(by[axis].begin(), by[axis].end(), 0u);
+            std::sort(by[axis].begin(), by[axis].end(), [&](uint32_t a, uint32_t b) {
+                if (lo(a, axis) != lo(b, axis)) return lo(a, axis) < lo(b, axis);
+                return hi(a, axis) != hi(b, axis) ? hi(a, axis) < hi(b, axis) : a < b;
+            });
+        }
+    }
+
+    double median_height(size_t b, size_t e) {
+        h.clear();
+        for (size_t k = b; k < e; ++k) h.push_back(lines[by[0][k]].h);
+        std::nth_element(h.begin(), h.begin() + h.size() / 2, h.end());
+        return h[h.size() / 2];
+    }
+
+    /* Widest gap between the projections of [b, e) onto `axis`; returns the
+       split coordinate, or NAN when no gap reaches `min_gap`. */
+    double widest_gap(size_t b, size_t e, int axis, double min_gap) const {
+        const std::vector<uint32_t>& v = by[axis];
+        double best = min_gap, at = NAN, reach = hi(v[b], axis);
+        for (size_t k = b + 1; k < e; ++k) {
+            double gap = lo(v[k], axis) - reach;
+            if (gap >= best) { best = gap; at = reach + gap / 2; }
+            reach = std::max(reach, hi(v[k], axis));
+        }
+        return at;
+    }
+
+    /* Lines of [b, e) starting before `at` on `axis` move to the front of both
+       orders; returns where they end. */
+    size_t split(size_t b, size_t e, int axis, double at) {
+        auto before = [&](uint32_t i) { return lo(i, axis) < at; };
+        std::stable_partition(by[1 - axis].begin() + b, by[1 - axis].begin() + e, before);
+        return size_t(std::partition_point(by[axis].begin() + b, by[axis].begin() + e, before) - by[axis].begin());
+    }
+};
+
+void xy_cut(std::vector<TextLine>& lines, uint32_t& next_column, std::vector<uint32_t>& order) {
+    Cut cut(lines);
+    struct Node { size_t b, e; uint32_t column, depth; };
+    std::vector<Node> todo{{0, lines.size(), 0, 0}};
+    while (!todo.empty()) {
+        Node n = todo.back();
+        todo.pop_back();
+        if (n.e - n.b > 1 && n.depth < kMaxDepth) {
+            double mh = cut.median_height(n.b, n.e);
+            bool done = false;
+            for (int axis : {0, 1}) {   /* vertical cut (columns) first */
+                double at = cut.widest_gap(n.b, n.e, axis, (axis ? kBlockGap : kLineGap) * mh);
+                if (std::isnan(at)) continue;
+                size_t m = cut.split(n.b, n.e, axis, at);
+                if (m == n.b || m == n.e) continue;   /* zero-size lines at the gap: no cut */
+                /* hi is pushed first, so lo is read first; a column cut opens
+                   a column for each side */
+                uint32_t lo_col = axis ? n.column : next_column++;
+                uint32_t hi_col = axis ? n.column : next_column++;
+                todo.push_back({m, n.e, hi_col, n.depth + 1});
+                todo.push_back({n.b, m, lo_col, n.depth + 1});
+                done = true;
+                break;
+            }
+            if (done) continue;
+        }
+        /* Leaf block: top to bottom, then left to right. */
+        auto first = cut.by[1].begin() + n.b, last = cut.by[1].begin() + n.e;
+        std::sort(first, last, [&](uint32_t a, uint32_t b) {
+            if (lines[a].y != lines[b].y) return lines[a].y < lines[b].y;
+            return lines[a].x != lines[b].x ? lines[a].x < lines[b].x : a < b;
+        });
+        for (auto it = first; it != last; ++it) {
+            lines[*it].column_id = n.column;
+            order.push_back(*it);
+        }
+    }
+}
+
+} /* namespace */
+
+std::vector<TextLine> bboxes_group_lines(const Page& page) {
+    const std::vector<BBox>& bb = page.bboxes;
+    std::vector<TextLine> lines;
+    if (bb.empty()) return lines;
+
+    /* 1. bands */
+    std::vector<uint32_t> by_y(bb.size());
+    std::iota(by_y.begin(), by_y.end(), 0u);
+    std::sort(by_y.begin(), by_y.end(), [&](uint32_t a, uint32_t b) {
+        double ca = bb[a].y + bb[a].h / 2, cb = bb[b].y + bb[b].h / 2;
+        return ca != cb ? ca < cb : a < b;
+    });
+    std::vector<std::vector<uint32_t>> bands;
+    double band_y0 = 0, band_y1 = 0;
+    for (uint32_t i : by_y) {
+        const BBox& b = bb[i];
+        double overlap = std::min(band_y1, b.y + b.h) - std::max(band_y0, b.y);
+        if (!bands.empty() && overlap >= 0.5 * std::max(b.h, 0.0) && b.h > 0) {
+            bands.back().push_back(i);
+            band_y0 = std::min(band_y0, b.y);
+            band_y1 = std::max(band_y1, b.y + b.h);
+        } else {
+            bands.push_back({i});
+            band_y0 = b.y;
+            band_y1 = b.y + b.h;
+        }
+    }
+
+    /* 2. lines */
+    for (auto& band : bands) {
+        std::sort(band.begin(), band.end(), [&](uint32_t a, uint32_t b) {
+            return bb[a].x != bb[b].x ? bb[a].x < bb[b].x : a < b;
+        });
+        TextLine cur;
+        auto flush = [&]() {
+            if (cur.members.empty()) return;
+            cur.w -= cur.x;   /* w/h held right/bottom edges while growing */
+            cur.h -= cur.y;
+            lines.push_back(std::move(cur));
+            cur = TextLine{};
+        };
+        for (uint32_t i : band) {
+            const BBox& b = bb[i];
+            if (!cur.members.empty()) {
+                double line_h = cur.h - cur.y;
+                if (b.x - cur.w > kLineGap * std::max(line_h, b.h)) flush();
+            }
+            if (cur.members.empty()) {
+                cur.x = b.x; cur.y = b.y; cur.w = b.x + b.w; cur.h = b.y + b.h;
+            } else {
+                cur.x = std::min(cur.x, b.x); cur.y = std::min(cur.y, b.y);
+                cur.w = std::max(cur.w, b.x + b.w); cur.h = std::max(cur.h, b.y + b.h);
+                cur.text += ' ';
+            }
+            cur.text += b.text;
+            cur.members.push_back(i);
+        }
+        flush();
+    }
+
+    /* 3. columns + reading order */
+    std::vector<uint32_t> order;
+    order.reserve(lines.size());
+    uint32_t next_column = 1;
+    xy_cut(lines, next_column, order);
+
+    std::vector<TextLine> ordered;
+    ordered.reserve(lines.size());
+    for (uint32_t i : order) ordered.push_back(std::move(lines[i]));
+
+    /* Renumber columns densely in reading order. */
+    std::vector<int64_t> remap(next_column, -1);
+    uint32_t dense = 0;
+    for (TextLine& l : ordered) {
+        if (remap[l.column_id] < 0) remap[l.column_id] = dense++;
+        l.column_id = static_cast<uint32_t>(remap[l.column_id]);
+    }
+    return ordered;
+}
@@ -4,6 +4,9 @@
 // and decompresses ONLY the small metadata parts — never the whole workbook body.
 // Recognition (what dialect a blob is) is a separate concern; these assume the dialect.
 #include "bboxes.h"
+#include "bboxes_types.h"
+#include "bboxes_xlsx_pkg.h"
+#include "bboxes_cfb.h"
 #include <miniz.h>
 #include <pugixml.hpp>
 #include <nlohmann/json.hpp>
@@ -94,6 +97,12 @@ bool zip_load(mz_zip_archive& z, const char* part, pugi::xml_document& doc) {
     mz_free(p);
     return ok;
 }
+// Memoized variant: small parts shared by several builders within one call are
+// inflated once per package (see bboxes_xlsx_pkg.h).
+bool zip_load(XlsxPackage& pkg, const char* part, pugi::xml_document& doc) {
+    const std::string* b = pkg.part(part);
+    return b && doc.load_buffer(b->data(), b->size());
+}
 bool zip_bytes(mz_zip_archive& z, const char* part, std::string& out) {
     int idx = mz_zip_reader_locate_file(&z, part, nullptr, 0);
     if (idx < 0) return false;
@@ -128,7 +137,8 @@ std::string base64(const std::string& in) {
 // lean=true skips the per-worksheet-part loop (which re-inflates every sheet —
 // the one thing in here that touches the bulk); the artifact pipeline gets those
 // per-sheet facts from the cell reader's side-channel instead (single pass).
-std::string xlsx_meta_from_zip(mz_zip_archive& z, bool lean = false) {
+std::string xlsx_meta_from_pkg(XlsxPackage& pkg, bool lean = false) {
+    mz_zip_archive& z = pkg.z;
     json out;
     out["dialect"] = "xlsx";
     out["integrity"] = {{"status", "clean"}};
@@ -136,13 +146,13 @@ std::string xlsx_meta_from_zip(mz_zip_archive& z, bool lean = false) {
     auto has = [&](const char* p) { for (auto& q : parts) if (q == p) return true; return false; };
     pugi::xml_document doc;
 
-    if (zip_load(z, "docProps/core.xml", doc)) {
+    if (zip_load(pkg, "docProps/core.xml", doc)) {
         json core = json::object();
         for (auto c : doc.first_child().children())
             if (c.text() && *c.text().get()) core[local(c.name())] = unescape_ooxml(c.text().get());
         if (!core.empty()) out["core"] = core;
     }
-    if (zip_load(z, "docProps/app.xml", doc)) {
+    if (zip_load(pkg, "docProps/app.xml", doc)) {
         json app = json::object();
         for (auto c : doc.first_child().children()) {
             bool has_elem = false;
@@ -156,7 +166,7 @@ std::string xlsx_meta_from_zip(mz_zip_archive& z, bool lean = false) {
         }
         if (!app.empty()) out["app"] = app;
     }
-    if (zip_load(z, "docProps/custom.xml", doc)) {
+    if (zip_load(pkg, "docProps/custom.xml", doc)) {
         json cu = json::object();
         for (auto p : all_by(doc, "property")) {
             const char* nm = p.attribute("name").as_string(nullptr);
@@ -164,7 +174,7 @@ std::string xlsx_meta_from_zip(mz_zip_archive& z, bool lean = false) {
         }
         if (!cu.empty()) out["custom"] = cu;
     }
-    if (zip_load(z, "xl/workbook.xml", doc)) {
+    if (zip_load(pkg, "xl/workbook.xml", doc)) {
         json wb = json::object();
         if (auto pr = first_by(doc, "workbookPr")) wb["date1904"] = truthy(pr.attribute("date1904").as_string());
         if (auto calc = first_by(doc, "calcPr")) wb["calc_mode"] = calc.attribute("calcMode").as_string("auto");
@@ -322,16 +332,19 @@ json walk_bytes(const void* data, size_t len, const std::string& name, int depth
 
 json walk_zip(const void* data, size_t len, const std::string& name, int depth) {
     json node; node["name"] = name;
-    mz_zip_archive z{};
-    if (!mz_zip_reader_init_mem(&z, data, len, 0)) {
+    XlsxPackage pkg;
+    if (!pkg.open_mem(data, len)) {
         node["dialect"] = "zip"; node["error"] = "unreadable zip"; return node;
     }
+    mz_zip_archive& z = pkg.z;
     auto parts = zip_list(z);
     auto has = [&](const char* p) { for (auto& q : parts) if (q == p) return true; return false; };
     if (has("[Content_Types].xml")) {                 // an OOXML package → dialect leaf
         if (has("xl/workbook.xml")) {
             node["dialect"] = "xlsx";
-            node["metadata"] = json::parse(xlsx_meta_from_zip(z));
+            node["metadata"] = json::parse(xlsx_meta_from_pkg(pkg));
+        } else if (has("xl/workbook.bin")) {
+            node["dialect"] = "xlsb";
         } else if (has("word/document.xml")) {
             node["dialect"] = "docx";
         } else if (has("ppt/presentation.xml")) {
@@ -339,14 +352,19 @@ json walk_zip(const void* data, size_t len, const std::string& name, int depth)
         } else {
             node["dialect"] = "ooxml";
         }
-        mz_zip_reader_end(&z);
         return node;
     }
+    if (has("mimetype") && has("content.xml")) {      // ODF: the media type names the kind
+        std::string mt;
+        if (zip_bytes(z, "mimetype", mt) && mt.compare(0, 46, "application/vnd.oasis.opendocument.spreadsheet") == 0) {
+            node["dialect"] = "ods";
+            return node;
+        }
+    }
     node["dialect"] = "zip";                           // plain archive → recurse members
     node["member_count"] = static_cast<int>(parts.size());
     if (depth >= kMaxDepth) {
         node["truncated"] = "max depth";
-        mz_zip_reader_end(&z);
         return node;
     }
     json kids = json::array();
@@ -357,7 +375,6 @@ json walk_zip(const void* data, size_t len, const std::string& name, int depth)
         kids.push_back(walk_bytes(mb.data(), mb.size(), part, depth + 1));
     }
     node["children"] = kids;
-    mz_zip_reader_end(&z);
     return node;
 }
 
@@ -370,8 +387,13 @@ json walk_bytes(const void* data, size_t len, const std::string& name, int depth
             n["metadata"] = json::parse(bboxes_pdf_metadata_json(data, len));
             return n;
         }
-        case K_OLE: {   // legacy .xls/.doc or a bare vbaProject.bin — leaf for now
+        case K_OLE: {   // legacy .xls/.doc, told apart by directory; else e.g. a bare vbaProject.bin
             json n; n["name"] = name; n["dialect"] = "ole";
+            CfbPackage cfb;
+            if (cfb.open(data, len)) {
+                if (cfb.entry("WordDocument")) n["dialect"] = "doc";
+                else if (cfb.entry("Workbook") || cfb.entry("Book")) n["dialect"] = "xls";
+            }
             n["size"] = static_cast<uint64_t>(len); return n;
         }
         case K_XML: {
@@ -455,9 +477,9 @@ json color_spec(pugi::xml_node c) {
 
 // theme_palette[themeIndex] = hex, in COLOR-THEME index order (0=lt1,1=dk1,2=lt2,
 // 3=dk2 — the dk/lt swap vs the clrScheme child order dk1,lt1,dk2,lt2,...).
-std::vector<std::string> theme_palette(mz_zip_archive& z) {
+std::vector<std::string> theme_palette(XlsxPackage& pkg) {
     pugi::xml_document doc;
-    if (!zip_load(z, "xl/theme/theme1.xml", doc)) return {};
+    if (!zip_load(pkg, "xl/theme/theme1.xml", doc)) return {};
     auto scheme = first_by(doc, "clrScheme");
     std::vector<std::string> raw;  // clrScheme child order
     for (auto child : scheme.children()) {
@@ -511,19 +533,19 @@ json resolve_border(pugi::xml_node b) {
     return j;
 }
 
-std::string xlsx_style_decode_from_zip(mz_zip_archive& z) {
+std::string xlsx_style_decode_from_pkg(XlsxPackage& pkg) {
     json out;
     out["dialect"] = "xlsx";
 
     pugi::xml_document wb;
     bool d1904 = false;
-    if (zip_load(z, "xl/workbook.xml", wb))
+    if (zip_load(pkg, "xl/workbook.xml", wb))
         d1904 = truthy(first_by(wb, "workbookPr").attribute("date1904").value());
     out["date1904"] = d1904;
-    out["theme_palette"] = theme_palette(z);
+    out["theme_palette"] = theme_palette(pkg);
 
     pugi::xml_document doc;
-    if (!zip_load(z, "xl/styles.xml", doc)) {
+    if (!zip_load(pkg, "xl/styles.xml", doc)) {
         out["style_decode"] = json::array();
         out["s_to_id"] = json::array();
         return out.dump(-1, ' ', false, json::error_handler_t::replace);
@@ -586,69 +608,100 @@ std::string xlsx_style_decode_from_zip(mz_zip_archive& z) {
     return out.dump(-1, ' ', false, json::error_handler_t::replace);
 }
 
+// read a whole file into a string (walk must recurse; nested members need inflating)
+bool slurp(const char* path, std::string& out) {
+    FILE* f = std::fopen(path, "rb");
+    if (!f) return false;
+    std::fseek(f, 0, SEEK_END);
+    long sz = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    if (sz < 0) { std::fclose(f); return false; }
+    out.resize(static_cast<size_t>(sz));
+    size_t got = std::fread(&out[0], 1, out.size(), f);
+    std::fclose(f);
+    out.resize(got);
+    return true;
+}
+} // namespace
+
 // Combined artifact HEADER (the footer bag): sha256 workbook id + workbook-global
 // style/theme decode + lean global metadata. Reads ONLY small parts (styles.xml,
 // theme1.xml, docProps, workbook.xml, tables) — never the worksheets — so it is
 // DISJOINT from the cell reader's body pass: bb_xlsx inflates the worksheets once,
 // xlsx_header inflates only these tiny parts, and neither re-does the other's work.
 // (Merge extents already live in each cell's w/h; dimension = max row/col of cells.)
-std::string xlsx_header_from_zip(mz_zip_archive& z, const void* buf, size_t len) {
+std::string bboxes_xlsx_header_from_pkg(XlsxPackage& pkg, const std::string& sha256) {
     /* Common header envelope (matches pdf_header): dialect + integrity + sha256 +
        page_count at the top level. The format-specific decode goes under a distinct
        key: pdf uses `styles` (an array of style rows), xlsx uses `style_decode` (the
        biconditional decode bundle) — never the same key meaning two things. */
-    json styles = json::parse(xlsx_style_decode_from_zip(z));  styles.erase("dialect");
-    json meta   = json::parse(xlsx_meta_from_zip(z, /*lean=*/true));
+    json styles = json::parse(xlsx_style_decode_from_pkg(pkg));  styles.erase("dialect");
+    json meta   = json::parse(xlsx_meta_from_pkg(pkg, /*lean=*/true));
     meta.erase("dialect");  meta.erase("integrity");   // envelope carries these once
     json h;
     h["dialect"]      = "xlsx";
     h["integrity"]    = {{"status", "clean"}};
-    SHA256 sha;  h["sha256"] = sha(buf, len);           // == workbook_id (§5)
+    h["sha256"]       = sha256;         // == workbook_id (§5)
     h["page_count"]   = meta.value("sheets", json::array()).size();  // sheets = pages
     h["style_decode"] = std::move(styles);
     h["meta"]         = std::move(meta);
     return h.dump(-1, ' ', false, json::error_handler_t::replace);
 }
 
-// read a whole file into a string (walk must recurse; nested members need inflating)
-bool slurp(const char* path, std::string& out) {
-    FILE* f = std::fopen(path, "rb");
-    if (!f) return false;
-    std::fseek(f, 0, SEEK_END);
-    long sz = std::ftell(f);
-    std::fseek(f, 0, SEEK_SET);
-    if (sz < 0) { std::fclose(f); return false; }
-    out.resize(static_cast<size_t>(sz));
-    size_t got = std::fread(&out[0], 1, out.size(), f);
-    std::fclose(f);
-    out.resize(got);
-    return true;
+// ── numFmt classification (shared with the fast xlsx reader's vdate channel) ──
+
+const char* bboxes_builtin_numfmt(int id) { return builtin_numfmt(id); }
+
+// Builtin date/time ids: 14-22 and 45-47 (US), plus 27-36 and 50-58, the
+// locale-dependent CJK date ids that builtin_numfmt has no US code for. Anything
+// else is classified from its code: a y/m/d/h/s token in the first section that is
+// not inside "..." literals, \ or _ or * escapes, or a [...] tag (colour, locale,
+// condition) — except the elapsed-time tags [h] [mm] [ss], which are time.
+bool bboxes_numfmt_is_date(int id, const char* code) {
+    if ((id >= 14 && id <= 22) || (id >= 27 && id <= 36) ||
+        (id >= 45 && id <= 47) || (id >= 50 && id <= 58)) return true;
+    if (!code) return false;
+    for (const char* p = code; *p && *p != ';'; p++) {
+        switch (*p) {
+            case '"': while (p[1] && p[1] != '"') p++; if (p[1]) p++; break;
+            case '\\': case '_': case '*': if (p[1]) p++; break;
+            case '[': {
+                char c = static_cast<char>(std::tolower(static_cast<unsigned char>(p[1])));
+                if (c == 'h' || c == 'm' || c == 's') return true;
+                while (p[1] && p[1] != ']') p++;
+                if (p[1]) p++;
+                break;
+            }
+            default:
+                switch (std::tolower(static_cast<unsigned char>(*p))) {
+                    case 'y': case 'm': case 'd': case 'h': case 's': return true;
+                }
+        }
+    }
+    return false;
 }
-} // namespace
 
 extern "C" {
 
 // Stream-oriented: reads only the metadata parts off the file, not the whole body.
 const char* bboxes_xlsx_metadata_json_file(const char* path) {
-    mz_zip_archive z{};
-    if (!mz_zip_reader_init_file(&z, path, 0)) {
+    XlsxPackage pkg;
+    if (!pkg.open_file(path)) {
         g_result = "{\"dialect\":\"xlsx\",\"integrity\":{\"status\":\"failed\",\"error\":\"not a zip / unreadable\"}}";
         return g_result.c_str();
     }
-    g_result = xlsx_meta_from_zip(z);
-    mz_zip_reader_end(&z);
+    g_result = xlsx_meta_from_pkg(pkg);
     return g_result.c_str();
 }
 
 // Buffer variant (when the bytes are already in hand, e.g. a DB BLOB).
 const char* bboxes_xlsx_metadata_json(const void* data, size_t len) {
-    mz_zip_archive z{};
-    if (!mz_zip_reader_init_mem(&z, data, len, 0)) {
+    XlsxPackage pkg;
+    if (!pkg.open_mem(data, len)) {
         g_result = "{\"dialect\":\"xlsx\",\"integrity\":{\"status\":\"failed\",\"error\":\"not a zip\"}}";
         return g_result.c_str();
     }
-    g_result = xlsx_meta_from_zip(z);
-    mz_zip_reader_end(&z);
+    g_result = xlsx_meta_from_pkg(pkg);
     return g_result.c_str();
 }
 
@@ -699,13 +752,13 @@ const char* bboxes_xlsx_vba_base64(const void* data, size_t len) {
 // one zip open, small parts only. Blob and file variants; the file variant slurps
 // once (so the sha256 is over the same bytes, no second read).
 const char* bboxes_xlsx_header_json(const void* data, size_t len) {
-    mz_zip_archive z{};
-    if (!mz_zip_reader_init_mem(&z, data, len, 0)) {
+    XlsxPackage pkg;
+    if (!pkg.open_mem(data, len)) {
         g_result = "{\"dialect\":\"xlsx\",\"error\":\"not a zip\"}";
         return g_result.c_str();
     }
-    g_result = xlsx_header_from_zip(z, data, len);
-    mz_zip_reader_end(&z);
+    SHA256 sha;
+    g_result = bboxes_xlsx_header_from_pkg(pkg, sha(data, len));
     return g_result.c_str();
 }
 const char* bboxes_xlsx_header_json_file(const char* path) {
@@ -722,45 +775,41 @@ const char* bboxes_xlsx_header_json_file(const char* path) {
 // per-worksheet loop (that re-inflates the bulk; the cell reader supplies
 // dimension/merges instead). Single-pass-friendly.
 const char* bboxes_xlsx_artifact_meta_json_file(const char* path) {
-    mz_zip_archive z{};
-    if (!mz_zip_reader_init_file(&z, path, 0)) {
+    XlsxPackage pkg;
+    if (!pkg.open_file(path)) {
         g_result = "{\"dialect\":\"xlsx\",\"integrity\":{\"status\":\"failed\",\"error\":\"not a zip / unreadable\"}}";
         return g_result.c_str();
     }
-    g_result = xlsx_meta_from_zip(z, /*lean=*/true);
-    mz_zip_reader_end(&z);
+    g_result = xlsx_meta_from_pkg(pkg, /*lean=*/true);
     return g_result.c_str();
 }
 const char* bboxes_xlsx_artifact_meta_json(const void* data, size_t len) {
-    mz_zip_archive z{};
-    if (!mz_zip_reader_init_mem(&z, data, len, 0)) {
+    XlsxPackage pkg;
+    if (!pkg.open_mem(data, len)) {
         g_result = "{\"dialect\":\"xlsx\",\"integrity\":{\"status\":\"failed\",\"error\":\"not a zip\"}}";
         return g_result.c_str();
     }
-    g_result = xlsx_meta_from_zip(z, /*lean=*/true);
-    mz_zip_reader_end(&z);
+    g_result = xlsx_meta_from_pkg(pkg, /*lean=*/true);
     return g_result.c_str();
 }
 
 // Biconditional style decode: styles.xml + theme1.xml → {s_to_id, style_decode}.
 const char* bboxes_xlsx_style_decode_json_file(const char* path) {
-    mz_zip_archive z{};
-    if (!mz_zip_reader_init_file(&z, path, 0)) {
+    XlsxPackage pkg;
+    if (!pkg.open_file(path)) {
         g_result = "{\"dialect\":\"xlsx\",\"error\":\"not a zip / unreadable\"}";
         return g_result.c_str();
     }
-    g_result = xlsx_style_decode_from_zip(z);
-    mz_zip_reader_end(&z);
+    g_result = xlsx_style_decode_from_pkg(pkg);
     return g_result.c_str();
 }
 const char* bboxes_xlsx_style_decode_json(const void* data, size_t len) {
-    mz_zip_archive z{};
-    if (!mz_zip_reader_init_mem(&z, data, len, 0)) {
+    XlsxPackage pkg;
+    if (!pkg.open_mem(data, len)) {
         g_result = "{\"dialect\":\"xlsx\",\"error\":\"not a zip\"}";
         return g_result.c_str();
     }
-    g_result = xlsx_style_decode_from_zip(z);
-    mz_zip_reader_end(&z);
+    g_result = xlsx_style_decode_from_pkg(pkg);
     return g_result.c_str();
 }
 
@@ -0,0 +1,539 @@
+/* .ods (OpenDocument spreadsheet) backend — the extract_xlsx_fast grain read from content.xml.
+ *
+ * Every sheet of an ODF spreadsheet lives in the one content.xml part (table:table per sheet,
+ * table:table-row / table:table-cell inside), so the part is pulled through miniz's extract iterator a
+ * chunk at a time and scanned as it arrives, memmem-style like the fast xlsx reader: no DOM, no full
+ * inflate. The scan works on whole rows; a row that straddles a chunk boundary waits for the next
+ * chunk, so memory follows the largest row rather than the part. Sheets outside the page range are
+ * hopped over without looking at their rows, but the part is read to the end: page_count is every
+ * table:table, as the xlsx and xlsb readers count every sheet of the workbook.
+ *
+ * ODF compresses runs of identical cells and rows (table:number-columns-repeated /
+ * number-rows-repeated), and LibreOffice pads every sheet out to the grid edge with empty ones — a
+ * trailing row repeated a million times, holding a cell repeated a thousand. Empty repeats only advance
+ * the row/column counters; a repeat that carries a value is emitted once per cell it stands for. Page
+ * width/height are the extent of the emitted cells, not of the padding.
+ *
+ * Output matches the fast xlsx reader: x = col, y = row (1-based), text = the raw value (office:value,
+ * office:date-value, "1"/"0" for booleans, the paragraphs for strings), a merge origin spanning its
+ * number-columns/rows-spanned with the range on the merges side-channel (ODF marks the covered cells
+ * itself, as table:covered-table-cell), and formulas turned from OpenFormula ("of:=SUM([.A1:.B2])")
+ * into A1 text ("=SUM(A1:B2)"). style_id is the cell's own table:style-name numbered in
+ * office:automatic-styles order, 0 for none; column default styles are not followed. Dates and times
+ * come typed (office:value-type), so vdate needs no number-format lookup; vnum is the serial from the
+ * document's null date. An encrypted package (manifest encryption-data) gives page_count = -1.
+ */
+#include "bboxes_types.h"
+#include "bboxes_bytes.h"
+#include "bboxes_xlsx_pkg.h"
+
+#include <miniz.h>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t kMaxRow = 1048576, kMaxCol = 16384;   /* the sheet grid: repeats past it are padding */
+constexpr size_t kChunk = 64 * 1024;                     /* inflater pull size */
+
+/* days since 1970-01-01 of a proleptic Gregorian date (civil-to-days) */
+int64_t days_from_civil(int64_t y, int64_t m, int64_t d) {
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+/* "YYYY-MM-DD[THH:MM:SS[.fff]]" -> days since the epoch, fraction included */
+bool iso_days(const std::string& s, double& out) {
+    int y, mo, d, h = 0, mi = 0;
+    double sec = 0;
+    char* q;
+    const char* p = s.c_str();
+    y = int(std::strtol(p, &q, 10));  if (*q != '-') return false;
+    mo = int(std::strtol(q + 1, &q, 10)); if (*q != '-') return false;
+    d = int(std::strtol(q + 1, &q, 10));
+    if (*q == 'T') {
+        h = int(std::strtol(q + 1, &q, 10));  if (*q != ':') return false;
+        mi = int(std::strtol(q + 1, &q, 10)); if (*q != ':') return false;
+        sec = std::strtod(q + 1, &q);
+    }
+    if (mo < 1 || mo > 12 || d < 1 || d > 31) return false;
+    out = double(days_from_civil(y, mo, d)) + (h * 3600.0 + mi * 60.0 + sec) / 86400.0;
+    return true;
+}
+
+/* ISO 8601 duration ("PT12H30M00S", "-P1DT2H") -> days */
+bool duration_days(const std::string& s, double& out) {
+    const char* p = s.c_str();
+    bool neg = *p == '-';
+    if (neg) p++;
+    if (*p++ != 'P') return false;
+    double days = 0;
+    bool t = false;
+    while (*p) {
+        if (*p == 'T') { t = true; p++; continue; }
+        char* q;
+        double v = std::strtod(p, &q);
+        if (q == p) return false;
+        switch (*q) {
+            case 'D': days += v; break;
+            case 'H': days += v / 24.0; break;
+            case 'M': days += t ? v / 1440.0 : v * 30.0; break;
+            case 'S': days += v / 86400.0; break;
+            default:  return false;
+        }
+        p = q + 1;
+    }
+    out = neg ? -days : days;
+    return true;
+}
+
+/* append the character data [p, e) with its entities decoded */
+void put_text(std::string& out, const char* p, const char* e) {
+    while (p < e) {
+        const char* amp = static_cast<const char*>(std::memchr(p, '&', e - p));
+        if (!amp) { out.append(p, e - p); return; }
+        out.append(p, amp - p);
+        const char* semi = static_cast<const char*>(std::memchr(amp, ';', e - amp));
+        if (!semi || semi - amp > 10) { out += '&'; p = amp + 1; continue; }
+        std::string ent(amp + 1, semi - amp - 1);
+        if      (ent == "amp")  out += '&';
+        else if (ent == "lt")   out += '<';
+        else if (ent == "gt")   out += '>';
+        else if (ent == "quot") out += '"';
+        else if (ent == "apos") out += '\'';
+        else if (ent.size() > 1 && ent[0] == '#')
+            put_utf8(out, uint32_t(ent[1] == 'x' || ent[1] == 'X' ? std::strtoul(ent.c_str() + 2, nullptr, 16)
+                                                                  : std::strtoul(ent.c_str() + 1, nullptr, 10)));
+        else out.append(amp, semi + 1 - amp);
+        p = semi + 1;
+    }
+}
+
+/* value of attribute `name` (with its leading space and `="`) in the start tag [p, e), raw; false if absent */
+bool attr(const char* p, const char* e, const char* name, const char*& v, size_t& n) {
+    size_t nl = std::strlen(name);
+    const char* a = static_cast<const char*>(memmem(p, e - p, name, nl));
+    if (!a) return false;
+    a += nl;
+    const char* q = static_cast<const char*>(std::memchr(a, '"', e - a));
+    if (!q) return false;
+    v = a; n = size_t(q - a);
+    return true;
+}
+
+std::string attr_str(const char* p, const char* e, const char* name) {
+    const char* v; size_t n;
+    std::string s;
+    if (attr(p, e, name, v, n)) put_text(s, v, v + n);
+    return s;
+}
+
+uint32_t attr_u32(const char* p, const char* e, const char* name, uint32_t dflt) {
+    const char* v; size_t n;
+    if (!attr(p, e, name, v, n) || !n) return dflt;
+    unsigned long x = std::strtoul(std::string(v, n).c_str(), nullptr, 10);
+    return x == 0 ? dflt : x > kMaxRow ? kMaxRow : uint32_t(x);
+}
+
+/* does [lt, e) open element `name` ("<table:table-row"), with a real name boundary after it? */
+bool opens(const char* lt, const char* e, const char* name, size_t nl) {
+    if (size_t(e - lt) <= nl || std::memcmp(lt, name, nl) != 0) return false;
+    char c = lt[nl];
+    return c == ' ' || c == '>' || c == '/' || c == '\t' || c == '\n' || c == '\r';
+}
+
+/* One paragraph's content [p, e) onto `out`: tags stripped, their text kept (spans, links), text:s /
+   text:tab / text:line-break expanded, annotations and notes dropped. Returns past the closing tag. */
+const char* paragraph(const char* p, const char* e, std::string& out) {
+    int depth = 0, skip = 0;   // skip: depth at which an annotation/note opened, 0 = none
+    while (p < e) {
+        const char* lt = static_cast<const char*>(std::memchr(p, '<', e - p));
+        if (!lt) { if (!skip) put_text(out, p, e); return e; }
+        if (!skip) put_text(out, p, lt);
+        const char* gt = static_cast<const char*>(std::memchr(lt, '>', e - lt));
+        if (!gt) return e;
+        p = gt + 1;
+        if (lt[1] == '/') {
+            if (depth == 0) return p;
+            if (skip == depth) skip = 0;
+            depth--;
+            continue;
+        }
+        if (lt[1] == '?' || lt[1] == '!') continue;
+        bool self = gt[-1] == '/';
+        if (!skip) {
+            if (opens(lt, gt + 1, "<text:s", 7)) {
+                uint32_t c = attr_u32(lt, gt, " text:c=\"", 1);
+                out.append(c > 1024 ? 1024 : c, ' ');
+            } else if (opens(lt, gt + 1, "<text:tab", 9)) out += '\t';
+            else if (opens(lt, gt + 1, "<text:line-break", 16)) out += '\n';
+            else if (!self && (opens(lt, gt + 1, "<office:annotation", 18) || opens(lt, gt + 1, "<text:note", 10)))
+                skip = depth + 1;
+        }
+        if (!self) depth++;
+    }
+    return e;
+}
+
+/* A cell's text: its own text:p / text:h paragraphs joined by '\n'. Anything else in the cell — an
+   office:annotation, a draw:frame anchored there — is stepped over, text and all. */
+void cell_text(const char* p, const char* e, std::string& out) {
+    int depth = 0;
+    bool first = true;
+    while (p < e) {
+        const char* lt = static_cast<const char*>(std::memchr(p, '<', e - p));
+        if (!lt) return;
+        const char* gt = static_cast<const char*>(std::memchr(lt, '>', e - lt));
+        if (!gt) return;
+        p = gt + 1;
+        if (lt[1] == '/') { depth--; continue; }
+        if (lt[1] == '?' || lt[1] == '!') continue;
+        bool self = gt[-1] == '/';
+        if (depth == 0 && (opens(lt, gt + 1, "<text:p", 7) || opens(lt, gt + 1, "<text:h", 7))) {
+            if (!first) out += '\n';
+            first = false;
+            if (!self) p = paragraph(p, e, out);
+            continue;
+        }
+        if (!self) depth++;
+    }
+}
+
+/* One OpenFormula reference, the inside of [...]: "$Sheet1.A1:.B2", ".A:.A", "'My Sheet'.$C$4". Sheet
+   qualifiers lose their absolute '$' and move in front as "Sheet!"; a range over two sheets becomes the
+   A1 3D form "S1:S2!A1:B2". */
+void a1_ref(const std::string& r, std::string& out) {
+    std::string sheet[2], cell[2];
+    int parts = 0;
+    size_t i = 0, n = r.size();
+    while (i <= n && parts < 2) {
+        size_t start = i, dot = std::string::npos;
+        bool q = false;
+        for (; i < n; i++) {
+            char c = r[i];
+            if (c == '\'') q = !q;
+            else if (!q && c == '.') dot = i;
+            else if (!q && c == ':') break;
+        }
+        std::string s = dot == std::string::npos ? std::string() : r.substr(start, dot - start);
+        std::string c = r.substr(dot == std::string::npos ? start : dot + 1, i - (dot == std::string::npos ? start : dot + 1));
+        size_t hash = s.find("'#");
+        if (hash != std::string::npos && hash + 2 < s.size() && s[hash + 2] == '$') s.erase(hash + 2, 1);
+        else if (!s.empty() && s[0] == '$') s.erase(0, 1);
+        sheet[parts] = s; cell[parts] = c; parts++;
+        if (i >= n) break;
+        i++;   // past ':'
+    }
+    if (parts == 2 && !sheet[1].empty() && sheet[1] != sheet[0]) {
+        out += sheet[0]; out += ':'; out += sheet[1]; out += '!';
+    } else if (!sheet[0].empty()) {
+        out += sheet[0]; out += '!';
+    }
+    out += cell[0];
+    if (parts == 2) { out += ':'; out += cell[1]; }
+}
+
+/* OpenFormula ("of:=SUM([.A1:.B2];2)") -> A1 text ("=SUM(A1:B2,2)"): references in brackets rewritten,
+   ';' back to ',', inline arrays to Excel's separators, '~' (union) to ',' and '!' (intersection) to a
+   space. String literals pass through untouched. Any namespace prefix is dropped. */
+void a1_formula(const std::string& f, std::string& out) {
+    out.clear();
+    size_t i = 0, n = f.size();
+    size_t eq = f.find('=');
+    if (eq != std::string::npos && f.find(':') < eq && f.find_first_of("\"[") > eq) i = eq;
+    if (i < n && f[i] != '=') out += '=';
+    int brace = 0;
+    while (i < n) {
+        char c = f[i];
+        if (c == '"') {
+            size_t j = i + 1;
+            while (j < n) { if (f[j] == '"') { if (j + 1 < n && f[j + 1] == '"') { j += 2; continue; } break; } j++; }
+            out.append(f, i, j + 1 - i);
+            i = j + 1;
+        } else if (c == '[') {
+            size_t j = i + 1;
+            bool q = false;
+            for (; j < n && (q || f[j] != ']'); j++) if (f[j] == '\'') q = !q;
+            a1_ref(f.substr(i + 1, j - i - 1), out);
+            i = j + 1;
+        } else {
+            if (c == '{') brace++;
+            else if (c == '}') brace--;
+            if (c == ';') out += ',';
+            else if (c == '|' && brace > 0) out += ';';
+            else if (c == '~') out += ',';
+            else if (c == '!') out += ' ';
+            else out += c;
+            i++;
+        }
+    }
+}
+
+/* The scan over content.xml. feed() takes each inflated chunk; what is complete in the buffer is
+   consumed and the tail kept for the next one. */
+class Content {
+public:
+    Content(BBoxResult& res, int start_page, int end_page) : res_(res), sp_(start_page), ep_(end_page) {}
+
+    /* false at the end of the part (eof), true while it wants more */
+    bool feed(const char* p, size_t n, bool eof) {
+        buf_.append(p, n);
+        bool more = run(eof);
+        buf_.erase(0, pos_);
+        resume_ = resume_ > pos_ ? resume_ - pos_ : 0;
+        pos_ = 0;
+        return more;
+    }
+
+private:
+    BBoxResult& res_;
+    int sp_, ep_;
+    std::string buf_;
+    size_t pos_ = 0;       // consumed prefix of buf_
+    size_t resume_ = 0;    // where the pending unit's end-tag search picks up
+    std::unordered_map<std::string, uint32_t> styles_;   // table-cell style name -> style_id
+    int64_t null_days_ = -25569;                         // 1899-12-30, the ODF default null date
+    int sheet_ = -1;       // index of the current table:table
+    bool in_sheet_ = false, emit_ = false;
+    uint32_t row_ = 0;     // rows already passed in this sheet (0-based next row)
+    Page page_;
+    std::vector<BBox> cells_;
+    std::vector<Merge> spans_;
+    std::string text_, formula_;
+
+    const char* find(const char* from, const char* term, size_t tl) const {
+        const char* b = buf_.data();
+        const char* e = b + buf_.size();
+        const char* f = b + (resume_ > size_t(from - b) ? resume_ : size_t(from - b));
+        return f >= e ? nullptr : static_cast<const char*>(memmem(f, e - f, term, tl));
+    }
+    /* the end tag was not in the buffer: keep the unit from `lt`, and start the next search near the tail */
+    void wait(const char* lt, size_t tl) {
+        pos_ = size_t(lt - buf_.data());
+        resume_ = buf_.size() >= tl ? buf_.size() - (tl - 1) : 0;
+    }
+
+    bool run(bool eof) {
+        const char* b = buf_.data();
+        const char* e = b + buf_.size();
+        while (pos_ < buf_.size()) {
+            const char* lt = static_cast<const char*>(std::memchr(b + pos_, '<', buf_.size() - pos_));
+            if (!lt) { pos_ = buf_.size(); break; }
+            if (in_sheet_ && !emit_) {                       // a sheet outside the range: straight to its end
+                const char* end = find(lt, "</table:table>", 14);
+                if (!end) {                                  // nothing in a skipped sheet is kept but a
+                    if (eof) return false;                   // tail that could start the end tag
+                    pos_ = buf_.size() > 13 ? buf_.size() - 13 : 0;
+                    resume_ = 0;
+                    return true;
+                }
+                close_sheet();
+                resume_ = 0;
+                pos_ = size_t(end - b) + 14;
+                continue;
+            }
+            const char* gt = static_cast<const char*>(std::memchr(lt, '>', e - lt));
+            if (!gt) { if (eof) return false; pos_ = size_t(lt - b); return true; }
+            pos_ = size_t(gt - b) + 1;
+            if (lt[1] == '/') {
+                if (in_sheet_ && opens(lt, gt + 1, "</table:table", 13)) close_sheet();
+                continue;
+            }
+            bool self = gt[-1] == '/';
+            if (opens(lt, gt + 1, "<table:table-row", 16)) {
+                if (!in_sheet_) continue;
+                if (self) { row(lt, gt, nullptr, nullptr); continue; }
+                const char* end = find(gt + 1, "</table:table-row>", 18);
+                if (!end) { if (eof) return false; wait(lt, 18); return true; }
+                resume_ = 0;
+                row(lt, gt, gt + 1, end);
+                pos_ = size_t(end - b) + 18;
+            } else if (opens(lt, gt + 1, "<table:table", 12)) {
+                if (in_sheet_) continue;
+                open_sheet();
+                if (self) close_sheet();
+            } else if (opens(lt, gt + 1, "<style:style", 12)) {
+                if (attr_str(lt, gt, " style:family=\"") == "table-cell") {
+                    std::string nm = attr_str(lt, gt, " style:name=\"");
+                    if (!nm.empty() && !styles_.count(nm)) styles_.emplace(nm, uint32_t(styles_.size() + 1));
+                }
+            } else if (opens(lt, gt + 1, "<table:null-date", 16)) {
+                double d;
+                if (iso_days(attr_str(lt, gt, " table:date-value=\""), d)) null_days_ = int64_t(std::floor(d));
+            }
+        }
+        return !eof;
+    }
+
+    void open_sheet() {
+        sheet_++;
+        row_ = 0;
+        emit_ = (sp_ <= 0 || sheet_ + 1 >= sp_) && (ep_ <= 0 || sheet_ + 1 <= ep_);
+        page_ = Page{};
+        page_.page_id = static_cast<uint32_t>(sheet_);
+        page_.document_id = 0;
+        page_.page_number = sheet_ + 1;
+        page_.width = 0; page_.height = 0;
+        in_sheet_ = true;
+    }
+
+    void close_sheet() {
+        if (emit_) res_.pages.push_back(std::move(page_));
+        res_.page_count++;                               // every sheet, in range or not
+        page_ = Page{};
+        in_sheet_ = emit_ = false;
+    }
+
+    uint32_t style_id(const std::string& nm) {
+        if (nm.empty()) return 0;
+        auto it = styles_.find(nm);
+        if (it != styles_.end()) return it->second;
+        uint32_t id = uint32_t(styles_.size() + 1);   // a common style named directly: numbered after the automatic ones
+        styles_.emplace(nm, id);
+        return id;
+    }
+
+    /* One table:table-row: its cells are read once, then stamped onto each row the repeat stands for. */
+    void row(const char* tag, const char* tag_end, const char* p, const char* end) {
+        uint32_t rep = attr_u32(tag, tag_end, " table:number-rows-repeated=\"", 1);
+        if (row_ >= kMaxRow) return;
+        if (rep > kMaxRow - row_) rep = kMaxRow - row_;
+        cells_.clear();
+        spans_.clear();
+        uint32_t col = 0;   // columns already passed in this row
+        while (p && p < end && col < kMaxCol) {
+            const char* lt = static_cast<const char*>(memmem(p, end - p, "<table:", 7));
+            if (!lt) break;
+            bool covered = opens(lt, end, "<table:covered-table-cell", 25);
+            if (!covered && !opens(lt, end, "<table:table-cell", 17)) { p = lt + 7; continue; }
+            const char* gt = static_cast<const char*>(std::memchr(lt, '>', end - lt));
+            if (!gt) break;
+            const char* body = gt + 1;
+            const char* body_end = body;
+            if (gt[-1] == '/') p = body;
+            else {
+                const char* close = covered ? "</table:covered-table-cell>" : "</table:table-cell>";
+                size_t cl = covered ? 27 : 19;
+                const char* ce = static_cast<const char*>(memmem(body, end - body, close, cl));
+                if (!ce) break;
+                body_end = ce;
+                p = ce + cl;
+            }
+            uint32_t crep = attr_u32(lt, gt, " table:number-columns-repeated=\"", 1);
+            if (crep > kMaxCol - col) crep = kMaxCol - col;
+            if (!covered) cell(lt, gt, body, body_end, col, crep);
+            col += crep;
+        }
+        if (!cells_.empty() || !spans_.empty()) {
+            for (uint32_t r = 0; r < rep; r++) {
+                uint32_t y = row_ + r + 1;
+                for (const BBox& c : cells_) {
+                    page_.bboxes.push_back(c);
+                    page_.bboxes.back().y = y;
+                }
+                for (const Merge& m : spans_)
+                    page_.merges.push_back({int(y), m.c1, int(y) + m.r2 - m.r1, m.c2});   // side-channel
+            }
+            if (!cells_.empty() && row_ + rep > page_.height) page_.height = row_ + rep;
+        }
+        row_ += rep;
+    }
+
+    void cell(const char* tag, const char* tag_end, const char* body, const char* body_end, uint32_t col, uint32_t crep) {
+        uint32_t cs = attr_u32(tag, tag_end, " table:number-columns-spanned=\"", 1);
+        uint32_t rs = attr_u32(tag, tag_end, " table:number-rows-spanned=\"", 1);
+        if (cs > 1 || rs > 1)
+            for (uint32_t k = 0; k < crep; k++)   // r1/r2 relative here; row() places them
+                spans_.push_back({0, int(col + k + 1), int(rs - 1), int(col + k + cs)});
+
+        std::string vt = attr_str(tag, tag_end, " office:value-type=\"");
+        std::string cvt = attr_str(tag, tag_end, " calcext:value-type=\"");
+        std::string f = attr_str(tag, tag_end, " table:formula=\"");
+        text_.clear();
+        if (body < body_end) cell_text(body, body_end, text_);
+        if (vt.empty() && f.empty() && text_.empty()) return;   // padding, however styled
+
+        BBox bb;
+        bb.page_id = static_cast<uint32_t>(sheet_);
+        bb.style_id = style_id(attr_str(tag, tag_end, " table:style-name=\""));
+        bb.y = 0; bb.w = cs; bb.h = rs;
+        if (cvt == "error") {
+            bb.cell_type = BBOX_ERROR;
+            bb.text = text_;
+        } else if (vt == "float" || vt == "percentage" || vt == "currency") {
+            bb.cell_type = BBOX_NUMBER;
+            bb.text = attr_str(tag, tag_end, " office:value=\"");
+            bb.vnum = std::strtod(bb.text.c_str(), nullptr);
+        } else if (vt == "date" || vt == "time") {
+            bb.cell_type = BBOX_NUMBER;
+            bb.text = attr_str(tag, tag_end, vt == "date" ? " office:date-value=\"" : " office:time-value=\"");
+            double d;
+            if (vt == "date" ? iso_days(bb.text, d) : duration_days(bb.text, d)) {
+                double serial = vt == "date" ? d - double(null_days_) : d;
+                bb.vnum = serial;
+                bb.has_vdate = true;
+                bb.vdate = static_cast<int64_t>(std::llround((double(null_days_) + serial) * 86400000.0)) * 1000;
+            }
+        } else if (vt == "boolean") {
+            std::string v = attr_str(tag, tag_end, " office:boolean-value=\"");
+            bb.cell_type = BBOX_BOOL;
+            bb.vbool = v == "true" || v == "1";
+            bb.text = bb.vbool ? "1" : "0";
+        } else {
+            bb.cell_type = BBOX_STRING;
+            const char* v; size_t n;
+            if (attr(tag, tag_end, " office:string-value=\"", v, n)) put_text(bb.text, v, v + n);
+            else bb.text = text_;
+        }
+        if (!f.empty()) { a1_formula(f, formula_); bb.formula = formula_; }
+
+        for (uint32_t k = 0; k < crep; k++) {
+            bb.x = col + k + 1;
+            cells_.push_back(bb);
+        }
+        if (col + crep > page_.width) page_.width = col + crep;
+    }
+};
+
+}  // namespace
+
+BBoxResult extract_ods(const void* buf, size_t len, int start_page, int end_page) {
+    BBoxResult result;
+    result.source_type = "ods";
+    result.page_count = -1;
+    XlsxPackage pkg;
+    if (!pkg.open_mem(buf, len)) return result;
+
+    try {
+        if (const std::string* mt = pkg.part("mimetype"))
+            if (mt->compare(0, 46, "application/vnd.oasis.opendocument.spreadsheet") != 0) return result;
+        if (const std::string* mf = pkg.part("META-INF/manifest.xml"))
+            if (mf->find("encryption-data") != std::string::npos) return result;   /* ODF package encryption: not read */
+        int idx = mz_zip_reader_locate_file(&pkg.z, "content.xml", nullptr, 0);
+        if (idx < 0) return result;
+        mz_zip_reader_extract_iter_state* it = mz_zip_reader_extract_iter_new(&pkg.z, mz_uint(idx), 0);
+        if (!it) return result;
+
+        result.page_count = 0;
+        Content content(result, start_page, end_page);
+        std::vector<char> chunk(kChunk);
+        size_t got;
+        do got = mz_zip_reader_extract_iter_read(it, chunk.data(), chunk.size());
+        while (content.feed(chunk.data(), got, got == 0));
+        /* the iterator also ends on an inflate or CRC error, which free() reports */
+        if (!mz_zip_reader_extract_iter_free(it)) { result.pages.clear(); result.page_count = -1; }
+    } catch (...) {
+        result.pages.clear();
+        result.page_count = -1;
+    }
+    return result;
+}
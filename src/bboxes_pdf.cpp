@@ -6,16 +6,28 @@
    a resolved pointer, so the call sites below are unchanged. */
 #include "pdfium_dyn.h"
 
+#include "sha256.h"
+
+#include <miniz.h>
 #include <nlohmann/json.hpp>
 #include <pugixml.hpp>
 
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include <algorithm>
 #include <cctype>
 #include <cmath>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <map>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 /* PDFium is not thread-safe for document operations.  All calls that
@@ -45,18 +57,54 @@ static void append_codepoint(std::string& s, unsigned int cp) {
     }
 }
 
-struct CharInfo {
-    uint32_t font_id;
-    uint32_t style_id;
-    double font_size;
-    double left, top, right, bottom;
-    unsigned int codepoint;
-};
-
-static bool same_style(const CharInfo& a, const CharInfo& b) {
-    return a.style_id == b.style_id;
+/* Encode `n` codepoints onto `s` in one go: size for the worst case once,
+   write through a raw pointer, trim to what was written. */
+static void append_codepoints(std::string& s, const uint32_t* cps, size_t n) {
+    size_t at = s.size();
+    s.resize(at + n * 4);
+    char* o = &s[at];
+    for (size_t k = 0; k < n; ++k) {
+        uint32_t cp = cps[k];
+        if (cp < 0x80) {
+            *o++ = static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            *o++ = static_cast<char>(0xC0 | (cp >> 6));
+            *o++ = static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            *o++ = static_cast<char>(0xE0 | (cp >> 12));
+            *o++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            *o++ = static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            *o++ = static_cast<char>(0xF0 | (cp >> 18));
+            *o++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            *o++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            *o++ = static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+    s.resize(static_cast<size_t>(o - s.data()));
 }
 
+/* One page's characters, struct-of-arrays: the break pass below reads a few
+   fields for every character, and contiguous columns let it run as plain
+   vectorizable loops instead of striding over 56-byte records. */
+struct PageChars {
+    std::vector<uint32_t> style_id;
+    std::vector<uint32_t> codepoint;
+    std::vector<double>   font_size;
+    std::vector<double>   left, top, right, bottom;
+
+    size_t size() const { return codepoint.size(); }
+    void reserve(size_t n) {
+        style_id.reserve(n); codepoint.reserve(n); font_size.reserve(n);
+        left.reserve(n); top.reserve(n); right.reserve(n); bottom.reserve(n);
+    }
+    void push(uint32_t sid, uint32_t cp, double fs,
+              double l, double t, double r, double b) {
+        style_id.push_back(sid); codepoint.push_back(cp); font_size.push_back(fs);
+        left.push_back(l); top.push_back(t); right.push_back(r); bottom.push_back(b);
+    }
+};
+
 /* Determine whether two characters are on the same visual line.
    Compares top-edge positions with a tolerance of half the line height.
 
@@ -70,66 +118,281 @@ static bool same_style(const CharInfo& a, const CharInfo& b) {
    subscripts whose top offset exceeds half the line height will be treated as
    separate lines.  This is usually correct (footnote markers, exponents) but
    will break for PDFs that render fractions as stacked inline glyphs. */
-static bool same_line(const CharInfo& a, const CharInfo& b) {
-    double line_height = a.bottom - a.top;
-    if (line_height <= 0) line_height = a.font_size;
-    double fs = a.font_size;
+static bool same_line(const PageChars& c, size_t a, size_t b) {
+    double line_height = c.bottom[a] - c.top[a];
+    if (line_height <= 0) line_height = c.font_size[a];
+    double fs = c.font_size[a];
     if (fs > 1.0 && fs > line_height) line_height = fs;
-    return std::fabs(a.top - b.top) < line_height * 0.5;
-}
-
-/* Conservative character-gap test: should these two adjacent characters
-   be part of the same bbox?
-
-   Design decision: this layer is deliberately conservative.  It only
-   merges characters that are unambiguously part of the same glyph run
-   (inter-character gaps typical of kerning and proportional spacing).
-   Anything wider — including normal inter-word spaces — breaks the run
-   and starts a new bbox.
-
-   The rationale: too many bboxes is a better failure mode than too few.
-   Downstream SQL/Python can always merge adjacent bboxes on the same
-   line (it's a linear window-function scan over sorted coordinates).
-   But if the C++ layer merges two table cells into one bbox, the column
-   boundary is destroyed and can't be recovered without re-parsing text.
-
-   The 0.35× font_size threshold is the original value and matches the
-   typical inter-character gap in proportional fonts (0.05–0.25× em).
-   Inter-word gaps are typically 0.3–0.5× em, so they will produce a
-   new bbox.  This means every word becomes its own bbox — that's fine,
-   the downstream coalescing layer has the full spatial context (column
-   alignment, row structure) to decide which words belong together.
-
-   FPDFText_GetFontSize returns the raw font dictionary size, which is
-   often 1.0 when the actual rendered size comes from the text matrix
-   (Tm) rather than the font resource.  This is common in government
-   forms (IRS W-4), Adobe InDesign exports, and some LaTeX-generated
-   PDFs.  When font_size is 1.0, the 0.35× threshold collapses to
-   0.35 points and nothing coalesces — every character becomes its own
-   bbox.  Fix: fall back to the character's bbox height (bottom - top),
-   which always reflects the rendered size.  We also fall back when
-   char_h drastically exceeds font_size (> 1.5×), which happens when
-   font_size is a small "design unit" and the text matrix scales it up.
-
-   FRAGILE: if a PDF genuinely has 1pt text (fine-print footnotes), this
-   heuristic uses bbox height instead, which should be similar.  But if
-   bbox height is inflated by a large descender/ascender on a particular
-   glyph, the threshold will be too generous and may merge characters
-   that should be separate.  We haven't seen this in practice. */
-static bool gap_ok(const CharInfo& prev, const CharInfo& cur) {
-    double gap = cur.left - prev.right;
-    double fs = prev.font_size;
-    double char_h = prev.bottom - prev.top;
-    if (char_h > 0 && (fs <= 1.0 || char_h > fs * 1.5))
-        fs = char_h;
-    return gap < fs * 0.35;
+    return std::fabs(c.top[a] - c.top[b]) < line_height * 0.5;
+}
+
+/* Pairwise break mask: brk[i] = 1 when character i cannot continue a run
+   that reaches character i-1 — a style change, or a character gap too wide
+   for one glyph run, written branch-free so the loop vectorizes.
+   same_line is not part of it: it compares against the run's FIRST
+   character, so it stays in the sequential walk. Style equality with the
+   previous character is equivalent to equality with the first, since every
+   character in between already matched. */
+static void break_mask(const PageChars& c, std::vector<uint8_t>& brk) {
+    const size_t n = c.size();
+    brk.assign(n, 1);
+    const uint32_t* sid = c.style_id.data();
+    const double* fsz = c.font_size.data();
+    const double* l = c.left.data();
+    const double* t = c.top.data();
+    const double* r = c.right.data();
+    const double* b = c.bottom.data();
+    uint8_t* m = brk.data();
+    for (size_t i = 1; i < n; ++i) {
+        /* The gap test is deliberately conservative. It only merges
+           characters that are unambiguously part of the same glyph run
+           (inter-character gaps typical of kerning and proportional
+           spacing). Anything wider — including normal inter-word spaces —
+           breaks the run and starts a new bbox.
+
+           The rationale: too many bboxes is a better failure mode than too
+           few. Downstream SQL/Python can always merge adjacent bboxes on the
+           same line (it's a linear window-function scan over sorted
+           coordinates). But if the C++ layer merges two table cells into one
+           bbox, the column boundary is destroyed and can't be recovered
+           without re-parsing text.
+
+           The 0.35× font_size threshold is the original value and matches the
+           typical inter-character gap in proportional fonts (0.05–0.25× em).
+           Inter-word gaps are typically 0.3–0.5× em, so they will produce a
+           new bbox. This means every word becomes its own bbox — that's fine,
+           the downstream coalescing layer has the full spatial context
+           (column alignment, row structure) to decide which words belong
+           together.
+
+           FPDFText_GetFontSize returns the raw font dictionary size, which is
+           often 1.0 when the actual rendered size comes from the text matrix
+           (Tm) rather than the font resource. This is common in government
+           forms (IRS W-4), Adobe InDesign exports, and some LaTeX-generated
+           PDFs. When font_size is 1.0, the 0.35× threshold collapses to 0.35
+           points and nothing coalesces — every character becomes its own
+           bbox. Fix: fall back to the character's bbox height (bottom - top),
+           which always reflects the rendered size. We also fall back when
+           char_h drastically exceeds font_size (> 1.5×), which happens when
+           font_size is a small "design unit" and the text matrix scales it up.
+
+           FRAGILE: if a PDF genuinely has 1pt text (fine-print footnotes),
+           this heuristic uses bbox height instead, which should be similar.
+           But if bbox height is inflated by a large descender/ascender on a
+           particular glyph, the threshold will be too generous and may merge
+           characters that should be separate. We haven't seen this in
+           practice. */
+        double fs = fsz[i - 1];
+        double char_h = b[i - 1] - t[i - 1];
+        fs = (char_h > 0 && (fs <= 1.0 || char_h > fs * 1.5)) ? char_h : fs;
+        bool gap_bad = !(l[i] - r[i - 1] < fs * 0.35);
+        m[i] = static_cast<uint8_t>((sid[i] != sid[i - 1]) | gap_bad);
+    }
+}
+
+/* ── ruling lines (path objects) ────────────────────────────────────────
+   Table borders and rules are the strongest grid signal a PDF carries, and
+   they live in path objects, not text. Each visible path is reduced to what
+   a grid detector can use: horizontal and vertical segments, and axis-aligned
+   rectangles. Curves and diagonals are dropped. A rectangle thinner than
+   kThinRule is a rule drawn as a filled box (the common way to paint a cell
+   border) and is reported as a line along its long axis. Form XObjects are
+   descended into, composing their matrices, so rules inside a reused table
+   template are not lost. */
+
+namespace {
+
+constexpr double kAxisEps  = 0.5;   /* pt: max drift for a segment to count as h/v */
+constexpr double kThinRule = 2.0;   /* pt: thinner rectangles are lines */
+constexpr int    kMaxFormDepth = 8;
+
+struct Affine {
+    double a = 1, b = 0, c = 0, d = 1, e = 0, f = 0;
+    void apply(double x, double y, double& ox, double& oy) const {
+        ox = a * x + c * y + e;
+        oy = b * x + d * y + f;
+    }
+};
+
+/* `inner` then `outer` — PDF's row-vector convention (inner × outer). */
+Affine compose(const Affine& i, const Affine& o) {
+    Affine m;
+    m.a = i.a * o.a + i.b * o.c;  m.b = i.a * o.b + i.b * o.d;
+    m.c = i.c * o.a + i.d * o.c;  m.d = i.c * o.b + i.d * o.d;
+    m.e = i.e * o.a + i.f * o.c + o.e;
+    m.f = i.e * o.b + i.f * o.d + o.f;
+    return m;
+}
+
+Affine object_matrix(FPDF_PAGEOBJECT obj) {
+    FS_MATRIX fm;
+    Affine m;
+    if (FPDFPageObj_GetMatrix(obj, &fm)) m = {fm.a, fm.b, fm.c, fm.d, fm.e, fm.f};
+    return m;
+}
+
+struct Pt { double x, y; };
+
+void push_line(std::vector<PageRule>& out, Pt p, Pt q, double lw, uint32_t rgba) {
+    double dx = std::fabs(q.x - p.x), dy = std::fabs(q.y - p.y);
+    if (dy <= kAxisEps && dx > kAxisEps) {
+        out.push_back({RULE_HLINE, std::min(p.x, q.x), (p.y + q.y) / 2, dx, 0, lw, rgba});
+    } else if (dx <= kAxisEps && dy > kAxisEps) {
+        out.push_back({RULE_VLINE, (p.x + q.x) / 2, std::min(p.y, q.y), 0, dy, lw, rgba});
+    }
+}
+
+/* One subpath, already in page top-left space. */
+void flush_subpath(std::vector<Pt>& pts, bool closed, bool curved, bool stroked,
+                   double lw, uint32_t rgba, std::vector<PageRule>& out) {
+    if (curved || pts.size() < 2) { pts.clear(); return; }
+    if (closed || (pts.size() > 2 && std::fabs(pts.front().x - pts.back().x) <= kAxisEps &&
+                   std::fabs(pts.front().y - pts.back().y) <= kAxisEps)) {
+        if (std::fabs(pts.front().x - pts.back().x) > kAxisEps ||
+            std::fabs(pts.front().y - pts.back().y) > kAxisEps)
+            pts.push_back(pts.front());
+        closed = true;
+    }
+
+    /* Axis-aligned rectangle: four edges, each h or v, alternating. */
+    if (closed && pts.size() == 5) {
+        bool rect = true;
+        for (size_t k = 0; k < 4 && rect; ++k) {
+            double dx = std::fabs(pts[k + 1].x - pts[k].x), dy = std::fabs(pts[k + 1].y - pts[k].y);
+            bool h = dy <= kAxisEps, v = dx <= kAxisEps;
+            bool h0 = std::fabs(pts[1].y - pts[0].y) <= kAxisEps;
+            rect = (h != v) && (h == ((k % 2 == 0) == h0));
+        }
+        if (rect) {
+            double x0 = pts[0].x, x1 = pts[0].x, y0 = pts[0].y, y1 = pts[0].y;
+            for (const Pt& p : pts) {
+                x0 = std::min(x0, p.x); x1 = std::max(x1, p.x);
+                y0 = std::min(y0, p.y); y1 = std::max(y1, p.y);
+            }
+            double w = x1 - x0, h = y1 - y0;
+            if (h <= kThinRule && w > h)
+                out.push_back({RULE_HLINE, x0, (y0 + y1) / 2, w, 0, std::max(h, lw), rgba});
+            else if (w <= kThinRule && h > w)
+                out.push_back({RULE_VLINE, (x0 + x1) / 2, y0, 0, h, std::max(w, lw), rgba});
+            else if (w > kThinRule && h > kThinRule)
+                out.push_back({RULE_RECT, x0, y0, w, h, lw, rgba});
+            pts.clear();
+            return;
+        }
+    }
+
+    /* Anything else only draws visible edges when stroked. */
+    if (stroked)
+        for (size_t k = 0; k + 1 < pts.size(); ++k) push_line(out, pts[k], pts[k + 1], lw, rgba);
+    pts.clear();
+}
+
+void path_rules(FPDF_PAGEOBJECT obj, const Affine& m, double page_height,
+                std::vector<PageRule>& out) {
+    int fill_mode = FPDF_FILLMODE_NONE;
+    FPDF_BOOL stroke = 0;
+    if (!FPDFPath_GetDrawMode(obj, &fill_mode, &stroke)) return;
+    if (fill_mode == FPDF_FILLMODE_NONE && !stroke) return;   /* clipping helper */
+
+    unsigned int r = 0, g = 0, b = 0, a = 255;
+    float lw = 0;
+    if (stroke) {
+        FPDFPageObj_GetStrokeColor(obj, &r, &g, &b, &a);
+        FPDFPageObj_GetStrokeWidth(obj, &lw);
+    } else {
+        FPDFPageObj_GetFillColor(obj, &r, &g, &b, &a);
+    }
+    if (a == 0) return;                                        /* fully transparent */
+    uint32_t rgba = (r & 0xFF) << 24 | (g & 0xFF) << 16 | (b & 0xFF) << 8 | (a & 0xFF);
+    double width = lw * std::sqrt(std::fabs(m.a * m.d - m.b * m.c));  /* user → page units */
+
+    std::vector<Pt> pts;
+    bool closed = false, curved = false;
+    int n = FPDFPath_CountSegments(obj);
+    for (int k = 0; k < n; ++k) {
+        FPDF_PATHSEGMENT seg = FPDFPath_GetPathSegment(obj, k);
+        float sx = 0, sy = 0;
+        if (!seg || !FPDFPathSegment_GetPoint(seg, &sx, &sy)) continue;
+        int type = FPDFPathSegment_GetType(seg);
+        if (type == FPDF_SEGMENT_MOVETO) {
+            flush_subpath(pts, closed, curved, stroke, width, rgba, out);
+            closed = curved = false;
+        } else if (type == FPDF_SEGMENT_BEZIERTO) {
+            curved = true;
+        } else if (type != FPDF_SEGMENT_LINETO) {
+            continue;
+        }
+        Pt p;
+        m.apply(sx, sy, p.x, p.y);
+        p.y = page_height - p.y;
+        pts.push_back(p);
+        if (FPDFPathSegment_GetClose(seg)) closed = true;
+    }
+    flush_subpath(pts, closed, curved, stroke, width, rgba, out);
+}
+
+/* Rules from one page-level object: a path, or a form XObject to descend. */
+void collect_rules(FPDF_PAGEOBJECT obj, int type, const Affine& outer, double page_height,
+                   std::vector<PageRule>& out, int depth = 0) {
+    if (type == FPDF_PAGEOBJ_PATH) {
+        path_rules(obj, compose(object_matrix(obj), outer), page_height, out);
+    } else if (type == FPDF_PAGEOBJ_FORM && depth < kMaxFormDepth) {
+        Affine form = compose(object_matrix(obj), outer);
+        int n = FPDFFormObj_CountObjects(obj);
+        for (int k = 0; k < n; ++k) {
+            FPDF_PAGEOBJECT child = FPDFFormObj_GetObject(obj, static_cast<unsigned long>(k));
+            if (child) collect_rules(child, FPDFPageObj_GetType(child), form, page_height, out, depth + 1);
+        }
+    }
+}
+
+} /* namespace */
+
+/* Every rule on a loaded page (the char-level extractor's object pass, taken
+   only when the open asked for rules). */
+static void page_rules(FPDF_PAGE page, double page_height, std::vector<PageRule>& out) {
+    int n = FPDFPage_CountObjects(page);
+    for (int k = 0; k < n; ++k) {
+        FPDF_PAGEOBJECT obj = FPDFPage_GetObject(page, k);
+        int type = FPDFPageObj_GetType(obj);
+        if (type == FPDF_PAGEOBJ_PATH || type == FPDF_PAGEOBJ_FORM)
+            collect_rules(obj, type, Affine{}, page_height, out);
+    }
 }
 
 /* ── extract one page ───────────────────────────────────────────────── */
 
+/* What a font resolves to: interned name plus bold/italic from its flags, with
+   the name scan as fallback. It depends only on the font, never on the glyph,
+   so both extractors resolve each FPDF_FONT once per page and reuse it. */
+struct ResolvedFont {
+    uint32_t font_id;
+    bool     bold;
+    bool     italic;
+};
+
+/* Character path: GetFontInfo reports the font's base name and flags for
+   character `ci`; only called on the first character of each font. */
+static ResolvedFont resolve_char_font(FPDF_TEXTPAGE text_page, int ci, FontTable& fonts) {
+    char name[256] = {};
+    int font_flags = 0;
+    FPDFText_GetFontInfo(text_page, ci, name, sizeof(name), &font_flags);
+    uint32_t fid = fonts.intern(name);
+
+    bool bold   = (font_flags >> 18) & 1;
+    bool italic = (font_flags >> 6) & 1;
+    /* Fallback: infer bold/italic from the font name when flags are absent */
+    if (!bold || !italic) {
+        const FontNameTraits& traits = fonts.name_traits(fid);
+        if (!bold)   bold   = traits.bold;
+        if (!italic) italic = traits.italic;
+    }
+    return {fid, bold, italic};
+}
+
 static void extract_page(FPDF_DOCUMENT doc, int pi,
                           FontTable& fonts, StyleTable& styles,
-                          Page& out_page) {
+                          Page& out_page, bool rules) {
     FPDF_PAGE page = FPDF_LoadPage(doc, pi);
     if (!page) return;
 
@@ -141,8 +404,16 @@ static void extract_page(FPDF_DOCUMENT doc, int pi,
     if (!text_page) { FPDF_ClosePage(page); return; }
 
     int char_count = FPDFText_CountChars(text_page);
-    std::vector<CharInfo> chars;
-    chars.reserve(char_count);
+    PageChars chars;
+    chars.reserve(char_count > 0 ? static_cast<size_t>(char_count) : 0);
+
+    /* Keyed by the character's font object (nullptr for characters PDFium
+       generated, which have none — GetFontInfo reports "" for those too).
+       Consecutive characters nearly always share a font, so check the last
+       one before the map. */
+    std::unordered_map<FPDF_FONT, ResolvedFont> font_cache;
+    FPDF_FONT last_font = nullptr;
+    const ResolvedFont* last = nullptr;
 
     for (int ci = 0; ci < char_count; ++ci) {
         unsigned int cp = FPDFText_GetUnicode(text_page, ci);
@@ -154,70 +425,63 @@ static void extract_page(FPDF_DOCUMENT doc, int pi,
         double tl_y = page_height - top;
         double br_y = page_height - bottom;
 
-        char font_name_buf[256] = {};
-        int font_flags = 0;
-        FPDFText_GetFontInfo(text_page, ci, font_name_buf, sizeof(font_name_buf), &font_flags);
+        FPDF_PAGEOBJECT obj = FPDFText_GetTextObject(text_page, ci);
+        FPDF_FONT font = obj ? FPDFTextObj_GetFont(obj) : nullptr;
+        if (!last || font != last_font) {
+            auto fit = font_cache.find(font);
+            if (fit == font_cache.end())
+                fit = font_cache.emplace(font, resolve_char_font(text_page, ci, fonts)).first;
+            last_font = font;
+            last = &fit->second;
+        }
         double font_size = FPDFText_GetFontSize(text_page, ci);
 
         unsigned int r = 0, g = 0, b = 0, a = 255;
         FPDFText_GetFillColor(text_page, ci, &r, &g, &b, &a);
 
-        uint32_t fid = fonts.intern(font_name_buf);
-
-        bool bold   = (font_flags >> 18) & 1;
-        bool italic = (font_flags >> 6) & 1;
-        /* Fallback: infer bold/italic from the font name when flags are absent */
-        if (!bold || !italic) {
-            FontNameTraits traits = font_name_traits(font_name_buf);
-            if (!bold)   bold   = traits.bold;
-            if (!italic) italic = traits.italic;
-        }
-        std::string weight = bold ? "bold" : "normal";
+        std::string weight = last->bold ? "bold" : "normal";
         std::string color  = color_string(r, g, b, a);
 
-        uint32_t sid = styles.intern(fid, font_size, color, weight, italic, false);
-        chars.push_back({fid, sid, font_size, left, tl_y, right, br_y, cp});
+        uint32_t sid = styles.intern(last->font_id, font_size, color, weight, last->italic, false);
+        chars.push(sid, cp, font_size, left, tl_y, right, br_y);
     }
 
-    for (size_t i = 0; i < chars.size(); ) {
-        const CharInfo& first = chars[i];
+    std::vector<uint8_t> brk;
+    break_mask(chars, brk);
 
-        if (first.codepoint == ' ' || first.codepoint == '\t' ||
-            first.codepoint == '\r' || first.codepoint == '\n') {
+    const uint32_t* cps = chars.codepoint.data();
+    for (size_t i = 0; i < chars.size(); ) {
+        uint32_t cp0 = cps[i];
+        if (cp0 == ' ' || cp0 == '\t' || cp0 == '\r' || cp0 == '\n') {
             ++i;
             continue;
         }
 
-        double run_left = first.left, run_top = first.top;
-        double run_right = first.right, run_bottom = first.bottom;
-        std::string text;
-        append_codepoint(text, first.codepoint);
+        double run_left = chars.left[i], run_top = chars.top[i];
+        double run_right = chars.right[i], run_bottom = chars.bottom[i];
 
         size_t j = i + 1;
-        while (j < chars.size()) {
-            const CharInfo& cur = chars[j];
-            if (!same_style(first, cur) || !same_line(first, cur)) break;
-            if (!gap_ok(chars[j - 1], cur)) break;
-            append_codepoint(text, cur.codepoint);
-            if (cur.right  > run_right)  run_right  = cur.right;
-            if (cur.bottom > run_bottom) run_bottom = cur.bottom;
-            if (cur.left   < run_left)   run_left   = cur.left;
-            if (cur.top    < run_top)    run_top    = cur.top;
+        while (j < chars.size() && !brk[j] && same_line(chars, i, j)) {
+            if (chars.right[j]  > run_right)  run_right  = chars.right[j];
+            if (chars.bottom[j] > run_bottom) run_bottom = chars.bottom[j];
+            if (chars.left[j]   < run_left)   run_left   = chars.left[j];
+            if (chars.top[j]    < run_top)    run_top    = chars.top[j];
             ++j;
         }
 
-        while (!text.empty() && (text.back() == ' ' || text.back() == '\t'))
-            text.pop_back();
+        /* Trailing blanks still widen the box (as before), but are not text. */
+        size_t end = j;
+        while (end > i && (cps[end - 1] == ' ' || cps[end - 1] == '\t')) --end;
 
-        if (!text.empty()) {
+        if (end > i) {
             BBox bb;
             bb.page_id  = out_page.page_id;
-            bb.style_id = first.style_id;
+            bb.style_id = chars.style_id[i];
             bb.x = run_left;
             bb.y = run_top;
             bb.w = run_right - run_left;
             bb.h = run_bottom - run_top;
-            bb.text = std::move(text);
+            append_codepoints(bb.text, cps + i, end - i);
             out_page.bboxes.push_back(std::move(bb));
         }
 
@@ -225,6 +489,7 @@ static void extract_page(FPDF_DOCUMENT doc, int pi,
     }
 
     FPDFText_ClosePage(text_page);
+    if (rules) page_rules(page, page_height, out_page.rules);
     FPDF_ClosePage(page);
 }
 
@@ -238,9 +503,29 @@ static void extract_page(FPDF_DOCUMENT doc, int pi,
    encodes it as one text object).  But for born-digital PDFs, text
    objects almost always correspond to natural word boundaries. */
 
+/* Object path: family name, flags and weight, once per FPDF_FONT per page. */
+static ResolvedFont resolve_obj_font(FPDF_FONT font, FontTable& fonts) {
+    char name[256] = {};
+    if (font) FPDFFont_GetFamilyName(font, name, sizeof(name));
+    uint32_t fid = fonts.intern(name);
+
+    int font_flags = font ? FPDFFont_GetFlags(font) : 0;
+    bool bold   = (font_flags >> 18) & 1;
+    /* Also check font weight as a fallback for bold detection */
+    if (!bold && font && FPDFFont_GetWeight(font) >= 700) bold = true;
+    bool italic = (font_flags >> 6) & 1;
+    /* Final fallback: infer bold/italic from the font name */
+    if (!bold || !italic) {
+        const FontNameTraits& traits = fonts.name_traits(fid);
+        if (!bold)   bold   = traits.bold;
+        if (!italic) italic = traits.italic;
+    }
+    return {fid, bold, italic};
+}
+
 static void extract_page_objects(FPDF_DOCUMENT doc, int pi,
                                   FontTable& fonts, StyleTable& styles,
-                                  Page& out_page) {
+                                  Page& out_page, bool rules) {
     FPDF_PAGE page = FPDF_LoadPage(doc, pi);
     if (!page) return;
 
@@ -248,29 +533,56 @@ static void extract_page_objects(FPDF_DOCUMENT doc, int pi,
     out_page.height = FPDF_GetPageHeight(page);
     double page_height = out_page.height;
 
-    /* Need a TEXTPAGE for FPDFTextObj_GetText */
-    FPDF_TEXTPAGE text_page = FPDFText_LoadPage(page);
-
+    /* Pre-pass: keep the text objects, and (when asked for) reduce paths and
+       forms to ruling lines on the way. Paths and images usually outnumber text
+       on a report page, and this lets the bbox vector be sized once. */
     int obj_count = FPDFPage_CountObjects(page);
-
+    std::vector<FPDF_PAGEOBJECT> text_objs;
+    text_objs.reserve(obj_count > 0 ? obj_count : 0);
     for (int oi = 0; oi < obj_count; ++oi) {
         FPDF_PAGEOBJECT obj = FPDFPage_GetObject(page, oi);
-        if (FPDFPageObj_GetType(obj) != FPDF_PAGEOBJ_TEXT) continue;
+        int type = FPDFPageObj_GetType(obj);
+        if (type == FPDF_PAGEOBJ_TEXT) text_objs.push_back(obj);
+        else if (rules) collect_rules(obj, type, Affine{}, page_height, out_page.rules);
+    }
+    if (text_objs.empty()) { FPDF_ClosePage(page); return; }
+    out_page.bboxes.reserve(out_page.bboxes.size() + text_objs.size());
 
+    /* Need a TEXTPAGE for FPDFTextObj_GetText */
+    FPDF_TEXTPAGE text_page = FPDFText_LoadPage(page);
+
+    /* Per-page scratch, reused across objects. FPDF_FONT handles are only
+       guaranteed while the page is loaded, so the font cache lives here too.
+       The style cache is a short list — a page rarely has more than a handful
+       of (font, weight, italic, size, colour) combinations — consulted before
+       the string-keyed StyleTable::intern. Its key is everything intern is
+       given: the font id names the family only, so a bold and a regular face
+       of one family share it. */
+    std::vector<unsigned short> utf16(256);
+    std::string text;
+    std::unordered_map<FPDF_FONT, ResolvedFont> font_cache;
+    struct StyleMemo { uint32_t font_id; bool bold, italic; double size; uint32_t rgba; uint32_t style_id; };
+    std::vector<StyleMemo> style_cache;
+
+    for (FPDF_PAGEOBJECT obj : text_objs) {
         /* ── Text content ── */
-        /* First call with NULL to get required buffer length */
-        unsigned long text_len = FPDFTextObj_GetText(obj, text_page, NULL, 0);
+        /* One call when the scratch buffer is big enough; PDFium leaves the
+           buffer untouched and reports the needed length when it is not. */
+        unsigned long text_len = FPDFTextObj_GetText(obj, text_page, utf16.data(),
+                                                     static_cast<unsigned long>(utf16.size() * 2));
         if (text_len <= 2) continue;  /* empty or just null terminator (UTF-16) */
+        if (text_len > utf16.size() * 2) {
+            utf16.resize((text_len + 1) / 2);
+            FPDFTextObj_GetText(obj, text_page, utf16.data(), text_len);
+        }
+        size_t units = text_len / 2;   /* byte count → UTF-16 units, incl. NUL */
 
-        std::vector<unsigned short> utf16(text_len);
-        FPDFTextObj_GetText(obj, text_page, utf16.data(), text_len);
-
-        /* Convert UTF-16 to UTF-8, skip whitespace-only */
-        std::string text;
-        for (unsigned long k = 0; k < text_len - 1; ++k) {
+        /* Convert UTF-16 to UTF-8, skipping leading blanks */
+        text.clear();
+        for (size_t k = 0; k + 1 < units; ++k) {
             unsigned int cp = utf16[k];
             /* Handle surrogate pairs */
-            if (cp >= 0xD800 && cp <= 0xDBFF && k + 1 < text_len - 1) {
+            if (cp >= 0xD800 && cp <= 0xDBFF && k + 2 < units) {
                 unsigned int lo = utf16[k + 1];
                 if (lo >= 0xDC00 && lo <= 0xDFFF) {
                     cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
@@ -278,6 +590,7 @@ static void extract_page_objects(FPDF_DOCUMENT doc, int pi,
                 }
             }
             if (cp == 0) break;
+            if (text.empty() && (cp == ' ' || cp == '\t')) continue;
             append_codepoint(text, cp);
         }
 
@@ -285,11 +598,6 @@ static void extract_page_objects(FPDF_DOCUMENT doc, int pi,
         while (!text.empty() && (text.back() == ' ' || text.back() == '\t'
                                  || text.back() == '\r' || text.back() == '\n'))
             text.pop_back();
-        /* Trim leading whitespace */
-        size_t start = 0;
-        while (start < text.size() && (text[start] == ' ' || text[start] == '\t'))
-            ++start;
-        if (start > 0) text.erase(0, start);
 
         if (text.empty()) continue;
 
@@ -304,38 +612,33 @@ static void extract_page_objects(FPDF_DOCUMENT doc, int pi,
 
         /* ── Font / style ── */
         FPDF_FONT font = FPDFTextObj_GetFont(obj);
-        char font_name_buf[256] = {};
-        if (font) {
-            FPDFFont_GetFamilyName(font, font_name_buf, sizeof(font_name_buf));
-        }
+        auto fit = font_cache.find(font);
+        if (fit == font_cache.end())
+            fit = font_cache.emplace(font, resolve_obj_font(font, fonts)).first;
+        const ResolvedFont& of = fit->second;
+
         float font_size_f = 0;
         FPDFTextObj_GetFontSize(obj, &font_size_f);
-        double font_size = static_cast<double>(font_size_f);
         /* Font size fallback: use bbox height if reported size is bogus */
-        if (font_size <= 1.0 && bb_h > 1.0) font_size = bb_h;
-
-        int font_flags = font ? FPDFFont_GetFlags(font) : 0;
-        bool bold   = (font_flags >> 18) & 1;
-        /* Also check font weight as a fallback for bold detection */
-        if (!bold && font) {
-            int weight = FPDFFont_GetWeight(font);
-            if (weight >= 700) bold = true;
-        }
-        bool italic = (font_flags >> 6) & 1;
-        /* Final fallback: infer bold/italic from the font name */
-        if (!bold || !italic) {
-            FontNameTraits traits = font_name_traits(font_name_buf);
-            if (!bold)   bold   = traits.bold;
-            if (!italic) italic = traits.italic;
-        }
+        if (font_size_f <= 1.0f && bb_h > 1.0) font_size_f = static_cast<float>(bb_h);
 
         unsigned int r = 0, g = 0, b = 0, a = 255;
         FPDFPageObj_GetFillColor(obj, &r, &g, &b, &a);
-
-        uint32_t fid = fonts.intern(font_name_buf);
-        std::string weight = bold ? "bold" : "normal";
-        std::string color  = color_string(r, g, b, a);
-        uint32_t sid = styles.intern(fid, font_size, color, weight, italic, false);
+        uint32_t rgba = (r & 0xFF) << 24 | (g & 0xFF) << 16 | (b & 0xFF) << 8 | (a & 0xFF);
+
+        const double font_size = static_cast<double>(font_size_f);
+        uint32_t sid = UINT32_MAX;
+        for (const StyleMemo& m : style_cache)
+            if (m.font_id == of.font_id && m.bold == of.bold && m.italic == of.italic &&
+                m.size == font_size && m.rgba == rgba) {
+                sid = m.style_id;
+                break;
+            }
+        if (sid == UINT32_MAX) {
+            sid = styles.intern(of.font_id, font_size, color_string(r, g, b, a),
+                                of.bold ? "bold" : "normal", of.italic, false);
+            style_cache.push_back({of.font_id, of.bold, of.italic, font_size, rgba, sid});
+        }
 
         BBox bb;
         bb.page_id  = out_page.page_id;
@@ -344,7 +647,7 @@ static void extract_page_objects(FPDF_DOCUMENT doc, int pi,
         bb.y = bb_y;
         bb.w = bb_w;
         bb.h = bb_h;
-        bb.text = std::move(text);
+        bb.text = text;
         out_page.bboxes.push_back(std::move(bb));
     }
 
@@ -352,6 +655,117 @@ static void extract_page_objects(FPDF_DOCUMENT doc, int pi,
     FPDF_ClosePage(page);
 }
 
+/* ── file-backed source ─────────────────────────────────────────────────
+   Block reader for FPDF_LoadCustomDocument: PDFium requests only the byte
+   ranges it needs (trailer, xref, the objects of the pages actually loaded),
+   so a page range out of a multi-GB scan touches a few hundred KB instead of
+   the whole file. Its requests are small and heavily overlapping — the xref
+   and the page tree are re-read for every page — so reads go through a small
+   LRU of aligned blocks rather than straight to fread. */
+
+namespace {
+
+struct PdfFile {
+    static constexpr size_t kBlock = 64 * 1024;
+    static constexpr size_t kSlots = 16;         /* 1 MiB resident at most */
+
+    FILE* fp = nullptr;
+    unsigned long size = 0;
+    FPDF_FILEACCESS access{};
+
+    ~PdfFile() { if (fp) fclose(fp); }
+
+    bool open(const char* path) {
+        fp = fopen(path, "rb");
+        if (!fp) return false;
+        if (fseeko(fp, 0, SEEK_END) != 0) return false;
+        off_t sz = ftello(fp);
+        if (sz <= 0) return false;
+        size = static_cast<unsigned long>(sz);
+        access.m_FileLen  = size;
+        access.m_GetBlock = &PdfFile::get_block;
+        access.m_Param    = this;
+        return true;
+    }
+
+private:
+    struct Slot { unsigned long index = 0; uint64_t used = 0; std::vector<unsigned char> bytes; };
+    Slot slots_[kSlots];
+    uint64_t tick_ = 0;
+
+    /* Block `index`, loaded into the least-recently-used slot on a miss. */
+    const Slot* block(unsigned long index) {
+        Slot* victim = &slots_[0];
+        for (Slot& s : slots_) {
+            if (s.used && s.index == index) { s.used = ++tick_; return &s; }
+            if (s.used < victim->used) victim = &s;
+        }
+        unsigned long off = index * kBlock;
+        size_t want = std::min<unsigned long>(kBlock, size - off);
+        victim->bytes.resize(want);
+        if (fseeko(fp, static_cast<off_t>(off), SEEK_SET) != 0 ||
+            fread(victim->bytes.data(), 1, want, fp) != want) {
+            victim->used = 0;
+            return nullptr;
+        }
+        victim->index = index;
+        victim->used  = ++tick_;
+        return victim;
+    }
+
+    static int get_block(void* param, unsigned long pos,
+                         unsigned char* buf, unsigned long n) {
+        auto* f = static_cast<PdfFile*>(param);
+        if (pos > f->size || n > f->size - pos) return 0;
+        while (n > 0) {
+            const Slot* s = f->block(pos / kBlock);
+            if (!s) return 0;
+            size_t at = pos % kBlock;
+            size_t take = std::min<size_t>(n, s->bytes.size() - at);
+            std::memcpy(buf, s->bytes.data() + at, take);
+            buf += take; pos += take; n -= take;
+        }
+        return 1;
+    }
+};
+
+using PageExtractor = void (*)(FPDF_DOCUMENT, int, FontTable&, StyleTable&, Page&, bool);
+
+} /* namespace */
+
+/* The page loop shared by every extract_pdf* entry point; `doc` is closed
+   here. Caller holds g_pdfium_mutex. */
+static BBoxResult extract_pdf_doc(FPDF_DOCUMENT doc, int start_page, int end_page,
+                                  PageExtractor extract, bool rules) {
+    BBoxResult result;
+    result.source_type = "pdf";
+    if (!doc) {
+        result.page_count = -1;
+        return result;
+    }
+
+    int total = FPDF_GetPageCount(doc);
+    result.page_count = total;
+
+    int sp = (start_page >= 1 ? start_page : 1) - 1;
+    int ep = (end_page   >= 1 ? end_page : total) - 1;
+    if (ep >= total) ep = total - 1;
+
+    for (int pi = sp; pi <= ep; ++pi) {
+        Page page;
+        page.page_id     = static_cast<uint32_t>(result.pages.size());
+        page.document_id = 0;
+        page.page_number = pi + 1;
+        page.width       = 0;
+        page.height      = 0;
+        extract(doc, pi, result.fonts, result.styles, page, rules);
+        result.pages.push_back(std::move(page));
+    }
+
+    FPDF_CloseDocument(doc);
+    return result;
+}
+
 /* ── public backend API ─────────────────────────────────────────────── */
 
 void bboxes_pdf_init(void) {
@@ -365,10 +779,8 @@ void bboxes_pdf_destroy(void) {
 }
 
 BBoxResult extract_pdf(const void* buf, size_t len, const char* password,
-                        int start_page, int end_page) {
+                        int start_page, int end_page, bool rules) {
     std::lock_guard<std::mutex> lock(g_pdfium_mutex);
-    BBoxResult result;
-    result.source_type = "pdf";
 
     /* PDFium is dlopen'd, so every FPDF_* name here is a pointer that is null
        until bb_pdfium_load() succeeds. Calling one unresolved is a segfault, so
@@ -376,36 +788,69 @@ BBoxResult extract_pdf(const void* buf, size_t len, const char* password,
        a crash into an error the caller can read. page_count = -1 is this
        backend's existing failure signal. */
     if (!bb_pdfium_load()) {
+        BBoxResult result;
+        result.source_type = "pdf";
         result.page_count = -1;
         return result;
     }
 
     FPDF_DOCUMENT doc = FPDF_LoadMemDocument(buf, static_cast<int>(len), password);
-    if (!doc) {
-        result.page_count = -1;
-        return result;
-    }
-
-    int total = FPDF_GetPageCount(doc);
-    result.page_count = total;
+    return extract_pdf_doc(doc, start_page, end_page, extract_page, rules);
+}
 
-    int sp = (start_page >= 1 ? start_page : 1) - 1;
-    int ep = (end_page   >= 1 ? end_page : total) - 1;
-    if (ep >= total) ep = total - 1;
+BBoxResult extract_pdf_file(const char* path, const char* password,
+                            int start_page, int end_page, bool objects, bool rules) {
+    std::lock_guard<std::mutex> lock(g_pdfium_mutex);
+    BBoxResult failed;
+    failed.source_type = "pdf";
+    failed.page_count = -1;
+    if (!bb_pdfium_load()) return failed;                 /* see extract_pdf */
+
+    PdfFile file;
+    if (!file.open(path)) return failed;
+    /* `file` outlives the document: extract_pdf_doc closes it before returning. */
+    FPDF_DOCUMENT doc = FPDF_LoadCustomDocument(&file.access, password);
+    return extract_pdf_doc(doc, start_page, end_page,
+                           objects ? extract_page_objects : extract_page, rules);
+}
 
-    for (int pi = sp; pi <= ep; ++pi) {
-        Page page;
-        page.page_id     = static_cast<uint32_t>(result.pages.size());
-        page.document_id = 0;
-        page.page_number = pi + 1;
-        page.width       = 0;
-        page.height      = 0;
-        extract_page(doc, pi, result.fonts, result.styles, page);
-        result.pages.push_back(std::move(page));
+void probe_pdf(const void* buf, size_t len, const char* path, DocProbe& out) {
+    out.format = "pdf";
+    std::lock_guard<std::mutex> lock(g_pdfium_mutex);
+    if (!bb_pdfium_load()) {                              /* see extract_pdf */
+        const char* e = bb_pdfium_error();
+        out.error = e ? e : "libpdfium unavailable";
+        return;
     }
-
+    PdfFile file;
+    FPDF_DOCUMENT doc = nullptr;
+    if (path) {
+        if (!file.open(path)) { out.error = "file not found / unreadable"; return; }
+        out.size_bytes = file.size;
+        doc = FPDF_LoadCustomDocument(&file.access, nullptr);
+    } else {
+        out.size_bytes = len;
+        doc = FPDF_LoadMemDocument(buf, static_cast<int>(len), nullptr);
+    }
+    /* PDFium touches the xref plus what the pages reference, which scales with
+       the file rather than with any decoded size the trailer could tell us. */
+    out.work_bytes = out.size_bytes;
+    if (!doc) {
+        unsigned long e = FPDF_GetLastError();
+        if (e == FPDF_ERR_PASSWORD) {
+            out.encrypted = 1;
+            out.password_required = 1;
+        } else {
+            out.error = e == FPDF_ERR_FORMAT   ? "not a PDF / corrupted" :
+                        e == FPDF_ERR_SECURITY ? "unsupported security scheme" : "unknown";
+            if (e == FPDF_ERR_SECURITY) out.encrypted = 1;
+        }
+        return;
+    }
+    out.pages = FPDF_GetPageCount(doc);
+    out.encrypted = FPDF_GetSecurityHandlerRevision(doc) >= 0 ? 1 : 0;   /* -1 if not */
+    out.password_required = 0;   /* opened with the empty user password */
     FPDF_CloseDocument(doc);
-    return result;
 }
 
 /* ── document metadata (JSON clob) ──────────────────────────────────────
@@ -602,16 +1047,6 @@ static json pdf_meta_build(FPDF_DOCUMENT doc) {
     return out;
 }
 
-/* Streaming block reader for FPDF_LoadCustomDocument — PDFium requests only
-   the byte ranges it needs (trailer, xref, referenced objects), so a large
-   PDF is never read whole. */
-static int pdf_file_getblock(void* param, unsigned long pos,
-                             unsigned char* buf, unsigned long size) {
-    FILE* fp = static_cast<FILE*>(param);
-    if (fseeko(fp, static_cast<off_t>(pos), SEEK_SET) != 0) return 0;
-    return fread(buf, 1, size, fp) == size ? 1 : 0;
-}
-
 extern "C" {
 
 const char* bboxes_pdf_metadata_json(const void* buf, size_t len) {
@@ -632,31 +1067,19 @@ const char* bboxes_pdf_metadata_json(const void* buf, size_t len) {
 
 const char* bboxes_pdf_metadata_json_file(const char* path) {
     std::lock_guard<std::mutex> lock(g_pdfium_mutex);
-    FILE* fp = fopen(path, "rb");
-    if (!fp) {
-        FPDF_DOCUMENT none = nullptr;
-        (void)none;
+    PdfFile file;
+    if (!file.open(path)) {
         json out;
         out["dialect"] = "pdf";
         out["integrity"] = {{"status", "failed"}, {"error", "file not found / unreadable"}};
         g_pdf_meta = out.dump(1, ' ', false, nlohmann::json::error_handler_t::replace);
         return g_pdf_meta.c_str();
     }
-    fseeko(fp, 0, SEEK_END);
-    off_t sz = ftello(fp);
-    fseeko(fp, 0, SEEK_SET);
-
-    FPDF_FILEACCESS fa{};
-    fa.m_FileLen = static_cast<unsigned long>(sz);
-    fa.m_GetBlock = pdf_file_getblock;
-    fa.m_Param = fp;                     /* kept alive on the stack below */
-
     /* Streaming tier: Info + structural only (XMP needs a full-byte scan and
        is offered by the buffer overload). */
-    FPDF_DOCUMENT doc = FPDF_LoadCustomDocument(&fa, nullptr);
+    FPDF_DOCUMENT doc = FPDF_LoadCustomDocument(&file.access, nullptr);
     g_pdf_meta = pdf_meta_build(doc).dump(1, ' ', false, nlohmann::json::error_handler_t::replace);
     if (doc) FPDF_CloseDocument(doc);
-    fclose(fp);
     return g_pdf_meta.c_str();
 }
 
@@ -664,45 +1087,257 @@ const char* bboxes_pdf_metadata_json_file(const char* path) {
 
 /* Object-level variant — uses FPDFPage_GetObject instead of char-by-char */
 BBoxResult extract_pdf_objects(const void* buf, size_t len, const char* password,
-                                int start_page, int end_page) {
+                                int start_page, int end_page, bool rules) {
     std::lock_guard<std::mutex> lock(g_pdfium_mutex);
-    BBoxResult result;
-    result.source_type = "pdf";
-
-    /* PDFium is dlopen'd, so every FPDF_* name here is a pointer that is null
-       until bb_pdfium_load() succeeds. Calling one unresolved is a segfault, so
-       the guard is not optional — it is what turns "libpdfium is missing" from
-       a crash into an error the caller can read. page_count = -1 is this
-       backend's existing failure signal. */
-    if (!bb_pdfium_load()) {
+    if (!bb_pdfium_load()) {                             /* see extract_pdf */
+        BBoxResult result;
+        result.source_type = "pdf";
         result.page_count = -1;
         return result;
     }
 
     FPDF_DOCUMENT doc = FPDF_LoadMemDocument(buf, static_cast<int>(len), password);
-    if (!doc) {
-        result.page_count = -1;
-        return result;
+    return extract_pdf_doc(doc, start_page, end_page, extract_page_objects, rules);
+}
+
+/* ── page rendering + on-disk raster cache ──────────────────────────────
+   Review tooling re-rasterizes the same pages every session, and rendering
+   is far slower than extraction. A rendered page is a pure function of
+   (document bytes, page, dpi, encoding), so it is cached on disk under the
+   document's SHA-256 — the same content address bboxes_get_doc reports —
+   and evicted least-recently-used (file mtime, bumped on every hit) once the
+   directory exceeds its byte budget. Writes go to a temp name and rename()
+   into place, so concurrent processes sharing a cache never see a torn file.
+
+   Cache layout: <dir>/<sha256>-<page>-<dpi*100>.png|.rgba. A .rgba entry is
+   an 8-byte header (width, height as little-endian u32) + tight RGBA rows. */
+
+namespace {
+
+std::mutex g_render_cache_mutex;
+std::string g_render_cache_dir;                       /* "" = cache disabled */
+uint64_t g_render_cache_max = 512ull << 20;
+bool g_render_cache_env_read = false;
+
+/* First use: BBOXES_RENDER_CACHE=<dir> turns the cache on without code. */
+void render_cache_env() {
+    if (g_render_cache_env_read) return;
+    g_render_cache_env_read = true;
+    if (const char* d = getenv("BBOXES_RENDER_CACHE")) g_render_cache_dir = d;
+}
+
+std::string render_cache_path(const std::string& dir, const std::string& sha,
+                              int page_number, double dpi, int format) {
+    char tail[64];
+    snprintf(tail, sizeof(tail), "-%d-%ld.%s", page_number,
+             std::lround(dpi * 100.0), format == BBOXES_RENDER_RGBA ? "rgba" : "png");
+    return dir + "/" + sha + tail;
+}
+
+bool read_whole(const std::string& path, std::string& out) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    fseeko(f, 0, SEEK_END);
+    off_t sz = ftello(f);
+    fseeko(f, 0, SEEK_SET);
+    out.resize(sz > 0 ? static_cast<size_t>(sz) : 0);
+    bool ok = sz > 0 && fread(&out[0], 1, out.size(), f) == out.size();
+    fclose(f);
+    return ok;
+}
+
+/* Pixel size of a cached entry: IHDR for PNG, our header for RGBA. */
+bool raster_dims(const std::string& bytes, int format, int* w, int* h) {
+    auto be32 = [&](size_t o) {
+        const auto* p = reinterpret_cast<const unsigned char*>(bytes.data()) + o;
+        return static_cast<int>(uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8 | p[3]);
+    };
+    auto le32 = [&](size_t o) {
+        const auto* p = reinterpret_cast<const unsigned char*>(bytes.data()) + o;
+        return static_cast<int>(uint32_t(p[3]) << 24 | uint32_t(p[2]) << 16 | uint32_t(p[1]) << 8 | p[0]);
+    };
+    if (format == BBOXES_RENDER_RGBA) {
+        if (bytes.size() < 8) return false;
+        *w = le32(0); *h = le32(4);
+        return bytes.size() == 8 + size_t(*w) * size_t(*h) * 4;
     }
+    if (bytes.size() < 24 || std::memcmp(bytes.data() + 1, "PNG", 3) != 0) return false;
+    *w = be32(16); *h = be32(20);
+    return true;
+}
 
-    int total = FPDF_GetPageCount(doc);
-    result.page_count = total;
+/* Drop least-recently-used entries until the directory fits the budget.
+   Only our own file names are counted or removed. Caller holds
+   g_render_cache_mutex. */
+void render_cache_evict(const std::string& dir, uint64_t max_bytes) {
+    DIR* d = opendir(dir.c_str());
+    if (!d) return;
+    struct Entry { std::string path; uint64_t size; time_t mtime; };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    while (dirent* e = readdir(d)) {
+        size_t n = std::strlen(e->d_name);
+        bool ours = n > 64 && (
+            (n > 4 && std::strcmp(e->d_name + n - 4, ".png") == 0) ||
+            (n > 5 && std::strcmp(e->d_name + n - 5, ".rgba") == 0));
+        if (!ours) continue;
+        std::string path = dir + "/" + e->d_name;
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) continue;
+        entries.push_back({std::move(path), static_cast<uint64_t>(st.st_size), st.st_mtime});
+        total += static_cast<uint64_t>(st.st_size);
+    }
+    closedir(d);
+    if (total <= max_bytes) return;
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) { return a.mtime < b.mtime; });
+    for (const Entry& e : entries) {
+        if (total <= max_bytes) break;
+        if (unlink(e.path.c_str()) == 0) total -= e.size;
+    }
+}
 
-    int sp = (start_page >= 1 ? start_page : 1) - 1;
-    int ep = (end_page   >= 1 ? end_page : total) - 1;
-    if (ep >= total) ep = total - 1;
+/* Publish one entry: write a temp name, then rename() it into place. Needs
+   no lock; the temp name is unique per process and thread. */
+bool render_cache_store(const std::string& dir, const std::string& path,
+                        const std::string& bytes) {
+    mkdir(dir.c_str(), 0755);                         /* EEXIST is fine */
+    std::string tmp = path + ".tmp." + std::to_string(static_cast<long>(getpid())) + "."
+                    + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || rename(tmp.c_str(), path.c_str()) != 0) { unlink(tmp.c_str()); return false; }
+    return true;
+}
 
-    for (int pi = sp; pi <= ep; ++pi) {
-        Page page;
-        page.page_id     = static_cast<uint32_t>(result.pages.size());
-        page.document_id = 0;
-        page.page_number = pi + 1;
-        page.width       = 0;
-        page.height      = 0;
-        extract_page_objects(doc, pi, result.fonts, result.styles, page);
-        result.pages.push_back(std::move(page));
+/* Rasterize one page into `out` (PNG or header + RGBA). Caller holds
+   g_pdfium_mutex and has loaded PDFium. */
+bool render_page(const void* buf, size_t len, const char* password,
+                 int page_number, double dpi, int format,
+                 std::string& out, int* out_w, int* out_h) {
+    FPDF_DOCUMENT doc = FPDF_LoadMemDocument(buf, static_cast<int>(len), password);
+    if (!doc) return false;
+    FPDF_PAGE page = page_number >= 1 ? FPDF_LoadPage(doc, page_number - 1) : nullptr;
+    if (!page) { FPDF_CloseDocument(doc); return false; }
+
+    double scale = dpi / 72.0;
+    int w = static_cast<int>(std::lround(FPDF_GetPageWidth(page) * scale));
+    int h = static_cast<int>(std::lround(FPDF_GetPageHeight(page) * scale));
+    /* 2^28 px (~1 GiB of BGRA) bounds a runaway dpi rather than any real page. */
+    bool ok = w > 0 && h > 0 && uint64_t(w) * uint64_t(h) <= (1ull << 28);
+    FPDF_BITMAP bmp = ok ? FPDFBitmap_Create(w, h, 1) : nullptr;
+    if (bmp) {
+        FPDFBitmap_FillRect(bmp, 0, 0, w, h, 0xFFFFFFFF);   /* opaque white paper */
+        FPDF_RenderPageBitmap(bmp, page, 0, 0, w, h, 0, FPDF_ANNOT);
+
+        /* PDFium's BGRA (stride-padded) → tight RGBA rows. */
+        const auto* src = static_cast<const unsigned char*>(FPDFBitmap_GetBuffer(bmp));
+        int stride = FPDFBitmap_GetStride(bmp);
+        std::string rgba(size_t(w) * size_t(h) * 4, '\0');
+        auto* dst = reinterpret_cast<unsigned char*>(&rgba[0]);
+        for (int y = 0; y < h; ++y) {
+            const unsigned char* s = src + size_t(y) * size_t(stride);
+            unsigned char* d = dst + size_t(y) * size_t(w) * 4;
+            for (int x = 0; x < w; ++x, s += 4, d += 4) {
+                d[0] = s[2]; d[1] = s[1]; d[2] = s[0]; d[3] = s[3];
+            }
+        }
+        FPDFBitmap_Destroy(bmp);
+
+        if (format == BBOXES_RENDER_RGBA) {
+            unsigned char hdr[8];
+            for (int k = 0; k < 4; ++k) {
+                hdr[k]     = static_cast<unsigned char>(uint32_t(w) >> (8 * k));
+                hdr[4 + k] = static_cast<unsigned char>(uint32_t(h) >> (8 * k));
+            }
+            out.assign(reinterpret_cast<const char*>(hdr), sizeof(hdr));
+            out += rgba;
+        } else {
+            size_t png_len = 0;
+            void* png = tdefl_write_image_to_png_file_in_memory_ex(
+                rgba.data(), w, h, 4, &png_len, MZ_DEFAULT_LEVEL, 0);
+            ok = png != nullptr;
+            if (ok) { out.assign(static_cast<const char*>(png), png_len); mz_free(png); }
+        }
+    } else {
+        ok = false;
     }
 
+    FPDF_ClosePage(page);
     FPDF_CloseDocument(doc);
-    return result;
+    if (ok) { *out_w = w; *out_h = h; }
+    return ok;
+}
+
+} /* namespace */
+
+extern "C" {
+
+void bboxes_pdf_render_cache(const char* dir, uint64_t max_bytes) {
+    std::lock_guard<std::mutex> lock(g_render_cache_mutex);
+    g_render_cache_env_read = true;                   /* explicit beats env */
+    g_render_cache_dir = dir ? dir : "";
+    if (max_bytes) g_render_cache_max = max_bytes;
 }
+
+const unsigned char* bboxes_pdf_render_page(const void* buf, size_t len,
+                                            const char* password, const char* checksum,
+                                            int page_number, double dpi, int format,
+                                            int* width, int* height, size_t* out_len) {
+    if (!buf || !len || !(dpi > 0) || !out_len) return nullptr;
+    if (format != BBOXES_RENDER_PNG && format != BBOXES_RENDER_RGBA) return nullptr;
+    int w = 0, h = 0;
+    bool hit = false;
+    std::string raster;                               /* this call's bytes */
+
+    std::string dir, path;
+    uint64_t max_bytes;
+    {
+        std::lock_guard<std::mutex> lock(g_render_cache_mutex);
+        render_cache_env();
+        dir = g_render_cache_dir;
+        max_bytes = g_render_cache_max;
+    }
+    if (!dir.empty()) {
+        std::string sha;
+        if (checksum && std::strlen(checksum) == 64) sha = checksum;
+        else { SHA256 sha256; sha = sha256(buf, len); }
+        path = render_cache_path(dir, sha, page_number, dpi, format);
+        /* No lock: entries only appear by rename(), so a file is whole or
+           absent, and one evicted mid-read stays readable through our open
+           handle. A failed utime() just means it was evicted meanwhile. */
+        hit = read_whole(path, raster) && raster_dims(raster, format, &w, &h);
+        if (hit) utime(path.c_str(), nullptr);        /* LRU: mark as recently used */
+    }
+
+    if (!hit) {
+        {
+            std::lock_guard<std::mutex> lock(g_pdfium_mutex);
+            if (!bb_pdfium_load()) return nullptr;    /* see extract_pdf */
+            if (!render_page(buf, len, password, page_number, dpi, format, raster, &w, &h))
+                return nullptr;
+        }
+        if (!path.empty() && render_cache_store(dir, path, raster)) {
+            std::lock_guard<std::mutex> lock(g_render_cache_mutex);
+            render_cache_evict(dir, max_bytes);
+        }
+    }
+
+    size_t skip = format == BBOXES_RENDER_RGBA ? 8 : 0;   /* callers get bare pixels */
+    size_t n = raster.size() - skip;
+    auto* out = static_cast<unsigned char*>(std::malloc(n ? n : 1));
+    if (!out) return nullptr;
+    std::memcpy(out, raster.data() + skip, n);
+    if (width)  *width = w;
+    if (height) *height = h;
+    *out_len = n;
+    return out;
+}
+
+void bboxes_pdf_render_free(const unsigned char* pixels) {
+    std::free(const_cast<unsigned char*>(pixels));
+}
+
+} /* extern "C" */
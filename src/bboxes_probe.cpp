@@ -0,0 +1,242 @@
+/* ── pre-flight probe ─────────────────────────────────────────────────
+   bboxes_probe answers "what is this, is it locked, how big is the job"
+   without extracting anything, so a batch scheduler can route, skip or
+   order documents first. Each format reads only what its container puts up
+   front or at the tail:
+
+     pdf   trailer, xref and page-tree root via PDFium (no page content)
+     zip   the central directory — names and uncompressed sizes, no inflate
+           beyond the workbook part (whose sheet entries are the sheet count)
+           and an ods manifest (which says whether the package is encrypted)
+     ole   the CFB directory and the workbook-globals records (xls backend);
+           for encrypted OOXML, EncryptionInfo, checked against the default
+           password. From a path the file is mapped, so only the sectors
+           those touch are read
+     text  nothing beyond the sniff
+
+   pages follows each extractor's page_count: sheets for spreadsheets, 1 for
+   the flow formats, unknown for ods, whose sheets are only listed in
+   content.xml. work_bytes is the decoded volume the extractor will walk,
+   a better cost proxy than file size for compressed containers: worksheet
+   XML (records for xlsb) plus shared strings for xlsx, content.xml for ods,
+   document.xml for docx, the Workbook stream for xls, WordDocument for
+   doc. */
+
+#include "bboxes.h"
+#include "bboxes_types.h"
+#include "bboxes_xlsb_records.h"
+#include "bboxes_xlsx_pkg.h"
+
+#include <nlohmann/json.hpp>
+
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using json = nlohmann::json;
+
+namespace {
+
+bool starts_ends(const char* s, const char* pre, const char* suf) {
+    size_t n = std::strlen(s), pl = std::strlen(pre), sl = std::strlen(suf);
+    return n >= pl + sl && std::strncmp(s, pre, pl) == 0 && std::strcmp(s + n - sl, suf) == 0;
+}
+
+/* <sheet> elements of workbook.xml, any namespace prefix: the sheets the reader lists,
+   whatever their parts are called. */
+int xml_sheets(const std::string& x) {
+    int n = 0;
+    for (size_t i = x.find('<'); i != std::string::npos; i = x.find('<', i + 1)) {
+        size_t b = i + 1, e = b;
+        while (e < x.size() && !std::isspace(static_cast<unsigned char>(x[e])) && x[e] != '/' && x[e] != '>') {
+            if (x[e] == ':') b = e + 1;
+            ++e;
+        }
+        n += x.compare(b, e - b, "sheet") == 0;
+    }
+    return n;
+}
+
+/* BrtBundleSh records of workbook.bin: one per sheet. */
+int bin_sheets(const std::string& wb) {
+    Records it(wb.data(), wb.size());
+    int sheets = 0;
+    for (Rec r; it.next(r);) sheets += r.id == 156;
+    return sheets;
+}
+
+void probe_zip(XlsxPackage& pkg, DocProbe& out) {
+    bool xlsx = false, xlsb = false, docx = false, ods = false;
+    uint64_t sheet_bytes = 0, text_bytes = 0, content_bytes = 0;
+    out.encrypted = 0;
+    mz_uint n = mz_zip_reader_get_num_files(&pkg.z);
+    for (mz_uint i = 0; i < n; ++i) {
+        mz_zip_archive_file_stat st;
+        if (!mz_zip_reader_file_stat(&pkg.z, i, &st)) continue;
+        if (st.m_is_encrypted) out.encrypted = 1;          /* legacy zip crypto: unreadable */
+        const char* name = st.m_filename;
+        if (std::strcmp(name, "xl/workbook.xml") == 0) {
+            xlsx = true;
+        } else if (std::strcmp(name, "xl/workbook.bin") == 0) {
+            xlsb = true;
+        } else if (starts_ends(name, "xl/worksheets/", ".xml") ||
+                   starts_ends(name, "xl/worksheets/", ".bin")) {
+            sheet_bytes += st.m_uncomp_size;
+        } else if (std::strcmp(name, "xl/sharedStrings.xml") == 0 ||
+                   std::strcmp(name, "xl/sharedStrings.bin") == 0) {
+            sheet_bytes += st.m_uncomp_size;
+        } else if (std::strcmp(name, "word/document.xml") == 0) {
+            docx = true;
+            text_bytes = st.m_uncomp_size;
+        } else if (std::strcmp(name, "content.xml") == 0) {
+            content_bytes = st.m_uncomp_size;
+        } else if (std::strcmp(name, "mimetype") == 0) {
+            const std::string* mt = pkg.part("mimetype");
+            ods = mt && mt->compare(0, 46, "application/vnd.oasis.opendocument.spreadsheet") == 0;
+        }
+    }
+    out.password_required = out.encrypted;
+    if (xlsx || xlsb) {
+        out.format = xlsx ? "xlsx" : "xlsb";
+        const std::string* wb = pkg.part(xlsx ? "xl/workbook.xml" : "xl/workbook.bin");
+        out.pages = !wb ? 0 : xlsx ? xml_sheets(*wb) : bin_sheets(*wb);
+        out.work_bytes = sheet_bytes;
+    } else if (docx) {
+        out.format = "docx";
+        out.pages = 1;
+        out.work_bytes = text_bytes;
+    } else if (ods) {
+        /* ODF encrypts per member, declared in the manifest rather than in the zip headers */
+        const std::string* mf = pkg.part("META-INF/manifest.xml");
+        if (mf && mf->find("encryption-data") != std::string::npos) out.encrypted = 1;
+        out.password_required = out.encrypted;
+        out.format = "ods";
+        out.pages = -1;
+        out.work_bytes = content_bytes;
+    } else {
+        out.format = "zip";
+        out.error = "zip without a workbook or document part";
+    }
+}
+
+void probe_flow(const char* format, uint64_t len, DocProbe& out) {
+    out.format = format;
+    out.encrypted = 0;
+    out.password_required = 0;
+    out.pages = 1;
+    out.work_bytes = len;
+}
+
+/* Password-protected OOXML ("ooxml-encrypted") is an OLE2 container, and a
+   head too short to reach the directory detects as "xls": probe_ole reads
+   whichever it is. */
+bool ole_magic(const void* buf, size_t len) {
+    return buf && len >= 8 && std::memcmp(buf, "\xD0\xCF\x11\xE0\xA1\xB1\x1A\xE1", 8) == 0;
+}
+
+const char* probe_json(const DocProbe& p) {
+    static thread_local std::string out;
+    auto tri = [](int v) { return v < 0 ? json(nullptr) : json(v != 0); };
+    json o;
+    o["format"]            = p.format;
+    o["encrypted"]         = tri(p.encrypted);
+    o["password_required"] = tri(p.password_required);
+    o["pages"]             = p.pages < 0 ? json(nullptr) : json(p.pages);
+    o["size_bytes"]        = p.size_bytes;
+    o["work_bytes"]        = p.work_bytes;
+    o["error"]             = p.error.empty() ? json(nullptr) : json(p.error);
+    out = o.dump(-1, ' ', false, json::error_handler_t::replace);
+    return out.c_str();
+}
+
+}  // namespace
+
+#ifndef BBOXES_HAS_XLS
+/* The CFB reader ships with the xls backend; without it an OLE2 file is
+   reported by its magic alone. */
+void probe_ole(const void*, size_t len, DocProbe& out) {
+    out.format = "ole";
+    out.size_bytes = len;
+    out.error = "xls backend not built: OLE2 contents not inspected";
+}
+#endif
+
+extern "C" {
+
+const char* bboxes_probe(const void* buf, size_t len) {
+    DocProbe p;
+    p.size_bytes = len;
+    std::string fmt = buf ? bboxes_detect(buf, len) : "";
+    if (fmt == "pdf") {
+        probe_pdf(buf, len, nullptr, p);
+    } else if (ole_magic(buf, len)) {
+        probe_ole(buf, len, p);
+    } else if (fmt == "xlsx" || fmt == "xlsb" || fmt == "ods" || fmt == "docx") {
+        XlsxPackage pkg;
+        if (pkg.open_mem(buf, len)) probe_zip(pkg, p);
+        else { p.format = fmt; p.error = "not a zip"; }
+    } else if (!fmt.empty()) {
+        probe_flow(fmt.c_str(), len, p);
+    } else {
+        p.error = "no input";
+    }
+    return probe_json(p);
+}
+
+const char* bboxes_probe_file(const char* path) {
+    DocProbe p;
+    FILE* f = path ? std::fopen(path, "rb") : nullptr;
+    if (!f) {
+        p.error = "file not found / unreadable";
+        return probe_json(p);
+    }
+    /* The sniff needs the head only; bboxes_detect looks at most 4 KiB in. */
+    std::string head(4096, '\0');
+    head.resize(std::fread(&head[0], 1, head.size(), f));
+    std::fseek(f, 0, SEEK_END);
+    long sz = std::ftell(f);
+    std::string fmt = bboxes_detect(head.data(), head.size());
+    p.size_bytes = sz > 0 ? static_cast<uint64_t>(sz) : 0;
+
+    if (fmt == "pdf") {
+        std::fclose(f);
+        probe_pdf(nullptr, 0, path, p);
+    } else if (fmt == "xlsx" || fmt == "xlsb" || fmt == "ods" || fmt == "docx") {
+        std::fclose(f);
+        XlsxPackage pkg;   /* reads the central directory from the tail only */
+        if (pkg.open_file(path)) probe_zip(pkg, p);
+        else { p.format = fmt; p.error = "not a zip / unreadable"; }
+    } else if (fmt == "xls" || fmt == "doc" || ole_magic(head.data(), head.size())) {
+        /* The CFB reader works over memory. Mapped, only the pages it touches —
+           header, FAT, directory, the globals records — come off the disk; a file
+           that cannot be mapped is read whole. */
+        std::fclose(f);
+        int fd = ::open(path, O_RDONLY);
+        struct stat sb;
+        void* map = fd >= 0 && ::fstat(fd, &sb) == 0 && sb.st_size > 0
+                  ? ::mmap(nullptr, size_t(sb.st_size), PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+        if (fd >= 0) ::close(fd);
+        if (map != MAP_FAILED) {
+            probe_ole(map, size_t(sb.st_size), p);
+            ::munmap(map, size_t(sb.st_size));
+        } else {
+            std::string buf(p.size_bytes, '\0');
+            f = std::fopen(path, "rb");
+            if (!f || std::fread(&buf[0], 1, buf.size(), f) != buf.size()) buf.clear();
+            if (f) std::fclose(f);
+            probe_ole(buf.data(), buf.size(), p);
+        }
+    } else {
+        std::fclose(f);
+        probe_flow(fmt.c_str(), p.size_bytes, p);
+    }
+    return probe_json(p);
+}
+
+}  // extern "C"
@@ -1,19 +1,29 @@
-/* Legacy .xls (BIFF) WALKER lane — formulas / defined names / VBA (the things libxls does NOT expose).
+/* Legacy .xls (BIFF) WALKER lane — cells / formulas / defined names / VBA.
  *
- * STRICT lanes: libxls-free. bboxes_xls.cpp owns values/formats/sheets; this owns the BIFF record stream
- * inside the OLE2/CFB container. Decoding from [MS-XLS] (no GPL/LGPL/MPL). CFB = microsoft/compoundfilereader
- * (MIT, third_party/). Surfaced the bboxes way: xls_names (defined-name inventory + target formula),
- * xls_formulas (every cell formula in R1C1 + A1 with its address). Ptg parser per [MS-XLS] 2.5.198.
+ * libxls-free: bboxes_xls.cpp keeps libxls for document properties and the style-decode table; this owns
+ * the BIFF record stream inside the OLE2/CFB container. Decoding from [MS-XLS] (no GPL/LGPL/MPL). CFB =
+ * bboxes_cfb.h over the microsoft/compoundfilereader structs (MIT, third_party/); the Workbook stream is
+ * walked in place. Surfaced the bboxes way: bb() cells (extract_xls, one pass: globals, then each sheet
+ * substream's cell records with formulas rendered inline), xls_names (defined-name inventory + target
+ * formula), xls_formulas (every cell formula in R1C1 + A1 with its address). Ptg parser per [MS-XLS]
+ * 2.5.198.
  */
 #include "bboxes.h"
 #include "bboxes_types.h"
+#include "bboxes_bytes.h"
 
-#include "compoundfilereader.h"
+#include "bboxes_cfb.h"
+#include "bboxes_covered.h"
+#include "bboxes_crypto.h"
+#include "bboxes_encrypted_pkg.h"
+#include "bboxes_ftab.h"
 #include <nlohmann/json.hpp>
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <fstream>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -29,11 +39,6 @@ std::vector<char> slurp(const char* path) {
     if (n > 0 && !f.read(b.data(), n)) b.clear();
     return b;
 }
-std::string cfb_entry_name(const CFB::COMPOUND_FILE_ENTRY* e) {
-    std::string s; int chars = e->nameLen >= 2 ? e->nameLen / 2 - 1 : 0;
-    for (int i = 0; i < chars && i < 31; i++) { uint16_t ch = e->name[i]; s += (ch && ch < 128) ? char(ch) : '?'; }
-    return s;
-}
 const char* builtin_name(uint8_t id) {
     switch (id) {
         case 0x00: return "Consolidate_Area"; case 0x01: return "Auto_Open";  case 0x02: return "Auto_Close";
@@ -43,40 +48,390 @@ const char* builtin_name(uint8_t id) {
         case 0x0C: return "Sheet_Title";      case 0x0D: return "_FilterDatabase"; default: return nullptr;
     }
 }
-bool read_workbook_stream(const void* buf, size_t len, std::vector<char>& out, std::string& err) {
-    try {
-        CFB::CompoundFileReader cfb(buf, len);
-        const CFB::COMPOUND_FILE_ENTRY* wb = nullptr;
-        cfb.EnumFiles(cfb.GetRootEntry(), -1, [&](const CFB::COMPOUND_FILE_ENTRY* e, const std::u16string&, int) {
-            if (cfb.IsStream(e)) { std::string nm = cfb_entry_name(e); if (nm == "Workbook" || nm == "Book") wb = e; }
-        });
+/* The Workbook (BIFF8) or Book (BIFF5) stream as one flat run over a single container parse: read in
+   place when its sectors are contiguous, which is how Excel writes them, and gathered once otherwise. */
+struct WorkbookStream {
+    CfbPackage cfb; CfbPackage::Stream st; std::vector<uint8_t> scratch;
+    const uint8_t* p = nullptr; size_t n = 0; std::string err;
+    bool open(const void* buf, size_t len) {
+        if (!cfb.open(buf, len)) { err = cfb.error(); return false; }
+        const CFB::COMPOUND_FILE_ENTRY* wb = cfb.entry("Workbook");
+        if (!wb) wb = cfb.entry("Book");
         if (!wb) { err = "no Workbook/Book stream"; return false; }
-        out.resize(static_cast<size_t>(wb->size));
-        cfb.ReadFile(wb, 0, out.data(), out.size());
+        if (!cfb.stream(wb, st)) { err = "Workbook stream truncated"; return false; }
+        p = CfbPackage::flat(st, scratch); n = st.size;
+        return true;
+    }
+};
+
+/* BIFF8 default 56-colour palette, colour indices 8..63 (icv); a PALETTE record overrides it per workbook. */
+const uint32_t kPalette[56] = {
+    0x000000,0xFFFFFF,0xFF0000,0x00FF00,0x0000FF,0xFFFF00,0xFF00FF,0x00FFFF,
+    0x800000,0x008000,0x000080,0x808000,0x800080,0x008080,0xC0C0C0,0x808080,
+    0x9999FF,0x993366,0xFFFFCC,0xCCFFFF,0x660066,0xFF8080,0x0066CC,0xCCCCFF,
+    0x000080,0xFF00FF,0xFFFF00,0x00FFFF,0x800080,0x800000,0x008080,0x0000FF,
+    0x00CCFF,0xCCFFFF,0xCCFFCC,0xFFFF99,0x99CCFF,0xFF99CC,0xCC99FF,0xFFCC99,
+    0x3366FF,0x33CCCC,0x99CC00,0xFFCC00,0xFF9900,0xFF6600,0x666699,0x969696,
+    0x003366,0x339966,0x003300,0x333300,0x993300,0x993366,0x333399,0x333333 };
+
+std::string icv_color(uint16_t idx, const uint32_t* pal) {
+    uint32_t rgb = (idx >= 8 && idx <= 63) ? pal[idx - 8]
+                 : (idx == 0x41)           ? 0xFFFFFF          /* default background */
+                 :                            0x000000;         /* auto / default fg / 0x7FFF / 0x40 / 0 */
+    char b[40];
+    std::snprintf(b, sizeof b, "rgba(%u,%u,%u,255)", (rgb >> 16) & 0xFF, (rgb >> 8) & 0xFF, rgb & 0xFF);
+    return b;
+}
+
+/* cch characters at s (compressed = Latin-1 bytes, else UTF-16LE), clipped to avail bytes. BIFF5 8-bit
+   strings are in the workbook codepage; read as Latin-1, which is right for the common cp1252 range. */
+std::string flat_chars(const uint8_t* s, size_t avail, size_t cch, bool high) {
+    std::string out; uint32_t pend = 0;
+    size_t k = std::min(cch, high ? avail / 2 : avail);
+    out.reserve(k);
+    for (size_t i = 0; i < k; i++) put_utf16(out, high ? le16(s + 2 * i) : s[i], pend);
+    return out;
+}
+
+/* A record body plus the CONTINUE (0x003C) records after it, read as one byte sequence. Only character
+   arrays notice the seams: a CONTINUE that splits one restarts with a fresh fHighByte flag byte
+   ([MS-XLS] 2.5.293). */
+struct ContReader {
+    std::vector<std::pair<const uint8_t*, size_t>> seg; size_t si = 0, pos = 0;
+    ContReader(const uint8_t* p, size_t n, size_t body, size_t len) {
+        seg.push_back({p + body, len});
+        for (size_t o = body + len; o + 4 <= n && le16(p + o) == 0x003C; ) {
+            size_t l = le16(p + o + 2); if (o + 4 + l > n) break;
+            seg.push_back({p + o + 4, l}); o += 4 + l;
+        }
+    }
+    explicit ContReader(std::vector<std::pair<const uint8_t*, size_t>> s) : seg(std::move(s)) {}
+    bool more() { while (si < seg.size() && pos >= seg[si].second) { si++; pos = 0; } return si < seg.size(); }
+    uint8_t u8() { return more() ? seg[si].first[pos++] : 0; }
+    uint16_t u16() { uint16_t a = u8(); return uint16_t(a | (u8() << 8)); }
+    uint32_t u32() { uint32_t a = u16(); return a | (uint32_t(u16()) << 16); }
+    void skip(size_t k) { while (k && more()) { size_t t = std::min(k, seg[si].second - pos); pos += t; k -= t; } }
+    void chars(size_t cch, bool high, std::string& out) {
+        uint32_t pend = 0;
+        while (cch > 0 && si < seg.size()) {
+            if (pos >= seg[si].second) {                     /* seam inside the characters: new flag byte */
+                if (++si >= seg.size()) break;
+                pos = 0; high = (u8() & 0x01) != 0; continue;
+            }
+            uint32_t c = seg[si].first[pos++];
+            if (high) { if (pos >= seg[si].second) break; c |= uint32_t(seg[si].first[pos++]) << 8; }
+            put_utf16(out, c, pend); cch--;
+        }
+    }
+};
+
+/* ── FILEPASS ([MS-XLS] 2.4.117, [MS-OFFCRYPTO] 2.3.5-2.3.7) ──────────────────────────────────────────
+   Three schemes: XOR obfuscation (BIFF5 and BIFF8), RC4 with an MD5 key ("standard", 40-bit) and RC4 with
+   a CryptoAPI SHA-1 key. Record headers are never encrypted, nor are the bodies of the records listed in
+   plain_record() or the lbPlyPos of BoundSheet8. The RC4 keystream runs over the whole stream regardless,
+   re-keyed every 1024 bytes from the block number, so any byte can be decrypted from its stream offset
+   alone; XOR indexes its 16-byte array by offset plus the record's length. With no password the default
+   (kDefaultXlsPassword) is tried. */
+
+struct BiffKey {
+    enum Kind { NONE, XOR, RC4, CAPI } kind = NONE;
+    uint8_t xor_arr[16] = {};
+    uint8_t base[20] = {}; size_t key_n = 16;       /* RC4: block key = hash(base || block), first key_n bytes */
+
+    /* FILEPASS body -> key for `password` (nullptr/empty: the default). False when the scheme is
+       unsupported or the password does not verify. */
+    bool open(const uint8_t* r, size_t len, bool biff8, const char* password) {
+        const char* pw = password && *password ? password : kDefaultXlsPassword;
+        if (!biff8) return len >= 4 && open_xor(le16(r), le16(r + 2), pw);
+        if (len >= 6 && le16(r) == 0x0000) return open_xor(le16(r + 2), le16(r + 4), pw);
+        if (len < 6 || le16(r) != 0x0001) return false;
+        uint16_t major = le16(r + 2), minor = le16(r + 4);
+        std::vector<uint8_t> u = utf16le(pw);
+        if (major == 1 && minor == 1 && len >= 54) {              /* RC4: salt, verifier, verifier hash */
+            uint8_t h0[16], h1[16];
+            bb_md5(u.data(), u.size(), h0);
+            uint8_t buf[21 * 16];
+            for (int k = 0; k < 16; k++) { std::memcpy(buf + 21 * k, h0, 5); std::memcpy(buf + 21 * k + 5, r + 6, 16); }
+            bb_md5(buf, sizeof buf, h1);
+            kind = RC4; std::memcpy(base, h1, 5); key_n = 16;
+            return verify(r + 22, r + 38, 16);
+        }
+        if ((major == 2 || major == 3 || major == 4) && minor == 2 && len >= 14) {   /* RC4 CryptoAPI */
+            size_t hsize = le32(r + 10), v = 14 + hsize;
+            if (hsize < 32 || v + 60 > len || le32(r + v) != 16) return false;
+            uint32_t bits = le32(r + 30);
+            if (bits == 0) bits = 40;
+            if (bits < 40 || bits > 128 || bits % 8) return false;
+            std::vector<uint8_t> sp(r + v + 4, r + v + 20);
+            sp.insert(sp.end(), u.begin(), u.end());
+            kind = CAPI; bb_sha1(sp.data(), sp.size(), base); key_n = bits / 8;
+            return verify(r + v + 20, r + v + 40, 20);
+        }
+        return false;
+    }
+    /* 16-byte RC4 key of 1024-byte block `blk` (a 40-bit CryptoAPI key is zero-padded). */
+    void block_key(uint32_t blk, uint8_t* key) const {
+        uint8_t in[24], h[20];
+        size_t bn = kind == RC4 ? 5 : 20;
+        std::memcpy(in, base, bn);
+        for (int k = 0; k < 4; k++) in[bn + k] = uint8_t(blk >> (8 * k));
+        std::memset(key, 0, 16);
+        if (kind == RC4) { bb_md5(in, bn + 4, h); std::memcpy(key, h, 16); }
+        else { bb_sha1(in, bn + 4, h); std::memcpy(key, h, key_n); }
+    }
+    size_t rc4_key_len() const { return kind == CAPI && key_n > 5 ? key_n : 16; }
+
+private:
+    bool verify(const uint8_t* enc_verifier, const uint8_t* enc_hash, size_t hash_n) {
+        uint8_t key[16], v[16], h[20], want[20];
+        block_key(0, key);
+        Rc4 rc4; rc4.init(key, rc4_key_len());
+        std::memcpy(v, enc_verifier, 16); rc4.apply(v, 16);
+        std::memcpy(h, enc_hash, hash_n); rc4.apply(h, hash_n);
+        if (kind == RC4) bb_md5(v, 16, want); else bb_sha1(v, 16, want);
+        return std::memcmp(h, want, hash_n) == 0;
+    }
+    /* [MS-OFFCRYPTO] 2.3.7.1-2.3.7.2, method 1: the password (8-bit, at most 15 characters) checks against
+       the stored verifier; the stored key and the password, padded, make the 16-byte array (each byte
+       rotated left by two; Word's variant of the array rotates right by one). */
+    bool open_xor(uint16_t key, uint16_t verifier, const char* pw) {
+        uint8_t b[15]; size_t n = 0;
+        for (const char* q = pw; *q && n < 15; q++) b[n++] = uint8_t(*q);
+        uint16_t v = 0;
+        for (size_t k = n + 1; k-- > 0; ) {
+            uint8_t c = k == 0 ? uint8_t(n) : b[k - 1];
+            v = uint16_t((((v & 0x4000) ? 1 : 0) | ((v << 1) & 0x7FFF)) ^ c);
+        }
+        if ((v ^ 0xCE4B) != verifier) return false;
+        static const uint8_t pad[15] = { 0xBB, 0xFF, 0xFF, 0xBA, 0xFF, 0xFF, 0xB9, 0x80, 0x00, 0xBE, 0x0F, 0x00, 0xBF, 0x0F, 0x00 };
+        for (size_t k = 0; k < 16; k++) {
+            uint8_t c = uint8_t((k < n ? b[k] : pad[k - n]) ^ (k & 1 ? key >> 8 : key & 0xFF));
+            xor_arr[k] = uint8_t((c << 2) | (c >> 6));
+        }
+        kind = XOR;
+        return true;
+    }
+};
+
+/* Records left in plain text inside an encrypted stream. */
+bool plain_record(uint16_t type) {
+    switch (type) {
+        case 0x0809: case 0x002F: case 0x0194: case 0x0195: case 0x00E1: case 0x0196: case 0x0138: return true;
+        default: return false;   /* BOF FILEPASS UsrExcl FileLock InterfaceHdr RRDInfo RRDHead */
+    }
+}
+
+/* Running decryption state for one forward walk: the RC4 keystream is kept positioned, so reading record
+   after record costs only the four header bytes skipped between bodies; a seek re-keys at most once. */
+class BiffDecrypter {
+public:
+    explicit BiffDecrypter(const BiffKey& k) : k_(k) {}
+    /* n bytes that sit at stream offset `off` inside a record of length `rlen`, in place. */
+    void apply(size_t off, uint8_t* d, size_t n, uint16_t rlen) {
+        if (k_.kind == BiffKey::XOR) {
+            for (size_t i = 0; i < n; i++) {
+                uint8_t c = uint8_t((d[i] << 3) | (d[i] >> 5));
+                d[i] = c ^ k_.xor_arr[(off + i + rlen) & 15];
+            }
+            return;
+        }
+        while (n > 0) {
+            uint32_t blk = uint32_t(off / 1024);
+            if (blk != blk_ || off < pos_) {
+                uint8_t key[16]; k_.block_key(blk, key);
+                rc4_.init(key, k_.rc4_key_len());
+                blk_ = blk; pos_ = size_t(blk) * 1024;
+            }
+            rc4_.skip(off - pos_);
+            size_t take = std::min(n, size_t(blk) * 1024 + 1024 - off);
+            rc4_.apply(d, take);
+            d += take; n -= take; off += take; pos_ = off;
+        }
+    }
+private:
+    const BiffKey& k_;
+    Rc4 rc4_; uint32_t blk_ = 0xFFFFFFFFu; size_t pos_ = 0;
+};
+
+/* Record iterator over a flat BIFF stream. The CONTINUE records after a record are folded into it: next()
+   steps over them, and cont() reads the body and its continuations as one sequence. With a key, each
+   record's body and continuations are decrypted into a buffer the iterator reuses: rec.r is then valid
+   only until the next next(), which in_place() tells a caller that keeps pointers. */
+struct BiffRec { uint16_t type = 0, len = 0; size_t body = 0, next = 0; const uint8_t* r = nullptr; };
+class BiffRecords {
+public:
+    BiffRecords(const uint8_t* p, size_t n, size_t off = 0, const BiffKey* key = nullptr) : p_(p), n_(n), off_(off) {
+        decrypt_with(key);
+    }
+    /* Decrypt the records that follow (scan_globals switches this on after FILEPASS). */
+    void decrypt_with(const BiffKey* key) {
+        if (key && key->kind != BiffKey::NONE) dec_.reset(new BiffDecrypter(*key));
+    }
+    bool next(BiffRec& rec) {
+        if (off_ + 4 > n_) return false;
+        rec.type = le16(p_ + off_); rec.len = le16(p_ + off_ + 2); rec.body = off_ + 4;
+        if (rec.body + rec.len > n_) return false;
+        rec.r = p_ + rec.body;
+        off_ = rec.body + rec.len;
+        while (off_ + 4 <= n_ && le16(p_ + off_) == 0x003C && off_ + 4 + le16(p_ + off_ + 2) <= n_)
+            off_ += 4 + le16(p_ + off_ + 2);
+        rec.next = off_;
+        if (dec_) decrypt(rec);
         return true;
-    } catch (const std::exception& e) { err = e.what(); return false; }
+    }
+    ContReader cont(const BiffRec& rec) const {
+        if (!dec_) return ContReader(p_, rec.next, rec.body, rec.len);
+        std::vector<std::pair<const uint8_t*, size_t>> seg;
+        for (size_t k = 0, at = 0; k < seg_len_.size(); at += seg_len_[k++]) seg.push_back({plain_.data() + at, seg_len_[k]});
+        return ContReader(std::move(seg));
+    }
+    size_t offset() const { return off_; }
+    bool in_place() const { return !dec_; }
+private:
+    void decrypt(BiffRec& rec) {
+        plain_.assign(p_ + rec.body, p_ + rec.next);          /* body + continuations, headers dropped below */
+        seg_len_.assign(1, rec.len);
+        size_t w = rec.len;
+        if (!plain_record(rec.type)) {
+            size_t skip = rec.type == 0x0085 ? std::min<size_t>(4, rec.len) : 0;   /* BoundSheet8 lbPlyPos */
+            dec_->apply(rec.body + skip, plain_.data() + skip, rec.len - skip, rec.len);
+        }
+        for (size_t o = rec.body + rec.len; o < rec.next; ) {
+            uint16_t l = le16(p_ + o + 2);
+            std::memmove(plain_.data() + w, p_ + o + 4, l);
+            dec_->apply(o + 4, plain_.data() + w, l, l);
+            seg_len_.push_back(l); w += l; o += 4 + l;
+        }
+        plain_.resize(w);
+        rec.r = plain_.data();
+    }
+
+    const uint8_t* p_; size_t n_, off_;
+    std::unique_ptr<BiffDecrypter> dec_;
+    std::vector<uint8_t> plain_; std::vector<size_t> seg_len_;
+};
+
+/* What the cell reader needs from the globals substream on top of Globals: the shared-string table and
+   the XF -> font / number-format chain behind every cell's style. */
+struct XlsFont { std::string name; double size = BBOXES_DEFAULT_FONT_SIZE; bool bold = false, italic = false,
+                 underline = false; uint16_t icv = 0; };
+struct CellGlobals { std::vector<std::string> sst; std::vector<XlsFont> fonts;
+                     std::vector<uint16_t> xf_font, xf_fmt; std::unordered_map<uint16_t, std::string> formats;
+                     uint32_t palette[56]; bool date1904 = false;
+                     CellGlobals() { std::memcpy(palette, kPalette, sizeof palette); } };
+
+void read_sst(ContReader& cr, std::vector<std::string>& sst) {   /* SST: cstTotal, cstUnique, strings */
+    cr.u32(); uint32_t cuniq = cr.u32();
+    sst.reserve(std::min<uint32_t>(cuniq, 1u << 20));
+    for (uint32_t i = 0; i < cuniq && cr.more(); i++) {           /* XLUnicodeRichExtendedString */
+        uint16_t cch = cr.u16(); uint8_t fl = cr.u8();
+        uint16_t runs = (fl & 0x08) ? cr.u16() : 0;
+        uint32_t ext  = (fl & 0x04) ? cr.u32() : 0;
+        std::string s; cr.chars(cch, fl & 0x01, s);
+        cr.skip(4u * runs + ext);
+        sst.push_back(std::move(s));
+    }
+}
+
+/* Formatting / string records of the globals substream, for the cell reader. */
+void scan_cell_global(const BiffRecords& it, const BiffRec& rec, bool biff8, CellGlobals& cg) {
+    const uint16_t type = rec.type, len = rec.len;
+    const uint8_t* r = rec.r;
+    if (type == 0x00FC && biff8 && len >= 8) {                    /* SST (+ CONTINUE) */
+        ContReader cr = it.cont(rec); read_sst(cr, cg.sst);
+    } else if (type == 0x0031 && len >= 15) {                    /* FONT: dyHeight grbit icv bls sss uls ... name@14 */
+        XlsFont f;
+        if (le16(r)) f.size = le16(r) / 20.0;                     /* twips -> points */
+        uint16_t grbit = le16(r + 2);
+        f.italic = (grbit & 0x0002) != 0;
+        f.icv = le16(r + 4);
+        f.bold = le16(r + 6) >= 700 || (grbit & 0x0001);
+        f.underline = r[10] != 0;
+        uint8_t cch = r[14];
+        f.name = biff8 ? (len >= 16 ? flat_chars(r + 16, len - 16u, cch, r[15] & 0x01) : std::string())
+                       : flat_chars(r + 15, len - 15u, cch, false);
+        cg.fonts.push_back(std::move(f));
+    } else if (type == 0x00E0 && len >= 4) {                     /* XF: ifnt, ifmt */
+        cg.xf_font.push_back(le16(r)); cg.xf_fmt.push_back(le16(r + 2));
+    } else if (type == 0x041E && len >= 3) {                     /* FORMAT: ifmt + string */
+        uint16_t id = le16(r);
+        if (biff8 && len >= 5) cg.formats[id] = flat_chars(r + 5, len - 5u, le16(r + 2), r[4] & 0x01);
+        else if (!biff8)       cg.formats[id] = flat_chars(r + 3, len - 3u, r[2], false);
+    } else if (type == 0x0092 && len >= 2) {                     /* PALETTE: ccv LongRGB entries for icv 8.. */
+        uint16_t ccv = le16(r);
+        for (uint16_t i = 0; i < ccv && i < 56 && 2u + 4u * i + 3u <= len; i++)
+            cg.palette[i] = (uint32_t(r[2 + 4 * i]) << 16) | (uint32_t(r[3 + 4 * i]) << 8) | r[4 + 4 * i];
+    } else if (type == 0x0022 && len >= 2) {                     /* DATEMODE */
+        cg.date1904 = le16(r) != 0;
+    }
 }
 
 /* ── globals pre-scan: sheet names (BoundSheet8) + ExternSheet XTIs (for 3D ref resolution) ──────────── */
 struct SupBookInfo { bool self = false; int ext_index = 0; std::vector<std::string> sheets; };  /* self = this workbook; else external, sheets named here */
 struct XTI { int isup = 0, first = 0, last = 0; };                                               /* ExternSheet entry: SupBook + sheet range */
+struct ExtSheet5 { int ext_index = 0; bool own_sheet = false; std::string book, sheet; };          /* BIFF5/7 EXTERNSHEET: ext_index 0 = this workbook */
 struct Globals { std::vector<std::string> sheets; std::vector<uint32_t> sheet_pos; std::vector<uint8_t> sheet_dt;
-                 std::vector<SupBookInfo> supbooks; std::vector<XTI> xtis;
-                 std::vector<std::string> lbl_names; uint16_t biff_version = 0x0600; };
-Globals scan_globals(const uint8_t* p, size_t n) {
-    Globals g; size_t off = 0; bool first_bof = true;
-    while (off + 4 <= n) {
-        uint16_t type = uint16_t(p[off]) | (uint16_t(p[off+1]) << 8);
-        uint16_t len  = uint16_t(p[off+2]) | (uint16_t(p[off+3]) << 8);
-        off += 4; if (off + len > n) break;
-        const uint8_t* r = p + off;
+                 std::vector<SupBookInfo> supbooks; std::vector<XTI> xtis; std::vector<ExtSheet5> ext5;
+                 std::vector<std::string> lbl_names; uint16_t biff_version = 0x0600;
+                 BiffKey key; size_t end = 0; bool filepass = false; };   /* end = offset past the globals EOF;
+                                                                            filepass = encrypted and not opened */
+/* BIFF5/7 EXTERNSHEET name: 0x03 + sheet = a sheet of this workbook, 0x02 = the formula's own sheet,
+   0x01 + encoded path "dir\x03[book.xls]Sheet" = an external workbook (numbered [n] in first-seen order).
+   Anything else (0x04 own book, add-in, DDE) carries no sheet to qualify with. */
+ExtSheet5 ext_sheet5(const uint8_t* s, size_t n, const std::vector<ExtSheet5>& prior) {
+    ExtSheet5 e;
+    if (n == 0) return e;
+    std::string rest = flat_chars(s + 1, n - 1, n - 1, false);
+    if (s[0] == 0x03) { e.sheet = std::move(rest); return e; }
+    if (s[0] == 0x02) { e.own_sheet = true; return e; }
+    if (s[0] != 0x01) return e;
+    size_t cut = rest.rfind(']');                            /* [book]Sheet; BIFF4-style 0x09 also ends the path */
+    if (cut == std::string::npos) cut = rest.find('\x09');
+    if (cut != std::string::npos) { e.book = rest.substr(0, cut); e.sheet = rest.substr(cut + 1); }
+    else e.book = std::move(rest);
+    int books = 0;
+    for (const ExtSheet5& p : prior) {
+        if (p.ext_index > books) books = p.ext_index;
+        if (p.ext_index && p.book == e.book) { e.ext_index = p.ext_index; return e; }
+    }
+    e.ext_index = books + 1;
+    return e;
+}
+/* Lbl: 14 fixed bytes, then the name — BIFF8 puts a flags byte first, BIFF5/7 names are 8-bit — then rgce. */
+struct LblName { std::string name; const uint8_t* rgce = nullptr; size_t avail = 0; };
+LblName lbl_name(const uint8_t* r, uint16_t len, bool biff8) {
+    LblName l;
+    uint16_t grbit = le16(r); uint8_t cch = r[3];
+    size_t at = biff8 ? 15 : 14; bool high = biff8 && (r[14] & 0x01);
+    const uint8_t* s = r + at;
+    if ((grbit & 0x0020) && cch >= 1 && at < len) { const char* bn = builtin_name(s[0]); l.name = bn ? bn : ("builtin#" + std::to_string(s[0])); }
+    else if (high) { for (uint32_t k = 0; k < cch && at + 2u*k + 1u < len; k++) { uint16_t ch = le16(s + 2*k); l.name += (ch < 128) ? char(ch) : '?'; } }
+    else { for (uint32_t k = 0; k < cch && at + k < len; k++) l.name += char(s[k]); }
+    size_t nb = high ? 2u * cch : cch;
+    l.rgce = s + nb; l.avail = at + nb <= len ? len - (at + nb) : 0;
+    return l;
+}
+/* Walks the globals substream only (first BOF to its EOF); sheet substreams are left to the caller. With
+   `cells`, the SST and formatting records are decoded too. At FILEPASS the key is derived from `password`
+   and the walk goes on decrypting; when it does not verify, the walk stops there with g.filepass set. */
+Globals scan_globals(const uint8_t* p, size_t n, CellGlobals* cells = nullptr, const char* password = nullptr) {
+    Globals g; BiffRecords it(p, n); BiffRec rec; bool first_bof = true;
+    while (it.next(rec)) {
+        const uint16_t type = rec.type, len = rec.len;
+        const uint8_t* r = rec.r;
         if (type == 0x0809 && first_bof) {                   /* first BOF = workbook globals: BIFF version */
             if (len >= 2) g.biff_version = uint16_t(r[0]) | (uint16_t(r[1]) << 8);
             first_bof = false;
+        } else if (type == 0x000A) {                         /* globals EOF */
+            break;
+        } else if (type == 0x002F) {                         /* FILEPASS */
+            if (!g.key.open(r, len, g.biff_version == 0x0600, password)) { g.key = BiffKey(); g.filepass = true; break; }
+            it.decrypt_with(&g.key);
         } else if (type == 0x0085 && len >= 8) {             /* BoundSheet8: lbPlyPos(4) hsState(1) dt(1) name@6 */
             uint32_t pos = uint32_t(r[0]) | (uint32_t(r[1])<<8) | (uint32_t(r[2])<<16) | (uint32_t(r[3])<<24);
             uint8_t dt = r[5], cch = r[6], flags = r[7]; std::string nm;
-            for (uint32_t i = 0; i < cch; i++) {
+            if (g.biff_version != 0x0600) nm = flat_chars(r + 7, len - 7u, cch, false);   /* BIFF5/7: 8-bit name, no flags byte */
+            else for (uint32_t i = 0; i < cch; i++) {
                 if (flags & 0x01) { size_t o = 8 + 2*i; if (o+1 < len) nm += char(uint16_t(r[o]) | (uint16_t(r[o+1])<<8)); }
                 else              { size_t o = 8 + i;   if (o   < len) nm += char(r[o]); }
             }
@@ -105,6 +460,8 @@ Globals scan_globals(const uint8_t* p, size_t n) {
             int extc = 0; for (auto& b : g.supbooks) if (!b.self) extc++;
             if (!sb.self) sb.ext_index = extc + 1;            /* 1-based index among external workbooks */
             g.supbooks.push_back(std::move(sb));
+        } else if (type == 0x0017 && len >= 1 && g.biff_version != 0x0600) {   /* BIFF5/7 EXTERNSHEET: one encoded sheet name per record */
+            g.ext5.push_back(ext_sheet5(r + 1, std::min<size_t>(r[0], len - 1u), g.ext5));
         } else if (type == 0x0017 && len >= 2) {             /* ExternSheet: cXTI then {iSupBook,itabFirst,itabLast} */
             uint16_t cxti = uint16_t(r[0]) | (uint16_t(r[1]) << 8);
             for (uint16_t i = 0; i < cxti && 2 + i*6 + 5 < len; i++) {
@@ -114,98 +471,18 @@ Globals scan_globals(const uint8_t* p, size_t n) {
                 g.xtis.push_back(x);
             }
         } else if (type == 0x0018 && len >= 15) {            /* Lbl/NAME: capture name (1-based) for PtgName */
-            uint16_t grbit = uint16_t(r[0]) | (uint16_t(r[1]) << 8);
-            uint8_t cch = r[3]; bool builtin = (grbit & 0x0020);
-            uint8_t flags = r[14]; const uint8_t* s = r + 15; std::string nm;
-            if (builtin && cch >= 1) { const char* bn = builtin_name(s[0]); nm = bn ? bn : ("builtin#" + std::to_string(s[0])); }
-            else if (flags & 0x01) { for (uint32_t k = 0; k < cch && 15u + 2u*k + 1u < len; k++) { uint16_t ch = uint16_t(s[2*k]) | (uint16_t(s[2*k+1]) << 8); nm += (ch < 128) ? char(ch) : '?'; } }
-            else { for (uint32_t k = 0; k < cch && 15u + k < len; k++) nm += char(s[k]); }
-            g.lbl_names.push_back(nm);
+            g.lbl_names.push_back(lbl_name(r, len, g.biff_version == 0x0600).name);
+        } else if (cells) {
+            scan_cell_global(it, rec, g.biff_version == 0x0600, *cells);
         }
-        off += len;
     }
+    g.end = it.offset();
     return g;
 }
 
-std::string col_letters(int col) {                            /* 0-based col -> A, B, ... AA */
-    std::string s; col += 1;
-    while (col > 0) { int r = (col - 1) % 26; s = char('A' + r) + s; col = (col - 1) / 26; }
-    return s;
-}
+std::string col_letters(int col) { std::string s; append_col(s, col); return s; }
 
 /* ── the Ptg parser: rgce token array -> {R1C1, A1} via a dual-notation RPN stack ─────────────────────── */
-struct Expr { std::string r1c1, a1; int prec = 99; };
-const char* ftab(uint16_t i) {                                /* [MS-XLS] 2.5.198.17 Ftab — canonical BIFF function index table */
-    switch (i) {
-        case 0: return "COUNT"; case 1: return "IF"; case 2: return "ISNA"; case 3: return "ISERROR";
-        case 4: return "SUM"; case 5: return "AVERAGE"; case 6: return "MIN"; case 7: return "MAX";
-        case 8: return "ROW"; case 9: return "COLUMN"; case 10: return "NA"; case 11: return "NPV";
-        case 12: return "STDEV"; case 13: return "DOLLAR"; case 14: return "FIXED"; case 15: return "SIN";
-        case 16: return "COS"; case 17: return "TAN"; case 18: return "ATAN"; case 19: return "PI";
-        case 20: return "SQRT"; case 21: return "EXP"; case 22: return "LN"; case 23: return "LOG10";
-        case 24: return "ABS"; case 25: return "INT"; case 26: return "SIGN"; case 27: return "ROUND";
-        case 28: return "LOOKUP"; case 29: return "INDEX"; case 30: return "REPT"; case 31: return "MID";
-        case 32: return "LEN"; case 33: return "VALUE"; case 34: return "TRUE"; case 35: return "FALSE";
-        case 36: return "AND"; case 37: return "OR"; case 38: return "NOT"; case 39: return "MOD";
-        case 40: return "DCOUNT"; case 41: return "DSUM"; case 42: return "DAVERAGE"; case 43: return "DMIN";
-        case 44: return "DMAX"; case 45: return "DSTDEV"; case 46: return "VAR"; case 47: return "DVAR";
-        case 48: return "TEXT"; case 56: return "PV"; case 57: return "FV"; case 58: return "NPER";
-        case 59: return "PMT"; case 60: return "RATE"; case 61: return "MIRR"; case 62: return "IRR";
-        case 63: return "RAND"; case 64: return "MATCH"; case 65: return "DATE"; case 66: return "TIME";
-        case 67: return "DAY"; case 68: return "MONTH"; case 69: return "YEAR"; case 70: return "WEEKDAY";
-        case 71: return "HOUR"; case 72: return "MINUTE"; case 73: return "SECOND"; case 74: return "NOW";
-        case 75: return "AREAS"; case 76: return "ROWS"; case 77: return "COLUMNS"; case 78: return "OFFSET";
-        case 82: return "SEARCH"; case 83: return "TRANSPOSE"; case 97: return "ATAN2"; case 98: return "ASIN";
-        case 99: return "ACOS"; case 100: return "CHOOSE"; case 101: return "HLOOKUP"; case 102: return "VLOOKUP";
-        case 105: return "ISREF"; case 109: return "LOG"; case 111: return "CHAR"; case 112: return "LOWER";
-        case 113: return "UPPER"; case 114: return "PROPER"; case 115: return "LEFT"; case 116: return "RIGHT";
-        case 117: return "EXACT"; case 118: return "TRIM"; case 119: return "REPLACE"; case 120: return "SUBSTITUTE";
-        case 121: return "CODE"; case 124: return "FIND"; case 125: return "CELL"; case 126: return "ISERR";
-        case 127: return "ISTEXT"; case 128: return "ISNUMBER"; case 129: return "ISBLANK"; case 130: return "T";
-        case 131: return "N"; case 140: return "DATEVALUE"; case 141: return "TIMEVALUE"; case 142: return "SLN";
-        case 143: return "SYD"; case 144: return "DDB"; case 148: return "INDIRECT"; case 162: return "CLEAN";
-        case 163: return "MDETERM"; case 164: return "MINVERSE"; case 165: return "MMULT"; case 167: return "IPMT";
-        case 168: return "PPMT"; case 169: return "COUNTA"; case 183: return "PRODUCT"; case 184: return "FACT";
-        case 189: return "DPRODUCT"; case 190: return "ISNONTEXT"; case 193: return "STDEVP"; case 194: return "VARP";
-        case 195: return "DSTDEVP"; case 196: return "DVARP"; case 197: return "TRUNC"; case 198: return "ISLOGICAL";
-        case 199: return "DCOUNTA"; case 212: return "ROUNDUP"; case 213: return "ROUNDDOWN"; case 216: return "RANK";
-        case 219: return "ADDRESS"; case 220: return "DAYS360"; case 221: return "TODAY"; case 222: return "VDB";
-        case 227: return "MEDIAN"; case 228: return "SUMPRODUCT"; case 229: return "SINH"; case 230: return "COSH";
-        case 231: return "TANH"; case 232: return "ASINH"; case 233: return "ACOSH"; case 234: return "ATANH";
-        case 235: return "DGET"; case 244: return "INFO"; case 247: return "DB"; case 252: return "FREQUENCY";
-        case 261: return "ERROR.TYPE"; case 269: return "AVEDEV"; case 270: return "BETADIST"; case 273: return "BINOMDIST";
-        case 276: return "COMBIN"; case 279: return "EVEN"; case 280: return "EXPONDIST"; case 285: return "FLOOR";
-        case 288: return "CEILING"; case 291: return "HYPGEOMDIST"; case 297: return "SUMSQ"; case 298: return "ODD";
-        case 299: return "SKEW"; case 300: return "ZTEST"; case 303: return "SUMXMY2"; case 304: return "SUMX2MY2";
-        case 305: return "SUMX2PY2"; case 318: return "DEVSQ"; case 321: return "SUMSQ"; case 325: return "LARGE";
-        case 326: return "SMALL"; case 327: return "QUARTILE"; case 328: return "PERCENTILE"; case 329: return "PERCENTRANK";
-        case 330: return "MODE"; case 331: return "TRIMMEAN"; case 336: return "CONCATENATE"; case 337: return "POWER";
-        case 342: return "RADIANS"; case 343: return "DEGREES"; case 344: return "SUBTOTAL"; case 345: return "SUMIF";
-        case 346: return "COUNTIF"; case 347: return "COUNTBLANK"; case 359: return "HYPERLINK"; case 361: return "AVERAGEA";
-        case 362: return "MAXA";
-        case 363: return "MINA"; case 364: return "STDEVPA"; case 365: return "VARPA"; case 366: return "STDEVA";
-        case 367: return "VARA";
-        default: return nullptr;
-    }
-}
-/* Fixed argument count for PtgFunc (0x21) — [MS-XLS] 2.5.198.17. PtgFuncVar carries its own count,
-   so only truly-fixed functions need listing here. -1 = unknown (fall back to 1). */
-int ftab_argc(uint16_t i) {
-    switch (i) {
-        case 10: case 19: case 34: case 35: case 63: case 74: case 221: return 0;   /* NA PI TRUE FALSE RAND NOW TODAY */
-        case 2: case 3: case 15: case 16: case 17: case 18: case 20: case 21: case 22: case 23:
-        case 24: case 25: case 26: case 38: case 67: case 68: case 69: case 71: case 72: case 73:
-        case 98: case 99: case 111: case 112: case 113: case 114: case 121: case 126: case 127:
-        case 128: case 129: case 130: case 131: case 162: case 184: case 190: case 198:
-        case 229: case 230: case 231: case 232: case 233: case 234: case 342: case 343: return 1;
-        case 27: case 39: case 97: case 117: case 212: case 213: case 220: case 276: case 285: case 288:
-        case 303: case 304: case 305: case 325: case 326: case 327: case 328: case 337: return 2;
-        /* ROUND MOD ATAN2 EXACT ROUNDUP ROUNDDOWN DAYS360 COMBIN FLOOR CEILING SUMXMY2 SUMX2MY2 SUMX2PY2 LARGE SMALL QUARTILE PERCENTILE POWER */
-        case 31: case 61: case 65: case 66: return 3;                               /* MID MIRR DATE TIME */
-        case 119: return 4;                                                         /* REPLACE */
-        default: return -1;
-    }
-}
 /* render one RgceLoc (rw + column-with-flags [MS-XLS] 2.5.198.105/.121).
    mode 0 = ABS  : PtgRef in a Formula — rw/col hold ABSOLUTE addresses; R1C1 rel = value-home.
    mode 1 = N    : PtgRefN / shared-formula base — rel axis holds a SIGNED OFFSET (row int16, col int8),
@@ -221,54 +498,164 @@ void render_loc2(uint16_t rwf, uint16_t gc, int homeRow, int homeCol, int mode,
     else { int hr = (mode == 1) ? homeRow : 0, hc = (mode == 1) ? homeCol : 0;
            rowR1 = rowOff; colR1 = colOff;
            rowA1 = rowRel ? hr + rowOff : int(rwf); colA1 = colRel ? hc + colOff : colAbs; }
-    std::string rp = rowRel ? ("R" + (rowR1 ? "[" + std::to_string(rowR1) + "]" : "")) : ("R" + std::to_string(int(rwf) + 1));
-    std::string cp = colRel ? ("C" + (colR1 ? "[" + std::to_string(colR1) + "]" : "")) : ("C" + std::to_string(colAbs + 1));
-    r1c1 = rp + cp;
-    a1 = (colRel ? "" : "$") + col_letters(colA1) + (rowRel ? "" : "$") + std::to_string(rowA1 + 1);
+    r1c1 += 'R';                                  /* appended, not assigned: callers write straight into the stack */
+    if (!rowRel) append_int(r1c1, int(rwf) + 1); else if (rowR1) { r1c1 += '['; append_int(r1c1, rowR1); r1c1 += ']'; }
+    r1c1 += 'C';
+    if (!colRel) append_int(r1c1, colAbs + 1);   else if (colR1) { r1c1 += '['; append_int(r1c1, colR1); r1c1 += ']'; }
+    if (!colRel) a1 += '$';
+    append_col(a1, colA1);
+    if (!rowRel) a1 += '$';
+    append_int(a1, rowA1 + 1);
+}
+/* appends "Sheet!" / "[1]Sheet2:Sheet5!"; ext_index 0 = this workbook */
+void put_qual(std::string& out, int ext_index, const std::string* first, const std::string* last) {
+    bool external = ext_index != 0;
+    if (external) { out += '['; append_int(out, ext_index); out += ']'; }
+    if (!first || first->empty()) { if (external) out += '!'; return; }
+    auto q = [&](const std::string& s) {
+        bool quote = s.find(' ') != std::string::npos;
+        if (quote) out += '\'';
+        out += s;
+        if (quote) out += '\'';
+    };
+    q(*first);
+    if (last && !last->empty() && *last != *first) { out += ':'; q(*last); }   /* Sheet2:Sheet5 */
+    out += '!';
 }
-std::string sheet_qual(const Globals& g, uint16_t ixti) {
-    if (ixti >= g.xtis.size()) return "";
+void sheet_qual(const Globals& g, uint16_t ixti, std::string& out) {   /* BIFF8: XTI -> SupBook + sheet range */
+    if (ixti >= g.xtis.size()) return;
     const XTI& x = g.xtis[ixti];
-    bool external = false; int ext_index = 0; std::string first, last;
+    int ext_index = 0; const std::string *first = nullptr, *last = nullptr;
     if (x.isup >= 0 && x.isup < (int)g.supbooks.size()) {
         const SupBookInfo& sb = g.supbooks[x.isup];
         const std::vector<std::string>& src = sb.self ? g.sheets : sb.sheets;   /* self -> local sheet names */
-        external = !sb.self; ext_index = sb.ext_index;
-        if (x.first >= 0 && x.first < (int)src.size()) first = src[x.first];
-        if (x.last  >= 0 && x.last  < (int)src.size()) last  = src[x.last];
-    }
-    std::string prefix = external ? ("[" + std::to_string(ext_index) + "]") : "";
-    if (first.empty()) return external ? prefix + "!" : "";
-    auto q = [](const std::string& s){ return s.find(' ') != std::string::npos ? "'" + s + "'" : s; };
-    std::string sheets = (last.empty() || last == first) ? q(first) : (q(first) + ":" + q(last));   /* Sheet2:Sheet5 */
-    return prefix + sheets + "!";
+        ext_index = sb.self ? 0 : sb.ext_index;
+        if (x.first >= 0 && x.first < (int)src.size()) first = &src[x.first];
+        if (x.last  >= 0 && x.last  < (int)src.size()) last  = &src[x.last];
+    }
+    put_qual(out, ext_index, first, last);
+}
+/* BIFF5/7: a negative ixals is this workbook, sheets itabFirst..itabLast; otherwise the 1-based EXTERNSHEET
+   record, always a single sheet. Returns whether the reference spans sheets. */
+bool sheet_qual5(const Globals& g, int16_t ixals, uint16_t itab1, uint16_t itab2, std::string& out) {
+    if (ixals < 0) {
+        const std::string* first = itab1 < g.sheets.size() ? &g.sheets[itab1] : nullptr;
+        const std::string* last  = itab2 < g.sheets.size() ? &g.sheets[itab2] : nullptr;
+        put_qual(out, 0, first, last);
+        return itab1 != itab2;
+    }
+    if (ixals == 0 || size_t(ixals) > g.ext5.size()) return false;
+    const ExtSheet5& e = g.ext5[size_t(ixals) - 1];
+    if (!e.own_sheet) put_qual(out, e.ext_index, &e.sheet, &e.sheet);
+    return false;
 }
-std::string ptg_str(const uint8_t* r, size_t avail, size_t& consumed) {   /* ShortXLUnicodeString */
-    uint8_t cch = r[0], flags = r[1]; std::string s;
+size_t ptg_str(const uint8_t* r, size_t avail, std::string& out) {   /* ShortXLUnicodeString; returns bytes used */
+    uint8_t cch = r[0], flags = r[1];
     for (uint32_t i = 0; i < cch; i++) {
-        if (flags & 0x01) { size_t o = 2 + 2*i; if (o+1 < avail) s += char(uint16_t(r[o]) | (uint16_t(r[o+1])<<8)); }
-        else              { size_t o = 2 + i;   if (o   < avail) s += char(r[o]); }
+        if (flags & 0x01) { size_t o = 2 + 2*i; if (o+1 < avail) out += char(uint16_t(r[o]) | (uint16_t(r[o+1])<<8)); }
+        else              { size_t o = 2 + i;   if (o   < avail) out += char(r[o]); }
     }
-    consumed = 2 + cch * ((flags & 0x01) ? 2 : 1);
-    return s;
+    return 2 + cch * ((flags & 0x01) ? 2 : 1);
 }
 
-Expr render_rgce(const uint8_t* rgce, size_t cce, int homeRow, int homeCol, bool hasHome, const Globals& g) {
-    std::vector<Expr> st;
-    auto push = [&](std::string r1, std::string a1, int prec = 99) { st.push_back({std::move(r1), std::move(a1), prec}); };
-    auto binop = [&](const char* sym, int prec) {
-        if (st.size() < 2) { push("«?»", "«?»"); return; }
-        Expr b = st.back(); st.pop_back(); Expr a = st.back(); st.pop_back();
-        auto w = [&](const std::string& s, int p) { return p < prec ? "(" + s + ")" : s; };
-        push(w(a.r1c1, a.prec) + sym + w(b.r1c1, b.prec), w(a.a1, a.prec) + sym + w(b.a1, b.prec), prec);
-    };
-    auto func = [&](const char* name, int argc) {
-        std::string r = std::string(name) + "(", a = r; int start = int(st.size()) - argc;
-        if (start < 0) start = 0;
-        for (int i = start; i < (int)st.size(); i++) { if (i > start) { r += ","; a += ","; } r += st[i].r1c1; a += st[i].a1; }
-        st.erase(st.begin() + start, st.end());
-        push(r + ")", a + ")");
-    };
+/* Renders rgce token arrays through two string stacks (R1C1 and A1) whose entries sit back to back in one
+   buffer per notation, each slot remembering where it starts. An operator rewrites the tail holding its
+   operands in place, so a formula costs no allocation once the buffers have grown — the renderer is meant
+   to live across a whole walk. Results are valid until the next render(). */
+class RgceRenderer {
+public:
+    explicit RgceRenderer(const Globals& g) : g_(g), biff8_(g.biff_version == 0x0600) {}
+
+    void render(const uint8_t* rgce, size_t cce, int homeRow, int homeCol, bool hasHome);
+    std::string r1c1() const { return st_.empty() ? std::string() : r1_.substr(st_.back().r); }
+    std::string a1()   const { return st_.empty() ? std::string() : a1_.substr(st_.back().a); }
+
+private:
+    struct Slot { size_t r, a; int prec; };
+
+    Slot& open(int prec = 99) { st_.push_back({r1_.size(), a1_.size(), prec}); return st_.back(); }
+    void push(const char* r, const char* a, int prec = 99) { open(prec); r1_ += r; a1_ += a; }
+    void push_same(const char* s) { push(s, s); }
+    void same_as_r1(const Slot& sl) { a1_.append(r1_, sl.r, std::string::npos); }   /* notation-free token */
+
+    /* Replace the top `k` slots with pre + arg0 + sep + arg1 ... + post, each arg wrapped in parens when its
+       precedence is below `wrap_below`. */
+    void fold(size_t k, const char* pre, const char* sep, const char* post, int wrap_below, int prec) {
+        size_t base = st_.size() - k;
+        Slot res{st_[base].r, st_[base].a, prec};
+        fold_one(r1_, base, k, pre, sep, post, wrap_below, &Slot::r);
+        fold_one(a1_, base, k, pre, sep, post, wrap_below, &Slot::a);
+        st_.resize(base);
+        st_.push_back(res);
+    }
+    void fold_one(std::string& buf, size_t base, size_t k, const char* pre, const char* sep, const char* post,
+                  int wrap_below, size_t Slot::*at) {
+        size_t start = st_[base].*at;
+        tmp_.assign(buf, start, std::string::npos);
+        buf.resize(start);
+        buf += pre;
+        for (size_t i = 0; i < k; i++) {
+            size_t b = st_[base + i].*at - start;
+            size_t e = (i + 1 < k ? st_[base + i + 1].*at : start + tmp_.size()) - start;
+            bool wrap = st_[base + i].prec < wrap_below;
+            if (i) buf += sep;
+            if (wrap) buf += '(';
+            buf.append(tmp_, b, e - b);
+            if (wrap) buf += ')';
+        }
+        buf += post;
+    }
+    void binop(const char* sym, int prec) {
+        if (st_.size() < 2) { push_same("«?»"); return; }
+        fold(2, "", sym, "", prec, prec);
+    }
+    void unary(const char* pre, const char* post, int prec) { if (!st_.empty()) fold(1, pre, "", post, 0, prec); }
+    void func(const char* name, int argc) {
+        size_t k = std::min<size_t>(argc < 0 ? 0 : size_t(argc), st_.size());
+        name_.assign(name); name_ += '(';
+        if (k == 0) { push(name_.c_str(), name_.c_str()); r1_ += ')'; a1_ += ')'; return; }
+        fold(k, name_.c_str(), ",", ")", 0, 99);
+    }
+    void func_id(uint16_t f, int argc) {
+        const char* fn = ftab_name(f);
+        if (fn) { func(fn, argc); return; }
+        std::string nm = "FUNC"; append_int(nm, f);
+        func(nm.c_str(), argc);
+    }
+    void area(uint16_t rw1, uint16_t rw2, uint16_t c1, uint16_t c2, int homeRow, int homeCol, int mode) {
+        open(8);
+        render_loc2(rw1, c1, homeRow, homeCol, mode, r1_, a1_);
+        r1_ += ':'; a1_ += ':';
+        render_loc2(rw2, c2, homeRow, homeCol, mode, r1_, a1_);
+    }
+    /* BIFF5/7 location: 14-bit rw with the relative flags on top, one-byte col; a relative row is a 14-bit
+       signed offset outside mode 0. Re-packed as the BIFF8 pair render_loc2 expects. */
+    void loc5(uint16_t rw, uint8_t col, int homeRow, int homeCol, int mode) {
+        uint16_t row = rw & 0x3FFF;
+        if (mode != 0 && (rw & 0x8000) && (row & 0x2000)) row |= 0xC000;
+        render_loc2(row, uint16_t(col | (rw & 0xC000)), homeRow, homeCol, mode, r1_, a1_);
+    }
+    void name_ref(uint32_t idx) {                                /* PtgName -> resolved defined-name */
+        Slot& sl = open();
+        if (idx >= 1 && idx <= g_.lbl_names.size()) r1_ += g_.lbl_names[idx - 1];
+        else { r1_ += "Name"; append_int(r1_, idx); }
+        same_as_r1(sl);
+    }
+    /* cross-sheet single ref -> area form Sheet1:Sheet3!A1:A1: repeat the location rendered from rs/as */
+    void ref_as_area(size_t rs, size_t as) {
+        tmp_.assign(r1_, rs, std::string::npos); r1_ += ':'; r1_ += tmp_;
+        tmp_.assign(a1_, as, std::string::npos); a1_ += ':'; a1_ += tmp_;
+    }
+    bool operand5(uint8_t base, const uint8_t* r, size_t avail, size_t& i, int homeRow, int homeCol, bool hasHome);
+
+    const Globals& g_;
+    const bool biff8_;
+    std::vector<Slot> st_;
+    std::string r1_, a1_, tmp_, name_, qual_;
+};
+
+void RgceRenderer::render(const uint8_t* rgce, size_t cce, int homeRow, int homeCol, bool hasHome) {
+    st_.clear(); r1_.clear(); a1_.clear();
     auto u16 = [](const uint8_t* q) -> uint16_t { return uint16_t(q[0]) | (uint16_t(q[1]) << 8); };
     size_t i = 0;
     while (i < cce) {
@@ -283,96 +670,178 @@ Expr render_rgce(const uint8_t* rgce, size_t cce, int homeRow, int homeCol, bool
                 case 0x09: binop("<", 1); break; case 0x0A: binop("<=",1); break; case 0x0B: binop("=", 1); break;
                 case 0x0C: binop(">=",1); break; case 0x0D: binop(">", 1); break; case 0x0E: binop("<>",1); break;
                 case 0x0F: binop(" ", 8); break; case 0x10: binop(",", 6); break; case 0x11: binop(":", 8); break;
-                case 0x12: if(!st.empty()){auto e=st.back();st.pop_back();push("+"+e.r1c1,"+"+e.a1,6);} break;  /* uplus */
-                case 0x13: if(!st.empty()){auto e=st.back();st.pop_back();push("-"+e.r1c1,"-"+e.a1,6);} break;  /* uminus */
-                case 0x14: if(!st.empty()){auto e=st.back();st.pop_back();push(e.r1c1+"%",e.a1+"%",7);} break;  /* percent */
-                case 0x15: if(!st.empty()){auto e=st.back();st.pop_back();push("("+e.r1c1+")","("+e.a1+")");} break; /* paren */
-                case 0x16: push("", ""); break;                                        /* missing arg */
-                case 0x17: { size_t used=0; std::string s = avail>=2 ? ptg_str(r,avail,used) : ""; i += used;
-                             std::string q="\""+s+"\""; push(q,q); } break;            /* PtgStr */
+                case 0x12: unary("+", "", 6); break;                                   /* uplus */
+                case 0x13: unary("-", "", 6); break;                                   /* uminus */
+                case 0x14: unary("", "%", 7); break;                                   /* percent */
+                case 0x15: unary("(", ")", 99); break;                                 /* paren */
+                case 0x16: push_same(""); break;                                       /* missing arg */
+                case 0x17: { Slot& sl = open(); r1_ += '"';                            /* PtgStr */
+                             if (!biff8_ && avail >= 1) {                              /* BIFF5/7: cch + 8-bit chars */
+                                 r1_.append(reinterpret_cast<const char*>(r + 1), std::min<size_t>(r[0], avail - 1));
+                                 i += 1u + r[0];
+                             } else if (avail >= 2) i += ptg_str(r, avail, r1_);
+                             r1_ += '"'; same_as_r1(sl); } break;
                 case 0x19: { uint8_t grbit = avail ? r[0] : 0;                          /* PtgAttr */
                              if (grbit & 0x04) { uint16_t c = avail >= 3 ? u16(r+1) : 0; i += 3 + (c + 1) * 2; } /* tAttrChoose: skip jump table */
                              else { i += 3; if (grbit & 0x10) func("SUM", 1); } }        /* tAttrSum; space/if/goto/skip are 3 bytes */
                     break;
-                case 0x1C: { uint8_t e = avail?r[0]:0; i += 1; const char* s = e==0x17?"#REF!":e==0x07?"#DIV/0!":e==0x0F?"#VALUE!":e==0x1D?"#NAME?":e==0x24?"#N/A":"#ERR!"; push(s,s);} break;
-                case 0x1D: { std::string s = (avail && r[0])?"TRUE()":"FALSE()"; i += 1; push(s,s);} break;   /* PtgBool (rendered as function, matching the oracle) */
-                case 0x1E: { int v = avail>=2 ? (uint16_t(r[0])|(uint16_t(r[1])<<8)) : 0; i += 2; push(std::to_string(v),std::to_string(v)); } break; /* int */
-                case 0x1F: { double d=0; if(avail>=8) memcpy(&d,r,8); i += 8; char b[32]; snprintf(b,sizeof b,"%.15g",d); push(b,b);} break; /* num */
+                case 0x1C: { uint8_t e = avail?r[0]:0; i += 1; push_same(e==0x17?"#REF!":e==0x07?"#DIV/0!":e==0x0F?"#VALUE!":e==0x1D?"#NAME?":e==0x24?"#N/A":"#ERR!"); } break;
+                case 0x1D: { push_same((avail && r[0])?"TRUE()":"FALSE()"); i += 1; } break;   /* PtgBool (rendered as function, matching the oracle) */
+                case 0x1E: { int v = avail>=2 ? u16(r) : 0; i += 2; Slot& sl = open(); append_int(r1_, v); same_as_r1(sl); } break; /* int */
+                case 0x1F: { double d=0; if(avail>=8) memcpy(&d,r,8); i += 8; char b[32]; snprintf(b,sizeof b,"%.15g",d); push_same(b);} break; /* num */
                 default: i = cce; break;                                               /* unknown control -> stop */
             }
+        } else if (!biff8_ && operand5(base, r, avail, i, homeRow, homeCol, hasHome)) {
+            continue;
         } else {
             switch (base) {
-                case 0x24: { int m=hasHome?0:2; if (avail>=4){ std::string a,b; render_loc2(u16(r),u16(r+2),homeRow,homeCol,m,a,b); push(a,b);} i += 4; } break;   /* PtgRef */
-                case 0x2C: { if (avail>=4){ std::string a,b; render_loc2(u16(r),u16(r+2),homeRow,homeCol,1,a,b);  push(a,b);} i += 4; } break;                        /* PtgRefN (offset) */
-                case 0x25: case 0x2D: { if (avail>=8){ int m=(base==0x25)?(hasHome?0:2):1; std::string a1,b1,a2,b2;   /* RgceArea: rwFirst,rwLast,colFirst,colLast */
-                    render_loc2(u16(r),  u16(r+4), homeRow,homeCol,m,a1,b1);
-                    render_loc2(u16(r+2),u16(r+6), homeRow,homeCol,m,a2,b2);
-                    push(a1+":"+a2, b1+":"+b2, 8);} i += 8; } break;                                                  /* PtgArea / PtgAreaN */
-                case 0x3A: { int m=hasHome?0:2; if (avail>=6){ uint16_t ix=u16(r); std::string a,b; render_loc2(u16(r+2),u16(r+4),homeRow,homeCol,m,a,b);
-                    std::string q=sheet_qual(g,ix);
-                    bool multi = ix < g.xtis.size() && g.xtis[ix].first != g.xtis[ix].last;   /* cross-sheet single ref -> area form A1:A1 */
-                    if (multi) push(q+a+":"+a, q+b+":"+b, 8); else push(q+a,q+b);} i += 6; } break;                    /* PtgRef3d: ixti + RgceLoc */
-                case 0x3B: { int m=hasHome?0:2; if (avail>=10){ uint16_t ix=u16(r); std::string a1,b1,a2,b2;         /* PtgArea3d: ixti + RgceArea */
-                    render_loc2(u16(r+2),u16(r+6),homeRow,homeCol,m,a1,b1);
-                    render_loc2(u16(r+4),u16(r+8),homeRow,homeCol,m,a2,b2);
-                    std::string q=sheet_qual(g,ix); push(q+a1+":"+a2, q+b1+":"+b2, 8);} i += 10; } break;
+                case 0x24: { int m=hasHome?0:2; if (avail>=4){ open(); render_loc2(u16(r),u16(r+2),homeRow,homeCol,m,r1_,a1_);} i += 4; } break;   /* PtgRef */
+                case 0x2C: { if (avail>=4){ open(); render_loc2(u16(r),u16(r+2),homeRow,homeCol,1,r1_,a1_);} i += 4; } break;                        /* PtgRefN (offset) */
+                case 0x25: case 0x2D: { if (avail>=8){ int m=(base==0x25)?(hasHome?0:2):1;                         /* RgceArea: rwFirst,rwLast,colFirst,colLast */
+                    area(u16(r), u16(r+2), u16(r+4), u16(r+6), homeRow, homeCol, m);} i += 8; } break;             /* PtgArea / PtgAreaN */
+                case 0x3A: { int m=hasHome?0:2; if (avail>=6){ uint16_t ix=u16(r);                                  /* PtgRef3d: ixti + RgceLoc */
+                    qual_.clear(); sheet_qual(g_,ix,qual_);
+                    bool multi = ix < g_.xtis.size() && g_.xtis[ix].first != g_.xtis[ix].last;   /* cross-sheet single ref -> area form A1:A1 */
+                    open(multi ? 8 : 99); r1_ += qual_; a1_ += qual_;
+                    size_t rs = r1_.size(), as = a1_.size();
+                    render_loc2(u16(r+2),u16(r+4),homeRow,homeCol,m,r1_,a1_);
+                    if (multi) ref_as_area(rs, as); } i += 6; } break;
+                case 0x3B: { int m=hasHome?0:2; if (avail>=10){ uint16_t ix=u16(r);                                 /* PtgArea3d: ixti + RgceArea */
+                    qual_.clear(); sheet_qual(g_,ix,qual_);
+                    open(8); r1_ += qual_; a1_ += qual_;
+                    render_loc2(u16(r+2),u16(r+6),homeRow,homeCol,m,r1_,a1_);
+                    r1_ += ':'; a1_ += ':';
+                    render_loc2(u16(r+4),u16(r+8),homeRow,homeCol,m,r1_,a1_);} i += 10; } break;
                 case 0x23: { uint32_t idx = avail>=4 ? (uint32_t(r[0])|(uint32_t(r[1])<<8)|(uint32_t(r[2])<<16)|(uint32_t(r[3])<<24)) : 0; i += 4;
-                             std::string nm = (idx>=1 && idx<=g.lbl_names.size()) ? g.lbl_names[idx-1] : ("Name"+std::to_string(idx));
-                             push(nm,nm); } break;                                       /* PtgName -> resolved defined-name */
+                             name_ref(idx); } break;                                     /* PtgName */
                 case 0x21: { uint16_t f = avail>=2 ? u16(r) : 0; i += 2;
-                             const char* fn=ftab(f); std::string nm = fn ? fn : ("FUNC"+std::to_string(f));
-                             int ac = ftab_argc(f); func(nm.c_str(), ac >= 0 ? ac : 1); } break;                     /* PtgFunc (fixed arg count) */
+                             int ac = ftab_argc(f); func_id(f, ac >= 0 ? ac : 1); } break;  /* PtgFunc (fixed arg count) */
                 case 0x22: { uint8_t argc = avail?r[0]:0; uint16_t f = avail>=3 ? u16(r+1) : 0; i += 3;
-                             const char* fn=ftab(f); std::string nm = fn ? fn : ("FUNC"+std::to_string(f)); func(nm.c_str(), argc); } break; /* PtgFuncVar */
+                             func_id(f, argc); } break;                                  /* PtgFuncVar */
                 default: i = cce; break;                                               /* unknown operand -> stop */
             }
         }
     }
-    if (st.empty()) return {"", "", 99};
-    return st.back();
 }
 
-/* ── the two-pass formula walk (shared by xls_formulas JSON + the bbox formula map) ──────────────────── */
+/* BIFF5/7 operands whose layout differs from BIFF8 ([MS-XLS] covers BIFF8 only; this follows the BIFF5
+   record layouts as Excel 95 writes them): PtgRef/RefN rw+col (3), PtgArea/AreaN (6), PtgRef3d/Area3d
+   behind an ixals + 8 reserved + itabFirst/itabLast prefix (17/20), PtgName ilbl + 12 reserved (14).
+   Returns false for tokens laid out as in BIFF8. */
+bool RgceRenderer::operand5(uint8_t base, const uint8_t* r, size_t avail, size_t& i, int homeRow, int homeCol, bool hasHome) {
+    const int m = hasHome ? 0 : 2;
+    switch (base) {
+        case 0x24: case 0x2C:                                                      /* PtgRef / PtgRefN */
+            if (avail >= 3) { open(); loc5(le16(r), r[2], homeRow, homeCol, base == 0x24 ? m : 1); }
+            i += 3; return true;
+        case 0x25: case 0x2D: {                                                    /* PtgArea / PtgAreaN */
+            int am = base == 0x25 ? m : 1;
+            if (avail >= 6) { open(8); loc5(le16(r), r[4], homeRow, homeCol, am); r1_ += ':'; a1_ += ':';
+                              loc5(le16(r + 2), r[5], homeRow, homeCol, am); }
+            i += 6; return true;
+        }
+        case 0x3A:                                                                 /* PtgRef3d */
+            if (avail >= 17) {
+                qual_.clear();
+                bool multi = sheet_qual5(g_, int16_t(le16(r)), le16(r + 10), le16(r + 12), qual_);
+                open(multi ? 8 : 99); r1_ += qual_; a1_ += qual_;
+                size_t rs = r1_.size(), as = a1_.size();
+                loc5(le16(r + 14), r[16], homeRow, homeCol, m);
+                if (multi) ref_as_area(rs, as);
+            }
+            i += 17; return true;
+        case 0x3B:                                                                 /* PtgArea3d */
+            if (avail >= 20) {
+                qual_.clear();
+                sheet_qual5(g_, int16_t(le16(r)), le16(r + 10), le16(r + 12), qual_);
+                open(8); r1_ += qual_; a1_ += qual_;
+                loc5(le16(r + 14), r[18], homeRow, homeCol, m); r1_ += ':'; a1_ += ':';
+                loc5(le16(r + 16), r[19], homeRow, homeCol, m);
+            }
+            i += 20; return true;
+        case 0x23:                                                                 /* PtgName */
+            name_ref(avail >= 2 ? le16(r) : 0);
+            i += 14; return true;
+        default:
+            return false;
+    }
+}
+
+/* ── shared formulas, one sheet substream at a time ───────────────────────────────────────────────────
+   A member FORMULA holds only PtgExp -> its anchor cell; the rgce lives in the SHRFMLA record that follows
+   the anchor's own FORMULA. Members met after their SHRFMLA render at once; the anchor itself (and any
+   member written out of order) waits in `pending` until that SHRFMLA arrives. Whatever still waits at the
+   sheet's EOF has no base in this substream (PtgExp to an ARRAY) and is dropped unrendered. */
+struct SheetFormulas {
+    struct Base { const uint8_t* rgce; uint16_t cce; };       /* into the Workbook stream, or `kept` */
+    struct Member { size_t slot; int rw, col; };
+    std::unordered_map<uint32_t, Base> shared;                 /* anchor (rw,col) -> base rgce */
+    std::unordered_map<uint32_t, std::vector<Member>> pending; /* anchor -> members awaiting it */
+    std::vector<std::vector<uint8_t>> kept;                    /* base rgce copies when records are decrypted */
+    int last_rw = -1, last_col = -1;                           /* the FORMULA a SHRFMLA belongs to */
+
+    static uint32_t key(int rw, int col) { return (uint32_t(rw & 0xFFFF) << 16) | uint32_t(col & 0xFFFF); }
+
+    /* FORMULA record body `r` (rlen >= 22) about to become `slot`; `emit(slot, rgce, cce, rw, col)` renders. */
+    template <class Emit>
+    void formula(const uint8_t* r, uint16_t rlen, size_t slot, Emit&& emit) {
+        int rw = le16(r), col = le16(r + 2); uint16_t cce = le16(r + 20);
+        const uint8_t* rgce = r + 22;
+        last_rw = rw; last_col = col;
+        if (22u + cce > rlen) return;
+        if (cce >= 5 && rgce[0] == 0x01) {                     /* PtgExp */
+            uint32_t anchor = key(le16(rgce + 1), le16(rgce + 3));
+            auto it = shared.find(anchor);
+            if (it != shared.end()) emit(slot, it->second.rgce, it->second.cce, rw, col);
+            else pending[anchor].push_back({slot, rw, col});
+        } else {
+            emit(slot, rgce, cce, rw, col);
+        }
+    }
+    template <class Emit>
+    void shrfmla(const uint8_t* r, uint16_t rlen, bool in_place, Emit&& emit) {
+        uint16_t cce = le16(r + 8);
+        if (10u + cce > rlen || last_rw < 0) return;
+        uint32_t anchor = key(last_rw, last_col);
+        if (in_place) shared[anchor] = {r + 10, cce};
+        else { kept.emplace_back(r + 10, r + 10 + cce); shared[anchor] = {kept.back().data(), cce}; }
+        auto it = pending.find(anchor);
+        if (it == pending.end()) return;
+        for (const Member& m : it->second) emit(m.slot, r + 10, cce, m.rw, m.col);
+        pending.erase(it);
+    }
+    void reset() { shared.clear(); pending.clear(); kept.clear(); last_rw = last_col = -1; }
+};
+
+/* ── the formula walk (xls_formulas JSON) — one pass over each sheet substream ──────────────────────── */
 struct FormulaRec { int sheet, row, col; std::string a1, r1c1; };
-std::vector<FormulaRec> walk_formulas(const uint8_t* p, size_t n, const Globals& g, bool* filepass) {
+std::vector<FormulaRec> walk_formulas(const uint8_t* p, size_t n, const Globals& g) {
     std::vector<FormulaRec> recs;
-    std::unordered_map<uint32_t,int> pos2idx;                 /* BoundSheet8 lbPlyPos -> libxls sheet index */
-    for (size_t s = 0; s < g.sheet_pos.size(); s++) pos2idx[g.sheet_pos[s]] = (int)s;
-    auto rd16 = [&](const uint8_t* q, size_t o2){ return uint16_t(q[o2] | (q[o2+1] << 8)); };
-    auto shkey = [](int sh, int rw, int cl){ return (uint64_t(uint32_t(sh)) << 40) | (uint64_t(rw & 0xFFFF) << 16) | (uint32_t(cl) & 0xFFFF); };
-    /* pass 1: ShrFmla base rgce keyed by the anchor Formula cell (see note in bboxes_xls_formula_map) */
-    std::unordered_map<uint64_t, std::vector<uint8_t>> shared;
-    { size_t o2 = 0; int cs = -1, lastRw = -1, lastCol = -1;
-      while (o2 + 4 <= n) {
-          size_t rs = o2; uint16_t t = rd16(p, o2), l = rd16(p, o2 + 2); o2 += 4; if (o2 + l > n) break;
-          const uint8_t* rr = p + o2;
-          if (t == 0x0809) { auto it = pos2idx.find((uint32_t)rs); if (it != pos2idx.end()) cs = it->second; }
-          else if (t == 0x0006 && l >= 22) { lastRw = rd16(rr, 0); lastCol = rd16(rr, 2); }
-          else if (t == 0x04BC && l >= 10) { uint16_t cce = rd16(rr, 8);
-              if (10u + cce <= l && lastRw >= 0) shared[shkey(cs, lastRw, lastCol)] = std::vector<uint8_t>(rr + 10, rr + 10 + cce); }
-          o2 += l;
-      }
-    }
-    /* pass 2: emit one FormulaRec per Formula record, expanding shared/array members */
-    size_t off = 0; int cur_sheet = -1;
-    while (off + 4 <= n) {
-        size_t rec_start = off; uint16_t type = rd16(p, off), rlen = rd16(p, off + 2);
-        off += 4; if (off + rlen > n) break; const uint8_t* r = p + off;
-        if (type == 0x002F) { if (filepass) *filepass = true; return {}; }
-        if (type == 0x0809) { auto it = pos2idx.find((uint32_t)rec_start); if (it != pos2idx.end()) cur_sheet = it->second; }
-        if (type == 0x0006 && rlen >= 22) {
-            int rw = rd16(r, 0), col = rd16(r, 2); uint16_t cce = rd16(r, 20);
-            const uint8_t* rgce = r + 22; size_t avail = rlen >= 22 ? rlen - 22 : 0;
-            if (cce <= avail) {
-                Expr e;
-                if (cce >= 5 && rgce[0] == 0x01) { int tr = rd16(rgce, 1), tc = rd16(rgce, 3);
-                    auto it = shared.find(shkey(cur_sheet, tr, tc));
-                    if (it != shared.end()) e = render_rgce(it->second.data(), it->second.size(), rw, col, true, g); }
-                else e = render_rgce(rgce, cce, rw, col, true, g);
-                recs.push_back({cur_sheet, rw, col, e.a1, e.r1c1});
+    RgceRenderer rr(g);
+    SheetFormulas sf;
+    auto emit = [&](size_t slot, const uint8_t* rgce, uint16_t cce, int rw, int col) {
+        rr.render(rgce, cce, rw, col, true);
+        recs[slot].a1 = rr.a1(); recs[slot].r1c1 = rr.r1c1();
+    };
+    for (size_t s = 0; s < g.sheet_pos.size(); s++) {
+        size_t off = g.sheet_pos[s];
+        if (off < g.end || off + 4 > n || le16(p + off) != 0x0809) continue;
+        BiffRecords it(p, n, off, &g.key); BiffRec rec;
+        int depth = 0;
+        while (it.next(rec)) {
+            const uint16_t type = rec.type, rlen = rec.len;
+            const uint8_t* r = rec.r;
+            if (type == 0x0809) depth++;
+            else if (type == 0x000A) { if (--depth == 0) break; }
+            else if (depth != 1) continue;
+            else if (type == 0x0006 && rlen >= 22) {
+                recs.push_back({int(s), le16(r), le16(r + 2), {}, {}});
+                sf.formula(r, rlen, recs.size() - 1, emit);
+            } else if (type == 0x04BC && rlen >= 10) {
+                sf.shrfmla(r, rlen, it.in_place(), emit);
             }
         }
-        off += rlen;
+        sf.reset();
     }
     return recs;
 }
@@ -383,35 +852,33 @@ std::vector<FormulaRec> walk_formulas(const uint8_t* p, size_t n, const Globals&
 const char* bboxes_xls_names_json(const void* buf, size_t len) {
     static thread_local std::string out;
     json o; o["dialect"] = "xls";
-    std::vector<char> wbuf; std::string err;
-    if (!read_workbook_stream(buf, len, wbuf, err)) { o["names"]=json::array(); o["error"]=err;
+    WorkbookStream wb;
+    if (!wb.open(buf, len)) { o["names"]=json::array(); o["error"]=wb.err;
         out = o.dump(-1,' ',false,json::error_handler_t::replace); return out.c_str(); }
-    const uint8_t* p = reinterpret_cast<const uint8_t*>(wbuf.data()); size_t n = wbuf.size();
-    Globals g = scan_globals(p, n);
-    json names = json::array(); size_t off = 0;
-    while (off + 4 <= n) {
-        uint16_t type = uint16_t(p[off]) | (uint16_t(p[off+1])<<8);
-        uint16_t rlen = uint16_t(p[off+2]) | (uint16_t(p[off+3])<<8);
-        off += 4; if (off + rlen > n) break;
-        if (type == 0x002F) { o["names"]=json::array(); o["error"]="FILEPASS: encrypted"; out=o.dump(); return out.c_str(); }
+    Globals g = scan_globals(wb.p, wb.n);
+    RgceRenderer rr(g);
+    json names = json::array();
+    BiffRecords it(wb.p, wb.n); BiffRec rec;
+    while (it.next(rec)) {
+        const uint16_t type = rec.type, rlen = rec.len;
+        if (type == 0x000A) break;                            /* NAME lives in the globals: sheets are never decrypted */
+        if (type == 0x002F) {                                 /* opened with the default password, or locked */
+            if (g.filepass) { o["names"]=json::array(); o["error"]="FILEPASS: encrypted"; out=o.dump(); return out.c_str(); }
+            it.decrypt_with(&g.key); continue;
+        }
         if (type == 0x0018 && rlen >= 15) {
-            const uint8_t* r = p + off;
+            const uint8_t* r = rec.r;
             uint16_t grbit = uint16_t(r[0])|(uint16_t(r[1])<<8);
-            uint8_t cch = r[3]; uint16_t cce = uint16_t(r[4])|(uint16_t(r[5])<<8); uint16_t itab = uint16_t(r[8])|(uint16_t(r[9])<<8);
+            uint16_t cce = uint16_t(r[4])|(uint16_t(r[5])<<8); uint16_t itab = uint16_t(r[8])|(uint16_t(r[9])<<8);
             bool hidden=(grbit&0x0001), builtin=(grbit&0x0020);
-            uint8_t flags = r[14]; const uint8_t* s = r + 15; std::string name;
-            if (builtin && cch>=1) { const char* bn=builtin_name(s[0]); name = bn?bn:("builtin#"+std::to_string(s[0])); }
-            else if (flags&0x01) { for(uint32_t k=0;k<cch && 15u+2u*k+1u<rlen;k++){uint16_t ch=uint16_t(s[2*k])|(uint16_t(s[2*k+1])<<8); name+=(ch<128)?char(ch):'?';} }
-            else { for(uint32_t k=0;k<cch && 15u+k<rlen;k++) name+=char(s[k]); }
-            size_t namebytes = (flags&0x01)? cch*2 : cch;
-            const uint8_t* rgce = s + namebytes; size_t rgce_avail = (15u+namebytes<=rlen)? rlen-(15u+namebytes) : 0;
-            Expr tgt = (cce>0 && cce<=rgce_avail) ? render_rgce(rgce, cce, 0, 0, false, g) : Expr{};
-            names.push_back({{"name",name},{"scope", itab==0?json(nullptr):json((int)itab-1)},
+            LblName l = lbl_name(r, rlen, g.biff_version == 0x0600);
+            std::string tr1, ta1;
+            if (cce>0 && cce<=l.avail) { rr.render(l.rgce, cce, 0, 0, false); tr1 = rr.r1c1(); ta1 = rr.a1(); }
+            names.push_back({{"name",l.name},{"scope", itab==0?json(nullptr):json((int)itab-1)},
                              {"hidden",hidden},{"builtin",builtin},
-                             {"formula_r1c1", tgt.r1c1.empty()?json(nullptr):json(tgt.r1c1)},
-                             {"formula_a1",   tgt.a1.empty()?json(nullptr):json(tgt.a1)}});
+                             {"formula_r1c1", tr1.empty()?json(nullptr):json(tr1)},
+                             {"formula_a1",   ta1.empty()?json(nullptr):json(ta1)}});
         }
-        off += rlen;
     }
     o["names"] = std::move(names);
     out = o.dump(-1,' ',false,json::error_handler_t::replace); return out.c_str();
@@ -422,16 +889,12 @@ const char* bboxes_xls_names_json_file(const char* path){ std::vector<char> s=sl
 const char* bboxes_xls_formulas_json(const void* buf, size_t len) {
     static thread_local std::string out;
     json o; o["dialect"] = "xls";
-    std::vector<char> wbuf; std::string err;
-    if (!read_workbook_stream(buf, len, wbuf, err)) { o["formulas"]=json::array(); o["error"]=err;
+    WorkbookStream wb;
+    if (!wb.open(buf, len)) { o["formulas"]=json::array(); o["error"]=wb.err;
         out=o.dump(-1,' ',false,json::error_handler_t::replace); return out.c_str(); }
-    const uint8_t* p = reinterpret_cast<const uint8_t*>(wbuf.data()); size_t n = wbuf.size();
-    Globals g = scan_globals(p, n);
-    if (g.biff_version != 0x0600)
-        o["warning"] = "BIFF5/7 workbook: 3D reference layout differs from BIFF8 and is not fully decoded";
-    bool filepass = false;
-    auto recs = walk_formulas(p, n, g, &filepass);
-    if (filepass) { o["formulas"] = json::array(); o["error"] = "FILEPASS: encrypted"; out = o.dump(); return out.c_str(); }
+    Globals g = scan_globals(wb.p, wb.n);
+    if (g.filepass) { o["formulas"] = json::array(); o["error"] = "FILEPASS: encrypted"; out = o.dump(); return out.c_str(); }
+    auto recs = walk_formulas(wb.p, wb.n, g);
     json arr = json::array();
     for (const auto& fr : recs) {
         std::string addr_a1 = col_letters(fr.col) + std::to_string(fr.row + 1);
@@ -445,15 +908,251 @@ const char* bboxes_xls_formulas_json(const void* buf, size_t len) {
 }
 const char* bboxes_xls_formulas_json_file(const char* path){ std::vector<char> s=slurp(path); return bboxes_xls_formulas_json(s.data(),s.size()); }
 
-/* (sheet,row,col) -> A1 formula, for extract_xls to fill the bbox `formula` field. Same walk as the
-   JSON entry point; empty A1 (unrenderable) cells are omitted. */
-std::unordered_map<uint64_t, std::string> bboxes_xls_formula_map(const void* buf, size_t len) {
-    std::unordered_map<uint64_t, std::string> m;
-    std::vector<char> wbuf; std::string err;
-    if (!read_workbook_stream(buf, len, wbuf, err)) return m;
-    const uint8_t* p = reinterpret_cast<const uint8_t*>(wbuf.data()); size_t n = wbuf.size();
-    Globals g = scan_globals(p, n); bool fp = false;
-    for (const auto& fr : walk_formulas(p, n, g, &fp))
-        if (!fr.a1.empty()) m[bboxes_xls_cellkey(fr.sheet, fr.row, fr.col)] = fr.a1;
-    return m;
+std::string bboxes_xls_color(uint16_t icv) { return icv_color(icv, kPalette); }
+
+/* ── bb() cells — one pass over the Workbook stream ──────────────────────────────────────────────────
+   The globals substream is decoded first (sheets, SST, fonts, XFs, formats, names for PtgName); each
+   sheet substream in the requested range is then read record by record, emitting a BBox per value-bearing cell
+   record as it is met. Shared-formula members resolve through SheetFormulas as their SHRFMLA arrives;
+   MERGEDCELLS trails the cell table, so merges are settled at the sheet's EOF. Same grid as xlsx:
+   x = col, y = row, 1-based; w/h = merge extent. */
+BBoxResult extract_xls(const void* buf, size_t len, const char* password,
+                       int start_page, int end_page) {
+    BBoxResult res;
+    res.source_type = "xls";
+    res.page_count  = 0;
+
+    WorkbookStream wb;
+    if (!wb.open(buf, len)) { res.page_count = -1; return res; }
+    const uint8_t* p = wb.p; const size_t n = wb.n;
+    CellGlobals cg;
+    Globals g = scan_globals(p, n, &cg, password);
+    if (g.filepass || g.sheets.empty()) { res.page_count = -1; return res; }   /* -> NULL cursor */
+    const bool biff8 = g.biff_version == 0x0600;
+
+    std::vector<uint8_t> xf_date(cg.xf_fmt.size());              /* XF -> date-formatted?, once per workbook */
+    for (size_t i = 0; i < cg.xf_fmt.size(); i++) {
+        auto it = cg.formats.find(cg.xf_fmt[i]);
+        xf_date[i] = bboxes_numfmt_is_date(cg.xf_fmt[i], it != cg.formats.end() ? it->second.c_str() : nullptr);
+    }
+    std::unordered_map<uint16_t, uint32_t> xf_to_style;          /* XF index -> bbox style_id, decoded once */
+    auto style_for = [&](uint16_t xf) -> uint32_t {
+        auto it = xf_to_style.find(xf);
+        if (it != xf_to_style.end()) return it->second;
+        XlsFont d;
+        if (xf < cg.xf_font.size()) {
+            uint16_t f = cg.xf_font[xf];
+            uint32_t fpos = (f > 4) ? uint32_t(f) - 1 : f;       /* BIFF skips font index 4 */
+            if (fpos < cg.fonts.size()) d = cg.fonts[fpos];
+        }
+        uint32_t fid = res.fonts.intern(d.name.empty() ? "default" : d.name.c_str());
+        uint32_t sid = res.styles.intern(fid, d.size, d.icv ? icv_color(d.icv, cg.palette) : BBOXES_DEFAULT_COLOR,
+                                         d.bold ? "bold" : BBOXES_DEFAULT_WEIGHT, d.italic, d.underline);
+        xf_to_style[xf] = sid;
+        return sid;
+    };
+
+    /* per-sheet state */
+    Page page;
+    long string_for = -1;                                         /* bbox awaiting a STRING record */
+    RgceRenderer rr(g);
+    SheetFormulas sf;
+    auto emit = [&](size_t slot, const uint8_t* rgce, uint16_t cce, int rw, int col) {
+        rr.render(rgce, cce, rw, col, true);
+        page.bboxes[slot].formula = rr.a1();
+    };
+    std::vector<Merge> merges;                                    /* 0-based until the sheet closes */
+    auto key = [](int rw, int col) { return (uint32_t(rw & 0xFFFF) << 16) | uint32_t(col & 0xFFFF); };
+
+    auto add = [&](int rw, int col, uint16_t xf) -> BBox& {
+        page.bboxes.emplace_back();
+        BBox& b = page.bboxes.back();
+        b.page_id  = page.page_id;
+        b.style_id = style_for(xf);
+        b.x = col + 1; b.y = rw + 1; b.w = 1; b.h = 1;
+        return b;
+    };
+    auto number = [&](BBox& b, double d, uint16_t xf) {
+        b.cell_type = BBOX_NUMBER; b.vnum = d;
+        char t[32]; std::snprintf(t, sizeof t, "%.15g", d); b.text = t;
+        if (xf < xf_date.size() && xf_date[xf]) { b.has_vdate = true; b.vdate = bboxes_serial_to_unix_us(d, cg.date1904); }
+    };
+    auto error = [](BBox& b, uint8_t e) {
+        b.cell_type = BBOX_ERROR;
+        b.text = e == 0x00 ? "#NULL!" : e == 0x07 ? "#DIV/0!" : e == 0x0F ? "#VALUE!" : e == 0x17 ? "#REF!"
+               : e == 0x1D ? "#NAME?" : e == 0x24 ? "#NUM!"   : e == 0x2A ? "#N/A"    : "#ERR!";
+    };
+    auto close_sheet = [&]() {
+        if (!merges.empty()) {
+            std::unordered_map<uint32_t, std::pair<double, double>> extent;
+            CoveredCells covered;
+            for (const Merge& m : merges) {
+                extent[key(m.r1, m.c1)] = { double(m.c2 - m.c1 + 1), double(m.r2 - m.r1 + 1) };
+                covered.add(m.r1, m.c1, m.r2, m.c2, m.r1, m.c1);
+                page.merges.push_back({ m.r1 + 1, m.c1 + 1, m.r2 + 1, m.c2 + 1 });
+            }
+            std::vector<BBox> kept;
+            kept.reserve(page.bboxes.size());
+            for (BBox& b : page.bboxes) {
+                uint32_t k = key(int(b.y) - 1, int(b.x) - 1);
+                if (covered.has(uint32_t(b.y) - 1, uint32_t(b.x) - 1)) continue;
+                auto it = extent.find(k);
+                if (it != extent.end()) { b.w = it->second.first; b.h = it->second.second; }
+                kept.push_back(std::move(b));
+            }
+            page.bboxes = std::move(kept);
+        }
+        for (const BBox& b : page.bboxes) {                       /* DIMENSIONS can be absent or stale */
+            page.width  = std::max(page.width,  b.x + b.w - 1);
+            page.height = std::max(page.height, b.y + b.h - 1);
+        }
+        res.pages.push_back(std::move(page));
+        res.page_count++;
+        page = Page{};
+        sf.reset(); merges.clear(); string_for = -1;
+    };
+
+    /* Sheets are reached through BoundSheet8 lbPlyPos, so a page range costs only the sheets in it; within
+       one, cost follows the records present (BLANK/MULBLANK/ROW fall through untouched), never the
+       DIMENSIONS rectangle. */
+    const int nsheets = static_cast<int>(g.sheets.size());
+    for (int s = 0; s < nsheets; s++) {
+        if (start_page > 0 && (s + 1) < start_page) continue;
+        if (end_page   > 0 && (s + 1) > end_page)   break;
+        size_t off = g.sheet_pos[s];
+        if (off < g.end || off + 4 > n || le16(p + off) != 0x0809) continue;   /* must land on a BOF */
+        page.page_id = static_cast<uint32_t>(s); page.document_id = 0; page.page_number = s + 1;
+        page.width = 0; page.height = 0;
+        BiffRecords it(p, n, off, &g.key); BiffRec rec;
+        int depth = 0;
+        while (it.next(rec)) {
+            const uint16_t type = rec.type, rlen = rec.len;
+            const uint8_t* r = rec.r;
+            if (type == 0x0809) {                                     /* BOF: the sheet's own, or a nested chart's */
+                depth++;
+            } else if (type == 0x000A) {                              /* EOF */
+                if (--depth == 0) break;
+            } else if (depth != 1) {
+                /* embedded chart substream */
+            } else if (type == 0x0200) {                              /* DIMENSIONS: rwMac / colMac are one past the last */
+                if (biff8 && rlen >= 12)  { page.height = le32(r + 4); page.width = le16(r + 10); }
+                else if (!biff8 && rlen >= 8) { page.height = le16(r + 2); page.width = le16(r + 6); }
+            } else if (type == 0x00FD && rlen >= 10) {                /* LABELSST */
+                uint32_t isst = le32(r + 6);
+                if (isst < cg.sst.size() && !cg.sst[isst].empty()) add(le16(r), le16(r + 2), le16(r + 4)).text = cg.sst[isst];
+            } else if ((type == 0x0204 || type == 0x00D6) && rlen >= 8) {   /* LABEL / RSTRING */
+                uint16_t cch = le16(r + 6);
+                std::string t = biff8 ? (rlen >= 9 ? flat_chars(r + 9, rlen - 9u, cch, r[8] & 0x01) : std::string())
+                                      : flat_chars(r + 8, rlen - 8u, cch, false);
+                if (!t.empty()) add(le16(r), le16(r + 2), le16(r + 4)).text = std::move(t);
+            } else if (type == 0x0203 && rlen >= 14) {                /* NUMBER */
+                double d; std::memcpy(&d, r + 6, 8);
+                uint16_t xf = le16(r + 4);
+                number(add(le16(r), le16(r + 2), xf), d, xf);
+            } else if (type == 0x027E && rlen >= 10) {                /* RK */
+                uint16_t xf = le16(r + 4);
+                number(add(le16(r), le16(r + 2), xf), rk_number(le32(r + 6)), xf);
+            } else if (type == 0x00BD && rlen >= 6) {                 /* MULRK: rw colFirst {ixfe RK}* colLast */
+                int rw = le16(r), col = le16(r + 2);
+                for (size_t o = 4; o + 6 <= size_t(rlen) - 2u; o += 6, col++) {
+                    uint16_t xf = le16(r + o);
+                    number(add(rw, col, xf), rk_number(le32(r + o + 2)), xf);
+                }
+            } else if (type == 0x0205 && rlen >= 8) {                 /* BOOLERR */
+                BBox& b = add(le16(r), le16(r + 2), le16(r + 4));
+                if (r[7]) error(b, r[6]);
+                else { b.cell_type = BBOX_BOOL; b.vbool = r[6] != 0; b.text = b.vbool ? "TRUE" : "FALSE"; }
+            } else if (type == 0x0006 && rlen >= 22) {                /* FORMULA: cached value + rgce */
+                int rw = le16(r), col = le16(r + 2); uint16_t xf = le16(r + 4);
+                size_t idx = page.bboxes.size();
+                BBox& b = add(rw, col, xf);
+                string_for = -1;
+                if (r[12] == 0xFF && r[13] == 0xFF) {                 /* FormulaValue: typed non-number */
+                    switch (r[6]) {
+                        case 0x00: b.cell_type = BBOX_STRING; string_for = long(idx); break;   /* STRING follows */
+                        case 0x01: b.cell_type = BBOX_BOOL; b.vbool = r[8] != 0; b.text = b.vbool ? "TRUE" : "FALSE"; break;
+                        case 0x02: error(b, r[8]); break;
+                        default:   b.cell_type = BBOX_STRING; break; /* empty string */
+                    }
+                } else {
+                    double d; std::memcpy(&d, r + 6, 8);
+                    number(b, d, xf);
+                }
+                sf.formula(r, rlen, idx, emit);
+            } else if (type == 0x04BC && rlen >= 10) {                /* SHRFMLA: base of the anchor FORMULA before it */
+                sf.shrfmla(r, rlen, it.in_place(), emit);
+            } else if (type == 0x0207 && string_for >= 0) {           /* STRING: a formula's string result */
+                BBox& b = page.bboxes[size_t(string_for)];
+                if (biff8 && rlen >= 3) {
+                    ContReader cr = it.cont(rec);
+                    uint16_t cch = cr.u16(); uint8_t fl = cr.u8();
+                    cr.chars(cch, fl & 0x01, b.text);
+                } else if (!biff8 && rlen >= 2) {
+                    b.text = flat_chars(r + 2, rlen - 2u, le16(r), false);
+                }
+                string_for = -1;
+            } else if (type == 0x00E5 && rlen >= 2) {                 /* MERGEDCELLS: cmcs Ref8 {rwFirst rwLast colFirst colLast} */
+                uint16_t cmcs = le16(r);
+                for (uint16_t i = 0; i < cmcs && 2u + 8u * i + 8u <= rlen; i++) {
+                    const uint8_t* m = r + 2 + 8 * i;
+                    int r1 = le16(m), r2 = le16(m + 2), c1 = le16(m + 4), c2 = le16(m + 6);
+                    if (r2 >= r1 && c2 >= c1) merges.push_back({ r1, c1, r2, c2 });
+                }
+            }
+        }
+        close_sheet();
+    }
+    return res;
+}
+
+/* Pre-flight probe over the CFB directory: which payload this OLE2 file carries, and for a workbook the
+   globals substream only (FILEPASS + BoundSheet8 count) — records are read header by header straight out
+   of the container's sector spans, never the sheet substreams. */
+void probe_ole(const void* buf, size_t len, DocProbe& out) {
+    out.format = "ole"; out.size_bytes = len;
+    CfbPackage cfb;
+    if (!cfb.open(buf, len)) { out.error = cfb.error(); return; }
+    const CFB::COMPOUND_FILE_ENTRY* wb = cfb.entry("Workbook");
+    if (!wb) wb = cfb.entry("Book");
+    const CFB::COMPOUND_FILE_ENTRY *word = cfb.entry("WordDocument"), *pkg = cfb.entry("EncryptedPackage");
+    if (pkg) {                                                /* ECMA-376 encrypted OOXML: the zip is inside */
+        out.format = "ooxml-encrypted"; out.encrypted = 1; out.work_bytes = cfb.entry_size(pkg);
+        /* Whether the default password opens it is known only after the key derivation, so
+           password_required stays unknown; EncryptionInfo still says if the cipher is readable. */
+        EncryptedPackage enc;
+        if (!enc.inspect(buf, len)) out.error = enc.error();
+        return;
+    }
+    CfbPackage::Stream st;
+    if (word) {                                               /* Word 97: FibBase flags at 0x0A, fEncrypted = bit 8 */
+        out.format = "doc"; out.pages = 1; out.work_bytes = cfb.entry_size(word);
+        uint8_t fib[12];
+        cfb.stream(word, st);
+        if (CfbPackage::read(st, 0, fib, sizeof(fib))) {
+            out.encrypted = (fib[11] & 0x01) ? 1 : 0; out.password_required = out.encrypted;
+        }
+        return;
+    }
+    if (!wb) return;
+    out.format = "xls"; out.work_bytes = cfb.entry_size(wb); out.encrypted = 0; out.pages = 0;
+    cfb.stream(wb, st);
+    size_t off = 0; bool first_bof = true, biff8 = true, opens = false; uint8_t h[4];
+    while (CfbPackage::read(st, off, h, sizeof(h))) {
+        uint16_t type = le16(h), rlen = le16(h + 2);
+        if (type == 0x0809) {
+            if (!first_bof) break;
+            first_bof = false;
+            biff8 = !CfbPackage::read(st, off + 4, h, 2) || le16(h) == 0x0600;
+        } else if (type == 0x000A) {                          /* EOF of the globals substream */
+            break;
+        } else if (type == 0x002F) {                          /* FILEPASS: locked unless the default password opens it */
+            std::vector<uint8_t> fp(rlen);
+            out.encrypted = 1;
+            opens = CfbPackage::read(st, off + 4, fp.data(), rlen) && BiffKey().open(fp.data(), rlen, biff8, nullptr);
+        } else if (type == 0x0085) {                          /* BoundSheet8 */
+            out.pages++;
+        }
+        off += 4 + rlen;
+    }
+    out.password_required = out.encrypted && !opens;
 }
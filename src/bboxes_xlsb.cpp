@@ -0,0 +1,572 @@
+/* .xlsb (BIFF12 binary workbook) backend — the same BBox grain as extract_xlsx_fast.
+ *
+ * An xlsb is an OOXML package whose parts are record streams instead of XML ([MS-XLSB] 2.1.4): each
+ * record is a 7-bit-varint id and size, then its body. Parts come through XlsxPackage, so a
+ * password-protected xlsb decrypts like an xlsx; only the relationships stay XML. The workbook part gives
+ * the sheets (BrtBundleSh), date1904, defined names and the XTI table for 3D references; styles.bin maps
+ * each cell XF to its number format for the vdate channel; sharedStrings.bin is read once.
+ *
+ * Cells are fixed-layout records, decoded without a tokenizer or a DOM: no XML pass, no number parsing
+ * (values are already doubles), which makes this the cheapest spreadsheet lane. Output matches the fast
+ * xlsx reader: x = col, y = row (1-based), style_id = the raw iStyleRef, text = the raw value (numbers in
+ * shortest round-trip form, booleans "1"/"0", errors "#DIV/0!"…), merges on the side-channel with the
+ * origin spanning the range and the covered cells skipped, and a shared/array master spanning its
+ * BrtShrFmla/BrtArrFmla range. Formulas are rendered from the BIFF12 rgce in A1 notation, with "=" in
+ * front as the xlsx readers give it. Rich-text runs (BrtCellRString / SST StrRuns) are not decoded: the
+ * text is kept, its formatting is not.
+ */
+#include "bboxes_types.h"
+#include "bboxes_bytes.h"
+#include "bboxes_covered.h"
+#include "bboxes_ftab.h"
+#include "bboxes_xlsb_records.h"
+#include "bboxes_xlsx_pkg.h"
+
+#include <miniz.h>
+#include <pugixml.hpp>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+inline uint64_t cell_key(uint32_t row, uint32_t col) { return (uint64_t(row) << 24) | col; }
+
+constexpr uint32_t kMaxRow = 1048576, kMaxCol = 16384;   /* the sheet grid, 1-based: ranges past it are corrupt */
+
+/* Record ids ([MS-XLSB] 2.3.2), the ones read here. */
+enum : uint32_t {
+    kRowHdr = 0, kCellBlank = 1, kCellRk = 2, kCellError = 3, kCellBool = 4, kCellReal = 5, kCellSt = 6,
+    kCellIsst = 7, kFmlaString = 8, kFmlaNum = 9, kFmlaBool = 10, kFmlaError = 11, kSSTItem = 19,
+    kName = 39, kFmt = 44, kXF = 47, kCellRString = 62, kWbProp = 153, kBundleSh = 156, kMergeCell = 176,
+    kSupSelf = 355, kSupSame = 356, kSupBookSrc = 359, kSupTabs = 360, kExternSheet = 362,
+    kArrFmla = 426, kShrFmla = 427, kBeginCellXFs = 617, kEndCellXFs = 618, kSupAddin = 667,
+};
+
+void put_chars(std::string& s, const uint8_t* q, size_t cch) {
+    uint32_t pend = 0;
+    for (size_t i = 0; i < cch; i++) put_utf16(s, le16(q + 2 * i), pend);
+}
+/* XLWideString (u32 cch + UTF-16) at q, appended to `out`; returns the bytes it takes, 0 when it runs
+   past `end`. The nullable form's 0xFFFFFFFF is an absent string. */
+size_t wide(const uint8_t* q, const uint8_t* end, std::string& out) {
+    if (end - q < 4) return 0;
+    uint32_t cch = le32(q);
+    if (cch == 0xFFFFFFFF) return 4;
+    if (cch > size_t(end - q - 4) / 2) return 0;
+    put_chars(out, q + 4, cch);
+    return 4 + size_t(cch) * 2;
+}
+
+void put_num(std::string& s, double d) {   /* shortest text that reads back as the same double */
+    char b[32];
+    int k = 0;
+    for (int prec = 15; prec <= 17; prec++) {
+        k = std::snprintf(b, sizeof b, "%.*g", prec, d);
+        if (std::strtod(b, nullptr) == d) break;
+    }
+    s.append(b, size_t(k));
+}
+
+const char* err_text(uint8_t e) {   /* BErr */
+    switch (e) {
+        case 0x00: return "#NULL!"; case 0x07: return "#DIV/0!"; case 0x0F: return "#VALUE!"; case 0x17: return "#REF!";
+        case 0x1D: return "#NAME?"; case 0x24: return "#NUM!"; case 0x2A: return "#N/A"; case 0x2B: return "#GETTING_DATA";
+        default: return "#ERR!";
+    }
+}
+
+/* Workbook globals the cells and formulas need. */
+struct Book {
+    std::vector<std::pair<std::string, std::string>> sheets;   /* (part, name), workbook order */
+    bool date1904 = false;
+    std::vector<std::string> names;                            /* BrtName order = PtgName index - 1 */
+    struct SupBook { bool self; int ext_index; std::vector<std::string> sheets; };
+    std::vector<SupBook> sups;
+    struct Xti { uint32_t sup; int32_t first, last; };
+    std::vector<Xti> xtis;
+};
+
+/* workbook.bin + its rels -> Book. The rels part is the one XML stream an xlsb keeps. */
+void read_book(XlsxPackage& pkg, Book& bk) {
+    const std::string* wb = pkg.part("xl/workbook.bin");
+    const std::string* relsxml = pkg.part("xl/_rels/workbook.bin.rels");
+    if (!wb || !relsxml) return;
+    std::unordered_map<std::string, std::string> rid2t;
+    pugi::xml_document reldoc;
+    reldoc.load_buffer(relsxml->data(), relsxml->size());
+    for (auto r : reldoc.document_element().children()) {
+        const char* nm = r.name(); const char* c = std::strchr(nm, ':');
+        if (std::strcmp(c ? c + 1 : nm, "Relationship") == 0) rid2t[r.attribute("Id").value()] = r.attribute("Target").value();
+    }
+    int ext = 0;
+    Records it(wb->data(), wb->size());
+    for (Rec r; it.next(r);) {
+        const uint8_t* end = r.p + r.n;
+        switch (r.id) {
+            case kWbProp: if (r.n >= 4) bk.date1904 = le32(r.p) & 1; break;
+            case kBundleSh: {   /* hsState, iTabID, strRelID, strName */
+                if (r.n < 8) break;
+                std::string rid, name;
+                size_t a = wide(r.p + 8, end, rid);
+                if (!a || !wide(r.p + 8 + a, end, name)) break;
+                auto t = rid2t.find(rid);
+                if (t == rid2t.end()) break;
+                const std::string& target = t->second;
+                bk.sheets.emplace_back((!target.empty() && target[0] == '/') ? target.substr(1) : "xl/" + target, name);
+            } break;
+            case kName: {   /* flags, chKey, itab, then the name */
+                std::string name;
+                if (r.n >= 9) wide(r.p + 9, end, name);
+                bk.names.push_back(std::move(name));
+            } break;
+            case kSupSelf: case kSupSame: bk.sups.push_back({true, 0, {}}); break;
+            case kSupAddin:               bk.sups.push_back({false, 0, {}}); break;
+            case kSupBookSrc:             bk.sups.push_back({false, ++ext, {}}); break;
+            case kSupTabs:                /* sheet names of the external book just opened */
+                if (!bk.sups.empty() && r.n >= 4) {
+                    const uint8_t* q = r.p + 4;
+                    for (uint32_t i = 0, n = le32(r.p); i < n && q < end; i++) {
+                        std::string s;
+                        size_t a = wide(q, end, s);
+                        if (!a) break;
+                        bk.sups.back().sheets.push_back(std::move(s));
+                        q += a;
+                    }
+                }
+                break;
+            case kExternSheet:   /* cXti, then Xti { externalLink, firstSheet, lastSheet } */
+                if (r.n >= 4)
+                    for (uint32_t i = 0, n = le32(r.p); i < n && 4 + 12 * size_t(i + 1) <= r.n; i++) {
+                        const uint8_t* x = r.p + 4 + 12 * i;
+                        bk.xtis.push_back({le32(x), int32_t(le32(x + 4)), int32_t(le32(x + 8))});
+                    }
+                break;
+            default: break;
+        }
+    }
+}
+
+/* Renders BIFF12 rgce to A1 text ([MS-XLSB] 2.2.2, 2.5.97). The token layouts follow BIFF8 with wider
+   fields: rows are 32-bit, a column is 14 bits plus the two relative flags, strings are UTF-16 with a
+   16-bit count, and arrays / mem-area extents sit in the rgcb trailer in token order. Excel stores the
+   parentheses it needs as PtgParen, so operands are joined without re-deriving precedence. The stack
+   strings are reused across formulas. */
+class FormulaText {
+public:
+    explicit FormulaText(const Book& bk) : bk_(bk) {}
+
+    /* false for a PtgExp/PtgTbl stub, whose formula is carried by the BrtShrFmla / BrtArrFmla / BrtTable
+       after the cell. (home_row, home_col) is the 0-based cell the N-form tokens are relative to. */
+    bool render(const uint8_t* rgce, size_t cce, const uint8_t* rgcb, size_t cb,
+                long home_row, long home_col, std::string& out) {
+        out.clear();
+        if (cce && (rgce[0] == 0x01 || rgce[0] == 0x02)) return false;
+        sp_ = 0;
+        const uint8_t* x = rgcb; const uint8_t* xe = rgcb + cb;
+        size_t i = 0;
+        while (i < cce) {
+            uint8_t ptg = rgce[i++];
+            uint8_t base = ptg < 0x20 ? ptg : ptg <= 0x3F ? ptg : ptg <= 0x5F ? ptg - 0x20 : ptg - 0x40;
+            const uint8_t* r = rgce + i;
+            auto need = [&](size_t k) { if (k > cce - i) { i = cce; return false; } i += k; return true; };
+            switch (base) {
+                case 0x03: binop("+"); break; case 0x04: binop("-"); break; case 0x05: binop("*"); break;
+                case 0x06: binop("/"); break; case 0x07: binop("^"); break; case 0x08: binop("&"); break;
+                case 0x09: binop("<"); break; case 0x0A: binop("<="); break; case 0x0B: binop("="); break;
+                case 0x0C: binop(">="); break; case 0x0D: binop(">"); break; case 0x0E: binop("<>"); break;
+                case 0x0F: binop(" "); break; case 0x10: binop(","); break; case 0x11: binop(":"); break;
+                case 0x12: wrap("+", ""); break;
+                case 0x13: wrap("-", ""); break;
+                case 0x14: wrap("", "%"); break;
+                case 0x15: wrap("(", ")"); break;
+                case 0x16: push(); break;                                               /* PtgMissArg */
+                case 0x17: {                                                            /* PtgStr */
+                    if (!need(2)) break;
+                    size_t cch = le16(r);
+                    if (!need(2 * cch)) break;
+                    std::string& s = push(); s += '"';
+                    uint32_t pend = 0;
+                    for (size_t k = 0; k < cch; k++) {
+                        uint16_t c = le16(r + 2 + 2 * k);
+                        if (c == '"') s += '"';
+                        put_utf16(s, c, pend);
+                    }
+                    s += '"';
+                } break;
+                case 0x19: {                                                            /* PtgAttr */
+                    if (!need(3)) break;
+                    uint8_t grbit = r[0];
+                    if (grbit & 0x04) need(2 * (size_t(le16(r + 1)) + 1));              /* tAttrChoose jump table */
+                    else if (grbit & 0x10) func("SUM", 1);                               /* tAttrSum */
+                } break;
+                case 0x1C: if (need(1)) push() += err_text(r[0]); break;
+                case 0x1D: if (need(1)) push() += r[0] ? "TRUE" : "FALSE"; break;
+                case 0x1E: if (need(2)) append_int(push(), le16(r)); break;
+                case 0x1F: if (need(8)) put_num(push(), le_f64(r)); break;
+                case 0x20: if (need(14)) array(x, xe); break;                          /* PtgArray: values in rgcb */
+                case 0x21: if (need(2)) { uint16_t f = le16(r); int ac = ftab_argc(f); func_id(f, ac >= 0 ? ac : 1); } break;
+                case 0x22: if (need(3)) func_id(le16(r + 1) & 0x7FFF, r[0]); break;    /* PtgFuncVar */
+                case 0x23: if (need(4)) name(le32(r)); break;
+                case 0x24: if (need(6)) loc(push(), le32(r), le16(r + 4), false, home_row, home_col); break;
+                case 0x25: if (need(12)) area(push(), r, false, home_row, home_col); break;
+                case 0x26: case 0x27: case 0x28:                                        /* PtgMem*: the subexpression follows */
+                    if (need(6) && base == 0x26 && xe - x >= 4) {                       /* PtgExtraMem in rgcb */
+                        uint32_t n = le32(x);
+                        x = size_t(xe - x - 4) / 16 >= n ? x + 4 + 16 * size_t(n) : xe;
+                    }
+                    break;
+                case 0x29: need(2); break;                                              /* PtgMemFunc */
+                case 0x2A: if (need(6)) push() += "#REF!"; break;
+                case 0x2B: if (need(12)) push() += "#REF!"; break;
+                case 0x2C: if (need(6)) loc(push(), le32(r), le16(r + 4), true, home_row, home_col); break;
+                case 0x2D: if (need(12)) area(push(), r, true, home_row, home_col); break;
+                case 0x39: if (need(6)) name(le32(r + 2)); break;                      /* PtgNameX, best effort */
+                case 0x3A: if (need(8)) { std::string& s = push(); qual(s, le16(r));
+                                          loc(s, le32(r + 2), le16(r + 6), false, home_row, home_col); } break;
+                case 0x3B: if (need(14)) { std::string& s = push(); qual(s, le16(r)); area(s, r + 2, false, home_row, home_col); } break;
+                case 0x3C: if (need(8)) { std::string& s = push(); qual(s, le16(r)); s += "#REF!"; } break;
+                case 0x3D: if (need(14)) { std::string& s = push(); qual(s, le16(r)); s += "#REF!"; } break;
+                default: i = cce; break;                                                /* PtgList, PtgSxName, …: stop */
+            }
+        }
+        if (sp_) out.swap(st_[sp_ - 1]);
+        return true;
+    }
+
+private:
+    std::string& push() {
+        if (sp_ == st_.size()) st_.emplace_back();
+        std::string& s = st_[sp_++];
+        s.clear();
+        return s;
+    }
+    void binop(const char* sym) {
+        if (sp_ < 2) { push() += "#ERR!"; return; }
+        std::string& a = st_[sp_ - 2];
+        a += sym; a += st_[sp_ - 1];
+        sp_--;
+    }
+    void wrap(const char* pre, const char* post) {
+        if (!sp_) return;
+        std::string& a = st_[sp_ - 1];
+        a.insert(0, pre); a += post;
+    }
+    /* name(args) over the top `argc` slots; the add-in form (iftab 255) takes its name from the first. */
+    void func(const char* fname, size_t argc) {
+        size_t k = argc < sp_ ? argc : sp_, b = sp_ - k;
+        tmp_.clear();
+        size_t a0 = b;
+        if (!fname) { if (k) { tmp_ = st_[b]; a0++; } else tmp_ = "#NAME?"; }
+        else tmp_ = fname;
+        tmp_ += '(';
+        for (size_t j = a0; j < sp_; j++) { if (j > a0) tmp_ += ','; tmp_ += st_[j]; }
+        tmp_ += ')';
+        sp_ = b;
+        push().swap(tmp_);
+    }
+    void func_id(uint16_t f, size_t argc) {
+        if (f == 255) { func(nullptr, argc); return; }
+        if (const char* fn = ftab_name(f)) { func(fn, argc); return; }
+        std::string nm = "FUNC"; append_int(nm, f);
+        func(nm.c_str(), argc);
+    }
+    void name(uint32_t idx) {
+        std::string& s = push();
+        if (idx >= 1 && idx <= bk_.names.size() && !bk_.names[idx - 1].empty()) s += bk_.names[idx - 1];
+        else { s += "Name"; append_int(s, long(idx)); }
+    }
+    /* RgceLoc / RgceLocRel: 32-bit row, 14-bit column with fColRel (0x4000) and fRwRel (0x8000). In the
+       N forms a relative axis holds a signed offset from the home cell, wrapping like Excel does. */
+    static void position(uint32_t rw, uint16_t cf, bool n_form, long hr, long hc, long& row, long& col) {
+        row = long(rw); col = cf & 0x3FFF;
+        if (!n_form) return;
+        if (cf & 0x8000) row = ((hr + long(int32_t(rw))) % 1048576 + 1048576) % 1048576;
+        if (cf & 0x4000) col = ((hc + (long(cf & 0x3FFF) ^ 0x2000) - 0x2000) % 16384 + 16384) % 16384;
+    }
+    static void put_loc(std::string& s, long row, long col, uint16_t cf, bool with_row, bool with_col) {
+        if (with_col) { if (!(cf & 0x4000)) s += '$'; append_col(s, col); }
+        if (with_row) { if (!(cf & 0x8000)) s += '$'; append_int(s, row + 1); }
+    }
+    static void loc(std::string& s, uint32_t rw, uint16_t cf, bool n_form, long hr, long hc) {
+        long row, col;
+        position(rw, cf, n_form, hr, hc, row, col);
+        put_loc(s, row, col, cf, true, true);
+    }
+    /* RgceArea: rowFirst, rowLast, colFirst, colLast. Whole columns render as A:B, whole rows as 1:3. */
+    static void area(std::string& s, const uint8_t* r, bool n_form, long hr, long hc) {
+        uint16_t c1 = le16(r + 8), c2 = le16(r + 10);
+        long r1, k1, r2, k2;
+        position(le32(r), c1, n_form, hr, hc, r1, k1);
+        position(le32(r + 4), c2, n_form, hr, hc, r2, k2);
+        bool cols = r1 == 0 && r2 == 1048575, rows = !cols && k1 == 0 && k2 == 16383;
+        put_loc(s, r1, k1, c1, !cols, !rows); s += ':';
+        put_loc(s, r2, k2, c2, !cols, !rows);
+    }
+    static void quoted(std::string& s, const std::string& nm) {
+        bool plain = !nm.empty() && !(nm[0] >= '0' && nm[0] <= '9');
+        for (unsigned char c : nm) if (!(std::isalnum(c) || c == '_' || c == '.' || c >= 0x80)) plain = false;
+        if (plain) { s += nm; return; }
+        s += '\'';
+        for (char c : nm) { if (c == '\'') s += '\''; s += c; }
+        s += '\'';
+    }
+    /* "Sheet!" / "Sheet1:Sheet3!" / "[1]Sheet!" for an XTI */
+    void qual(std::string& s, uint16_t ixti) const {
+        if (ixti >= bk_.xtis.size()) return;
+        const Book::Xti& x = bk_.xtis[ixti];
+        const Book::SupBook* sb = x.sup < bk_.sups.size() ? &bk_.sups[x.sup] : nullptr;
+        bool self = !sb || sb->self;
+        auto sheet = [&](int32_t i) -> const std::string* {
+            if (self) return i >= 0 && size_t(i) < bk_.sheets.size() ? &bk_.sheets[size_t(i)].second : nullptr;
+            return i >= 0 && size_t(i) < sb->sheets.size() ? &sb->sheets[size_t(i)] : nullptr;
+        };
+        if (!self) { s += '['; append_int(s, sb->ext_index); s += ']'; }
+        const std::string* f = sheet(x.first);
+        const std::string* l = sheet(x.last);
+        if (f) { quoted(s, *f); if (l && x.last != x.first) { s += ':'; quoted(s, *l); } }
+        else if (x.first == -1) s += "#REF";
+        if (f || !self || x.first == -1) s += '!';
+    }
+    /* PtgExtraArray ([MS-XLSB] 2.5.97.88): rows, cols, then typed values row by row */
+    void array(const uint8_t*& x, const uint8_t* xe) {
+        std::string& s = push();
+        if (xe - x < 8) { s += "{}"; return; }
+        uint32_t rows = le32(x), cols = le32(x + 4);
+        x += 8;
+        s += '{';
+        for (uint32_t rr = 0; rr < rows && x < xe; rr++) {
+            if (rr) s += ';';
+            for (uint32_t cc = 0; cc < cols && x < xe; cc++) {
+                if (cc) s += ',';
+                uint8_t t = *x++;
+                if (t == 0x00 && xe - x >= 8) { put_num(s, le_f64(x)); x += 8; }
+                else if (t == 0x01) {
+                    size_t at = s.size();
+                    s += '"';
+                    size_t a = wide(x, xe, s);
+                    if (!a) { s.resize(at); x = xe; break; }
+                    s += '"'; x += a;
+                }
+                else if (t == 0x02 && x < xe) { s += *x++ ? "TRUE" : "FALSE"; }
+                else if (t == 0x04 && x < xe) { s += err_text(*x++); }
+                else { x = xe; break; }
+            }
+        }
+        s += '}';
+    }
+
+    const Book& bk_;
+    std::vector<std::string> st_;
+    size_t sp_ = 0;
+    std::string tmp_;
+};
+
+/* CellParsedFormula / SharedParsedFormula / ArrayParsedFormula at q: cce, rgce, cb, rgcb. Returns
+   whether a formula was rendered into `f` (with its "="). */
+bool parsed_formula(FormulaText& ft, const uint8_t* q, const uint8_t* end, long hr, long hc, std::string& f) {
+    f.clear();
+    if (end - q < 4) return false;
+    uint32_t cce = le32(q);
+    if (cce > size_t(end - q - 4)) return false;
+    const uint8_t* rgce = q + 4;
+    const uint8_t* tail = rgce + cce;
+    const uint8_t* rgcb = tail; size_t cb = 0;
+    if (end - tail >= 4) { cb = le32(tail); rgcb = tail + 4; if (cb > size_t(end - rgcb)) cb = size_t(end - rgcb); }
+    std::string body;
+    if (!ft.render(rgce, cce, rgcb, cb, hr, hc, body) || body.empty()) return false;
+    f.reserve(body.size() + 1);
+    f += '=';
+    f += body;
+    return true;
+}
+
+}  // namespace
+
+/* A password-protected xlsb (OLE2-wrapped) decrypts through the package like an xlsx; a password that
+   does not verify, or a buffer that is not a package, gives page_count = -1. */
+BBoxResult extract_xlsb(const void* buf, size_t len, const char* password, int start_page, int end_page) {
+    XlsxPackage pkg;
+    if (!pkg.open_mem(buf, len, password)) {
+        BBoxResult result;
+        result.source_type = "xlsb";
+        result.page_count = -1;
+        return result;
+    }
+    return extract_xlsb(pkg, start_page, end_page);
+}
+
+BBoxResult extract_xlsb(XlsxPackage& pkg, int start_page, int end_page) {
+    BBoxResult result;
+    result.source_type = "xlsb";
+
+    try {
+        Book bk;
+        read_book(pkg, bk);
+        if (!pkg.part("xl/workbook.bin")) { result.page_count = -1; return result; }
+
+        // cell XF -> date-formatted?, once per workbook (vdate channel)
+        std::vector<char> xf_date;
+        if (const std::string* st = pkg.part("xl/styles.bin")) {
+            std::unordered_map<int, std::string> custom;
+            bool in_cell_xfs = false;
+            Records it(st->data(), st->size());
+            for (Rec r; it.next(r);) {
+                if (r.id == kFmt && r.n >= 2) {
+                    std::string code;
+                    wide(r.p + 2, r.p + r.n, code);
+                    custom[le16(r.p)] = std::move(code);
+                } else if (r.id == kBeginCellXFs) in_cell_xfs = true;
+                else if (r.id == kEndCellXFs) in_cell_xfs = false;
+                else if (r.id == kXF && in_cell_xfs && r.n >= 4) {
+                    int id = le16(r.p + 2);
+                    auto c = custom.find(id);
+                    xf_date.push_back(bboxes_numfmt_is_date(id, c != custom.end() ? c->second.c_str() : bboxes_builtin_numfmt(id)));
+                }
+            }
+        }
+
+        // shared strings, once (RichStr: flags, then the XLWideString)
+        std::vector<std::string> sst;
+        if (const std::string* ss = pkg.part("xl/sharedStrings.bin")) {
+            Records it(ss->data(), ss->size());
+            for (Rec r; it.next(r);) {
+                if (r.id != kSSTItem) continue;
+                sst.emplace_back();
+                if (r.n >= 1) wide(r.p + 1, r.p + r.n, sst.back());
+            }
+        }
+
+        int sheet_count = static_cast<int>(bk.sheets.size());
+        result.page_count = sheet_count;
+        if (sheet_count == 0) return result;
+        int sp = (start_page > 0) ? start_page : 1;
+        int ep = (end_page > 0) ? end_page : sheet_count;
+        if (sp > sheet_count) sp = sheet_count;
+        if (ep > sheet_count) ep = sheet_count;
+        if (sp > ep) { result.page_count = -1; return result; }
+
+        FormulaText ft(bk);
+        std::string formula;
+        for (int si = sp - 1; si < ep; si++) {
+            int idx = mz_zip_reader_locate_file(&pkg.z, bk.sheets[si].first.c_str(), nullptr, 0);
+            size_t sz = 0;
+            void* raw = idx < 0 ? nullptr : mz_zip_reader_extract_to_heap(&pkg.z, idx, &sz, 0);
+            if (!raw) continue;
+            std::unique_ptr<void, void (*)(void*)> hold(raw, mz_free);
+
+            Page page;
+            page.page_id = static_cast<uint32_t>(si);
+            page.document_id = 0;
+            page.page_number = si + 1;
+
+            CoveredCells covered;                     // shared/array children, then merge interiors
+            struct Span { uint32_t r1, c1, r2, c2; };
+            std::vector<Span> merged;                 // BrtMergeCell, applied once the cells are in
+
+            double pw = 0, ph = 0;
+            uint32_t row = 0;
+            bool last_emitted = false;   // did the previous cell record produce page.bboxes.back()?
+            Records it(raw, sz);
+            for (Rec r; it.next(r);) {
+                const uint8_t* end = r.p + r.n;
+                if (r.id == kRowHdr) { if (r.n >= 4) row = le32(r.p) + 1; continue; }
+                if (r.id == kMergeCell) {
+                    if (r.n < 16) continue;
+                    uint32_t r1 = le32(r.p) + 1, r2 = le32(r.p + 4) + 1, c1 = le32(r.p + 8) + 1, c2 = le32(r.p + 12) + 1;
+                    if (r2 >= r1 && c2 >= c1 && r2 <= kMaxRow && c2 <= kMaxCol) merged.push_back({r1, c1, r2, c2});
+                    continue;
+                }
+                if (r.id == kShrFmla || r.id == kArrFmla) {
+                    /* RfX of the group, then its formula; it follows the master's own cell record */
+                    if (!last_emitted || r.n < 16) continue;
+                    BBox& m = page.bboxes.back();
+                    uint32_t r1 = le32(r.p) + 1, r2 = le32(r.p + 4) + 1, c1 = le32(r.p + 8) + 1, c2 = le32(r.p + 12) + 1;
+                    if (uint32_t(m.y) != r1 || uint32_t(m.x) != c1 || r2 < r1 || c2 < c1 || r2 > kMaxRow || c2 > kMaxCol) continue;
+                    const uint8_t* f = r.p + 16 + (r.id == kArrFmla ? 1 : 0);   /* BrtArrFmla: a flags byte first */
+                    if (f <= end && parsed_formula(ft, f, end, long(r1) - 1, long(c1) - 1, formula)) m.formula = formula;
+                    m.w = double(c2 - c1 + 1); m.h = double(r2 - r1 + 1);   // a merge on the master wins at close
+                    covered.add(r1, c1, r2, c2, r1, c1);
+                    continue;
+                }
+                if (!((r.id >= kCellBlank && r.id <= kFmlaError) || r.id == kCellRString)) continue;
+                last_emitted = false;
+                if (r.n < 8) continue;
+                uint32_t col = le32(r.p) + 1;
+                uint32_t style = le32(r.p + 4) & 0xFFFFFF;
+                if (col > pw) pw = col;
+                if (row > ph) ph = row;
+                if (r.id == kCellBlank || covered.has(row, col)) continue;
+
+                BBox bb;
+                bb.page_id = static_cast<uint32_t>(si);
+                bb.style_id = style;
+                bb.x = col; bb.y = row; bb.w = 1; bb.h = 1;
+                const uint8_t* v = r.p + 8;
+                const uint8_t* fq = nullptr;   // CellParsedFormula, after the value and grbitFlags
+                bool ok = true;
+                switch (r.id) {
+                    case kCellRk:   if ((ok = r.n >= 12)) { bb.cell_type = BBOX_NUMBER; bb.vnum = rk_number(le32(v)); } break;
+                    case kCellReal: case kFmlaNum:
+                        if ((ok = r.n >= 16)) { bb.cell_type = BBOX_NUMBER; bb.vnum = le_f64(v); fq = v + 8 + 2; } break;
+                    case kCellBool: case kFmlaBool:
+                        if ((ok = r.n >= 9)) { bb.cell_type = BBOX_BOOL; bb.vbool = v[0] != 0; bb.text = bb.vbool ? "1" : "0"; fq = v + 1 + 2; } break;
+                    case kCellError: case kFmlaError:
+                        if ((ok = r.n >= 9)) { bb.cell_type = BBOX_ERROR; bb.text = err_text(v[0]); fq = v + 1 + 2; } break;
+                    case kCellIsst:
+                        if ((ok = r.n >= 12)) { bb.cell_type = BBOX_STRING; uint32_t i = le32(v); if (i < sst.size()) bb.text = sst[i]; } break;
+                    case kCellSt: case kFmlaString: {
+                        bb.cell_type = BBOX_STRING;
+                        size_t a = wide(v, end, bb.text);
+                        ok = a != 0; fq = v + a + 2;
+                    } break;
+                    case kCellRString:
+                        bb.cell_type = BBOX_STRING;
+                        ok = r.n >= 9 && wide(v + 1, end, bb.text) != 0; break;
+                    default: break;
+                }
+                if (!ok) continue;
+                if (bb.cell_type == BBOX_NUMBER) {
+                    put_num(bb.text, bb.vnum);
+                    if (style < xf_date.size() && xf_date[style]) {
+                        bb.has_vdate = true; bb.vdate = bboxes_serial_to_unix_us(bb.vnum, bk.date1904); }
+                }
+                if (r.id >= kFmlaString && r.id <= kFmlaError && fq && fq <= end &&
+                    parsed_formula(ft, fq, end, long(row) - 1, long(col) - 1, formula))
+                    bb.formula = formula;
+                page.bboxes.push_back(std::move(bb));
+                last_emitted = true;
+            }
+            if (!merged.empty()) {
+                /* merges sit after the cell table: origins take the merge's extent, covered cells drop out */
+                std::unordered_map<uint64_t, std::pair<double, double>> extent;  // top-left -> (w,h)
+                covered.clear();
+                for (const Span& m : merged) {
+                    extent[cell_key(m.r1, m.c1)] = { double(m.c2 - m.c1 + 1), double(m.r2 - m.r1 + 1) };
+                    page.merges.push_back({int(m.r1), int(m.c1), int(m.r2), int(m.c2)});  // side-channel
+                    covered.add(m.r1, m.c1, m.r2, m.c2, m.r1, m.c1);
+                }
+                std::vector<BBox> kept;
+                kept.reserve(page.bboxes.size());
+                for (BBox& b : page.bboxes) {
+                    uint32_t rr = uint32_t(b.y), cc = uint32_t(b.x);
+                    if (covered.has(rr, cc)) continue;
+                    if (auto e = extent.find(cell_key(rr, cc)); e != extent.end()) { b.w = e->second.first; b.h = e->second.second; }
+                    kept.push_back(std::move(b));
+                }
+                page.bboxes = std::move(kept);
+            }
+            page.width = pw; page.height = ph;
+            result.pages.push_back(std::move(page));
+        }
+    } catch (...) {
+        result.page_count = -1;
+    }
+    return result;
+}
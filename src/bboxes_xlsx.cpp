@@ -1,8 +1,11 @@
 #include "bboxes.h"
+#include "bboxes_covered.h"
 #include "bboxes_types.h"
+#include "bboxes_xlsx_pkg.h"
 
 #include <xlnt/xlnt.hpp>
-#include <sstream>
+#include <istream>
+#include <streambuf>
 #include <string>
 
 /* ── shared/array-formula regions ─────────────────────────────────────────
@@ -18,19 +21,18 @@
 #include <cstdint>
 #include <cstring>
 #include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
 namespace {
 
+inline uint64_t cell_key(uint32_t row, uint32_t col) { return (uint64_t(row) << 24) | col; }
+
 struct Region { double w = 1.0, h = 1.0; std::string formula; };
 struct SheetRegions {
     std::unordered_map<uint64_t, Region> masters;  // master cell -> extent + formula
-    std::unordered_set<uint64_t> covered;          // drag-fill/array children to skip
+    CoveredCells covered;                          // drag-fill/array children to skip
 };
 
-inline uint64_t cell_key(uint32_t row, uint32_t col) { return (uint64_t(row) << 24) | col; }
-
 const char* local_name(const char* n) {
     const char* c = std::strchr(n, ':');
     return c ? c + 1 : n;
@@ -81,6 +83,12 @@ bool parse_ref(const std::string& ref, uint32_t& r1, uint32_t& c1, uint32_t& r2,
 }
 
 void parse_sheet_regions(const std::string& xml, SheetRegions& sr) {
+    /* Only t="shared" / t="array" groups matter here, and a cell's own t= is never
+       either value — so a sheet without those strings has nothing to find and
+       skips the DOM build entirely (the common case). The quoted value is what is
+       looked for, in either quote, so t='shared' and t = "shared" pass too. */
+    auto has = [&](const char* v) { return memmem(xml.data(), xml.size(), v, std::strlen(v)) != nullptr; };
+    if (!has("\"shared\"") && !has("'shared'") && !has("\"array\"") && !has("'array'")) return;
     pugi::xml_document doc;
     if (!doc.load_buffer(xml.data(), xml.size())) return;
     std::vector<pugi::xml_node> cells;
@@ -109,7 +117,7 @@ void parse_sheet_regions(const std::string& xml, SheetRegions& sr) {
                     sr.masters[key] = std::move(rg);
                 }
             } else {  // child: empty <f t="shared" si=.../>
-                sr.covered.insert(key);
+                sr.covered.add(cr, cc);
             }
         } else if (std::strcmp(t, "array") == 0 && refv && *refv) {
             uint32_t r1, c1, r2, c2;
@@ -119,15 +127,16 @@ void parse_sheet_regions(const std::string& xml, SheetRegions& sr) {
                 rg.h = double(r2 - r1 + 1);
                 rg.formula = std::string("=") + f.text().get();
                 sr.masters[key] = std::move(rg);
-                for (uint32_t rr = r1; rr <= r2; rr++)  // array children have no <f>: geometric fill
-                    for (uint32_t cx = c1; cx <= c2; cx++)
-                        if (!(rr == cr && cx == cc)) sr.covered.insert(cell_key(rr, cx));
+                sr.covered.add(r1, c1, r2, c2, cr, cc);  // array children have no <f>: geometric fill
             }
         }
     }
 }
 
-std::unordered_map<std::string, SheetRegions> build_sheet_regions(const void* buf, size_t len) {
+/* sp..ep is the 0-based half-open sheet range actually being extracted: sheets
+   outside it are never inflated a second time. */
+std::unordered_map<std::string, SheetRegions> build_sheet_regions(const void* buf, size_t len,
+                                                                  int sp, int ep) {
     std::unordered_map<std::string, SheetRegions> out;
     mz_zip_archive z;
     std::memset(&z, 0, sizeof(z));
@@ -143,7 +152,8 @@ std::unordered_map<std::string, SheetRegions> build_sheet_regions(const void* bu
         all_by(reldoc, "Relationship", rels);
         std::unordered_map<std::string, std::string> rid2t;
         for (auto& r : rels) rid2t[r.attribute("Id").value()] = r.attribute("Target").value();
-        for (auto& s : sheets) {
+        for (int si = sp; si < ep && si < static_cast<int>(sheets.size()); si++) {
+            auto& s = sheets[si];
             auto it = rid2t.find(s.attribute("r:id").value());
             if (it == rid2t.end()) continue;
             const std::string& t = it->second;
@@ -160,6 +170,28 @@ std::unordered_map<std::string, SheetRegions> build_sheet_regions(const void* bu
     return out;
 }
 
+/* Read-only streambuf over the caller's buffer, so xlnt's zip reader seeks and
+   reads the original bytes instead of a std::string + istringstream copy. */
+struct MemBuf : std::streambuf {
+    MemBuf(const void* buf, size_t len) {
+        char* b = const_cast<char*>(static_cast<const char*>(buf));
+        setg(b, b, b + len);
+    }
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                     std::ios_base::openmode which) override {
+        if (!(which & std::ios_base::in)) return pos_type(off_type(-1));
+        char* p = dir == std::ios_base::beg ? eback() :
+                  dir == std::ios_base::cur ? gptr() : egptr();
+        p += off;
+        if (p < eback() || p > egptr()) return pos_type(off_type(-1));
+        setg(eback(), p, egptr());
+        return pos_type(p - eback());
+    }
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+        return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+};
+
 }  // namespace
 
 /* ── lifecycle (no-ops for xlnt) ─────────────────────────────────── */
@@ -176,12 +208,10 @@ BBoxResult extract_xlsx(const void* buf, size_t len, const char* password,
 
     try {
         xlnt::workbook wb;
-        std::string data(static_cast<const char*>(buf), len);
-        std::istringstream stream(data);
+        MemBuf mb(buf, len);
+        std::istream stream(&mb);
         wb.load(stream);
-
-        /* shared/array-formula group extents, read straight from the XML */
-        auto regions = build_sheet_regions(buf, len);
+        const bool date1904 = wb.base_date() == xlnt::calendar::mac_1904;
 
         int sheet_count = static_cast<int>(wb.sheet_count());
         result.page_count = sheet_count;
@@ -193,6 +223,10 @@ BBoxResult extract_xlsx(const void* buf, size_t len, const char* password,
         if (ep > sheet_count) ep = sheet_count;
         if (sp > ep) { result.page_count = -1; return result; }
 
+        /* shared/array-formula group extents, read straight from the XML — only
+           for the sheets in range */
+        auto regions = build_sheet_regions(buf, len, sp - 1, ep);
+
         for (int si = sp - 1; si < ep; si++) {
             auto ws = wb.sheet_by_index(si);
 
@@ -209,30 +243,35 @@ BBoxResult extract_xlsx(const void* buf, size_t len, const char* password,
             page.width       = static_cast<double>(highest_col.index);
             page.height      = static_cast<double>(highest_row);
 
-            /* collect merged cell ranges to skip covered cells */
-            auto merged = ws.merged_ranges();
+            /* merge index, built once per sheet: top-left -> (w,h) extent plus the
+               covered non-origins (same shape as the fast path). Replaces a scan of
+               every merged range per cell, which was O(cells x merges). */
+            CoveredCells covered;
+            std::unordered_map<uint64_t, std::pair<double, double>> extent;
+            for (const auto& mr : ws.merged_ranges()) {
+                auto tl = mr.top_left();
+                auto br = mr.bottom_right();
+                uint32_t r1 = tl.row(), c1 = tl.column().index;
+                uint32_t r2 = br.row(), c2 = br.column().index;
+                extent[cell_key(r1, c1)] = { double(c2 - c1 + 1), double(r2 - r1 + 1) };
+                covered.add(r1, c1, r2, c2, r1, c1);
+            }
+
+            /* rows(true) hands back only stored cells, so the body below runs once
+               per cell that exists; xlnt's iterator still steps over every row it
+               materialized, empty positions included. */
+            for (auto cells : ws.rows(true)) {
+                for (auto cell : cells) {
+                    auto row = cell.row();
+                    auto col = cell.column();
+                    uint64_t key = cell_key(row, col.index);
 
-            for (auto row = 1u; row <= highest_row; row++) {
-                for (auto col = xlnt::column_t(1); col <= highest_col; col++) {
                     /* skip cells covered by a merge (not the top-left origin) */
-                    bool is_covered = false;
-                    for (const auto& mr : merged) {
-                        if (mr.contains(xlnt::cell_reference(col, row))) {
-                            auto tl = mr.top_left();
-                            if (tl.column() != col || tl.row() != row) {
-                                is_covered = true;
-                                break;
-                            }
-                        }
-                    }
-                    if (is_covered) continue;
+                    if (covered.has(row, col.index)) continue;
 
                     /* skip drag-fill/array children — the group is emitted once at its master */
-                    uint64_t key = cell_key(row, col.index);
-                    if (sr && sr->covered.count(key)) continue;
+                    if (sr && sr->covered.has(row, col.index)) continue;
 
-                    if (!ws.has_cell(xlnt::cell_reference(col, row))) continue;
-                    auto cell = ws.cell(xlnt::cell_reference(col, row));
                     bool is_master = sr && sr->masters.count(key);
                     /* Emit truly-empty cells only when they carry nothing: a formula IS
                        content even with no cached value (fullCalcOnLoad / exporters that
@@ -287,14 +326,9 @@ BBoxResult extract_xlsx(const void* buf, size_t len, const char* password,
                        may need revisiting if merged headers confuse grid alignment. */
                     double cell_w = 1.0;
                     double cell_h = 1.0;
-                    for (const auto& mr : merged) {
-                        auto tl = mr.top_left();
-                        if (tl.column() == col && tl.row() == row) {
-                            auto br = mr.bottom_right();
-                            cell_w = static_cast<double>(br.column().index - col.index + 1);
-                            cell_h = static_cast<double>(br.row() - row + 1);
-                            break;
-                        }
+                    if (auto it = extent.find(key); it != extent.end()) {
+                        cell_w = it->second.first;
+                        cell_h = it->second.second;
                     }
 
                     /* a drag-fill/array master spans its whole group (unexpanded region) */
@@ -313,7 +347,10 @@ BBoxResult extract_xlsx(const void* buf, size_t len, const char* password,
                     bb.h = cell_h;
                     bb.text = cell.to_string();  /* master's displayed value represents the region */
                     switch (cell.data_type()) {  /* typed-value channel (legacy path parity) */
-                        case xlnt::cell_type::number:  bb.cell_type = BBOX_NUMBER; bb.vnum = cell.value<double>(); break;
+                        case xlnt::cell_type::number:  bb.cell_type = BBOX_NUMBER; bb.vnum = cell.value<double>();
+                                                       if (cell.is_date()) { bb.has_vdate = true;
+                                                           bb.vdate = bboxes_serial_to_unix_us(bb.vnum, date1904); }
+                                                       break;
                         case xlnt::cell_type::boolean: bb.cell_type = BBOX_BOOL;   bb.vbool = cell.value<bool>();  break;
                         case xlnt::cell_type::error:   bb.cell_type = BBOX_ERROR;  break;
                         default:                       bb.cell_type = BBOX_STRING; break;
@@ -389,26 +426,156 @@ static void xml_unescape(std::string& s) {
     s = std::move(out);
 }
 
-BBoxResult extract_xlsx_fast(const void* buf, size_t len, const char* /*password*/,
-                             int start_page, int end_page) {
+/* ── rich-text runs (<r> in an <si> or <is>) ─────────────────────────── */
+
+struct RunSpan { uint32_t start, length, style_id; };
+
+/* code points of an escaped XML text piece, after entity decoding */
+static uint32_t text_cp_len(const char* p, size_t n) {
+    std::string s(p, n);
+    xml_unescape(s);
+    uint32_t k = 0;
+    for (unsigned char ch : s) if ((ch & 0xC0) != 0x80) k++;
+    return k;
+}
+
+/* first <tag ...> / <tag/> inside [p, e) with a real name boundary, or nullptr */
+static const char* rpr_tag(const char* p, const char* e, const char* tag, const char** tag_end) {
+    size_t n = std::strlen(tag);
+    for (const char* q = p; q < e && (q = static_cast<const char*>(memmem(q, e - q, tag, n))); q += n) {
+        char c = q + n < e ? q[n] : '\0';
+        if (c != '/' && c != ' ' && c != '>') continue;
+        *tag_end = static_cast<const char*>(std::memchr(q, '>', e - q));
+        return *tag_end ? q : nullptr;
+    }
+    return nullptr;
+}
+
+/* toggle element (<b/>, <i val="0"/>, <u val="none"/>): present and not switched off */
+static bool rpr_flag(const char* p, const char* e, const char* tag) {
+    const char* te;
+    const char* q = rpr_tag(p, e, tag, &te);
+    if (!q) return false;
+    std::string v = x_attr(q, te, " val=\"");
+    return !(v == "0" || v == "false" || v == "none");
+}
+
+/* Intern the run properties of an <rPr> body [p, e) — rFont/sz/color/b/i/u, the
+   same axes StyleTable carries. A run without <rPr> gets the defaults (it inherits
+   the cell's xf, which the fast reader reports as the raw `s`). */
+static uint32_t intern_rpr(const char* p, const char* e, BBoxResult& result) {
+    std::string font = "default", color = BBOXES_DEFAULT_COLOR;
+    double size = 11.0;
+    bool bold = false, italic = false, underline = false;
+    if (p) {
+        const char* te;
+        if (const char* q = rpr_tag(p, e, "<rFont", &te)) {
+            std::string v = x_attr(q, te, " val=\"");
+            if (!v.empty()) { xml_unescape(v); font = v; }
+        }
+        if (const char* q = rpr_tag(p, e, "<sz", &te)) {
+            std::string v = x_attr(q, te, " val=\"");
+            if (!v.empty()) size = std::strtod(v.c_str(), nullptr);
+        }
+        if (const char* q = rpr_tag(p, e, "<color", &te)) {
+            std::string hex = x_attr(q, te, " rgb=\"");   /* theme/indexed colours keep the default */
+            if (hex.size() == 8) {
+                unsigned long argb = std::strtoul(hex.c_str(), nullptr, 16);
+                color = color_string((argb >> 16) & 0xFF, (argb >> 8) & 0xFF, argb & 0xFF, (argb >> 24) & 0xFF);
+            }
+        }
+        bold = rpr_flag(p, e, "<b");
+        italic = rpr_flag(p, e, "<i");
+        underline = rpr_flag(p, e, "<u");
+    }
+    uint32_t font_id = result.run_fonts.intern(font.c_str());
+    return result.run_styles.intern(font_id, size, color, bold ? "bold" : "normal", italic, underline);
+}
+
+/* Concatenate the <t> texts of an <si>/<is> body [p, end) into `val` (raw, still
+   escaped — as the SST scan always has). With `with_runs` (the open's runs flag) and
+   <r> runs in the body, also record each run's span (code-point offsets into the
+   decoded text) and interned <rPr>; <t> outside any run (leading plain text, <rPh>
+   phonetics) only advances the offset. */
+static void rich_text(const char* p, const char* end, std::string& val,
+                      std::vector<RunSpan>& runs, BBoxResult& result, bool with_runs) {
+    const bool rich = with_runs && memmem(p, end - p, "<r>", 3) != nullptr;
+    const char* run_end = nullptr;   // "</r>" of the run we're inside
+    uint32_t run_style = 0, off = 0;
+    const char* q = p;
+    while (q < end) {
+        const char* t = static_cast<const char*>(memmem(q, end - q, "<t", 2));
+        if (!t) break;
+        const char* gt = static_cast<const char*>(std::memchr(t, '>', end - t));
+        if (!gt) break;
+        if (*(gt - 1) == '/') { q = gt + 1; continue; }
+        const char* tc = static_cast<const char*>(memmem(gt, end - gt, "</t>", 4));
+        if (!tc) break;
+        val.append(gt + 1, tc - (gt + 1));
+        if (rich) {
+            const char* r = nullptr;   // last run opened between q and this <t>
+            for (const char* s = q; (s = static_cast<const char*>(memmem(s, t - s, "<r>", 3))); s += 3) r = s;
+            if (r) {
+                run_end = static_cast<const char*>(memmem(r, end - r, "</r>", 4));
+                const char* rp = static_cast<const char*>(memmem(r, t - r, "<rPr>", 5));
+                const char* rpe = rp ? static_cast<const char*>(memmem(rp, t - rp, "</rPr>", 6)) : nullptr;
+                run_style = intern_rpr(rp && rpe ? rp + 5 : nullptr, rpe, result);
+            }
+            uint32_t n = text_cp_len(gt + 1, tc - (gt + 1));
+            if (run_end && t < run_end && n) runs.push_back({off, n, run_style});
+            off += n;
+        }
+        q = tc + 4;
+    }
+}
+
+/* A password-protected workbook (OLE2-wrapped) is decrypted segment by segment
+   as the zip reader pulls from it; a password that does not verify gives
+   page_count = -1, like a buffer that is not a zip. The container does not say
+   whether an xlsx or an xlsb is inside, so a package with a binary workbook
+   part and no XML one goes to the xlsb reader. */
+BBoxResult extract_xlsx_fast(const void* buf, size_t len, const char* password,
+                             int start_page, int end_page, bool runs) {
+    XlsxPackage pkg;
+    if (!pkg.open_mem(buf, len, password)) {
+        BBoxResult result;
+        result.source_type = "xlsx";
+        result.page_count = -1;
+        return result;
+    }
+#ifdef BBOXES_HAS_XLSB
+    if (!pkg.part("xl/workbook.xml") && mz_zip_reader_locate_file(&pkg.z, "xl/workbook.bin", nullptr, 0) >= 0)
+        return extract_xlsb(pkg, start_page, end_page);
+#endif
+    return extract_xlsx_fast(pkg, start_page, end_page, runs);
+}
+
+/* Small parts come from the package's memo (shared with the header builder when
+   bboxes_open_xlsx_artifact drives both); worksheets are inflated here, once. */
+BBoxResult extract_xlsx_fast(XlsxPackage& pkg, int start_page, int end_page, bool runs) {
     BBoxResult result;
     result.source_type = "xlsx";
-    mz_zip_archive z;
-    std::memset(&z, 0, sizeof(z));
-    if (!mz_zip_reader_init_mem(&z, buf, len, 0)) { result.page_count = -1; return result; }
+    mz_zip_archive& z = pkg.z;
+    const bool with_runs = runs;
 
     try {
         // ordered sheets [(part, name)] from workbook.xml + rels (workbook order = page_id)
-        std::string wbxml, relsxml;
+        const std::string* wbxml = pkg.part("xl/workbook.xml");
+        const std::string* relsxml = pkg.part("xl/_rels/workbook.xml.rels");
         std::vector<std::pair<std::string, std::string>> sheets;
-        if (zip_read(z, "xl/workbook.xml", wbxml) &&
-            zip_read(z, "xl/_rels/workbook.xml.rels", relsxml)) {
+        bool date1904 = false;
+        if (wbxml && relsxml) {
             pugi::xml_document wbdoc, reldoc;
-            wbdoc.load_buffer(wbxml.data(), wbxml.size());
-            reldoc.load_buffer(relsxml.data(), relsxml.size());
-            std::vector<pugi::xml_node> ss, rels;
+            wbdoc.load_buffer(wbxml->data(), wbxml->size());
+            reldoc.load_buffer(relsxml->data(), relsxml->size());
+            std::vector<pugi::xml_node> ss, rels, pr;
             all_by(wbdoc, "sheet", ss);
             all_by(reldoc, "Relationship", rels);
+            all_by(wbdoc, "workbookPr", pr);
+            if (!pr.empty()) {
+                const char* d = pr[0].attribute("date1904").value();
+                date1904 = !std::strcmp(d, "1") || !std::strcmp(d, "true");
+            }
             std::unordered_map<std::string, std::string> rid2t;
             for (auto& r : rels) rid2t[r.attribute("Id").value()] = r.attribute("Target").value();
             for (auto& s : ss) {
@@ -420,37 +587,51 @@ BBoxResult extract_xlsx_fast(const void* buf, size_t len, const char* /*password
             }
         }
 
+        // cellXfs `s` -> date-formatted?, once per workbook (vdate channel)
+        std::vector<char> xf_date;
+        if (const std::string* stxml = pkg.part("xl/styles.xml")) {
+            pugi::xml_document stdoc;
+            stdoc.load_buffer(stxml->data(), stxml->size());
+            std::vector<pugi::xml_node> nfs, cxs;
+            all_by(stdoc, "numFmt", nfs);
+            all_by(stdoc, "cellXfs", cxs);
+            std::unordered_map<int, std::string> custom;
+            for (auto& nf : nfs) custom[nf.attribute("numFmtId").as_int()] = nf.attribute("formatCode").value();
+            if (!cxs.empty())
+                for (auto xf : cxs[0].children()) {
+                    if (xf.type() != pugi::node_element || std::strcmp(local_name(xf.name()), "xf")) continue;
+                    int id = xf.attribute("numFmtId").as_int(0);
+                    auto it = custom.find(id);
+                    xf_date.push_back(bboxes_numfmt_is_date(
+                        id, it != custom.end() ? it->second.c_str() : bboxes_builtin_numfmt(id)));
+                }
+        }
+
         // shared strings, once
-        std::string sstxml;
         std::vector<std::string> sst;
-        if (zip_read(z, "xl/sharedStrings.xml", sstxml)) {
-            const char* p = sstxml.data(); const char* end = p + sstxml.size();
+        std::unordered_map<size_t, std::vector<RunSpan>> sst_runs;   // only rich <si>
+        if (const std::string* sstxml = pkg.part("xl/sharedStrings.xml")) {
+            const char* p = sstxml->data(); const char* end = p + sstxml->size();
+            std::vector<RunSpan> runs;
             while ((p = static_cast<const char*>(memmem(p, end - p, "<si>", 4)))) {
                 p += 4;
                 const char* se = static_cast<const char*>(memmem(p, end - p, "</si>", 5));
                 if (!se) break;
-                std::string val; const char* q = p;
-                while (q < se) {
-                    const char* t = static_cast<const char*>(memmem(q, se - q, "<t", 2));
-                    if (!t) break;
-                    const char* gt = static_cast<const char*>(std::memchr(t, '>', se - t));
-                    if (!gt) break;
-                    if (*(gt - 1) == '/') { q = gt + 1; continue; }
-                    const char* tc = static_cast<const char*>(memmem(gt, se - gt, "</t>", 4));
-                    if (!tc) break;
-                    val.append(gt + 1, tc - (gt + 1)); q = tc + 4;
-                }
+                std::string val;
+                rich_text(p, se, val, runs, result, with_runs);
+                if (!runs.empty()) { sst_runs[sst.size()] = std::move(runs); runs.clear(); }
                 sst.push_back(std::move(val)); p = se + 5;
             }
         }
 
         int sheet_count = static_cast<int>(sheets.size());
         result.page_count = sheet_count;
+        if (sheet_count == 0) return result;
         int sp = (start_page > 0) ? start_page : 1;
         int ep = (end_page > 0) ? end_page : sheet_count;
         if (sp > sheet_count) sp = sheet_count;
         if (ep > sheet_count) ep = sheet_count;
-        if (sp > ep) { result.page_count = -1; mz_zip_reader_end(&z); return result; }
+        if (sp > ep) { result.page_count = -1; return result; }
 
         for (int si = sp - 1; si < ep; si++) {
             std::string xml;
@@ -462,7 +643,7 @@ BBoxResult extract_xlsx_fast(const void* buf, size_t len, const char* /*password
             page.document_id = 0;
             page.page_number = si + 1;
 
-            std::unordered_set<uint64_t> covered;
+            CoveredCells covered;
             std::unordered_map<uint64_t, std::pair<double, double>> extent;  // top-left -> (w,h)
 
             // merges (small block, usually after sheetData) -> extents + covered non-origins
@@ -474,9 +655,7 @@ BBoxResult extract_xlsx_fast(const void* buf, size_t len, const char* /*password
                 if (parse_ref(x_attr(m, me, " ref=\"").c_str(), r1, c1, r2, c2)) {
                     extent[cell_key(r1, c1)] = { double(c2 - c1 + 1), double(r2 - r1 + 1) };
                     page.merges.push_back({int(r1), int(c1), int(r2), int(c2)});  // side-channel
-                    for (uint32_t rr = r1; rr <= r2; rr++)
-                        for (uint32_t cc = c1; cc <= c2; cc++)
-                            if (!(rr == r1 && cc == c1)) covered.insert(cell_key(rr, cc));
+                    covered.add(r1, c1, r2, c2, r1, c1);
                 }
                 m = me + 1;
             }
@@ -500,7 +679,7 @@ BBoxResult extract_xlsx_fast(const void* buf, size_t len, const char* /*password
                     cell_end = ce; next = ce + 4;
                 }
                 uint64_t key = cell_key(row, col);
-                if (self_closing || covered.count(key)) { p = next; continue; }
+                if (self_closing || covered.has(row, col)) { p = next; continue; }
 
                 std::string sref = x_attr(p, tag_end, " s=\"");
                 std::string tref = x_attr(p, tag_end, " t=\"");
@@ -520,9 +699,7 @@ BBoxResult extract_xlsx_fast(const void* buf, size_t len, const char* /*password
                             uint32_t r1, c1, r2, c2;
                             if (parse_ref(fref.c_str(), r1, c1, r2, c2)) {
                                 w = double(c2 - c1 + 1); h = double(r2 - r1 + 1);
-                                for (uint32_t rr = r1; rr <= r2; rr++)
-                                    for (uint32_t cc = c1; cc <= c2; cc++)
-                                        if (!(rr == row && cc == col)) covered.insert(cell_key(rr, cc));
+                                covered.add(r1, c1, r2, c2, row, col);
                             }
                         }
                     }
@@ -533,11 +710,20 @@ BBoxResult extract_xlsx_fast(const void* buf, size_t len, const char* /*password
                 const char* vpos = (tref == "inlineStr")
                     ? static_cast<const char*>(memmem(tag_end, cell_end - tag_end, "<is", 3))
                     : static_cast<const char*>(memmem(tag_end, cell_end - tag_end, "<v", 2));
-                std::string v = (tref == "inlineStr") ? x_inner(tag_end, cell_end, "<t", 2, "</t>", 4)
-                                                       : x_inner(tag_end, cell_end, "<v", 2, "</v>", 4);
+                std::string v;
+                std::vector<RunSpan> inline_runs;
+                const std::vector<RunSpan>* cell_runs = &inline_runs;
+                if (tref == "inlineStr") {   // every <t> of the <is>, runs included
+                    const char* ie = vpos ? static_cast<const char*>(memmem(vpos, cell_end - vpos, "</is>", 5)) : nullptr;
+                    if (ie) rich_text(vpos, ie, v, inline_runs, result, with_runs);
+                } else {
+                    v = x_inner(tag_end, cell_end, "<v", 2, "</v>", 4);
+                }
                 std::string text;
                 if (tref == "s") { long i = std::strtol(v.c_str(), nullptr, 10);
-                                   if (i >= 0 && static_cast<size_t>(i) < sst.size()) text = sst[i]; }
+                                   if (i >= 0 && static_cast<size_t>(i) < sst.size()) {
+                                       text = sst[i];
+                                       if (auto r = sst_runs.find(i); r != sst_runs.end()) cell_runs = &r->second; } }
                 else text = std::move(v);
 
                 if (!vpos && formula.empty()) { p = next; continue; }   // truly-empty cell
@@ -553,9 +739,13 @@ BBoxResult extract_xlsx_fast(const void* buf, size_t len, const char* /*password
                 if      (tref == "b") { bb.cell_type = BBOX_BOOL;  bb.vbool = (bb.text == "1"); }
                 else if (tref == "e") { bb.cell_type = BBOX_ERROR; }
                 else if (tref == "s" || tref == "inlineStr" || tref == "str") bb.cell_type = BBOX_STRING;
-                else { bb.cell_type = BBOX_NUMBER; bb.vnum = std::strtod(bb.text.c_str(), nullptr); }
+                else { bb.cell_type = BBOX_NUMBER; bb.vnum = std::strtod(bb.text.c_str(), nullptr);
+                       if (bb.style_id < xf_date.size() && xf_date[bb.style_id] && !bb.text.empty()) {
+                           bb.has_vdate = true; bb.vdate = bboxes_serial_to_unix_us(bb.vnum, date1904); } }
                 bb.formula = std::move(formula);
                 page.bboxes.push_back(std::move(bb));
+                for (const RunSpan& rs : *cell_runs)   // rich-text side-channel
+                    page.runs.push_back({col, row, rs.start, rs.length, rs.style_id});
                 p = next;
             }
             page.width = pw; page.height = ph;
@@ -564,6 +754,5 @@ BBoxResult extract_xlsx_fast(const void* buf, size_t len, const char* /*password
     } catch (...) {
         result.page_count = -1;
     }
-    mz_zip_reader_end(&z);
     return result;
 }
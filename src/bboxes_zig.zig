@@ -53,3 +53,124 @@ test "sha256 matches the known digest for 'abc'" {
         buf[0..64],
     );
 }
+
+/// Incremental SHA-256 for input that is never in memory at once (a PDF opened
+/// by path). The state lives in the caller's 128-byte, 16-aligned buffer
+/// (`SHA256::add` in sha256.h), so nothing is allocated here.
+const Sha256 = std.crypto.hash.sha2.Sha256;
+comptime {
+    std.debug.assert(@sizeOf(Sha256) <= 128 and @alignOf(Sha256) <= 16);
+}
+
+export fn bb_sha256_init(state: *anyopaque) void {
+    const h: *Sha256 = @ptrCast(@alignCast(state));
+    h.* = Sha256.init(.{});
+}
+
+export fn bb_sha256_update(state: *anyopaque, data: ?[*]const u8, len: usize) void {
+    const h: *Sha256 = @ptrCast(@alignCast(state));
+    if (data) |p| h.update(p[0..len]);
+}
+
+/// Same lowercase hex as `bb_sha256_hex`; the state is spent afterwards.
+export fn bb_sha256_final_hex(state: *anyopaque, out: [*]u8) void {
+    const h: *Sha256 = @ptrCast(@alignCast(state));
+    var digest: [Sha256.digest_length]u8 = undefined;
+    h.final(&digest);
+    _ = std.fmt.bufPrint(out[0..64], "{x}", .{&digest}) catch unreachable;
+    out[64] = 0;
+}
+
+test "incremental sha256 matches the one-shot digest" {
+    var state: [128]u8 align(16) = undefined;
+    var buf: [65]u8 = undefined;
+    bb_sha256_init(&state);
+    bb_sha256_update(&state, "a", 1);
+    bb_sha256_update(&state, null, 0);
+    bb_sha256_update(&state, "bc", 2);
+    bb_sha256_final_hex(&state, &buf);
+    try std.testing.expectEqualStrings(
+        "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+        buf[0..64],
+    );
+}
+
+/// MD5 of a buffer into `out` (16 bytes). Legacy .xls "standard" RC4
+/// encryption derives its per-block keys with it ([MS-OFFCRYPTO] 2.3.6.2);
+/// nothing here uses it as a content address.
+export fn bb_md5(data: ?[*]const u8, len: usize, out: [*]u8) void {
+    const slice = if (data) |p| p[0..len] else &[_]u8{};
+    std.crypto.hash.Md5.hash(slice, out[0..std.crypto.hash.Md5.digest_length], .{});
+}
+
+/// SHA-1 of a buffer into `out` (20 bytes), for the CryptoAPI RC4 key
+/// derivation of encrypted .xls ([MS-OFFCRYPTO] 2.3.5.2).
+export fn bb_sha1(data: ?[*]const u8, len: usize, out: [*]u8) void {
+    const slice = if (data) |p| p[0..len] else &[_]u8{};
+    std.crypto.hash.Sha1.hash(slice, out[0..std.crypto.hash.Sha1.digest_length], .{});
+}
+
+test "md5 and sha1 match the known digests for 'abc'" {
+    var md5: [16]u8 = undefined;
+    bb_md5("abc", 3, &md5);
+    try std.testing.expectEqualSlices(u8, &.{ 0x90, 0x01, 0x50, 0x98, 0x3c, 0xd2, 0x4f, 0xb0, 0xd6, 0x96, 0x3f, 0x7d, 0x28, 0xe1, 0x7f, 0x72 }, &md5);
+    var sha1: [20]u8 = undefined;
+    bb_sha1("abc", 3, &sha1);
+    try std.testing.expectEqualSlices(u8, &.{ 0xa9, 0x99, 0x3e, 0x36, 0x47, 0x06, 0x81, 0x6a, 0xba, 0x3e, 0x25, 0x71, 0x78, 0x50, 0xc2, 0x6c, 0x9c, 0xd0, 0xd8, 0x9d }, &sha1);
+}
+
+/// SHA-512 of a buffer into `out` (64 bytes): the hash Office 2013 and later
+/// name in an encrypted OOXML package's EncryptionInfo ([MS-OFFCRYPTO] 2.3.4.11).
+export fn bb_sha512(data: ?[*]const u8, len: usize, out: [*]u8) void {
+    const slice = if (data) |p| p[0..len] else &[_]u8{};
+    std.crypto.hash.sha2.Sha512.hash(slice, out[0..std.crypto.hash.sha2.Sha512.digest_length], .{});
+}
+
+/// AES-decrypt `len` bytes (whole 16-byte blocks) in place: CBC from `iv`, or
+/// ECB when `iv` is null. The key is 16 or 32 bytes; any other size returns
+/// false and leaves `data` alone (the standard library has no AES-192, and
+/// Office does not write it by default).
+export fn bb_aes_decrypt(key: [*]const u8, key_len: usize, iv: ?[*]const u8, data: [*]u8, len: usize) bool {
+    const aes = std.crypto.core.aes;
+    switch (key_len) {
+        16 => aesDecrypt(aes.Aes128, key[0..16].*, iv, data[0 .. len - len % 16]),
+        32 => aesDecrypt(aes.Aes256, key[0..32].*, iv, data[0 .. len - len % 16]),
+        else => return false,
+    }
+    return true;
+}
+
+fn aesDecrypt(comptime Aes: type, key: [Aes.key_bits / 8]u8, iv: ?[*]const u8, data: []u8) void {
+    const ctx = Aes.initDec(key);
+    var prev: [16]u8 = if (iv) |p| p[0..16].* else [_]u8{0} ** 16;
+    var i: usize = 0;
+    while (i < data.len) : (i += 16) {
+        const block = data[i..][0..16];
+        const ct = block.*;
+        ctx.decrypt(block, &ct);
+        if (iv != null) {
+            for (0..16) |k| block[k] ^= prev[k];
+            prev = ct;
+        }
+    }
+}
+
+test "sha512 matches the known digest for 'abc'" {
+    var out: [64]u8 = undefined;
+    bb_sha512("abc", 3, &out);
+    try std.testing.expectEqualSlices(u8, &.{ 0xdd, 0xaf, 0x35, 0xa1, 0x93, 0x61, 0x7a, 0xba }, out[0..8]);
+    try std.testing.expectEqualSlices(u8, &.{ 0x2a, 0x9a, 0xc9, 0x4f, 0xa5, 0x4c, 0xa4, 0x9f }, out[56..64]);
+}
+
+test "aes decrypts the FIPS-197 appendix C vectors" {
+    var key: [32]u8 = undefined;
+    for (&key, 0..) |*b, k| b.* = @intCast(k);
+    var b128 = [_]u8{ 0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a };
+    var b256 = [_]u8{ 0x8e, 0xa2, 0xb7, 0xca, 0x51, 0x67, 0x45, 0xbf, 0xea, 0xfc, 0x49, 0x90, 0x4b, 0x49, 0x60, 0x89 };
+    const plain = [_]u8{ 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff };
+    try std.testing.expect(bb_aes_decrypt(&key, 16, null, &b128, 16));
+    try std.testing.expectEqualSlices(u8, &plain, &b128);
+    try std.testing.expect(bb_aes_decrypt(&key, 32, null, &b256, 16));
+    try std.testing.expectEqualSlices(u8, &plain, &b256);
+    try std.testing.expect(!bb_aes_decrypt(&key, 24, null, &b256, 16));
+}
@@ -0,0 +1,21 @@
+"""Golden projection shared by the spreadsheet checks in test_cross_check.sh.
+
+The bboxes goldens (golden/fixtures__sample_xlsb.bboxes.json,
+golden/fixtures__sample_xls.bboxes.json) keep a subset of each bbox's fields,
+with vdate as an ISO string. rows() reduces a cursor's bboxes to that shape,
+so every reader and every encrypted twin is compared the same way:
+
+    sys.path.insert(0, '$DIR/test')
+    from golden_rows import rows
+    assert rows(cur, golden) == golden
+"""
+
+
+def rows(cur, golden):
+    """cur.bboxes(), each cut to the keys of golden[0], vdate as isoformat() or None."""
+    keys = golden[0].keys()
+    out = []
+    for b in cur.bboxes():
+        b["vdate"] = b["vdate"].isoformat() if b["vdate"] else None
+        out.append({k: b[k] for k in keys})
+    return out
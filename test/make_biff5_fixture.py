@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+"""Authored BIFF5/7 fixture for the golden diff — the 3D-reference lane.
+
+Neither xlwt nor LibreOffice writes BIFF5 with the ExternSheet shapes we need,
+so this lays the Book stream down record by record: BIFF5 BoundSheets (8-bit
+names, no flags byte), one EXTERNSHEET per sheet reference (own-book sheet and
+an encoded external path), a BIFF5 NAME, and formulas using PtgRef3d/PtgArea3d
+(ixals + itabFirst/itabLast), plain BIFF5 PtgRef/PtgArea, PtgStr, PtgName and a
+shared formula. The golden is hand-authored next to it:
+golden/fixtures__biff5_3d.formulas.json / .names.json.
+
+Stdlib only. Writes where run_corpus.py looks for fixtures by default:
+    python3 test/make_biff5_fixture.py [out.xls]
+"""
+import struct, sys
+from pathlib import Path
+
+from ole2_writer import bof, rec, u16, u32, workbook
+
+FIXTURES = Path(__file__).resolve().parent.parent.parent / "xls_biff" / "test"
+
+
+def loc(r, c, row_rel=False, col_rel=False):
+    """BIFF5 cell address: 14-bit row with the relative flags on top, one-byte column."""
+    return u16(r | (0x8000 if row_rel else 0) | (0x4000 if col_rel else 0)) + bytes([c & 0xFF])
+
+
+def ref3d(ixals, t1, t2, r, c, row_rel=False, col_rel=False):
+    return b"\x3A" + u16(ixals) + b"\0" * 8 + u16(t1) + u16(t2) + loc(r, c, row_rel, col_rel)
+
+
+def area3d(ixals, t1, t2, r1, r2, c1, c2):
+    return b"\x3B" + u16(ixals) + b"\0" * 8 + u16(t1) + u16(t2) + u16(r1) + u16(r2) + bytes([c1, c2])
+
+
+def book():
+    sheets = ["Data", "Two", "My Sheet"]
+    glob = [bof(0x0005, 0x0500), rec(0x0022, u16(0))]
+    bs_at = len(glob)
+    glob += [None] * len(sheets)
+    glob.append(rec(0x0016, u16(2)))                                  # EXTERNCOUNT
+    for name in (b"\x03Two", b"\x01\x01C\x03dir\x03[ext.xls]Sheet A"):
+        glob.append(rec(0x0017, bytes([len(name)]) + name))           # EXTERNSHEET: own sheet, external
+    nrg = area3d(-1, 0, 0, 0, 1, 0, 1)                                # MyName = Data!$A$1:$B$2
+    glob.append(rec(0x0018, u16(0) + b"\0" + bytes([6]) + u16(len(nrg)) + u16(0) + u16(0) + b"\0" * 4 + b"MyName" + nrg))
+    glob.append(rec(0x000A, b""))
+
+    def formula(r, c, rgce):
+        return rec(0x0006, u16(r) + u16(c) + u16(0) + struct.pack("<d", 0) + u16(0) + u32(0) + u16(len(rgce)) + rgce)
+    exp = b"\x01" + u16(0) + u16(1)                                   # PtgExp -> anchor B1
+    shr = b"\x2C" + loc(0, -1, True, True) + b"\x1E" + u16(2) + b"\x05"
+    data = [bof(0x0010, 0x0500),
+            formula(0, 0, ref3d(-1, 1, 1, 1, 1)),                                       # Two!$B$2
+            formula(1, 0, area3d(-1, 0, 1, 0, 2, 0, 1) + b"\x22\x01" + u16(4)),         # SUM(Data:Two!$A$1:$B$3)
+            formula(2, 0, ref3d(2, 0, 0, 3, 2)),                                        # [1]'Sheet A'!$C$4
+            formula(3, 0, ref3d(1, 0, 0, 0, 0, True, True)),                            # Two!A1
+            formula(4, 0, b"\x24" + loc(3, 0, True, True) + b"\x1E" + u16(1) + b"\x03"),  # A4+1
+            formula(5, 0, b"\x17\x02ab\x17\x01c\x08"),                                  # "ab"&"c"
+            formula(6, 0, ref3d(-1, 0, 2, 0, 1)),                                       # Data:'My Sheet'!$B$1:$B$1
+            formula(7, 0, b"\x23" + u16(1) + b"\0" * 12 + b"\x25" + u16(0) + u16(9) + bytes([1, 1]) + b"\x10\x15"),   # (MyName,$B$1:$B$10)
+            formula(0, 1, exp),                                                         # B1:B2 shared: A1*2
+            rec(0x04BC, u16(0) + u16(1) + b"\x01\x01" + b"\0\0" + u16(len(shr)) + shr),
+            formula(1, 1, exp),
+            formula(9, 0, b"\x24" + loc(9000, 0) + b"\x24" + loc(5, 3, True) + b"\x03"),  # $A$9001+$D6
+            rec(0x000A, b"")]
+    empty = [bof(0x0010, 0x0500), rec(0x000A, b"")]
+
+    def boundsheet(p, name): return rec(0x0085, u32(p) + b"\0\0" + bytes([len(name)]) + name.encode("latin-1"))
+    glob[bs_at:bs_at + len(sheets)] = [boundsheet(0, s) for s in sheets]   # sized first, lbPlyPos patched below
+    pos, at = [], sum(len(g) for g in glob)
+    for body in (data, empty, empty):
+        pos.append(at)
+        at += sum(len(r) for r in body)
+    glob[bs_at:bs_at + len(sheets)] = [boundsheet(p, s) for p, s in zip(pos, sheets)]
+    return b"".join(glob + data + empty + empty)
+
+
+def main():
+    out = Path(sys.argv[1]) if len(sys.argv) > 1 else FIXTURES / "biff5_3d.xls"
+    out.parent.mkdir(parents=True, exist_ok=True)
+    out.write_bytes(workbook(book(), "Book"))
+    print(f"wrote {out}")
+
+
+if __name__ == "__main__":
+    main()
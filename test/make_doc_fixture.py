@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""Authored Word 97 .doc fixture for the doc reader check in test_cross_check.sh.
+
+Word is not in the test environment, so the WordDocument and 1Table streams
+are laid down by hand ([MS-DOC] 2.5 FIB, 2.8.35 PlcPcd, 2.9.79 PapxFkp):
+
+  piece 1   8-bit text: a paragraph, a 2x2 table (one cell of two paragraphs)
+            whose PAPX carries sprmPChgTabs with cb = 255 in front of
+            sprmPFInTable, so a reader that takes 255 as the operand size
+            skips the table flag and flows the cells; a field, whose code
+            is dropped and result kept; cp1252 quotes
+  piece 2   UTF-16 text: non-ASCII and a surrogate pair, so a paragraph's
+            width is its character count, not its UTF-8 length
+
+Stdlib only. Writes next to the other samples by default:
+    python3 test/make_doc_fixture.py [out_dir]
+"""
+import sys
+from pathlib import Path
+
+from ole2_writer import cfb, u16, u32
+
+OUT = Path(__file__).resolve().parent.parent / "test_data"
+
+
+# (text, mark, paragraph kind): kind is None, "cell" (in a table) or "ttp" (row end)
+PIECE1 = [("Hello world", "\r", None),
+          ("A1", "\x07", "cell"),
+          ("B1 line1", "\r", "cell"),
+          ("B1 line2", "\x07", "cell"),
+          ("", "\x07", "ttp"),
+          ("A2", "\x07", "cell"),
+          ("B2", "\x07", "cell"),
+          ("", "\x07", "ttp"),
+          ('See \x13 HYPERLINK "u" \x14link\x15 end', "\r", None),
+          ("Caf\xe9 \x93q\x94", "\r", None)]
+PIECE2 = [("Ωmega \U0001F600 café", "\r", None),
+          ("last", "\r", None)]
+
+# sprmPChgTabs, cb = 255: one tab deleted (dxaDel, dxaClose), two added (dxaAdd x2, tbd x2)
+CHG_TABS = u16(0xC615) + b"\xff" + b"\x01" + u16(720) + u16(50) + b"\x02" + u16(1440) + u16(2880) + b"\x00\x00"
+GRPPRL = {None: u16(0),
+          "cell": u16(0) + CHG_TABS + u16(0x2416) + b"\x01",
+          "ttp": u16(0) + CHG_TABS + u16(0x2416) + b"\x01" + u16(0x2417) + b"\x01"}
+
+
+def papx_fkp(bounds):
+    """One PapxFkp page: rgfc, one BxPap per run pointing at its PapxInFkp (stored from the end)."""
+    fkp = bytearray(512)
+    rgfc = [s for s, _, _ in bounds] + [bounds[-1][1]]
+    for i, fc in enumerate(rgfc):
+        fkp[4 * i:4 * i + 4] = u32(fc)
+    at, offset = 511, {}
+    for kind, g in GRPPRL.items():
+        cb = (len(g) + 2) // 2                                      # grpprl is 2 * cb - 1 bytes
+        body = bytes([cb]) + g + b"\0" * (2 * cb - 1 - len(g))
+        at = (at - len(body)) & ~1
+        fkp[at:at + len(body)] = body
+        offset[kind] = at // 2
+    bx = 4 * len(rgfc)
+    for i, (_, _, kind) in enumerate(bounds):
+        fkp[bx + 13 * i] = offset[kind]
+    fkp[511] = len(bounds)
+    return bytes(fkp)
+
+
+def word_document():
+    t1 = "".join(a + m for a, m, _ in PIECE1).encode("latin-1")        # 0x93 0x94: cp1252 quotes
+    t2 = "".join(a + m for a, m, _ in PIECE2).encode("utf-16-le")
+    n1, n2 = len(t1), len(t2) // 2
+    text1 = 1024
+    text2 = text1 + n1 + (text1 + n1) % 2
+    fkp_pn = (text2 + len(t2) + 511) // 512
+    wd = bytearray(fkp_pn * 512 + 512)
+    wd[text1:text1 + n1] = t1
+    wd[text2:text2 + len(t2)] = t2
+
+    bounds, fc = [], text1                                          # paragraph fc ranges
+    for a, m, kind in PIECE1:
+        bounds.append((fc, fc + len(a) + 1, kind))
+        fc += len(a) + 1
+    fc = text2
+    for a, m, kind in PIECE2:
+        n = len((a + m).encode("utf-16-le"))
+        bounds.append((fc, fc + n, kind))
+        fc += n
+    wd[fkp_pn * 512:] = papx_fkp(bounds)
+
+    # Table stream: Clx (one Prc, then the Pcdt) and the PlcBtePapx
+    pcds = u16(0) + u32((text1 * 2) | 0x40000000) + u16(0) + u16(0) + u32(text2) + u16(0)
+    plc = u32(0) + u32(n1) + u32(n1 + n2) + pcds
+    clx = b"\x01" + u16(2) + b"\0\0" + b"\x02" + u32(len(plc)) + plc
+    bte = u32(bounds[0][0]) + u32(bounds[-1][1]) + u32(fkp_pn)
+    table = bytes(16) + clx + bte
+    fclcb = [(0, 0)] * 93
+    fclcb[13] = (16 + len(clx), len(bte))                            # PlcBtePapx
+    fclcb[33] = (16, len(clx))                                       # Clx
+
+    # FibBase (fWhichTblStm: 1Table), FibRgW97, FibRgLw97 (ccpText), FibRgFcLcb97
+    fib = u16(0xA5EC) + u16(0x00C1) + u16(0) + u16(0) + u16(0) + u16(0x0200) + bytes(20)
+    fib += u16(14) + bytes(28)
+    lw = [0] * 22
+    lw[3] = n1 + n2
+    fib += u16(22) + b"".join(u32(x) for x in lw)
+    fib += u16(93) + b"".join(u32(a) + u32(b) for a, b in fclcb) + u16(0)
+    assert len(fib) < text1
+    wd[:len(fib)] = fib
+    return bytes(wd), table + bytes(4096 - len(table))
+
+
+def main():
+    out = Path(sys.argv[1]) if len(sys.argv) > 1 else OUT
+    out.mkdir(parents=True, exist_ok=True)
+    wd, table = word_document()
+    (out / "sample.doc").write_bytes(cfb([("WordDocument", wd), ("1Table", table)]))
+    print(f"wrote {out / 'sample.doc'}")
+
+
+if __name__ == "__main__":
+    main()
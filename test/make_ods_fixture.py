@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""Authored .ods fixtures for the ods reader checks in test_cross_check.sh.
+
+LibreOffice is not in the test environment, so content.xml is written by hand
+with the shapes the reader has to get right:
+
+  Data      values of every type (string, float, boolean, date, time), a
+            2x2 span with its covered cells, a value repeated across columns
+            and rows, an OpenFormula with a quoted sheet name and `;`
+            separators, and the padding LibreOffice writes to the sheet edge
+            (1048571 rows x 1024 styled empty cells, 16379 trailing columns)
+            which must not grow the extent or the bbox count.
+  My Sheet  one cell, the page-range target.
+  Third     one cell.
+
+sample_encrypted.ods is the same package with an encryption-data manifest
+entry, which the reader refuses.
+
+Stdlib only. Writes next to the other samples by default:
+    python3 test/make_ods_fixture.py [out_dir]
+"""
+import sys
+import zipfile
+from pathlib import Path
+
+OUT = Path(__file__).resolve().parent.parent / "test_data"
+
+NS = ('xmlns:office="urn:oasis:names:tc:opendocument:xmlns:office:1.0" '
+      'xmlns:table="urn:oasis:names:tc:opendocument:xmlns:table:1.0" '
+      'xmlns:style="urn:oasis:names:tc:opendocument:xmlns:style:1.0" '
+      'xmlns:text="urn:oasis:names:tc:opendocument:xmlns:text:1.0" '
+      'xmlns:of="urn:oasis:names:tc:opendocument:xmlns:of:1.2"')
+
+
+def cell(inner="", **attrs):
+    a = "".join(f' {k.replace("__", ":").replace("_", "-")}="{v}"' for k, v in attrs.items())
+    return f"<table:table-cell{a}>{inner}</table:table-cell>" if inner else f"<table:table-cell{a}/>"
+
+
+def p(text):
+    return f"<text:p>{text}</text:p>"
+
+
+def row(*cells, repeat=0):
+    r = f' table:number-rows-repeated="{repeat}"' if repeat else ""
+    return f"<table:table-row{r}>{''.join(cells)}</table:table-row>"
+
+
+def data_sheet():
+    return "".join([
+        '<table:table table:name="Data">',
+        '<table:table-column table:number-columns-repeated="1024"/>',
+        row(cell(p("hello"), office__value_type="string"),
+            cell(p("1.50"), office__value_type="float", office__value="1.5"),
+            cell(p("TRUE"), office__value_type="boolean", office__boolean_value="true"),
+            cell(p("01/05/24 13:45"), office__value_type="date", office__date_value="2024-01-05T13:45:00"),
+            cell(p("12:30"), office__value_type="time", office__time_value="PT12H30M00S"),
+            cell(table__number_columns_repeated="16379")),
+        row(cell(p("3"), table__formula="of:=[.B1]*2+SUM([.A1:.B2];[$'My Sheet'.$C$4])",
+                 office__value_type="float", office__value="3"),
+            cell(p("merged"), table__number_columns_spanned="2", table__number_rows_spanned="2",
+                 office__value_type="string"),
+            "<table:covered-table-cell/>",
+            cell(p("x"), office__value_type="string")),
+        row(cell(),
+            '<table:covered-table-cell table:number-columns-repeated="2"/>',
+            cell(p("9"), office__value_type="float", office__value="9")),
+        row(cell(p("7"), office__value_type="float", office__value="7", table__number_columns_repeated="3"),
+            repeat=2),
+        row(cell(table__style_name="ce1", table__number_columns_repeated="1024"), repeat=1048571),
+        "</table:table>",
+    ])
+
+
+def content():
+    single = '<table:table table:name="{}">' + row(cell(p("{}"), office__value_type="string")) + "</table:table>"
+    return ('<?xml version="1.0" encoding="UTF-8"?>'
+            f'<office:document-content {NS} office:version="1.3">'
+            '<office:automatic-styles><style:style style:name="ce1" style:family="table-cell"/></office:automatic-styles>'
+            "<office:body><office:spreadsheet>"
+            + data_sheet()
+            + single.format("My Sheet", "second")
+            + single.format("Third", "third")
+            + "</office:spreadsheet></office:body></office:document-content>")
+
+
+def member(name, data, z, method):
+    info = zipfile.ZipInfo(name, date_time=(2024, 1, 1, 0, 0, 0))   # fixed, so reruns are byte-identical
+    info.compress_type = method
+    z.writestr(info, data)
+
+
+def package(path, manifest_extra=""):
+    manifest = ('<?xml version="1.0" encoding="UTF-8"?>'
+                '<manifest:manifest xmlns:manifest="urn:oasis:names:tc:opendocument:xmlns:manifest:1.0">'
+                '<manifest:file-entry manifest:full-path="/" manifest:media-type="application/vnd.oasis.opendocument.spreadsheet"/>'
+                f'<manifest:file-entry manifest:full-path="content.xml" manifest:media-type="text/xml">{manifest_extra}</manifest:file-entry>'
+                "</manifest:manifest>")
+    with zipfile.ZipFile(path, "w") as z:
+        # mimetype first and stored, as ODF requires; detection reads it from the local header
+        member("mimetype", "application/vnd.oasis.opendocument.spreadsheet", z, zipfile.ZIP_STORED)
+        member("content.xml", content(), z, zipfile.ZIP_DEFLATED)
+        member("META-INF/manifest.xml", manifest, z, zipfile.ZIP_DEFLATED)
+
+
+def main():
+    out = Path(sys.argv[1]) if len(sys.argv) > 1 else OUT
+    out.mkdir(parents=True, exist_ok=True)
+    package(out / "sample.ods")
+    package(out / "sample_encrypted.ods",
+            '<manifest:encryption-data manifest:checksum-type="SHA1/1K" manifest:checksum="AAAA">'
+            '<manifest:algorithm manifest:algorithm-name="Blowfish CFB" manifest:initialisation-vector="AAAA"/>'
+            '<manifest:key-derivation manifest:key-derivation-name="PBKDF2" manifest:iteration-count="1024" manifest:salt="AAAA"/>'
+            "</manifest:encryption-data>")
+    print(f"wrote {out / 'sample.ods'}, {out / 'sample_encrypted.ods'}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,179 @@
+#!/usr/bin/env python3
+"""Password-protected OOXML fixtures ([MS-OFFCRYPTO] 2.3.4) for the
+ooxml-encrypted checks in test_cross_check.sh.
+
+Excel is not in the test environment, so the packages are encrypted here, with
+a pure-Python AES: the plaintexts are the workbooks make_xlsb_fixture.py
+writes, so a decrypted read must give golden/fixtures__sample_xlsb.bboxes.json.
+
+  sample_agile.xlsx      Agile: SHA-512 spun 100000 times, AES-256-CBC in
+                         4096-byte segments; password "blobboxes"
+  sample_standard.xlsx   Standard: SHA-1 spun 50000 times, AES-128-ECB;
+                         password "blobboxes"
+  sample_agile.xlsb      Agile over the .xlsb, under the default password
+                         "VelvetSweatshop" (a write-protected workbook), so it
+                         opens without one and has to be told apart from an
+                         xlsx only after decryption
+
+Salts and keys come from a seeded generator, so reruns are byte-identical.
+Each package is an OLE2 container holding EncryptionInfo (in the mini stream)
+and EncryptedPackage.
+
+Stdlib only. Run make_xlsb_fixture.py first; writes next to the other samples
+by default:
+    python3 test/make_ooxml_encrypted_fixture.py [out_dir]
+"""
+import base64
+import hashlib
+import random
+import struct
+import sys
+from pathlib import Path
+
+from ole2_writer import cfb, u16, u32
+
+OUT = Path(__file__).resolve().parent.parent / "test_data"
+PASSWORD = "blobboxes"
+
+
+# ── AES, encryption direction only (FIPS-197) ──
+
+def _sbox():
+    box, p, q = [0] * 256, 1, 1
+    while True:                                   # p walks GF(2^8)* by 3, q by 3^-1
+        p ^= ((p << 1) ^ (0x1B if p & 0x80 else 0)) & 0xFF
+        q ^= q << 1; q ^= q << 2; q ^= q << 4; q &= 0xFF
+        if q & 0x80:
+            q ^= 0x09
+        r = lambda k: ((q << k) | (q >> (8 - k))) & 0xFF
+        box[p] = q ^ r(1) ^ r(2) ^ r(3) ^ r(4) ^ 0x63
+        if p == 1:
+            break
+    box[0] = 0x63
+    return box
+
+
+SBOX = _sbox()
+
+
+def xtime(a): return ((a << 1) ^ 0x1B) & 0xFF if a & 0x80 else a << 1
+
+
+def expand(key):
+    nk = len(key) // 4
+    nr = nk + 6
+    w = [list(key[4 * i:4 * i + 4]) for i in range(nk)]
+    rc = 1
+    for i in range(nk, 4 * (nr + 1)):
+        t = list(w[i - 1])
+        if i % nk == 0:
+            t = [SBOX[b] for b in t[1:] + t[:1]]
+            t[0] ^= rc
+            rc = xtime(rc)
+        elif nk > 6 and i % nk == 4:
+            t = [SBOX[b] for b in t]
+        w.append([a ^ b for a, b in zip(w[i - nk], t)])
+    return [sum(w[4 * r:4 * r + 4], []) for r in range(nr + 1)]
+
+
+def block(rk, b):
+    s = [x ^ k for x, k in zip(b, rk[0])]
+    for r in range(1, len(rk)):
+        s = [SBOX[x] for x in s]
+        s = [s[(i + 4 * (i % 4)) % 16] for i in range(16)]        # ShiftRows, column-major state
+        if r != len(rk) - 1:
+            m = []
+            for c in range(4):
+                a = s[4 * c:4 * c + 4]
+                t = a[0] ^ a[1] ^ a[2] ^ a[3]
+                m += [a[i] ^ t ^ xtime(a[i] ^ a[(i + 1) % 4]) for i in range(4)]
+            s = m
+        s = [x ^ k for x, k in zip(s, rk[r])]
+    return bytes(s)
+
+
+assert block(expand(bytes(range(16))), bytes.fromhex("00112233445566778899aabbccddeeff")).hex() == "69c4e0d86a7b0430d8cdb78070b4c55a"
+assert block(expand(bytes(range(32))), bytes.fromhex("00112233445566778899aabbccddeeff")).hex() == "8ea2b7ca516745bfeafc49904b496089"
+
+
+def pad16(d): return d + b"\0" * (-len(d) % 16)
+
+
+def ecb(key, d):
+    rk, d = expand(key), pad16(d)
+    return b"".join(block(rk, d[i:i + 16]) for i in range(0, len(d), 16))
+
+
+def cbc(key, iv, d):
+    rk, d, out = expand(key), pad16(d), b""
+    for i in range(0, len(d), 16):
+        iv = block(rk, bytes(a ^ b for a, b in zip(d[i:i + 16], iv)))
+        out += iv
+    return out
+
+
+# ── [MS-OFFCRYPTO] encryptors ──
+
+def fit(b, n): return b[:n] + b"\x36" * (n - len(b))
+
+
+def agile(plain, pw, rnd, spin=100000):
+    """2.3.4.10-2.3.4.15: SHA-512, AES-256, the package key wrapped under the password key."""
+    H = lambda d: hashlib.sha512(d).digest()
+    ksalt, psalt, secret, vin = (rnd.randbytes(n) for n in (16, 16, 32, 16))
+    h = H(psalt + pw.encode("utf-16-le"))
+    for i in range(spin):
+        h = H(u32(i) + h)
+    wrap = lambda blk, data: cbc(fit(H(h + bytes.fromhex(blk)), 32), psalt, data)
+    data = b"".join(cbc(secret, fit(H(ksalt + u32(i // 4096)), 16), plain[i:i + 4096])
+                    for i in range(0, len(plain), 4096))
+    b64 = lambda b: base64.b64encode(b).decode()
+    common = 'saltSize="16" blockSize="16" keyBits="256" hashSize="64" cipherAlgorithm="AES" ' \
+             'cipherChaining="ChainingModeCBC" hashAlgorithm="SHA512"'
+    xml = ('<?xml version="1.0" encoding="UTF-8" standalone="yes"?>\r\n'
+           '<encryption xmlns="http://schemas.microsoft.com/office/2006/encryption" '
+           'xmlns:p="http://schemas.microsoft.com/office/2006/keyEncryptor/password">'
+           f'<keyData {common} saltValue="{b64(ksalt)}"/>'
+           '<dataIntegrity encryptedHmacKey="" encryptedHmacValue=""/>'
+           '<keyEncryptors><keyEncryptor uri="http://schemas.microsoft.com/office/2006/keyEncryptor/password">'
+           f'<p:encryptedKey spinCount="{spin}" {common} saltValue="{b64(psalt)}" '
+           f'encryptedVerifierHashInput="{b64(wrap("fea7d2763b4b9e79", vin))}" '
+           f'encryptedVerifierHashValue="{b64(wrap("d7aa0f6d3061344e", H(vin)))}" '
+           f'encryptedKeyValue="{b64(wrap("146e0be7abacd0d6", secret))}"/>'
+           "</keyEncryptor></keyEncryptors></encryption>")
+    return u16(4) + u16(4) + u32(0x40) + xml.encode(), struct.pack("<Q", len(plain)) + data
+
+
+def standard(plain, pw, rnd):
+    """2.3.4.5-2.3.4.9: SHA-1 spun 50000 times, CryptDeriveKey, AES-128-ECB."""
+    H = lambda d: hashlib.sha1(d).digest()
+    salt, verifier = rnd.randbytes(16), rnd.randbytes(16)
+    h = H(salt + pw.encode("utf-16-le"))
+    for i in range(50000):
+        h = H(u32(i) + h)
+    h = H(h + u32(0)) + bytes(44)
+    key = (H(bytes(a ^ 0x36 for a in h)) + H(bytes(a ^ 0x5C for a in h)))[:16]
+    csp = "Microsoft Enhanced RSA and AES Cryptographic Provider\0".encode("utf-16-le")
+    header = u32(0x24) + u32(0) + u32(0x660E) + u32(0x8004) + u32(128) + u32(0x18) + u32(0) + u32(0) + csp
+    ver = u32(16) + salt + ecb(key, verifier) + u32(20) + ecb(key, H(verifier) + bytes(12))
+    info = u16(4) + u16(2) + u32(0x24) + u32(len(header)) + header + ver
+    return info, struct.pack("<Q", len(plain)) + ecb(key, plain)
+
+
+def package(info_and_data):
+    info, data = info_and_data
+    return cfb([("EncryptionInfo", info), ("EncryptedPackage", data)])
+
+
+def main():
+    out = Path(sys.argv[1]) if len(sys.argv) > 1 else OUT
+    xlsx, xlsb = (out / "sample_xlsb.xlsx").read_bytes(), (out / "sample.xlsb").read_bytes()
+    rnd = random.Random(48)
+    (out / "sample_agile.xlsx").write_bytes(package(agile(xlsx, PASSWORD, rnd)))
+    (out / "sample_standard.xlsx").write_bytes(package(standard(xlsx, PASSWORD, rnd)))
+    (out / "sample_agile.xlsb").write_bytes(package(agile(xlsb, "VelvetSweatshop", rnd)))
+    print(f"wrote {out / 'sample_agile.xlsx'}, {out / 'sample_standard.xlsx'}, {out / 'sample_agile.xlsb'}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+"""One-page PDF for the ruling-line check in test_cross_check.sh.
+
+A small ruled table, one path per case the rule walk distinguishes:
+
+    a stroked horizontal segment             -> hline
+    a stroked vertical segment               -> vline
+    a stroked rectangle                      -> rect
+    a filled 200 x 1 pt rectangle            -> hline (thinner than kThinRule)
+    a vertical segment inside a form XObject,
+      placed with a translating cm           -> vline at the composed position
+
+plus one text run, so the object-level reader sees a text object beside the
+paths. RULES lists what bboxes_next_rule must report, in page order, in the
+bbox space (points, top-left origin of the 612 x 792 page).
+
+Stdlib only. The check builds it in memory; to write it out for inspection:
+    python3 test/make_pdf_rules_fixture.py [out.pdf]
+"""
+import sys
+
+HEIGHT = 792
+
+CONTENT = b"""BT /F1 10 Tf 80 700 Td (cell) Tj ET
+0 0 1 RG 1 w 72 720 m 272 720 l S
+1 0 0 RG 2 w 72 620 m 72 720 l S
+0 G 0.5 w 300 620 100 50 re S
+0 g 72 600 200 1 re f
+q 1 0 0 1 100 0 cm /Fm1 Do Q
+"""
+
+FORM = b"0 G 1 w 50 500 m 50 550 l S\n"
+
+# (kind, x, y, w, h, line_width, color)
+RULES = [
+    ("hline", 72, HEIGHT - 720, 200, 0, 1, "rgba(0,0,255,255)"),
+    ("vline", 72, HEIGHT - 720, 0, 100, 2, "rgba(255,0,0,255)"),
+    ("rect", 300, HEIGHT - 670, 100, 50, 0.5, "rgba(0,0,0,255)"),
+    ("hline", 72, HEIGHT - 600.5, 200, 0, 1, "rgba(0,0,0,255)"),
+    ("vline", 150, HEIGHT - 550, 0, 50, 1, "rgba(0,0,0,255)"),
+]
+
+
+def build():
+    objs = [b"<< /Type /Catalog /Pages 2 0 R >>",
+            b"<< /Type /Pages /Kids [3 0 R] /Count 1 >>",
+            b"<< /Type /Page /Parent 2 0 R /MediaBox [0 0 612 %d] "
+            b"/Resources << /Font << /F1 4 0 R >> /XObject << /Fm1 6 0 R >> >> /Contents 5 0 R >>" % HEIGHT,
+            b"<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>",
+            b"<< /Length %d >>\nstream\n%sendstream" % (len(CONTENT), CONTENT),
+            b"<< /Type /XObject /Subtype /Form /BBox [0 0 612 %d] /Length %d >>\nstream\n%sendstream"
+            % (HEIGHT, len(FORM), FORM)]
+    out = bytearray(b"%PDF-1.4\n")
+    offsets = []
+    for n, body in enumerate(objs, 1):
+        offsets.append(len(out))
+        out += b"%d 0 obj\n%s\nendobj\n" % (n, body)
+    xref = len(out)
+    out += b"xref\n0 %d\n0000000000 65535 f \n" % (len(objs) + 1)
+    out += b"".join(b"%010d 00000 n \n" % o for o in offsets)
+    out += b"trailer\n<< /Size %d /Root 1 0 R >>\nstartxref\n%d\n%%%%EOF\n" % (len(objs) + 1, xref)
+    return bytes(out)
+
+
+def main():
+    out = sys.argv[1] if len(sys.argv) > 1 else "rules.pdf"
+    with open(out, "wb") as f:
+        f.write(build())
+    print(f"wrote {out}")
+
+
+if __name__ == "__main__":
+    main()
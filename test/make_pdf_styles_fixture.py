@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+"""One-page PDF for the object-level style check in test_cross_check.sh.
+
+Two font resources name the same base font, Helvetica; the second's
+FontDescriptor sets ForceBold and FontWeight 700. They resolve to one font id
+(the family) with different weights, so a per-page style memo keyed on the
+font id alone hands the bold runs the regular style, or the other way round.
+Text objects alternate regular / bold, with one regular run a quarter point
+larger, and every run's text names the style it must get:
+
+    "regular 12", "bold 12", "regular 12.25", ...
+
+Stdlib only. The check builds it in memory; to write it out for inspection:
+    python3 test/make_pdf_styles_fixture.py [out.pdf]
+"""
+import sys
+
+RUNS = [("F1", 12, "regular 12"), ("F2", 12, "bold 12"), ("F1", 12.25, "regular 12.25"),
+        ("F2", 12, "bold 12 again"), ("F1", 12, "regular 12 again")]
+
+
+def build():
+    content = b"".join(b"BT /%s %g Tf 72 %d Td (%s) Tj ET\n" % (f.encode(), size, 720 - 24 * i, text.encode())
+                       for i, (f, size, text) in enumerate(RUNS))
+    objs = [b"<< /Type /Catalog /Pages 2 0 R >>",
+            b"<< /Type /Pages /Kids [3 0 R] /Count 1 >>",
+            b"<< /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792] "
+            b"/Resources << /Font << /F1 4 0 R /F2 5 0 R >> >> /Contents 7 0 R >>",
+            b"<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>",
+            b"<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica /FontDescriptor 6 0 R >>",
+            b"<< /Type /FontDescriptor /FontName /Helvetica /Flags 262176 /FontWeight 700 "
+            b"/FontBBox [-166 -225 1000 931] /ItalicAngle 0 /Ascent 718 /Descent -207 /CapHeight 718 /StemV 140 >>",
+            b"<< /Length %d >>\nstream\n%sendstream" % (len(content), content)]
+    out = bytearray(b"%PDF-1.4\n")
+    offsets = []
+    for n, body in enumerate(objs, 1):
+        offsets.append(len(out))
+        out += b"%d 0 obj\n%s\nendobj\n" % (n, body)
+    xref = len(out)
+    out += b"xref\n0 %d\n0000000000 65535 f \n" % (len(objs) + 1)
+    out += b"".join(b"%010d 00000 n \n" % o for o in offsets)
+    out += b"trailer\n<< /Size %d /Root 1 0 R >>\nstartxref\n%d\n%%%%EOF\n" % (len(objs) + 1, xref)
+    return bytes(out)
+
+
+def main():
+    out = sys.argv[1] if len(sys.argv) > 1 else "styles.pdf"
+    with open(out, "wb") as f:
+        f.write(build())
+    print(f"wrote {out}")
+
+
+if __name__ == "__main__":
+    main()
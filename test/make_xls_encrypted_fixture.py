@@ -0,0 +1,242 @@
+#!/usr/bin/env python3
+"""Encrypted BIFF8 fixtures ([MS-XLS] 2.4.117 FILEPASS, [MS-OFFCRYPTO] 2.3.6,
+2.3.5, 2.3.7) for the xls checks in test_cross_check.sh.
+
+Excel is not in the test environment, so one workbook is laid down record by
+record and encrypted here:
+
+  sample.xls                 plain
+  sample_rc4.xls             RC4 (MD5), default password "VelvetSweatshop"
+  sample_rc4_pw.xls          RC4 (MD5), password "blobboxes"
+  sample_cryptoapi.xls       RC4 CryptoAPI (SHA-1, 128-bit), default password
+  sample_cryptoapi_pw.xls    RC4 CryptoAPI (SHA-1, 128-bit), password "blobboxes"
+  sample_xor.xls             XOR obfuscation (method 1), default password
+  sample_xor_pw.xls          XOR obfuscation (method 1), password "blobboxes"
+
+Every decrypted read must give golden/fixtures__sample_xls.bboxes.json. The
+workbook has the records decryption gets wrong first: an SST string split by a
+CONTINUE and switching to UTF-16 across it, BoundSheet8 (lbPlyPos stays in the
+clear), a shared formula, a formula with a string result, and a defined name
+over a 3D area. The second sheet sits past the first 1024-byte block, so the
+RC4 readers must re-key; XOR obfuscation instead keys every byte off its
+stream offset plus its record's length.
+
+Salts come from a seeded generator, so reruns are byte-identical.
+
+Stdlib only. Writes next to the other samples by default:
+    python3 test/make_xls_encrypted_fixture.py [out_dir]
+"""
+import hashlib
+import random
+import struct
+import sys
+from pathlib import Path
+
+from ole2_writer import bof, rec, u16, u32, workbook
+
+OUT = Path(__file__).resolve().parent.parent / "test_data"
+PASSWORD = "blobboxes"
+
+
+def cell(r, c, xf=0): return u16(r) + u16(c) + u16(xf)
+def rk_int(v): return (v << 2) | 2
+
+
+def xlstr(s):                                     # XLUnicodeString, 8-bit
+    return u16(len(s)) + b"\0" + s.encode("latin-1")
+
+
+def globals_records(filepass):
+    font = lambda name, h=200, grbit=0, icv=0x7FFF, bls=400: rec(
+        0x0031, u16(h) + u16(grbit) + u16(icv) + u16(bls) + u16(0) + b"\0" * 4 + bytes([len(name)]) + b"\0" + name.encode())
+    xf = lambda ifnt, ifmt: rec(0x00E0, u16(ifnt) + u16(ifmt) + b"\0" * 16)
+    glob = [bof(0x0005)]
+    if filepass:
+        glob.append(rec(0x002F, filepass))
+    glob.append(rec(0x0022, u16(0)))                                  # DATEMODE: 1900
+    glob += [font("Arial")] * 4 + [font("Calibri", 240, 0x0002, 10, 700)]   # ifnt 5 (4 is skipped)
+    glob.append(rec(0x041E, u16(164) + xlstr("yyyy-mm-dd")))
+    glob += [xf(0, 0)] * 15 + [xf(5, 0), xf(0, 164)]                  # 15: bold italic Calibri, 16: date
+    return glob
+
+
+def tail_records():
+    # SST: the third string's characters go on in a CONTINUE, which switches to UTF-16
+    sst = u32(3) + u32(3) + xlstr("Hello") + u16(2) + b"\x08" + u16(1) + b"Hi" + u32(0) + u16(6) + b"\0" + b"abc"
+    total = b"\x3B" + u16(0) + u16(1) + u16(3) + u16(0) + u16(0)      # PtgArea3d Data!$A$2:$A$4
+    return [rec(0x01AE, u16(2) + u16(0x0401)),                        # SupBook: this workbook
+            rec(0x0017, u16(1) + u16(0) + u16(0) + u16(0)),           # ExternSheet: one XTI, sheet 0
+            rec(0x0018, u16(0) + b"\0" + bytes([5]) + u16(len(total)) + u16(0) + u16(0) + b"\0" * 4
+                + b"\0" + b"Total" + total),
+            rec(0x00FC, sst), rec(0x003C, b"\x01" + "déf".encode("utf-16-le")),
+            rec(0x000A, b"")]
+
+
+def data_sheet():
+    sh = [bof(0x0010), rec(0x0200, u32(0) + u32(22) + u16(0) + u16(6) + u16(0))]     # DIMENSIONS
+    sh.append(rec(0x00FD, cell(0, 0, 15) + u32(0)))                   # A1 Hello (styled)
+    sh.append(rec(0x00FD, cell(0, 1) + u32(1)))                       # B1 Hi
+    sh.append(rec(0x00FD, cell(0, 2) + u32(2)))                       # C1 abcdéf
+    sh.append(rec(0x0203, cell(1, 0) + struct.pack("<d", 1.5)))       # A2 1.5
+    sh.append(rec(0x027E, cell(1, 1, 16) + u32(rk_int(45000))))       # B2 date
+    sh.append(rec(0x00BD, u16(2) + u16(0) + u16(0) + u32(rk_int(7)) + u16(0) + u32(rk_int(8) | 1) + u16(1)))  # A3 7, B3 0.08
+    sh.append(rec(0x0205, cell(3, 0) + b"\x01\x00"))                  # A4 TRUE
+    sh.append(rec(0x0205, cell(3, 1) + b"\x07\x01"))                  # B4 #DIV/0!
+    a2 = b"\x24" + u16(1) + u16(0xC000) + b"\x1E" + u16(1) + b"\x03"  # A5 = A2+1
+    sh.append(rec(0x0006, cell(4, 0) + struct.pack("<d", 2.5) + u16(0) + u32(0) + u16(len(a2)) + a2))
+    xy = b"\x17\x01\x00x" + b"\x17\x01\x00y" + b"\x08"                # B5 = "x"&"y", string result
+    sh.append(rec(0x0006, cell(4, 1) + b"\0" * 6 + b"\xff\xff" + u16(0) + u32(0) + u16(len(xy)) + xy))
+    sh.append(rec(0x0207, xlstr("xy")))
+    exp = b"\x01" + u16(5) + u16(0)                                   # A6:A7 shared: A5*2
+    shr = b"\x2C" + u16(0xFFFF) + u16(0xC000) + b"\x1E" + u16(2) + b"\x05"
+    sh.append(rec(0x0006, cell(5, 0) + struct.pack("<d", 5.0) + u16(8) + u32(0) + u16(len(exp)) + exp))
+    sh.append(rec(0x04BC, u16(5) + u16(6) + b"\0\0" + b"\0" + b"\x02" + u16(len(shr)) + shr))
+    sh.append(rec(0x0006, cell(6, 0) + struct.pack("<d", 10.0) + u16(8) + u32(0) + u16(len(exp)) + exp))
+    sh.append(rec(0x0204, cell(0, 3) + xlstr("Merged")))              # D1:E2 merged,
+    sh.append(rec(0x0204, cell(1, 4) + xlstr("covered")))             # with a value under it
+    sh += [rec(0x0203, cell(10 + i // 4, i % 4) + struct.pack("<d", i * 0.25)) for i in range(48)]   # past block 0
+    sh.append(rec(0x00E5, u16(1) + u16(0) + u16(1) + u16(3) + u16(4)))
+    sh.append(rec(0x000A, b""))
+    return sh
+
+
+def second_sheet():
+    return [bof(0x0010), rec(0x0200, u32(0) + u32(1) + u16(0) + u16(1) + u16(0)),
+            rec(0x0203, cell(0, 0) + struct.pack("<d", 42.0)), rec(0x000A, b"")]
+
+
+def book(filepass=b""):
+    names, sheets = ["Data", "Two"], [data_sheet(), second_sheet()]
+    boundsheet = lambda p, nm: rec(0x0085, u32(p) + b"\0\0" + bytes([len(nm)]) + b"\0" + nm.encode())
+    head, tail = globals_records(filepass), tail_records()
+    at = sum(len(r) for r in head + tail) + sum(len(boundsheet(0, nm)) for nm in names)
+    pos = []
+    for sh in sheets:
+        pos.append(at)
+        at += sum(len(r) for r in sh)
+    glob = head + [boundsheet(p, nm) for p, nm in zip(pos, names)] + tail
+    return b"".join(glob + sum(sheets, []))
+
+
+# ── encryption ──
+
+def rc4(key, data):
+    S, j = list(range(256)), 0
+    for i in range(256):
+        j = (j + S[i] + key[i % len(key)]) & 255
+        S[i], S[j] = S[j], S[i]
+    i = j = 0
+    out = bytearray()
+    for c in data:
+        i = (i + 1) & 255
+        j = (j + S[i]) & 255
+        S[i], S[j] = S[j], S[i]
+        out.append(c ^ S[(S[i] + S[j]) & 255])
+    return bytes(out)
+
+
+CLEAR = {0x0809, 0x002F, 0x0194, 0x0195, 0x00E1, 0x0196, 0x0138}   # BOF FILEPASS UsrExcl FileLock InterfaceHdr RRDInfo RRDHead
+
+
+def encrypt(stream, crypt):
+    """Record bodies passed byte by byte through crypt(offset, record_length, byte);
+    headers, the CLEAR records and BoundSheet8.lbPlyPos stay plain."""
+    s, o = bytearray(stream), 0
+    while o + 4 <= len(s):
+        t, n = struct.unpack_from("<HH", s, o)
+        if t not in CLEAR:
+            for p in range(o + 4 + (4 if t == 0x0085 else 0), o + 4 + n):
+                s[p] = crypt(p, n, s[p])
+        o += 4 + n
+    return bytes(s)
+
+
+def rc4_stream(block_key):
+    """XOR with the RC4 keystream at the byte's stream offset, re-keyed every 1024 bytes."""
+    blocks = {}
+
+    def crypt(p, n, c):
+        b = p // 1024
+        if b not in blocks:
+            blocks[b] = rc4(block_key(b), bytes(1024))
+        return c ^ blocks[b][p % 1024]
+    return crypt
+
+
+def rc4_md5(pw, rnd):
+    """2.3.6: MD5 of the password, then of (5 bytes + salt) x 16; FILEPASS version 1.1."""
+    salt, verifier = rnd.randbytes(16), rnd.randbytes(16)
+    h0 = hashlib.md5(pw.encode("utf-16-le")).digest()
+    h1 = hashlib.md5((h0[:5] + salt) * 16).digest()
+    key = lambda b: hashlib.md5(h1[:5] + u32(b)).digest()
+    ver = rc4(key(0), verifier + hashlib.md5(verifier).digest())
+    return u16(1) + u16(1) + u16(1) + salt + ver, rc4_stream(key)
+
+
+def rc4_cryptoapi(pw, rnd):
+    """2.3.5: SHA-1 of salt + password, one key per block, 128-bit; FILEPASS version 4.2."""
+    salt, verifier = rnd.randbytes(16), rnd.randbytes(16)
+    h0 = hashlib.sha1(salt + pw.encode("utf-16-le")).digest()
+    key = lambda b: hashlib.sha1(h0 + u32(b)).digest()[:16]
+    ver = rc4(key(0), verifier + hashlib.sha1(verifier).digest())
+    csp = "Microsoft Enhanced Cryptographic Provider v1.0\0".encode("utf-16-le")
+    header = u32(0x04) + u32(0) + u32(0x6801) + u32(0x8004) + u32(128) + u32(1) + u32(0) + u32(0) + csp
+    return (u16(1) + u16(4) + u16(2) + u32(0x04) + u32(len(header)) + header
+            + u32(16) + salt + ver[:16] + u32(20) + ver[16:]), rc4_stream(key)
+
+
+XOR_INITIAL = [0xE1F0, 0x1D0F, 0xCC9C, 0x84C0, 0x110C, 0x0E10, 0xF1CE, 0x313E,
+               0x1872, 0xE139, 0xD40F, 0x84F9, 0x280C, 0xA96A, 0x4EC3]
+XOR_MATRIX = [0xAEFC, 0x4DD9, 0x9BB2, 0x2745, 0x4E8A, 0x9D14, 0x2A09, 0x7B61, 0xF6C2, 0xFDA5, 0xEB6B,
+              0xC6F7, 0x9DCF, 0x2BBF, 0x4563, 0x8AC6, 0x05AD, 0x0B5A, 0x16B4, 0x2D68, 0x5AD0, 0x0375,
+              0x06EA, 0x0DD4, 0x1BA8, 0x3750, 0x6EA0, 0xDD40, 0xD849, 0xA0B3, 0x5147, 0xA28E, 0x553D,
+              0xAA7A, 0x44D5, 0x6F45, 0xDE8A, 0xAD35, 0x4A4B, 0x9496, 0x390D, 0x721A, 0xEB23, 0xC667,
+              0x9CEF, 0x29FF, 0x53FE, 0xA7FC, 0x5FD9, 0x47D3, 0x8FA6, 0x0F6D, 0x1EDA, 0x3DB4, 0x7B68,
+              0xF6D0, 0xB861, 0x60E3, 0xC1C6, 0x93AD, 0x377B, 0x6EF6, 0xDDEC, 0x45A0, 0x8B40, 0x06A1,
+              0x0D42, 0x1A84, 0x3508, 0x6A10, 0xAA51, 0x4483, 0x8906, 0x022D, 0x045A, 0x08B4, 0x1168,
+              0x76B4, 0xED68, 0xCAF1, 0x85C3, 0x1BA7, 0x374E, 0x6E9C, 0x3730, 0x6E60, 0xDCC0, 0xA9A1,
+              0x4363, 0x86C6, 0x1DAD, 0x3331, 0x6662, 0xCCC4, 0x89A9, 0x0373, 0x06E6, 0x0DCC, 0x1021,
+              0x2042, 0x4084, 0x8108, 0x1231, 0x2462, 0x48C4]
+XOR_PAD = [0xBB, 0xFF, 0xFF, 0xBA, 0xFF, 0xFF, 0xB9, 0x80, 0x00, 0xBE, 0x0F, 0x00, 0xBF, 0x0F, 0x00]
+
+
+def xor_obfuscation(pw, rnd):
+    """2.3.7.1-2.3.7.4: key and verifier from the 8-bit password (at most 15 characters), a
+    16-byte array from both; each byte is XORed with the array at (offset + record length)
+    mod 16, then rotated right by 3. FILEPASS wEncryptionType 0."""
+    b = pw.encode("latin-1")[:15]
+    key, element = XOR_INITIAL[len(b) - 1], len(XOR_MATRIX) - 1
+    for c in reversed(b):
+        for _ in range(7):
+            if c & 0x40:
+                key ^= XOR_MATRIX[element]
+            c, element = c << 1, element - 1
+    verifier = 0
+    for c in reversed(bytes([len(b)]) + b):
+        verifier = (((verifier >> 14) & 1) | ((verifier << 1) & 0x7FFF)) ^ c
+    arr = [(b + bytes(XOR_PAD))[k] ^ (key >> 8 if k & 1 else key & 0xFF) for k in range(16)]
+    arr = [((c << 2) | (c >> 6)) & 0xFF for c in arr]
+
+    def crypt(p, n, c):
+        c ^= arr[(p + n) & 15]
+        return ((c >> 3) | (c << 5)) & 0xFF
+    return u16(0) + u16(key) + u16(verifier ^ 0xCE4B), crypt
+
+
+def main():
+    out = Path(sys.argv[1]) if len(sys.argv) > 1 else OUT
+    out.mkdir(parents=True, exist_ok=True)
+    rnd = random.Random(47)
+    (out / "sample.xls").write_bytes(workbook(book()))
+    written = ["sample.xls"]
+    for scheme, tag in ((rc4_md5, "rc4"), (rc4_cryptoapi, "cryptoapi"), (xor_obfuscation, "xor")):
+        for pw, suffix in (("VelvetSweatshop", ""), (PASSWORD, "_pw")):
+            filepass, crypt = scheme(pw, rnd)
+            name = f"sample_{tag}{suffix}.xls"
+            (out / name).write_bytes(workbook(encrypt(book(filepass), crypt)))
+            written.append(name)
+    print("wrote " + ", ".join(str(out / n) for n in written))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+"""Randomized BIFF8 formula workbooks for the formula-renderer regression in
+test_cross_check.sh.
+
+Each seed lays down one workbook of three sheets, 40 FORMULA records a sheet,
+whose rgce are random well-formed token trees (operators, functions, 2D and 3D
+references, constants, attributes) with about one in ten replaced by random
+bytes. A few cells join shared formulas, with the SHRFMLA after the anchor, after
+a member, or missing altogether, and two NAME records carry random rgce too.
+
+golden/fixtures__xls_fuzz.sha256.json holds, per seed, the SHA-256 of the
+bboxes_xls_formulas_json and bboxes_xls_names_json output of the two-pass
+renderer the one-pass walk replaced (the output itself runs to megabytes); the
+check regenerates the workbooks in memory and compares.
+
+Stdlib only. The check builds them in memory; to write them out for inspection:
+    python3 test/make_xls_fuzz_fixture.py out_dir [seeds]
+"""
+import random
+import struct
+import sys
+from pathlib import Path
+
+from ole2_writer import bof, rec, u16, u32, workbook
+
+SEEDS = 32
+
+
+def expr(rng, depth=0):
+    """One operand's worth of rgce: a leaf token, or an operator / function over sub-trees."""
+    if depth > 4 or rng.random() < 0.35:
+        k = rng.randrange(12)
+        if k == 0: return b"\x1E" + u16(rng.randrange(65536))                                 # PtgInt
+        if k == 1: return b"\x1F" + struct.pack("<d", rng.choice([0.5, 1e20, -3.25, 1 / 3]))  # PtgNum
+        if k == 2:                                                                             # PtgStr
+            s = rng.choice(["a", "hello world", ""])
+            return b"\x17" + bytes([len(s), 0]) + s.encode()
+        if k == 3:                                                                             # PtgRef
+            return (bytes([rng.choice([0x24, 0x44, 0x64])]) + u16(rng.randrange(200))
+                    + u16(rng.randrange(50) | rng.choice([0, 0x4000, 0x8000, 0xC000])))
+        if k == 4:                                                                             # PtgArea
+            return (bytes([rng.choice([0x25, 0x45])]) + u16(rng.randrange(100)) + u16(rng.randrange(100, 300))
+                    + u16(rng.randrange(20) | 0xC000) + u16(rng.randrange(20, 40)))
+        if k == 5: return b"\x1D" + bytes([rng.randrange(2)])                                 # PtgBool
+        if k == 6: return b"\x1C" + bytes([rng.choice([0x17, 0x07, 0x0F, 0x1D, 0x24, 0x2A])])  # PtgErr
+        if k == 7: return b"\x16"                                                              # PtgMissArg
+        if k == 8: return b"\x23" + u32(rng.randrange(0, 4))                                  # PtgName
+        if k == 9:                                                                             # PtgRef3d
+            return b"\x3A" + u16(rng.randrange(4)) + u16(rng.randrange(100)) + u16(rng.randrange(10) | 0xC000)
+        if k == 10: return b"\x3B" + u16(rng.randrange(4)) + u16(1) + u16(9) + u16(2) + u16(5 | 0x4000)   # PtgArea3d
+        return b"\x2C" + u16(rng.randrange(65536)) + u16(rng.randrange(256) | 0xC000)          # PtgRefN
+    k = rng.randrange(6)
+    if k <= 1:                                                                                 # binary operator
+        return expr(rng, depth + 1) + expr(rng, depth + 1) + bytes([rng.randrange(0x03, 0x12)])
+    if k == 2:                                                                                 # unary / paren / %
+        return expr(rng, depth + 1) + bytes([rng.randrange(0x12, 0x16)])
+    if k == 3:                                                                                 # PtgFuncVar
+        n = rng.randrange(0, 4)
+        return b"".join(expr(rng, depth + 1) for _ in range(n)) + b"\x42" + bytes([n]) + u16(rng.choice([4, 1, 100, 999, 336]))
+    if k == 4:                                                                                 # PtgFunc, argc sometimes short
+        f = rng.choice([27, 39, 31, 19, 24, 119, 500])
+        n = {27: 2, 39: 2, 31: 3, 19: 0, 24: 1, 119: 4}.get(f, 1)
+        return b"".join(expr(rng, depth + 1) for _ in range(rng.choice([n, n, max(0, n - 1)]))) + b"\x41" + u16(f)
+    return expr(rng, depth + 1) + b"\x19\x10\x00\x00"                                          # PtgAttrSum
+
+
+def formula(r, c, rgce):
+    return rec(0x0006, u16(r) + u16(c) + u16(0) + struct.pack("<d", 1.0) + u16(0) + u32(0) + u16(len(rgce)) + rgce)
+
+
+def sheet(rng, si):
+    """40 formulas down column si. Rows 10-13 are a shared formula in record order; rows
+    21 and 22 come before their anchor, row 20, and its SHRFMLA; rows 30-31 point at
+    a base that never comes."""
+    exp = lambda r: b"\x01" + u16(r) + u16(si)
+    shr = lambda r1, r2, rgce: rec(0x04BC, u16(r1) + u16(r2) + bytes([si, si]) + b"\0" + bytes([r2 - r1 + 1])
+                                   + u16(len(rgce)) + rgce)
+    recs = [bof(0x0010)]
+    for r in range(40):
+        if 10 <= r <= 13 or 20 <= r <= 23:
+            if r in (10, 20):
+                continue
+            if r in (11, 23):                          # the anchor and its base, then this member
+                anchor = r - 1 if r == 11 else 20
+                recs += [formula(anchor, si, exp(anchor)), shr(anchor, anchor + 3, expr(rng))]
+            recs.append(formula(r, si, exp(10 if r < 20 else 20)))
+            continue
+        if r in (30, 31):
+            recs.append(formula(r, si, exp(30)))
+            continue
+        rgce = expr(rng)
+        if rng.random() < 0.1:
+            rgce = bytes(rng.randrange(256) for _ in range(rng.randrange(1, 12)))
+        recs.append(formula(r, si, rgce))
+    recs.append(rec(0x000A, b""))
+    return b"".join(recs)
+
+
+def build(seed):
+    rng = random.Random(seed)
+    names = ["Data", "My Sheet", "Two"]
+    boundsheet = lambda p, nm: rec(0x0085, u32(p) + b"\0\0" + bytes([len(nm)]) + b"\0" + nm.encode())
+    head = [bof(0x0005)] + [rec(0x00E0, u16(0) + u16(0) + b"\0" * 16)] * 15
+    tail = [rec(0x01AE, u16(3) + u16(0x0401)),                                     # SupBook: this workbook
+            rec(0x0017, u16(3) + u16(0) + u16(0) + u16(0) + u16(0) + u16(1) + u16(1) + u16(0) + u16(0) + u16(2))]
+    for nm in ("Alpha", "Beta"):
+        rgce = expr(rng)
+        tail.append(rec(0x0018, u16(0) + b"\0" + bytes([len(nm)]) + u16(len(rgce)) + u16(0) + u16(0) + b"\0" * 4
+                        + b"\0" + nm.encode() + rgce))
+    tail.append(rec(0x000A, b""))
+    sheets = [sheet(rng, si) for si in range(len(names))]
+    at = sum(len(r) for r in head + tail) + sum(len(boundsheet(0, nm)) for nm in names)
+    bs = []
+    for nm, sh in zip(names, sheets):
+        bs.append(boundsheet(at, nm))
+        at += len(sh)
+    return workbook(b"".join(head + bs + tail + sheets))
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit("usage: make_xls_fuzz_fixture.py out_dir [seeds]")
+    out = Path(sys.argv[1])
+    seeds = int(sys.argv[2]) if len(sys.argv) > 2 else SEEDS
+    out.mkdir(parents=True, exist_ok=True)
+    for seed in range(seeds):
+        (out / f"fuzz_{seed}.xls").write_bytes(build(seed))
+    print(f"wrote {seeds} workbooks to {out}")
+
+
+if __name__ == "__main__":
+    main()
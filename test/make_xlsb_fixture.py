@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+"""Authored .xlsb fixture, and the same workbook as .xlsx, for the xlsb checks.
+
+Excel is not in the test environment, so the BIFF12 parts are laid down record
+by record ([MS-XLSB] 2.1.4: 7-bit varint id and size, then the body), and the
+.xlsx twin is written from the same cell list. The xlsb reader is meant to give
+exactly the fast xlsx reader's bboxes, so test_cross_check.sh diffs both
+against one golden: golden/fixtures__sample_xlsb.bboxes.json.
+
+Sheet "Data" covers RK numbers (integer and the /100 form), a real, shared and
+inline strings, a date-formatted cell, bool and error cells, a plain formula,
+a shared formula over A3:B4, an array formula over A7:A8 and a merge A5:C6
+with a value under it. Sheet "Second" has one cell, for the page-range check.
+
+Stdlib only. Writes next to the other samples by default:
+    python3 test/make_xlsb_fixture.py [out_dir]
+"""
+import struct
+import sys
+import zipfile
+from pathlib import Path
+
+OUT = Path(__file__).resolve().parent.parent / "test_data"
+
+
+def u8(v): return struct.pack("<B", v)
+def u16(v): return struct.pack("<H", v & 0xFFFF)
+def u32(v): return struct.pack("<I", v & 0xFFFFFFFF)
+def f64(v): return struct.pack("<d", v)
+
+
+def vint(v):
+    out = b""
+    while True:
+        b, v = v & 0x7F, v >> 7
+        if not v:
+            return out + bytes([b])
+        out += bytes([b | 0x80])
+
+
+def rec(i, body=b""): return vint(i) + vint(len(body)) + body
+def ws(s): e = s.encode("utf-16-le"); return u32(len(e) // 2) + e       # XLWideString
+def cell(c, s=0): return u32(c) + u32(s)                                 # Cell: column, iStyleRef
+def fml(rgce, rgcb=b""): return u32(len(rgce)) + rgce + u32(len(rgcb)) + rgcb
+def rk_int(v): return u32((v << 2) | 2)
+def rk_cents(v): return u32((v << 2) | 3)                                # integer, /100
+def row(r): return rec(0, u32(r) + b"\0" * 13)                            # BrtRowHdr, 0-based
+
+
+def loc(r, c, rel=True): return u32(r) + u16(c | (0xC000 if rel else 0))
+def area(r1, r2, c1, c2): return u32(r1) + u32(r2) + u16(c1) + u16(c2)   # absolute
+
+
+# (sheet, 0-based row, 0-based col): the xlsx side of each cell as (t, s, v, f)
+XLSX_CELLS = {}
+
+
+def xcell(sheet, r, c, v, t=None, s=0, f=None):
+    XLSX_CELLS.setdefault(sheet, []).append((r, c, t, s, v, f))
+
+
+def data_sheet():
+    s = rec(129) + rec(145)                                             # BrtBeginSheet, BrtBeginSheetData
+    s += row(0)
+    s += rec(7, cell(0) + u32(0));                 xcell(0, 0, 0, "0", "s")               # A1 shared 'hello'
+    s += rec(2, cell(1) + rk_int(42));             xcell(0, 0, 1, "42")                   # B1 RK int
+    s += rec(2, cell(2) + rk_cents(125));          xcell(0, 0, 2, "1.25")                 # C1 RK /100
+    s += rec(5, cell(3) + f64(0.1));               xcell(0, 0, 3, "0.1")                  # D1 real
+    s += rec(2, cell(4, 1) + rk_int(45000));       xcell(0, 0, 4, "45000", s=1)           # E1 date
+    s += row(1)
+    s += rec(6, cell(0) + ws("inline"));           xcell(0, 1, 0, "inline", "str")        # A2
+    s += rec(4, cell(1) + u8(1));                  xcell(0, 1, 1, "1", "b")               # B2 TRUE
+    s += rec(3, cell(2) + u8(0x07));               xcell(0, 1, 2, "#DIV/0!", "e")         # C2
+    s += rec(9, cell(3) + f64(84) + u16(0) + fml(b"\x24" + loc(0, 1) + b"\x1E" + u16(2) + b"\x05"))
+    xcell(0, 1, 3, "84", f="B1*2")                                                          # D2 =B1*2
+    s += rec(7, cell(4) + u32(1));                 xcell(0, 1, 4, "1", "s")               # E2 shared 'world'
+    # A3:B4 shared formula: master A3 =B1+1, the members reusing it relative to themselves
+    shr = b"\x2C" + u32(0xFFFFFFFE) + u16(0x0001 | 0xC000) + b"\x1E" + u16(1) + b"\x03"   # RefN(-2, +1) + 1
+    s += row(2)
+    s += rec(9, cell(0) + f64(43) + u16(0) + fml(b"\x01" + u32(2)))
+    s += rec(427, u32(2) + u32(3) + u32(0) + u32(1) + fml(shr))                # BrtShrFmla, RfX A3:B4
+    xcell(0, 2, 0, "43", f=("shared", "A3:B4", "B1+1"))
+    s += rec(9, cell(1) + f64(2.25) + u16(0) + fml(b"\x01" + u32(2)));  xcell(0, 2, 1, "2.25", f=("shared",))
+    s += row(3)
+    s += rec(9, cell(0) + f64(2) + u16(0) + fml(b"\x01" + u32(2)));     xcell(0, 3, 0, "2", f=("shared",))   # =B2+1
+    s += rec(11, cell(1) + u8(0x07) + u16(0) + fml(b"\x01" + u32(2)));  xcell(0, 3, 1, "#DIV/0!", "e", f=("shared",))
+    s += row(4)
+    s += rec(7, cell(0) + u32(2));                 xcell(0, 4, 0, "2", "s")               # A5 'merged', origin of A5:C6
+    s += rec(5, cell(1) + f64(5));                 xcell(0, 4, 1, "5")                    # B5 under the merge
+    s += row(6)
+    arr = b"\x25" + area(0, 0, 1, 2) + b"\x22\x01" + u16(4)                          # SUM($B$1:$C$1)
+    s += rec(9, cell(0) + f64(43.25) + u16(0) + fml(b"\x01" + u32(6)))
+    s += rec(426, u32(6) + u32(7) + u32(0) + u32(0) + u8(0) + fml(arr))        # BrtArrFmla, RfX A7:A8
+    xcell(0, 6, 0, "43.25", f=("array", "A7:A8", "SUM($B$1:$C$1)"))
+    s += row(7)
+    s += rec(9, cell(0) + f64(43.25) + u16(0) + fml(b"\x01" + u32(6)));  xcell(0, 7, 0, "43.25")
+    s += rec(146)                                                                # BrtEndSheetData
+    s += rec(177, u32(1)) + rec(176, u32(4) + u32(5) + u32(0) + u32(2)) + rec(178)   # merge A5:C6
+    return s + rec(130)
+
+
+def second_sheet():
+    xcell(1, 1, 1, "3")
+    return rec(129) + rec(145) + row(1) + rec(2, cell(1) + rk_int(3)) + rec(146) + rec(130)
+
+
+SST = ["hello", "world", "merged"]
+SHEETS = ["Data", "Second"]
+
+
+def member(z, name, data):
+    info = zipfile.ZipInfo(name, date_time=(2024, 1, 1, 0, 0, 0))    # fixed, so reruns are byte-identical
+    info.compress_type = zipfile.ZIP_DEFLATED
+    z.writestr(info, data)
+
+
+def rels(ext):
+    return ('<?xml version="1.0" encoding="UTF-8" standalone="yes"?>'
+            '<Relationships xmlns="http://schemas.openxmlformats.org/package/2006/relationships">'
+            + "".join(f'<Relationship Id="rId{i + 1}" Type="http://schemas.openxmlformats.org/officeDocument/2006/relationships/worksheet" '
+                      f'Target="worksheets/sheet{i + 1}.{ext}"/>' for i in range(len(SHEETS)))
+            + f'<Relationship Id="rId9" Type="http://schemas.openxmlformats.org/officeDocument/2006/relationships/sharedStrings" Target="sharedStrings.{ext}"/>'
+            + f'<Relationship Id="rId10" Type="http://schemas.openxmlformats.org/officeDocument/2006/relationships/styles" Target="styles.{ext}"/>'
+            "</Relationships>")
+
+
+def write_xlsb(path):
+    wb = rec(131) + rec(153, u32(0) + u32(0)) + rec(143)
+    for i, name in enumerate(SHEETS):
+        wb += rec(156, u32(0) + u32(i + 1) + ws(f"rId{i + 1}") + ws(name))     # BrtBundleSh
+    wb += rec(144) + rec(132)
+    sst = rec(159, u32(len(SST)) + u32(len(SST))) + b"".join(rec(19, u8(0) + ws(t)) for t in SST) + rec(160)
+    st = rec(278) + rec(617, u32(2))
+    st += rec(47, u16(0xFFFF) + u16(0) + b"\0" * 12) + rec(47, u16(0) + u16(14) + b"\0" * 12)   # cellXfs 0, 1 = m/d/yyyy
+    st += rec(618) + rec(279)
+    with zipfile.ZipFile(path, "w") as z:
+        member(z, "[Content_Types].xml", '<?xml version="1.0"?><Types xmlns="http://schemas.openxmlformats.org/package/2006/content-types">'
+               '<Default Extension="bin" ContentType="application/vnd.ms-excel.sheet.binary.macroEnabled.main"/></Types>')
+        member(z, "xl/workbook.bin", wb)
+        member(z, "xl/_rels/workbook.bin.rels", rels("bin"))
+        member(z, "xl/styles.bin", st)
+        member(z, "xl/sharedStrings.bin", sst)
+        member(z, "xl/worksheets/sheet1.bin", data_sheet())
+        member(z, "xl/worksheets/sheet2.bin", second_sheet())
+
+
+def a1(r, c):
+    col = ""
+    c += 1
+    while c:
+        c, m = divmod(c - 1, 26)
+        col = chr(65 + m) + col
+    return f"{col}{r + 1}"
+
+
+def sheet_xml(sheet, merges=""):
+    rows = {}
+    for r, c, t, s, v, f in XLSX_CELLS.get(sheet, []):
+        a = f' t="{t}"' if t else ""
+        a += f' s="{s}"' if s else ""
+        fx = ""
+        if isinstance(f, str):
+            fx = f"<f>{f}</f>"
+        elif f and len(f) == 3:
+            si = ' si="0"' if f[0] == "shared" else ""
+            fx = f'<f t="{f[0]}" ref="{f[1]}"{si}>{f[2]}</f>'
+        elif f:
+            fx = '<f t="shared" si="0"/>'
+        rows.setdefault(r, []).append(f'<c r="{a1(r, c)}"{a}>{fx}<v>{v}</v></c>')
+    body = "".join(f'<row r="{r + 1}">{"".join(cs)}</row>' for r, cs in sorted(rows.items()))
+    return ('<?xml version="1.0" encoding="UTF-8" standalone="yes"?>'
+            '<worksheet xmlns="http://schemas.openxmlformats.org/spreadsheetml/2006/main">'
+            f"<sheetData>{body}</sheetData>{merges}</worksheet>")
+
+
+def write_xlsx(path):
+    main = 'xmlns="http://schemas.openxmlformats.org/spreadsheetml/2006/main"'
+    wb = (f'<?xml version="1.0" encoding="UTF-8" standalone="yes"?><workbook {main} '
+          'xmlns:r="http://schemas.openxmlformats.org/officeDocument/2006/relationships"><sheets>'
+          + "".join(f'<sheet name="{n}" sheetId="{i + 1}" r:id="rId{i + 1}"/>' for i, n in enumerate(SHEETS))
+          + "</sheets></workbook>")
+    sst = (f'<?xml version="1.0" encoding="UTF-8" standalone="yes"?><sst {main} count="{len(SST)}" uniqueCount="{len(SST)}">'
+           + "".join(f"<si><t>{t}</t></si>" for t in SST) + "</sst>")
+    st = (f'<?xml version="1.0" encoding="UTF-8" standalone="yes"?><styleSheet {main}>'
+          '<cellXfs count="2"><xf numFmtId="0"/><xf numFmtId="14" applyNumberFormat="1"/></cellXfs></styleSheet>')
+    with zipfile.ZipFile(path, "w") as z:
+        member(z, "[Content_Types].xml", '<?xml version="1.0"?><Types xmlns="http://schemas.openxmlformats.org/package/2006/content-types">'
+               '<Override PartName="/xl/workbook.xml" ContentType="application/vnd.openxmlformats-officedocument.spreadsheetml.sheet.main+xml"/></Types>')
+        member(z, "xl/workbook.xml", wb)
+        member(z, "xl/_rels/workbook.xml.rels", rels("xml"))
+        member(z, "xl/styles.xml", st)
+        member(z, "xl/sharedStrings.xml", sst)
+        member(z, "xl/worksheets/sheet1.xml", sheet_xml(0, '<mergeCells count="1"><mergeCell ref="A5:C6"/></mergeCells>'))
+        member(z, "xl/worksheets/sheet2.xml", sheet_xml(1))
+
+
+def main():
+    out = Path(sys.argv[1]) if len(sys.argv) > 1 else OUT
+    out.mkdir(parents=True, exist_ok=True)
+    write_xlsb(out / "sample.xlsb")          # fills XLSX_CELLS as it goes
+    write_xlsx(out / "sample_xlsb.xlsx")
+    print(f"wrote {out / 'sample.xlsb'}, {out / 'sample_xlsb.xlsx'}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,69 @@
+"""Byte writers shared by the OLE2 fixture generators (make_*_fixture.py).
+
+Little-endian packers, BIFF records with their BOF, and cfb(): a v3 compound
+file around named streams, which every legacy-Office fixture (.xls, .doc, an
+encrypted OOXML package) needs and none of the test environments can produce.
+
+Stdlib only.
+"""
+import struct
+
+
+def u16(v): return struct.pack("<H", v & 0xFFFF)
+def u32(v): return struct.pack("<I", v & 0xFFFFFFFF)
+def rec(t, body): return u16(t) + u16(len(body)) + body
+
+
+def bof(dt, version=0x0600):
+    """BOF of a BIFF8 substream (0x0600), or BIFF5/7 (0x0500), which stops after rupYear."""
+    body = u16(version) + u16(dt) + u16(0x0DBB) + u16(0x07CC)
+    return rec(0x0809, body + (u32(0) + u32(0x06) if version == 0x0600 else b""))
+
+
+def cfb(streams):
+    """v3 compound file: streams under 4096 bytes in the mini stream, the rest in
+    regular sectors laid out in order; FAT sectors first, then the directory."""
+    ss = 512
+    mini, minifat, regular, entries = b"", [], [], []
+    for name, data in streams:
+        if len(data) < 4096:
+            start, k = len(minifat), (len(data) + 63) // 64
+            minifat += [start + i + 1 for i in range(k - 1)] + [0xFFFFFFFE]
+            mini += data + b"\0" * (k * 64 - len(data))
+            entries.append((name, start, len(data), None))
+        else:
+            entries.append((name, None, len(data), len(regular)))
+            regular.append(data)
+    minifat = b"".join(u32(x) for x in minifat)
+    blobs = [b + b"\0" * (-len(b) % ss) for b in regular + [mini]] + [minifat + b"\xff" * (-len(minifat) % ss)]
+    nsec = sum(len(b) // ss for b in blobs) + 1                    # + the directory
+    nfat = 1
+    while nfat * 128 < nsec + nfat:
+        nfat += 1
+    fat, starts, at = [0xFFFFFFFD] * nfat + [0xFFFFFFFE], [], nfat + 1
+    for b in blobs:
+        k = len(b) // ss
+        starts.append(at)
+        fat += [at + i + 1 for i in range(k - 1)] + [0xFFFFFFFE]
+        at += k
+    fat += [0xFFFFFFFF] * (-len(fat) % 128)
+    hdr = (bytes.fromhex("D0CF11E0A1B11AE1") + b"\0" * 16 + u16(0x3E) + u16(3) + u16(0xFFFE) + u16(9) + u16(6)
+           + b"\0" * 6 + u32(0) + u32(nfat) + u32(nfat) + u32(0) + u32(4096) + u32(starts[-1]) + u32(len(blobs[-1]) // ss)
+           + u32(0xFFFFFFFE) + u32(0) + b"".join(u32(i) for i in range(nfat)) + b"\xff" * (4 * (109 - nfat)))
+
+    def entry(nm, typ, right, child, start, size):
+        n = nm.encode("utf-16-le") + b"\0\0"
+        return (n + b"\0" * (64 - len(n)) + u16(len(n)) + bytes([typ, 1]) + u32(0xFFFFFFFF) + u32(right)
+                + u32(child) + b"\0" * 36 + u32(start) + u32(size) + u32(0))
+    d = entry("Root Entry", 5, 0xFFFFFFFF, 1, starts[-2], len(mini))
+    for i, (name, mstart, size, reg) in enumerate(entries):   # siblings chained to the right
+        right = i + 2 if i + 1 < len(entries) else 0xFFFFFFFF
+        d += entry(name, 2, right, 0xFFFFFFFF, mstart if reg is None else starts[reg], size)
+    assert len(d) <= ss
+    return hdr + b"".join(u32(x) for x in fat) + d + b"\0" * (ss - len(d)) + b"".join(blobs)
+
+
+def workbook(stream, name="Workbook"):
+    """A BIFF stream alone in a compound file, zero-padded to 4096 bytes so it sits
+    in regular sectors, as Excel writes it."""
+    return cfb([(name, stream + b"\0" * max(0, 4096 - len(stream)))])
@@ -6,7 +6,8 @@ segfault/hang on a nasty workbook is reported (CRASH/HANG) instead of killing
 the run:
 
   1. ROBUSTNESS / smoke  — does our tool parse every corpus file without
-     crashing? Classify: OK | BIFF5/7-warn | FILEPASS-skip | FAIL | CRASH | HANG.
+     crashing? Classify: OK | BIFF5/7-warn | FILEPASS-locked | FAIL | CRASH | HANG.
+     (FILEPASS-locked: encrypted and the default password does not open it.)
      Report per-file formula/name/sheet counts.
   2. GOLDEN diff         — for files that have a golden under test/golden/
      (mirrored tree, "<sheet>!<A1>" -> A1 formula), diff our A1 formula output
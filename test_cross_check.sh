@@ -17,6 +17,18 @@ PDF="$(cd "$(dirname "$PDF")" && pwd)/$(basename "$PDF")"
 XLSX="$DIR/test_data/sample.xlsx"
 TXT="$DIR/test_data/sample.txt"
 DOCX="$DIR/test_data/sample.docx"
+XLSB="$DIR/test_data/sample.xlsb"        # test/make_xlsb_fixture.py, with its .xlsx twin
+XLSB_TWIN="$DIR/test_data/sample_xlsb.xlsx"
+XLSB_GOLDEN="$DIR/test/golden/fixtures__sample_xlsb.bboxes.json"
+ODS="$DIR/test_data/sample.ods"          # test/make_ods_fixture.py
+ODS_ENC="$DIR/test_data/sample_encrypted.ods"
+XLS="$DIR/test_data/sample.xls"          # test/make_xls_encrypted_fixture.py, with its
+XLS_GOLDEN="$DIR/test/golden/fixtures__sample_xls.bboxes.json"   # RC4 / CryptoAPI / XOR twins
+XLS_FUZZ_GOLDEN="$DIR/test/golden/fixtures__xls_fuzz.sha256.json" # test/make_xls_fuzz_fixture.py
+OOXML_AGILE="$DIR/test_data/sample_agile.xlsx"        # test/make_ooxml_encrypted_fixture.py,
+OOXML_STANDARD="$DIR/test_data/sample_standard.xlsx"  # the xlsb twins under a password
+OOXML_XLSB="$DIR/test_data/sample_agile.xlsb"
+DOC="$DIR/test_data/sample.doc"          # test/make_doc_fixture.py
 
 PASS=0
 FAIL=0
@@ -51,6 +63,26 @@ for k in ['document_id','source_type','checksum','page_count']:
 print(f'    doc matches (pages={struct[\"page_count\"]})')
 "
 
+check "pdf/file_checksum" "$PYTHON" -c "
+import hashlib, json, sys; sys.path.insert(0, '$DIR/python')
+import blobboxes as bboxes
+from blobboxes._native import lib, _str
+data = open('$PDF','rb').read()
+want = hashlib.sha256(data).hexdigest()
+# the path opens never hash; the opt-in call gives the digest the buffer opens take
+for cls in (bboxes.open_pdf, bboxes.open_pdf_objects):
+    with cls(data) as cur:
+        assert cur.doc()['checksum'] == want, cls
+    with cls.from_path('$PDF') as cur:
+        assert cur.doc()['checksum'] == '', cls
+for fn in ('bboxes_open_pdf_file', 'bboxes_open_pdf_objects_file'):
+    cur = getattr(lib, fn)('$PDF'.encode(), None, 0, 0)
+    assert json.loads(_str(lib.bboxes_get_doc_json(cur)))['checksum'] == '', fn
+    lib.bboxes_close(cur)
+assert bboxes.file_checksum('$PDF') == want
+assert lib.bboxes_file_checksum(b'/nonexistent/x.pdf') is None
+"
+
 check "pdf/pages" "$PYTHON" -c "
 import json, sys; sys.path.insert(0, '$DIR/python')
 import blobboxes as bboxes
@@ -100,6 +132,127 @@ for i,(s,j) in enumerate(zip(structs, jsons)):
 print(f'    {len(structs)} style rows match')
 "
 
+check "pdf/object_styles" "$PYTHON" -c "
+import sys; sys.path.insert(0, '$DIR/python'); sys.path.insert(0, '$DIR/test')
+import blobboxes as bboxes
+from make_pdf_styles_fixture import build
+# one family, a bold and a regular face: each run's text names the style it must get
+with bboxes.open_pdf_objects(build()) as cur:
+    styles = {s['style_id']: s for s in cur.styles()}
+    got = {b['text']: styles[b['style_id']] for b in cur.bboxes()}
+assert len(got) == 5, sorted(got)
+ids = {}
+for text, s in got.items():
+    weight, size = text.split()[:2]
+    assert (s['weight'], s['font_size']) == ('bold' if weight == 'bold' else 'normal', float(size)), (text, s)
+    ids.setdefault((weight, size), set()).add(s['style_id'])
+assert all(len(v) == 1 for v in ids.values()) and len(set.union(*ids.values())) == 3, ids
+"
+
+check "pdf/global_dict" "$PYTHON" -c "
+import json, sys, threading; sys.path.insert(0, '$DIR/python'); sys.path.insert(0, '$DIR/test')
+import blobboxes as bboxes
+from blobboxes._native import lib, _str
+from make_pdf_styles_fixture import build
+docs = [build(), open('$PDF','rb').read(), build()]
+def described(fonts, styles, boxes):
+    # each bbox as (text, font name, size, colour, weight, ...): the same whatever the id space
+    name = {f['font_id']: f['name'] for f in fonts}
+    st = {s['style_id']: (name[s['font_id']],) + tuple(s[k] for k in ('font_size', 'color', 'weight', 'italic', 'underline'))
+          for s in styles}
+    return [(b['text'], st[b['style_id']]) for b in boxes]
+local = []
+for d in docs:
+    with bboxes.open_pdf(d) as cur:
+        local.append(described(cur.fonts(), cur.styles(), cur.bboxes()))
+bboxes.global_dict_reset()
+assert bboxes.global_fonts() == [] and bboxes.global_styles() == []
+# attach: the cursor's ids index the global tables, and JSON built before attaching is rebuilt
+attached = []
+for d, want in zip(docs, local):
+    with bboxes.open_pdf(d) as cur:
+        _str(lib.bboxes_get_bboxes_json(cur._cur))
+        cur.attach_global()
+        boxes = cur.bboxes()
+        assert described(bboxes.global_fonts(), bboxes.global_styles(), boxes) == want
+        ids = [b['style_id'] for b in boxes]
+        assert [b['style_id'] for b in json.loads(_str(lib.bboxes_get_bboxes_json(cur._cur)))] == ids
+        attached.append(ids)
+assert attached[0] == attached[2], 'the same document gets the same ids'
+fonts, styles = bboxes.global_fonts(), bboxes.global_styles()
+assert [f['font_id'] for f in fonts] == list(range(len(fonts))) and len({f['name'] for f in fonts}) == len(fonts)
+assert [s['style_id'] for s in styles] == list(range(len(styles)))
+# auto: every open attaches, the one-shot JSON helpers' cursors too; nothing new is interned
+bboxes.global_dict_auto(True)
+try:
+    for d, ids in zip(docs, attached):
+        with bboxes.open_pdf(d) as cur:
+            assert [b['style_id'] for b in cur.bboxes()] == ids
+        assert [b['style_id'] for b in json.loads(bboxes.bboxes_json(d))] == ids
+        assert set(ids) <= {s['style_id'] for s in json.loads(bboxes.styles_json(d))}
+finally:
+    bboxes.global_dict_auto(False)
+assert (bboxes.global_fonts(), bboxes.global_styles()) == (fonts, styles)
+with bboxes.open_pdf(docs[1]) as cur:
+    assert described(cur.fonts(), cur.styles(), cur.bboxes()) == local[1], 'auto off: local ids again'
+# reset racing attaches: whatever survives, no id is issued twice
+def attach_loop():
+    for _ in range(20):
+        with bboxes.open_pdf(docs[1]) as cur:
+            cur.attach_global()
+def reset_loop():
+    for _ in range(200):
+        bboxes.global_dict_reset()
+threads = [threading.Thread(target=attach_loop) for _ in range(4)] + [threading.Thread(target=reset_loop)]
+for t in threads: t.start()
+for t in threads: t.join()
+for table, key in ((bboxes.global_fonts(), 'font_id'), (bboxes.global_styles(), 'style_id')):
+    ids = [e[key] for e in table]
+    assert len(set(ids)) == len(ids), ids
+bboxes.global_dict_reset()
+assert bboxes.global_fonts() == [] and bboxes.global_styles() == []
+"
+
+check "pdf/rules" "$PYTHON" -c "
+import json, sys; sys.path.insert(0, '$DIR/python'); sys.path.insert(0, '$DIR/test')
+import blobboxes as bboxes
+from blobboxes._native import lib, _str
+from make_pdf_rules_fixture import build, RULES
+data = build()
+def key(r):
+    return (r['kind'],) + tuple(round(r[k], 3) for k in ('x', 'y', 'w', 'h', 'line_width')) + (r['color'],)
+want = [(k,) + tuple(round(float(v), 3) for v in (x, y, w, h, lw)) + (c,) for k, x, y, w, h, lw, c in RULES]
+# hline, vline, rect, a thin filled rect as a line, a line inside a form; both grains
+for cls in (bboxes.open_pdf, bboxes.open_pdf_objects):
+    with cls(data, rules=True) as cur:
+        assert [key(r) for r in cur.rules()] == want, (cls, cur.rules())
+        assert [key(r) for r in json.loads(_str(lib.bboxes_get_rules_json(cur._cur)))] == want, cls
+    # off by default: the object walk is not paid for
+    with cls(data) as cur:
+        assert cur.rules() == [] and len(cur.bboxes()) > 0, cls
+"
+
+check "pdf/lines" "$PYTHON" -c "
+import sys; sys.path.insert(0, '$DIR/python')
+import blobboxes as bboxes
+from collections import Counter, defaultdict
+# every bbox in exactly one line; columns numbered densely in reading order
+for path in ('$PDF', '$DIR/test_data/synthetic/two_column.pdf'):
+    with bboxes.open_pdf(open(path, 'rb').read()) as cur:
+        per_page = Counter(b['page_id'] for b in cur.bboxes())
+        lines = defaultdict(list)
+        for l in cur.lines():
+            lines[l['page_id']].append(l)
+    for page, n in per_page.items():
+        got = sorted(i for l in lines[page] for i in l['bbox_indices'])
+        assert got == list(range(n)), (path, page)
+        cols = []
+        for l in lines[page]:
+            if l['column_id'] not in cols:
+                cols.append(l['column_id'])
+        assert cols == list(range(len(cols))), (path, page, cols)
+"
+
 check "pdf/bboxes" "$PYTHON" -c "
 import json, sys; sys.path.insert(0, '$DIR/python')
 import blobboxes as bboxes
@@ -118,6 +271,34 @@ for i,(s,j) in enumerate(zip(structs, jsons)):
 print(f'    {len(structs)} bbox rows match')
 "
 
+check "pdf/render" "$PYTHON" -c "
+import os, struct, sys, tempfile; sys.path.insert(0, '$DIR/python')
+import blobboxes as bboxes
+data = open('$PDF','rb').read()
+with tempfile.TemporaryDirectory() as d:
+    bboxes.render_cache(d)
+    w, h, png = bboxes.render_page(data, 1, 72)
+    assert png[:8] == b'\\x89PNG\\r\\n\\x1a\\n' and struct.unpack('>II', png[16:24]) == (w, h), (w, h)
+    w, h, px = bboxes.render_page(data, 1, 72, rgba=True)
+    assert len(px) == w * h * 4, (w, h, len(px))
+    [entry] = [f for f in os.listdir(d) if f.endswith('.rgba')]
+    # a hit is served from disk: swap in a 1x1 entry and get it back
+    with open(os.path.join(d, entry), 'wb') as f:
+        f.write(struct.pack('<II', 1, 1) + b'\\x01\\x02\\x03\\x04')
+    assert bboxes.render_page(data, 1, 72, rgba=True) == (1, 1, b'\\x01\\x02\\x03\\x04')
+    # off: rendered again, nothing written
+    bboxes.render_cache(None)
+    before = sorted(os.listdir(d))
+    assert bboxes.render_page(data, 1, 72, rgba=True) == (w, h, px)
+    bboxes.render_page(data, 1, 96)
+    assert sorted(os.listdir(d)) == before, (before, os.listdir(d))
+try:
+    bboxes.render_page(data, 999, 72)
+    raise AssertionError('page 999 rendered')
+except bboxes.Error:
+    pass
+"
+
 # ─── XLSX: Python smoke test ──────────────────────────────────────
 
 echo ""
@@ -135,6 +316,7 @@ assert d['page_count'] >= 1, f'page_count={d[\"page_count\"]}'
 assert len(cur.pages()) >= 1
 boxes = cur.bboxes()
 assert len(boxes) >= 1
+assert cur.fonts() == [], 'xlsx_fast has no fonts'
 cur.close()
 # fonts/styles come from the xlnt reader (open_xlsx_slow), which decodes the style table.
 slow = bboxes.open_xlsx_slow(data)
@@ -145,6 +327,93 @@ slow.close()
 print(f'    xlsx: {d[\"page_count\"]} pages, {len(boxes)} bboxes (fast); {len(fonts)} fonts, {len(styles)} styles (xlnt)')
 "
 
+check "xlsx/rich_runs" "$PYTHON" -c "
+import sys, io, zipfile; sys.path.insert(0, '$DIR/python')
+import blobboxes as bboxes
+ns = 'http://schemas.openxmlformats.org/'
+buf = io.BytesIO()
+with zipfile.ZipFile(buf, 'w') as z:
+    z.writestr('xl/workbook.xml', '<workbook xmlns=\"' + ns + 'spreadsheetml/2006/main\" xmlns:r=\"'
+               + ns + 'officeDocument/2006/relationships\"><sheets><sheet name=\"S\" sheetId=\"1\" r:id=\"rId1\"/></sheets></workbook>')
+    z.writestr('xl/_rels/workbook.xml.rels', '<Relationships xmlns=\"' + ns + 'package/2006/relationships\">'
+               '<Relationship Id=\"rId1\" Type=\"' + ns + 'officeDocument/2006/relationships/worksheet\" Target=\"worksheets/sheet1.xml\"/></Relationships>')
+    z.writestr('xl/sharedStrings.xml', '<sst><si><r><rPr><b/><rFont val=\"Arial\"/></rPr><t>Bold</t></r>'
+               '<r><t xml:space=\"preserve\"> tail</t></r></si></sst>')
+    z.writestr('xl/worksheets/sheet1.xml', '<worksheet><sheetData><row r=\"1\"><c r=\"A1\" t=\"s\"><v>0</v></c>'
+               '</row></sheetData></worksheet>')
+data = buf.getvalue()
+# off by default: the text is read, the run properties are not
+with bboxes.open_xlsx(data) as cur:
+    assert [b['text'] for b in cur.bboxes()] == ['Bold tail']
+    assert cur.runs() == [] and cur.fonts() == []
+want = [(0, 4, 'Arial', 'bold'), (4, 5, 'default', 'normal')]
+with bboxes.open_xlsx(data, rich_runs=True) as cur, bboxes.open_xlsx(data) as plain:
+    runs = [(r['start'], r['length'], r['font'], r['weight']) for r in cur.runs()]
+    assert runs == want, runs
+    assert cur.fonts() == [], 'run fonts stay out of the fast reader font table'
+    assert plain.runs() == [], 'the flag belongs to one open, not the process'
+with bboxes.open_xlsx_artifact(data, rich_runs=True) as cur:
+    assert [(r['start'], r['length'], r['font'], r['weight']) for r in cur.runs()] == want
+"
+
+check "xlsx/whole_column_ranges" "$PYTHON" -c "
+import sys, io, zipfile, time; sys.path.insert(0, '$DIR/python')
+import blobboxes as bboxes
+# a whole-column merge and column-long array/shared refs: tested as spans, never expanded cell by cell
+ns = 'http://schemas.openxmlformats.org/'
+sheet = ('<worksheet xmlns=\"' + ns + 'spreadsheetml/2006/main\"><sheetData>'
+         '<row r=\"1\"><c r=\"A1\"><v>1</v></c><c r=\"B1\"><v>2</v></c>'
+         '<c r=\"C1\"><f t=\"array\" ref=\"C1:C200000\">A1:A200000*2</f><v>2</v></c></row>'
+         '<row r=\"5\"><c r=\"A5\"><v>5</v></c><c r=\"B5\"><v>99</v></c><c r=\"C5\"><v>7</v></c>'
+         '<c r=\"D5\"><f t=\"shared\" ref=\"D5:D100000\" si=\"0\">A5+1</f><v>6</v></c></row>'
+         '<row r=\"6\"><c r=\"D6\"><f t=\"shared\" si=\"0\"/><v>7</v></c><c r=\"E6\"><v>3</v></c></row>'
+         '</sheetData><mergeCells count=\"1\"><mergeCell ref=\"B1:B1048576\"/></mergeCells></worksheet>')
+buf = io.BytesIO()
+with zipfile.ZipFile(buf, 'w') as z:
+    z.writestr('[Content_Types].xml', '<Types xmlns=\"' + ns + 'package/2006/content-types\">'
+               '<Default Extension=\"xml\" ContentType=\"application/xml\"/></Types>')
+    z.writestr('xl/workbook.xml', '<workbook xmlns=\"' + ns + 'spreadsheetml/2006/main\" xmlns:r=\"'
+               + ns + 'officeDocument/2006/relationships\"><sheets><sheet name=\"S\" sheetId=\"1\" r:id=\"rId1\"/></sheets></workbook>')
+    z.writestr('xl/_rels/workbook.xml.rels', '<Relationships xmlns=\"' + ns + 'package/2006/relationships\">'
+               '<Relationship Id=\"rId1\" Type=\"' + ns + 'officeDocument/2006/relationships/worksheet\" Target=\"worksheets/sheet1.xml\"/></Relationships>')
+    z.writestr('xl/worksheets/sheet1.xml', sheet)
+data = buf.getvalue()
+want = [(1, 1, 1, 1, '1'), (2, 1, 1, 1048576, '2'), (3, 1, 1, 200000, '2'),
+        (1, 5, 1, 1, '5'), (4, 5, 1, 99996, '6'), (5, 6, 1, 1, '3')]
+for opener in (bboxes.open_xlsx, bboxes.open_xlsx_slow):
+    t0 = time.perf_counter()
+    with opener(data) as cur:
+        got = [(b['x'], b['y'], b['w'], b['h'], b['text']) for b in cur.bboxes()]
+    assert got == want, (opener.__name__, got)
+    assert time.perf_counter() - t0 < 2.0, opener.__name__
+"
+
+check "xlsx/single_quoted_formulas" "$PYTHON" -c "
+import sys, io, zipfile; sys.path.insert(0, '$DIR/python')
+import blobboxes as bboxes
+# shared and array formulas whose attributes are single-quoted (^ stands for the quote)
+ns = 'http://schemas.openxmlformats.org/'
+sheet = ('<worksheet xmlns=\"' + ns + 'spreadsheetml/2006/main\"><sheetData>'
+         '<row r=\"1\"><c r=\"A1\"><v>1</v></c><c r=\"B1\"><f t=^shared^ ref=^B1:B3^ si=^0^>A1*2</f><v>2</v></c>'
+         '<c r=\"C1\"><f t=^array^ ref=^C1:C2^>A1:A2</f><v>1</v></c></row>'
+         '<row r=\"2\"><c r=\"A2\"><v>2</v></c><c r=\"B2\"><f t=^shared^ si=^0^/><v>4</v></c><c r=\"C2\"><v>2</v></c></row>'
+         '<row r=\"3\"><c r=\"A3\"><v>3</v></c><c r=\"B3\"><f t=^shared^ si=^0^/><v>6</v></c></row>'
+         '</sheetData></worksheet>').replace('^', chr(39))
+buf = io.BytesIO()
+with zipfile.ZipFile(buf, 'w') as z:
+    z.writestr('[Content_Types].xml', '<Types xmlns=\"' + ns + 'package/2006/content-types\">'
+               '<Default Extension=\"xml\" ContentType=\"application/xml\"/></Types>')
+    z.writestr('xl/workbook.xml', '<workbook xmlns=\"' + ns + 'spreadsheetml/2006/main\" xmlns:r=\"'
+               + ns + 'officeDocument/2006/relationships\"><sheets><sheet name=\"S\" sheetId=\"1\" r:id=\"rId1\"/></sheets></workbook>')
+    z.writestr('xl/_rels/workbook.xml.rels', '<Relationships xmlns=\"' + ns + 'package/2006/relationships\">'
+               '<Relationship Id=\"rId1\" Type=\"' + ns + 'officeDocument/2006/relationships/worksheet\" Target=\"worksheets/sheet1.xml\"/></Relationships>')
+    z.writestr('xl/worksheets/sheet1.xml', sheet)
+with bboxes.open_xlsx_slow(buf.getvalue()) as cur:
+    got = [(b['x'], b['y'], b['w'], b['h'], b['text']) for b in cur.bboxes()]
+assert got == [(1, 1, 1, 1, '1'), (2, 1, 1, 3, '2'), (3, 1, 1, 2, '1'),
+               (1, 2, 1, 1, '2'), (1, 3, 1, 1, '3')], got
+"
+
 # ─── Text: Python smoke test ─────────────────────────────────────
 
 echo ""
@@ -186,6 +455,389 @@ cur.close()
 print(f'    docx: {d[\"page_count\"]} tables, {len(boxes)} bboxes (cells)')
 "
 
+# ─── XLSB: Python, golden shared with the fast xlsx reader ──────
+
+echo ""
+echo "=== Python XLSB: golden, same as xlsx_fast on the twin workbook ==="
+
+check "xlsb/golden" "$PYTHON" -c "
+import sys, json; sys.path.insert(0, '$DIR/python'); sys.path.insert(0, '$DIR/test')
+import blobboxes as bboxes
+from golden_rows import rows
+golden = json.load(open('$XLSB_GOLDEN'))
+data = open('$XLSB','rb').read()
+assert bboxes.detect(data) == 'xlsb'
+with bboxes.open_xlsb(data) as cur:
+    assert cur.doc()['page_count'] == 2
+    got = rows(cur, golden)
+for g, b in zip(golden, got):
+    assert g == b, f'{b} != golden {g}'
+assert len(got) == len(golden), f'{len(got)} bboxes, golden has {len(golden)}'
+print(f'    xlsb: {len(got)} bboxes match the golden')
+"
+
+check "xlsb/xlsx_fast_twin" "$PYTHON" -c "
+import sys, json; sys.path.insert(0, '$DIR/python'); sys.path.insert(0, '$DIR/test')
+import blobboxes as bboxes
+from golden_rows import rows
+golden = json.load(open('$XLSB_GOLDEN'))
+with bboxes.open_xlsx(open('$XLSB_TWIN','rb').read()) as cur:
+    got = rows(cur, golden)
+assert got == golden, [(g, b) for g, b in zip(golden, got) if g != b] or f'{len(got)} vs {len(golden)}'
+with bboxes.open_xlsx(open('$XLSB_TWIN','rb').read()) as fast, bboxes.open_xlsb(open('$XLSB','rb').read()) as xb:
+    assert fast.pages() == xb.pages(), (fast.pages(), xb.pages())
+"
+
+check "xlsb/page_range" "$PYTHON" -c "
+import sys; sys.path.insert(0, '$DIR/python')
+import blobboxes as bboxes
+with bboxes.open_xlsb(open('$XLSB','rb').read(), None, 2, 2) as cur:
+    pages, boxes = cur.pages(), cur.bboxes()
+assert [p['page_number'] for p in pages] == [2], pages
+assert [(b['page_id'], b['x'], b['y'], b['text']) for b in boxes] == [(1, 2, 2, '3')], boxes
+"
+
+# ─── ODS: Python ─────────────────────────────────────────────────
+
+echo ""
+echo "=== Python ODS: values, spans, padding, page range ==="
+
+check "ods/values" "$PYTHON" -c "
+import sys, datetime; sys.path.insert(0, '$DIR/python')
+import blobboxes as bboxes
+data = open('$ODS','rb').read()
+assert bboxes.detect(data) == 'ods'
+cur = bboxes.open_ods(data)
+d = cur.doc()
+assert d['source_type'] == 'ods' and d['page_count'] == 3, d
+at = {(b['page_id'], b['x'], b['y']): b for b in cur.bboxes()}
+cur.close()
+assert at[(0,1,1)]['cell_type'] == 'string' and at[(0,1,1)]['text'] == 'hello'
+assert at[(0,2,1)]['vnum'] == 1.5
+assert at[(0,3,1)]['cell_type'] == 'bool' and at[(0,3,1)]['vbool'] is True
+assert at[(0,4,1)]['vdate'] == datetime.datetime(2024, 1, 5, 13, 45), at[(0,4,1)]
+assert at[(0,5,1)]['vdate'] == datetime.datetime(1899, 12, 30, 12, 30), at[(0,5,1)]
+assert abs(at[(0,5,1)]['vnum'] - 12.5 / 24) < 1e-12
+print(f'    ods: {len(at)} bboxes over {d[\"page_count\"]} sheets')
+"
+
+check "ods/formula" "$PYTHON" -c "
+import sys; sys.path.insert(0, '$DIR/python')
+import blobboxes as bboxes
+cur = bboxes.open_ods(open('$ODS','rb').read())
+f = {(b['x'], b['y']): b['formula'] for b in cur.bboxes() if b['page_id'] == 0}
+cur.close()
+# OpenFormula [.B1] / [\$'My Sheet'.\$C\$4] and ';' separators, rewritten to A1
+assert f[(1,2)] == \"=B1*2+SUM(A1:B2,'My Sheet'!\$C\$4)\", f[(1,2)]
+"
+
+check "ods/spans_repeats_padding" "$PYTHON" -c "
+import sys; sys.path.insert(0, '$DIR/python')
+import blobboxes as bboxes
+cur = bboxes.open_ods(open('$ODS','rb').read())
+pages = cur.pages()
+boxes = [b for b in cur.bboxes() if b['page_id'] == 0]
+cur.close()
+# 1048571 x 1024 styled padding rows and 16379 trailing columns: no growth
+assert (pages[0]['width'], pages[0]['height']) == (5, 5), pages[0]
+assert len(boxes) == 15, len(boxes)
+m = [b for b in boxes if b['text'] == 'merged']
+assert len(m) == 1 and (m[0]['x'], m[0]['y'], m[0]['w'], m[0]['h']) == (2, 2, 2, 2), m
+# covered cells yield nothing; the cell after them lands in its own column
+assert not [b for b in boxes if (b['x'], b['y']) in ((3,2), (2,3), (3,3))]
+assert [b['vnum'] for b in boxes if b['x'] == 4 and b['y'] == 3] == [9]
+# one cell repeated over 3 columns and 2 rows
+sevens = sorted((b['x'], b['y']) for b in boxes if b['vnum'] == 7)
+assert sevens == [(x, y) for x in (1,2,3) for y in (4,5)], sevens
+"
+
+check "ods/page_range" "$PYTHON" -c "
+import sys; sys.path.insert(0, '$DIR/python')
+import blobboxes as bboxes
+data = open('$ODS','rb').read()
+cur = bboxes.open_ods(data, 2, 2)
+pages, boxes, d = cur.pages(), cur.bboxes(), cur.doc()
+cur.close()
+assert [p['page_number'] for p in pages] == [2], pages
+assert [b['text'] for b in boxes] == ['second'], boxes
+# page_count is every sheet, as for xlsx / xlsb, not the pages in range
+assert d['page_count'] == 3, d
+for sp, ep in ((1, 1), (3, 0), (0, 2)):
+    with bboxes.open_ods(data, sp, ep) as cur:
+        assert cur.doc()['page_count'] == 3, (sp, ep, cur.doc())
+cur = bboxes.open_ods(data, 3, 0)
+assert [b['text'] for b in cur.bboxes()] == ['third']
+cur.close()
+"
+
+check "ods/encrypted" "$PYTHON" -c "
+import sys; sys.path.insert(0, '$DIR/python')
+import blobboxes as bboxes
+data = open('$ODS_ENC','rb').read()
+try:
+    bboxes.open_ods(data)
+except bboxes.Error:
+    pass
+else:
+    raise AssertionError('encrypted ods opened')
+assert bboxes.probe(data)['encrypted'] is True
+"
+
+# ─── XLS: Python, RC4 and CryptoAPI against one golden ──────────
+
+echo ""
+echo "=== Python XLS: plain, RC4 and CryptoAPI decrypt to one golden ==="
+
+check "xls/encrypted_golden" "$PYTHON" -c "
+import sys, json; sys.path.insert(0, '$DIR/python'); sys.path.insert(0, '$DIR/test')
+import blobboxes as bboxes
+import golden_rows
+golden = json.load(open('$XLS_GOLDEN'))
+def rows(data, pw=None):
+    with bboxes.open_xls(data, pw) as cur:
+        return golden_rows.rows(cur, golden)
+assert rows(open('$XLS','rb').read()) == golden
+base = '$XLS'[:-len('.xls')]
+for scheme in ('rc4', 'cryptoapi', 'xor'):
+    # VelvetSweatshop: opens with no password
+    assert rows(open(f'{base}_{scheme}.xls','rb').read()) == golden, scheme
+    data = open(f'{base}_{scheme}_pw.xls','rb').read()
+    assert rows(data, 'blobboxes') == golden, scheme
+    for pw in (None, 'wrong'):
+        try:
+            rows(data, pw)
+        except bboxes.Error:
+            pass
+        else:
+            raise AssertionError(f'{scheme}_pw opened with password {pw!r}')
+"
+
+check "xls/encrypted_probe_names" "$PYTHON" -c "
+import sys, json; sys.path.insert(0, '$DIR/python')
+import blobboxes as bboxes
+from blobboxes._native import lib, _str
+base = '$XLS'[:-len('.xls')]
+plain = open('$XLS','rb').read()
+want = json.loads(_str(lib.bboxes_xls_names_json(plain, len(plain))))
+assert [n['formula_a1'] for n in want['names']] == ['Data!\$A\$2:\$A\$4'], want
+for scheme in ('rc4', 'cryptoapi', 'xor'):
+    data = open(f'{base}_{scheme}.xls','rb').read()
+    p = bboxes.probe(data)
+    assert (p['format'], p['encrypted'], p['password_required'], p['pages']) == ('xls', True, False, 2), p
+    assert json.loads(_str(lib.bboxes_xls_names_json(data, len(data)))) == want, scheme
+    p = bboxes.probe(open(f'{base}_{scheme}_pw.xls','rb').read())
+    assert (p['encrypted'], p['password_required']) == (True, True), p
+"
+
+check "probe/file_and_zip" "$PYTHON" -c "
+import sys, io, zipfile; sys.path.insert(0, '$DIR/python')
+import blobboxes as bboxes
+base = '$XLS'[:-len('.xls')]
+# the OLE2 path maps the file: same answer as over the bytes
+for path in ('$XLS', base + '_rc4_pw.xls', '$DOC', '$OOXML_AGILE', '$XLSX', '$XLSB'):
+    assert bboxes.probe_file(path) == bboxes.probe(open(path, 'rb').read()), path
+# sheets are the workbook's <sheet> entries, whatever the parts are called
+out = io.BytesIO()
+with zipfile.ZipFile('$XLSX') as zi, zipfile.ZipFile(out, 'w') as zo:
+    for n in zi.namelist():
+        b = zi.read(n).replace(b'sheet1.xml', b'data.xml')
+        if n == 'xl/workbook.xml':
+            b = b.replace(b'<sheet ', b'<x:sheet xmlns:x=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\" ')
+        zo.writestr(n.replace('sheet1.xml', 'data.xml'), b)
+data = out.getvalue()
+p = bboxes.probe(data)
+assert (p['format'], p['pages']) == ('xlsx', 2), p
+out = io.BytesIO()
+with zipfile.ZipFile(out, 'w') as z:
+    z.writestr('a.txt', 'hi')
+p = bboxes.probe(out.getvalue())
+assert (p['format'], p['pages'], p['error']) == ('zip', None, 'zip without a workbook or document part'), p
+"
+
+check "format_file/page_range" "$PYTHON" -c "
+import json, sys; sys.path.insert(0, '$DIR/python')
+import blobboxes
+from blobboxes import _native as n
+from blobboxes._native import lib, _str
+def pages(fmt, path, sp, ep):
+    cur = lib.bboxes_open_format_file(fmt, path.encode(), sp, ep)
+    if not cur: return None
+    try: return [p['page_number'] for p in json.loads(_str(lib.bboxes_get_pages_json(cur)))]
+    finally: lib.bboxes_close(cur)
+# spreadsheets take the range as a sheet range, named or auto-detected
+for fmt in (n.FORMAT_XLSB, n.FORMAT_AUTO):
+    assert pages(fmt, '$XLSB', 2, 2) == [2], fmt
+# a flow format has no pages to range over: refused, not ignored
+for fmt in (n.FORMAT_TEXT, n.FORMAT_AUTO):
+    assert pages(fmt, '$TXT', 0, 0), fmt
+    assert pages(fmt, '$TXT', 1, 1) is None, fmt
+"
+
+check "xls/formula_fuzz" "$PYTHON" -c "
+import sys, json, hashlib; sys.path.insert(0, '$DIR/python'); sys.path.insert(0, '$DIR/test')
+import blobboxes
+from blobboxes._native import lib
+from make_xls_fuzz_fixture import build
+# random and malformed rgce, shared formulas in and out of record order
+for g in json.load(open('$XLS_FUZZ_GOLDEN')):
+    data = build(g['seed'])
+    got = {k: hashlib.sha256(fn(data, len(data))).hexdigest()
+           for k, fn in (('formulas', lib.bboxes_xls_formulas_json), ('names', lib.bboxes_xls_names_json))}
+    assert got == {'formulas': g['formulas'], 'names': g['names']}, g['seed']
+"
+
+# ─── Encrypted OOXML: Python ─────────────────────────────────────
+
+echo ""
+echo "=== Python encrypted OOXML: detect, probe, Agile and Standard ==="
+
+check "ooxml/detect_probe" "$PYTHON" -c "
+import sys; sys.path.insert(0, '$DIR/python')
+import blobboxes as bboxes
+for path in ('$OOXML_AGILE', '$OOXML_STANDARD', '$OOXML_XLSB'):
+    data = open(path, 'rb').read()
+    assert bboxes.detect(data) == 'ooxml-encrypted', (path, bboxes.detect(data))
+    p = bboxes.probe(data)
+    # EncryptionInfo only: whether the default password opens it is not known
+    assert (p['format'], p['encrypted'], p['password_required'], p['error']) == ('ooxml-encrypted', True, None, None), p
+"
+
+check "ooxml/password" "$PYTHON" -c "
+import sys, json; sys.path.insert(0, '$DIR/python'); sys.path.insert(0, '$DIR/test')
+import blobboxes as bboxes
+from golden_rows import rows
+golden = json.load(open('$XLSB_GOLDEN'))
+for path in ('$OOXML_AGILE', '$OOXML_STANDARD'):
+    data = open(path, 'rb').read()
+    with bboxes.open_xlsx(data, 'blobboxes') as cur:
+        assert rows(cur, golden) == golden, path
+    for pw in (None, 'wrong'):
+        try:
+            bboxes.open_xlsx(data, pw)
+        except bboxes.Error:
+            pass
+        else:
+            raise AssertionError(f'{path} opened with password {pw!r}')
+"
+
+check "ooxml/default_password_xlsb" "$PYTHON" -c "
+import sys, json; sys.path.insert(0, '$DIR/python'); sys.path.insert(0, '$DIR/test')
+import blobboxes as bboxes
+from golden_rows import rows
+golden = json.load(open('$XLSB_GOLDEN'))
+# VelvetSweatshop: auto-open decrypts, then finds a binary workbook inside
+with bboxes.open(open('$OOXML_XLSB', 'rb').read()) as cur:
+    assert cur.doc()['source_type'] == 'xlsb'
+    got = rows(cur, golden)
+assert got == golden
+"
+
+# ─── DOC: Python ─────────────────────────────────────────────────
+
+echo ""
+echo "=== Python DOC: table cells and paragraph widths ==="
+
+check "doc/layout" "$PYTHON" -c "
+import sys; sys.path.insert(0, '$DIR/python')
+import blobboxes as bboxes
+data = open('$DOC', 'rb').read()
+assert bboxes.detect(data) == 'doc'
+with bboxes.open_doc(data) as cur:
+    got = [(b['x'], b['y'], b['w'], b['text']) for b in cur.bboxes()]
+# the cells' PAPX carries sprmPChgTabs (cb 255) ahead of sprmPFInTable;
+# w counts characters, so the surrogate pair is one
+assert got == [(1, 1, 11, 'Hello world'),
+               (1, 2, 1, 'A1'), (2, 2, 1, 'B1 line1\\nB1 line2'),
+               (1, 3, 1, 'A2'), (2, 3, 1, 'B2'),
+               (1, 4, 12, 'See link end'),
+               (1, 5, 8, 'Caf\\u00e9 \\u201cq\\u201d'),
+               (1, 6, 12, '\\u03a9mega \\U0001F600 caf\\u00e9'),
+               (1, 7, 4, 'last')], got
+"
+
+# ─── Spatial index: Python, against brute force ──────────────────
+
+echo ""
+echo "=== Python spatial index: rect and nearest against a scan ==="
+
+check "spatial/brute_force" "$PYTHON" -c "
+import sys, io, random, zipfile; sys.path.insert(0, '$DIR/python')
+import blobboxes as bboxes
+rng = random.Random(36)
+
+def col(c):
+    s = ''
+    while c:
+        c, r = divmod(c - 1, 26)
+        s = chr(65 + r) + s
+    return s
+
+# sheets of 1, 17, 300 and 1500 cells (one node, two levels, three) with merges of mixed sizes
+ns = 'http://schemas.openxmlformats.org/'
+buf = io.BytesIO()
+with zipfile.ZipFile(buf, 'w') as z:
+    sizes = (1, 17, 300, 1500)
+    z.writestr('xl/workbook.xml', '<workbook xmlns:r=\"' + ns + 'officeDocument/2006/relationships\"><sheets>'
+               + ''.join(f'<sheet name=\"S{i}\" sheetId=\"{i + 1}\" r:id=\"rId{i}\"/>' for i in range(len(sizes)))
+               + '</sheets></workbook>')
+    z.writestr('xl/_rels/workbook.xml.rels', '<Relationships>' + ''.join(
+        f'<Relationship Id=\"rId{i}\" Target=\"worksheets/s{i}.xml\"/>' for i in range(len(sizes))) + '</Relationships>')
+    for i, n in enumerate(sizes):
+        cells = sorted(rng.sample([(r, c) for r in range(1, 61) for c in range(1, 61)], n))
+        rows, merges = {}, []
+        for r, c in cells:
+            rows.setdefault(r, []).append(f'<c r=\"{col(c)}{r}\"><v>{r * 100 + c}</v></c>')
+            if rng.random() < 0.2:
+                merges.append(f'<mergeCell ref=\"{col(c)}{r}:{col(c + rng.randrange(4))}{r + rng.randrange(3)}\"/>')
+        z.writestr(f'xl/worksheets/s{i}.xml', '<worksheet><sheetData>'
+                   + ''.join(f'<row r=\"{r}\">' + ''.join(cs) + '</row>' for r, cs in sorted(rows.items()))
+                   + '</sheetData><mergeCells>' + ''.join(merges) + '</mergeCells></worksheet>')
+
+def box(b):
+    return (min(b['x'], b['x'] + b['w']), min(b['y'], b['y'] + b['h']),
+            max(b['x'], b['x'] + b['w']), max(b['y'], b['y'] + b['h']))
+
+def d2(bx, x, y):
+    dx = bx[0] - x if x < bx[0] else (x - bx[2] if x > bx[2] else 0)
+    dy = bx[1] - y if y < bx[1] else (y - bx[3] if y > bx[3] else 0)
+    return dx * dx + dy * dy
+
+def compare(cur, exact):
+    pages = {}
+    for b in cur.bboxes():
+        pages.setdefault(b['page_id'], []).append(box(b))
+    queries = 0
+    for pid, boxes in pages.items():
+        x0, y0 = min(b[0] for b in boxes), min(b[1] for b in boxes)
+        x1, y1 = max(b[2] for b in boxes), max(b[3] for b in boxes)
+        pt = lambda: (rng.uniform(x0 - 5, x1 + 5), rng.uniform(y0 - 5, y1 + 5))
+        if exact:   # on the grid too, so edges touch and distances tie
+            pt = lambda: (rng.randint(int(x0) - 2, int(x1) + 2), rng.randint(int(y0) - 2, int(y1) + 2))
+        for _ in range(200):
+            (ax, ay), (bx_, by) = pt(), pt()
+            want = [i for i, b in enumerate(boxes)
+                    if b[0] <= max(ax, bx_) and min(ax, bx_) <= b[2] and b[1] <= max(ay, by) and min(ay, by) <= b[3]]
+            assert cur.query_rect(pid, ax, ay, bx_, by) == want, (pid, ax, ay, bx_, by)
+            x, y = pt()
+            k = rng.choice((1, 3, 16, 40, len(boxes) + 5))
+            got = cur.nearest(pid, x, y, k)
+            ranked = sorted(range(len(boxes)), key=lambda i: (d2(boxes[i], x, y), i))[:k]
+            if exact:
+                assert got == ranked, (pid, x, y, k)
+            else:
+                assert len(got) == len(ranked)
+                for g, r in zip(got, ranked):
+                    assert abs(d2(boxes[g], x, y) - d2(boxes[r], x, y)) <= 1e-9 * (1 + d2(boxes[r], x, y)), (pid, x, y, k)
+            queries += 2
+    return queries
+
+with bboxes.open_xlsx(buf.getvalue()) as cur:
+    n = compare(cur, True)
+with bboxes.open(open('$PDF', 'rb').read()) as cur:
+    n += compare(cur, False)
+print(f'    {n} queries matched the scan')
+"
+
 # ─── DuckDB: PDF table function EXCEPT scalar JSON ───────────────
 
 echo ""
@@ -275,6 +927,8 @@ SELECT CASE WHEN count(*) > 0 THEN 'ok (' || count(*) || ' rows)' ELSE 'EMPTY' E
 FROM bb_text('$TXT');
 "
 
+check "duckdb/text/page_range_rejected" bash -c "! '$DUCKDB' -unsigned -c \"LOAD '$DUCKDB_EXT'; SELECT count(*) FROM bb_text('$TXT', start_page := 1);\" 2>/dev/null"
+
 # ─── DuckDB: DOCX smoke test ─────────────────────────────────────
 
 echo ""
@@ -406,6 +1060,21 @@ assert rows[0] > 0, f'expected rows, got {rows[0]}'
 print(f'    {rows[0]} xlsx bbox rows')
 "
 
+check "sqlite/vdate" "$PYTHON" -c "
+import sqlite3, sys; sys.path.insert(0, '$DIR/python')
+import blobboxes as bboxes
+db = sqlite3.connect(':memory:')
+db.enable_load_extension(True)
+db.load_extension('$SQLITE_EXT')
+# vdate text is the library's ISO form and reads back through SQLite's date functions
+rows = db.execute(\"SELECT page_id, x, y, vdate, strftime('%Y-%m-%dT%H:%M:%S', vdate) FROM bb('$ODS') WHERE vdate IS NOT NULL\").fetchall()
+with bboxes.open_ods(open('$ODS','rb').read()) as cur:
+    want = sorted((b['page_id'], b['x'], b['y'], b['vdate'].isoformat()) for b in cur.bboxes() if b['vdate'])
+assert sorted(r[:4] for r in rows) == want and want, (rows, want)
+assert all(r[3] == r[4] for r in rows), rows
+assert {'2024-01-05T13:45:00', '1899-12-30T12:30:00'} <= {r[3] for r in rows}, rows
+"
+
 # ─── SQLite: Text smoke test ─────────────────────────────────────
 
 echo ""